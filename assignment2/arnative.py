@@ -0,0 +1,964 @@
+"""
+ctypes bindings of the native AR library in native/.
+
+Build it first:
+    cmake -S native -B native/build -DCMAKE_BUILD_TYPE=Release
+    cmake --build native/build
+
+numpy arrays are handed to the library by pointer, without copies, as long
+as they are C-contiguous and of the expected dtype. Use available() to fall
+back to the Python/OpenCV code paths when the library is not built.
+"""
+import ctypes
+import os
+import sys
+
+import numpy as np
+
+ABI_VERSION = 9
+
+_here = os.path.dirname(os.path.abspath(__file__))
+
+
+def _library_candidates():
+    if os.environ.get('ARNATIVE_LIBRARY'):
+        yield os.environ['ARNATIVE_LIBRARY']
+    if sys.platform == 'win32':
+        names = ['arnative.dll']
+    elif sys.platform == 'darwin':
+        names = ['libarnative.dylib']
+    else:
+        names = ['libarnative.so']
+    for build_dir in ['build', os.path.join('build', 'Release')]:
+        for name in names:
+            yield os.path.join(_here, 'native', build_dir, name)
+
+
+def _load():
+    for path in _library_candidates():
+        if not os.path.exists(path):
+            continue
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError as error:
+            print("[DEBUG] Failed to load", path, error)
+            continue
+        if lib.ar_abi_version() != ABI_VERSION:
+            print("[DEBUG] Ignoring", path, "built for another interface version")
+            continue
+        return lib
+    return None
+
+
+_lib = _load()
+
+_float_p = ctypes.POINTER(ctypes.c_float)
+_double_p = ctypes.POINTER(ctypes.c_double)
+
+SOURCE_SYNTHETIC = 0
+SOURCE_Y4M = 1
+SOURCE_EXTERNAL = 2
+
+MAX_HANDS = 4
+HAND_LANDMARKS = 21
+
+_ubyte_p = ctypes.POINTER(ctypes.c_ubyte)
+
+
+class _Frame(ctypes.Structure):
+    _fields_ = [
+        ('sequence', ctypes.c_uint64),
+        ('capture_time_ns', ctypes.c_uint64),
+        ('width', ctypes.c_int),
+        ('height', ctypes.c_int),
+        ('stride', ctypes.c_int),
+        ('pixels', _ubyte_p),
+        ('hand_count', ctypes.c_int),
+        ('model_points', _float_p),
+        ('image_points', _float_p),
+        ('rvecs', _double_p),
+        ('tvecs', _double_p),
+        ('world_points', _float_p),
+        ('reprojected', _float_p),
+        ('errors', _double_p),
+    ]
+
+
+_InferenceCallback = ctypes.CFUNCTYPE(
+    ctypes.c_int, ctypes.c_void_p, _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+    _float_p, _float_p, ctypes.c_int)
+_RenderCallback = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(_Frame))
+
+
+class _PipelineConfig(ctypes.Structure):
+    _fields_ = [
+        ('source', ctypes.c_int),
+        ('video_path', ctypes.c_char_p),
+        ('loop', ctypes.c_int),
+        ('width', ctypes.c_int),
+        ('height', ctypes.c_int),
+        ('source_fps', ctypes.c_double),
+        ('queue_capacity', ctypes.c_int),
+        ('inference', _InferenceCallback),
+        ('inference_user', ctypes.c_void_p),
+        ('inference_command', ctypes.c_char_p),
+        ('synthetic_inference_ms', ctypes.c_double),
+        ('render', _RenderCallback),
+        ('render_user', ctypes.c_void_p),
+        ('camera_matrix', ctypes.c_double * 9),
+    ]
+
+
+FILTER_ONE_EURO = 0
+FILTER_KALMAN = 1
+
+
+class _FilterParams(ctypes.Structure):
+    _fields_ = [
+        ('type', ctypes.c_int),
+        ('min_cutoff', ctypes.c_float),
+        ('beta', ctypes.c_float),
+        ('derivative_cutoff', ctypes.c_float),
+        ('process_noise', ctypes.c_float),
+        ('measurement_noise', ctypes.c_float),
+    ]
+
+
+class _TrackerParams(ctypes.Structure):
+    _fields_ = [
+        ('window_radius', ctypes.c_int),
+        ('levels', ctypes.c_int),
+        ('iterations', ctypes.c_int),
+        ('epsilon', ctypes.c_float),
+        ('min_eigenvalue', ctypes.c_float),
+        ('max_fb_error', ctypes.c_float),
+        ('max_match_error', ctypes.c_float),
+        ('min_tracked_fraction', ctypes.c_float),
+        ('max_track_frames', ctypes.c_int),
+    ]
+
+
+CONTACT_BEGIN = 0
+CONTACT_END = 1
+GRAB_BEGIN = 2
+GRAB_END = 3
+
+
+class _ContactEvent(ctypes.Structure):
+    _fields_ = [
+        ('hand', ctypes.c_int),
+        ('object', ctypes.c_int),
+        ('type', ctypes.c_int),
+        ('distance', ctypes.c_float),
+    ]
+
+
+class _StageStats(ctypes.Structure):
+    _fields_ = [
+        ('name', ctypes.c_char * 16),
+        ('processed', ctypes.c_uint64),
+        ('dropped', ctypes.c_uint64),
+        ('fps', ctypes.c_double),
+        ('busy_ms', ctypes.c_double),
+        ('latency_p50_ms', ctypes.c_double),
+        ('latency_p90_ms', ctypes.c_double),
+        ('latency_p99_ms', ctypes.c_double),
+    ]
+
+
+class _ShmHeader(ctypes.Structure):
+    _fields_ = [
+        ('sequence', ctypes.c_uint64),
+        ('timestamp_ns', ctypes.c_uint64),
+        ('publish_time_ns', ctypes.c_uint64),
+        ('width', ctypes.c_int32),
+        ('height', ctypes.c_int32),
+        ('stride', ctypes.c_int32),
+        ('channels', ctypes.c_int32),
+        ('record_count', ctypes.c_int32),
+        ('user', ctypes.c_int32),
+        ('frame_size', ctypes.c_uint32),
+        ('record_size', ctypes.c_uint32),
+    ]
+
+
+class _ShmSlot(ctypes.Structure):
+    _fields_ = [
+        ('header', ctypes.POINTER(_ShmHeader)),
+        ('frame', ctypes.POINTER(ctypes.c_ubyte)),
+        ('record', ctypes.POINTER(ctypes.c_ubyte)),
+    ]
+
+
+if _lib is not None:
+    _lib.ar_solve_pnp_batch.restype = ctypes.c_int
+    _lib.ar_solve_pnp_batch.argtypes = [
+        ctypes.c_int, ctypes.c_int, _float_p, _float_p, _double_p,
+        _double_p, _double_p, _float_p, _float_p, _double_p]
+
+    _lib.ar_pipeline_default_config.restype = None
+    _lib.ar_pipeline_default_config.argtypes = [ctypes.POINTER(_PipelineConfig)]
+    _lib.ar_pipeline_create.restype = ctypes.c_void_p
+    _lib.ar_pipeline_create.argtypes = [ctypes.POINTER(_PipelineConfig)]
+    _lib.ar_pipeline_start.restype = ctypes.c_int
+    _lib.ar_pipeline_start.argtypes = [ctypes.c_void_p]
+    _lib.ar_pipeline_stop.restype = None
+    _lib.ar_pipeline_stop.argtypes = [ctypes.c_void_p]
+    _lib.ar_pipeline_destroy.restype = None
+    _lib.ar_pipeline_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_pipeline_push_frame.restype = ctypes.c_int
+    _lib.ar_pipeline_push_frame.argtypes = [ctypes.c_void_p, _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+    _lib.ar_pipeline_acquire.restype = ctypes.c_int
+    _lib.ar_pipeline_acquire.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Frame), ctypes.c_int]
+    _lib.ar_pipeline_release.restype = None
+    _lib.ar_pipeline_release.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Frame)]
+    _lib.ar_pipeline_stats.restype = ctypes.c_int
+    _lib.ar_pipeline_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(_StageStats), ctypes.c_int]
+
+    _lib.ar_overlay_create.restype = ctypes.c_void_p
+    _lib.ar_overlay_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+    _lib.ar_overlay_destroy.restype = None
+    _lib.ar_overlay_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_overlay_set_marker_mesh.restype = ctypes.c_int
+    _lib.ar_overlay_set_marker_mesh.argtypes = [
+        ctypes.c_void_p, _float_p, ctypes.c_int, ctypes.POINTER(ctypes.c_uint), ctypes.c_int]
+    _lib.ar_overlay_draw.restype = None
+    _lib.ar_overlay_draw.argtypes = [
+        ctypes.c_void_p, _float_p, ctypes.c_int, _float_p, ctypes.c_float, ctypes.c_int, _float_p, _float_p]
+
+    _int_p = ctypes.POINTER(ctypes.c_int)
+    _lib.ar_interaction_create.restype = ctypes.c_void_p
+    _lib.ar_interaction_create.argtypes = [ctypes.c_float]
+    _lib.ar_interaction_destroy.restype = None
+    _lib.ar_interaction_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_interaction_add_object.restype = ctypes.c_int
+    _lib.ar_interaction_add_object.argtypes = [ctypes.c_void_p, _float_p, ctypes.c_float]
+    _lib.ar_interaction_remove_object.restype = None
+    _lib.ar_interaction_remove_object.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    _lib.ar_interaction_move_objects.restype = None
+    _lib.ar_interaction_move_objects.argtypes = [ctypes.c_void_p, _int_p, _float_p, ctypes.c_int]
+    _lib.ar_interaction_query_sphere.restype = ctypes.c_int
+    _lib.ar_interaction_query_sphere.argtypes = [ctypes.c_void_p, _float_p, ctypes.c_float, _int_p, ctypes.c_int]
+    _lib.ar_interaction_update_hands.restype = ctypes.c_int
+    _lib.ar_interaction_update_hands.argtypes = [
+        ctypes.c_void_p, _float_p, ctypes.c_int, ctypes.c_float, ctypes.c_float,
+        ctypes.POINTER(_ContactEvent), ctypes.c_int]
+    _lib.ar_interaction_grabbed.restype = ctypes.c_int
+    _lib.ar_interaction_grabbed.argtypes = [ctypes.c_void_p, ctypes.c_int]
+
+    _lib.ar_filter_default_params.restype = None
+    _lib.ar_filter_default_params.argtypes = [ctypes.POINTER(_FilterParams), ctypes.c_int]
+    _lib.ar_filter_create.restype = ctypes.c_void_p
+    _lib.ar_filter_create.argtypes = [ctypes.c_int, ctypes.POINTER(_FilterParams)]
+    _lib.ar_filter_destroy.restype = None
+    _lib.ar_filter_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_filter_reset.restype = None
+    _lib.ar_filter_reset.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+    _lib.ar_filter_update.restype = None
+    _lib.ar_filter_update.argtypes = [
+        ctypes.c_void_p, _float_p, ctypes.c_double, ctypes.c_float, _float_p, _float_p]
+
+    _lib.ar_compositor_create.restype = ctypes.c_void_p
+    _lib.ar_compositor_create.argtypes = [ctypes.c_int, ctypes.c_int]
+    _lib.ar_compositor_destroy.restype = None
+    _lib.ar_compositor_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_compositor_begin_upload.restype = _ubyte_p
+    _lib.ar_compositor_begin_upload.argtypes = [ctypes.c_void_p]
+    _lib.ar_compositor_end_upload.restype = None
+    _lib.ar_compositor_end_upload.argtypes = [ctypes.c_void_p]
+    _lib.ar_compositor_upload.restype = ctypes.c_int
+    _lib.ar_compositor_upload.argtypes = [ctypes.c_void_p, _ubyte_p, ctypes.c_int]
+    _lib.ar_compositor_draw.restype = None
+    _lib.ar_compositor_draw.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    _lib.ar_compositor_stats.restype = None
+    _lib.ar_compositor_stats.argtypes = [
+        ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64)]
+
+    _lib.ar_preprocess_create.restype = ctypes.c_void_p
+    _lib.ar_preprocess_create.argtypes = [ctypes.c_int]
+    _lib.ar_preprocess_destroy.restype = None
+    _lib.ar_preprocess_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_preprocess_thread_count.restype = ctypes.c_int
+    _lib.ar_preprocess_thread_count.argtypes = [ctypes.c_void_p]
+    _lib.ar_preprocess_frame.restype = ctypes.c_int
+    _lib.ar_preprocess_frame.argtypes = [
+        ctypes.c_void_p, _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+        _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+
+    _lib.ar_tracker_default_params.restype = None
+    _lib.ar_tracker_default_params.argtypes = [ctypes.POINTER(_TrackerParams)]
+    _lib.ar_tracker_create.restype = ctypes.c_void_p
+    _lib.ar_tracker_create.argtypes = [ctypes.c_int, ctypes.POINTER(_TrackerParams)]
+    _lib.ar_tracker_destroy.restype = None
+    _lib.ar_tracker_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_tracker_set_points.restype = ctypes.c_int
+    _lib.ar_tracker_set_points.argtypes = [
+        ctypes.c_void_p, _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, _float_p, ctypes.c_int]
+    _lib.ar_tracker_track.restype = ctypes.c_int
+    _lib.ar_tracker_track.argtypes = [
+        ctypes.c_void_p, _ubyte_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+        _float_p, _ubyte_p, _float_p]
+    _lib.ar_tracker_object_count.restype = ctypes.c_int
+    _lib.ar_tracker_object_count.argtypes = [ctypes.c_void_p]
+
+    _lib.ar_shm_create.restype = ctypes.c_void_p
+    _lib.ar_shm_create.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64]
+    _lib.ar_shm_open.restype = ctypes.c_void_p
+    _lib.ar_shm_open.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    _lib.ar_shm_destroy.restype = None
+    _lib.ar_shm_destroy.argtypes = [ctypes.c_void_p]
+    _lib.ar_shm_capacity.restype = None
+    _lib.ar_shm_capacity.argtypes = [
+        ctypes.c_void_p, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64)]
+    _lib.ar_shm_begin_write.restype = ctypes.c_int
+    _lib.ar_shm_begin_write.argtypes = [ctypes.c_void_p, ctypes.POINTER(_ShmSlot), ctypes.c_int]
+    _lib.ar_shm_end_write.restype = None
+    _lib.ar_shm_end_write.argtypes = [ctypes.c_void_p]
+    _lib.ar_shm_close_writer.restype = None
+    _lib.ar_shm_close_writer.argtypes = [ctypes.c_void_p]
+    _lib.ar_shm_begin_read.restype = ctypes.c_int
+    _lib.ar_shm_begin_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(_ShmSlot), ctypes.c_int, ctypes.c_int]
+    _lib.ar_shm_end_read.restype = None
+    _lib.ar_shm_end_read.argtypes = [ctypes.c_void_p]
+    _lib.ar_shm_stats.restype = None
+    _lib.ar_shm_stats.argtypes = [
+        ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64)]
+
+
+def available():
+    return _lib is not None
+
+
+def _pointer(array, pointer_type):
+    return array.ctypes.data_as(pointer_type)
+
+
+def solve_pnp_batch(model_points, image_points, camera_matrix):
+    """
+    Solve the pose of all hands of a frame in one call.
+
+    Input:
+      model_points: H x N x 3 float32, model space landmarks of H hands
+      image_points: H x N x 2 float32, image landmarks in pixels
+      camera_matrix: 3 x 3 intrinsic matrix
+
+    Output (rvecs, tvecs, world_points, reprojected, errors):
+      rvecs, tvecs: H x 3 rotation vectors and translations (OpenCV convention)
+      world_points: H x N x 3, model points in camera space
+      reprojected: H x N x 2, world points projected to pixels
+      errors: H, norm of the reprojection residuals / N per hand, -1 if it failed
+    """
+    model_points = np.ascontiguousarray(model_points, dtype=np.float32)
+    image_points = np.ascontiguousarray(image_points, dtype=np.float32)
+    camera_matrix = np.ascontiguousarray(camera_matrix, dtype=np.float64)
+    hand_count, point_count = model_points.shape[:2]
+    if image_points.shape[:2] != (hand_count, point_count):
+        raise ValueError("model_points and image_points do not match")
+
+    rvecs = np.empty((hand_count, 3), dtype=np.float64)
+    tvecs = np.empty((hand_count, 3), dtype=np.float64)
+    world_points = np.empty((hand_count, point_count, 3), dtype=np.float32)
+    reprojected = np.empty((hand_count, point_count, 2), dtype=np.float32)
+    errors = np.empty(hand_count, dtype=np.float64)
+    if hand_count == 0:
+        return rvecs, tvecs, world_points, reprojected, errors
+
+    _lib.ar_solve_pnp_batch(
+        hand_count, point_count,
+        _pointer(model_points, _float_p), _pointer(image_points, _float_p), _pointer(camera_matrix, _double_p),
+        _pointer(rvecs, _double_p), _pointer(tvecs, _double_p),
+        _pointer(world_points, _float_p), _pointer(reprojected, _float_p), _pointer(errors, _double_p))
+    return rvecs, tvecs, world_points, reprojected, errors
+
+
+class PipelineFrame:
+    """
+    A finished frame of the pipeline. The arrays are views of the pipeline's
+    memory and are only valid until release().
+    """
+
+    def __init__(self, raw):
+        self.raw = raw
+        self.sequence = raw.sequence
+        self.capture_time_ns = raw.capture_time_ns
+        self.hand_count = raw.hand_count
+        rows = raw.height
+        self.pixels = np.ctypeslib.as_array(raw.pixels, shape=(rows, raw.stride))[:, :raw.width * 3] \
+            .reshape(rows, raw.width, 3)
+        hands = raw.hand_count
+        if hands:
+            self.model_points = np.ctypeslib.as_array(raw.model_points, shape=(hands, HAND_LANDMARKS, 3))
+            self.image_points = np.ctypeslib.as_array(raw.image_points, shape=(hands, HAND_LANDMARKS, 2))
+            self.rvecs = np.ctypeslib.as_array(raw.rvecs, shape=(hands, 3))
+            self.tvecs = np.ctypeslib.as_array(raw.tvecs, shape=(hands, 3))
+            self.world_points = np.ctypeslib.as_array(raw.world_points, shape=(hands, HAND_LANDMARKS, 3))
+            self.reprojected = np.ctypeslib.as_array(raw.reprojected, shape=(hands, HAND_LANDMARKS, 2))
+            self.errors = np.ctypeslib.as_array(raw.errors, shape=(hands,))
+        else:
+            self.model_points = np.empty((0, HAND_LANDMARKS, 3), dtype=np.float32)
+            self.image_points = np.empty((0, HAND_LANDMARKS, 2), dtype=np.float32)
+            self.rvecs = np.empty((0, 3))
+            self.tvecs = np.empty((0, 3))
+            self.world_points = np.empty((0, HAND_LANDMARKS, 3), dtype=np.float32)
+            self.reprojected = np.empty((0, HAND_LANDMARKS, 2), dtype=np.float32)
+            self.errors = np.empty(0)
+
+
+class Pipeline:
+    """
+    Capture, inference, pose and rendering on native threads (see
+    ar_pipeline_* in native/include/arnative.h). Rendering stays on the
+    caller's thread, which owns the GL context: acquire() the newest
+    finished frame, draw it, then release() it.
+
+    inference is an optional Python function (bgr_image) -> (model_points,
+    image_points) of shapes H x 21 x 3 and H x 21 x 2. It runs on the native
+    inference thread, holding the GIL only for its own duration.
+    """
+
+    def __init__(self, source=SOURCE_SYNTHETIC, video_path=None, width=1280, height=720,
+                 source_fps=30.0, queue_capacity=2, inference=None, inference_command=None,
+                 synthetic_inference_ms=20.0, camera_matrix=None, loop=True):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        config = _PipelineConfig()
+        _lib.ar_pipeline_default_config(ctypes.byref(config))
+        config.source = source
+        config.video_path = video_path.encode() if video_path else None
+        config.loop = int(loop)
+        config.width = width
+        config.height = height
+        config.source_fps = source_fps
+        config.queue_capacity = queue_capacity
+        config.inference_command = inference_command.encode() if inference_command else None
+        config.synthetic_inference_ms = synthetic_inference_ms
+        if camera_matrix is not None:
+            config.camera_matrix[:] = np.asarray(camera_matrix, dtype=np.float64).ravel()
+
+        # The callback object must outlive the pipeline
+        self._inference = None
+        if inference is not None:
+            def call(user, bgr, w, h, stride, model_out, image_out, max_hands):
+                image = np.ctypeslib.as_array(bgr, shape=(h, stride))[:, :w * 3].reshape(h, w, 3)
+                model_points, image_points = inference(image)
+                hands = min(len(model_points), max_hands)
+                if hands:
+                    np.ctypeslib.as_array(model_out, shape=(max_hands, HAND_LANDMARKS, 3))[:hands] = model_points[:hands]
+                    np.ctypeslib.as_array(image_out, shape=(max_hands, HAND_LANDMARKS, 2))[:hands] = image_points[:hands]
+                return hands
+            self._inference = _InferenceCallback(call)
+            config.inference = self._inference
+
+        self._config = config
+        self._handle = _lib.ar_pipeline_create(ctypes.byref(config))
+
+    def start(self):
+        if not _lib.ar_pipeline_start(self._handle):
+            raise RuntimeError("Failed to start the pipeline")
+
+    def stop(self):
+        if self._handle:
+            _lib.ar_pipeline_stop(self._handle)
+
+    def close(self):
+        if self._handle:
+            _lib.ar_pipeline_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def push_frame(self, bgr_image):
+        """
+        External source only: a height x width x 3 uint8 BGR frame of the
+        configured size. Returns False if the frame was dropped.
+        """
+        height, width = self._config.height, self._config.width
+        if bgr_image.dtype != np.uint8 or bgr_image.shape != (height, width, 3) \
+                or not bgr_image.flags['C_CONTIGUOUS']:
+            raise ValueError("Expected a contiguous %d x %d x 3 uint8 image" % (height, width))
+        return bool(_lib.ar_pipeline_push_frame(self._handle, _pointer(bgr_image, _ubyte_p), width, height, bgr_image.strides[0]))
+
+    def acquire(self, timeout_ms=100):
+        """The newest finished frame, or None on timeout."""
+        raw = _Frame()
+        if not _lib.ar_pipeline_acquire(self._handle, ctypes.byref(raw), timeout_ms):
+            return None
+        return PipelineFrame(raw)
+
+    def release(self, frame):
+        _lib.ar_pipeline_release(self._handle, ctypes.byref(frame.raw))
+
+    def stats(self):
+        """One dict per stage: processed, dropped, fps, busy_ms and latency percentiles."""
+        stats = (_StageStats * 8)()
+        count = _lib.ar_pipeline_stats(self._handle, stats, 8)
+        return [{
+            'name': stats[i].name.decode(),
+            'processed': stats[i].processed,
+            'dropped': stats[i].dropped,
+            'fps': stats[i].fps,
+            'busy_ms': stats[i].busy_ms,
+            'latency_p50_ms': stats[i].latency_p50_ms,
+            'latency_p90_ms': stats[i].latency_p90_ms,
+            'latency_p99_ms': stats[i].latency_p99_ms,
+        } for i in range(count)]
+
+
+class Compositor:
+    """
+    Camera background drawn from one persistent texture, fed through pixel
+    buffer objects (see ar_compositor_* in native/include/arnative.h). The
+    flip and BGR to RGB conversion happen in the blit shader, so frames go
+    in exactly as OpenCV captures them. The GL context must be current.
+    """
+
+    def __init__(self, width, height):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self.width = width
+        self.height = height
+        self._handle = _lib.ar_compositor_create(width, height)
+        if not self._handle:
+            raise RuntimeError("Failed to create the background compositor")
+
+    def release(self):
+        if self._handle:
+            _lib.ar_compositor_destroy(self._handle)
+            self._handle = None
+
+    def upload(self, bgr_image):
+        """Queue a height x width x 3 uint8 BGR frame for the next draw()."""
+        if bgr_image.dtype != np.uint8 or bgr_image.shape != (self.height, self.width, 3) \
+                or bgr_image.strides[1:] != (3, 1):
+            raise ValueError("Expected a %d x %d x 3 uint8 image" % (self.height, self.width))
+        return bool(_lib.ar_compositor_upload(self._handle, _pointer(bgr_image, _ubyte_p), bgr_image.strides[0]))
+
+    def begin_upload(self):
+        """
+        A writable height x width x 3 view of the next upload buffer, e.g. for
+        capture.read(image=...), or None. Call end_upload() when filled.
+        """
+        pixels = _lib.ar_compositor_begin_upload(self._handle)
+        if not pixels:
+            return None
+        return np.ctypeslib.as_array(pixels, shape=(self.height, self.width, 3))
+
+    def end_upload(self):
+        _lib.ar_compositor_end_upload(self._handle)
+
+    def draw(self, mirror=True):
+        _lib.ar_compositor_draw(self._handle, int(mirror))
+
+    def stats(self):
+        uploads = ctypes.c_uint64()
+        orphaned = ctypes.c_uint64()
+        _lib.ar_compositor_stats(self._handle, ctypes.byref(uploads), ctypes.byref(orphaned))
+        return uploads.value, orphaned.value
+
+
+class LandmarkFilter:
+    """
+    One Euro or constant velocity Kalman filtering of a fixed size array of
+    landmark coordinates, e.g. hands x 21 x 3 (see ar_filter_* in
+    native/include/arnative.h). update() returns the smoothed values and
+    the values extrapolated by predict_s seconds, in the input's shape.
+    Keyword arguments override the parameters, whose defaults suit pixels.
+    """
+
+    def __init__(self, shape, kind=FILTER_ONE_EURO, **params):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self.shape = tuple(np.atleast_1d(shape))
+        self.size = int(np.prod(self.shape))
+        config = _FilterParams()
+        _lib.ar_filter_default_params(ctypes.byref(config), kind)
+        for name, value in params.items():
+            setattr(config, name, value)
+        self._handle = _lib.ar_filter_create(self.size, ctypes.byref(config))
+        self._filtered = np.empty(self.shape, dtype=np.float32)
+        self._predicted = np.empty(self.shape, dtype=np.float32)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.ar_filter_destroy(self._handle)
+            self._handle = None
+
+    def reset(self, first=0, count=None):
+        """Restart the given flat range of channels, all of them by default."""
+        _lib.ar_filter_reset(self._handle, first, self.size - first if count is None else count)
+
+    def update(self, measurements, timestamp_s, predict_s=0.0):
+        """
+        Filter one frame of measurements taken at timestamp_s. The returned
+        arrays are reused by the next update.
+        """
+        measurements = np.ascontiguousarray(measurements, dtype=np.float32)
+        if measurements.size != self.size:
+            raise ValueError("Expected %d values, got %d" % (self.size, measurements.size))
+        _lib.ar_filter_update(self._handle, _pointer(measurements, _float_p), timestamp_s, predict_s,
+                              _pointer(self._filtered, _float_p), _pointer(self._predicted, _float_p))
+        return self._filtered, self._predicted
+
+
+PREPROCESS_MIRROR = 1
+PREPROCESS_SWAP_RB = 2
+
+
+class Preprocessor:
+    """
+    cv2.resize (INTER_LINEAR) + cv2.flip(image, 1) + cv2.cvtColor(BGR2RGB)
+    in one pass over the frame, split over threads (see ar_preprocess_* in
+    native/include/arnative.h). Results are within one or two levels of
+    the OpenCV sequence.
+    """
+
+    def __init__(self, threads=0):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self._handle = _lib.ar_preprocess_create(threads)
+        self.threads = _lib.ar_preprocess_thread_count(self._handle)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.ar_preprocess_destroy(self._handle)
+            self._handle = None
+
+    def __call__(self, image, size, mirror=False, swap_rb=False, out=None):
+        """
+        Resize an H x W x 3 uint8 image to size = (width, height), like
+        cv2.resize. out, if given, must be height x width x 3 uint8 with
+        C-contiguous rows.
+        """
+        if image.dtype != np.uint8 or image.ndim != 3 or image.shape[2] != 3 or image.strides[1:] != (3, 1):
+            image = np.ascontiguousarray(image, dtype=np.uint8)
+        width, height = size
+        if out is None:
+            out = np.empty((height, width, 3), dtype=np.uint8)
+        elif out.shape != (height, width, 3) or out.dtype != np.uint8 or out.strides[1:] != (3, 1):
+            raise ValueError("out must be a %d x %d x 3 uint8 array" % (height, width))
+        flags = (PREPROCESS_MIRROR if mirror else 0) | (PREPROCESS_SWAP_RB if swap_rb else 0)
+        if not _lib.ar_preprocess_frame(self._handle, _pointer(image, _ubyte_p), image.shape[1], image.shape[0],
+                                        image.strides[0], _pointer(out, _ubyte_p), width, height, out.strides[0],
+                                        flags):
+            raise ValueError("Bad preprocessing arguments")
+        return out
+
+
+def _image_arguments(image):
+    """Pointer, width, height, row stride and channels of an 8-bit image."""
+    if image.dtype != np.uint8 or image.strides[-1] != 1 or (image.ndim == 3 and image.strides[1] != image.shape[2]):
+        image = np.ascontiguousarray(image, dtype=np.uint8)
+    channels = image.shape[2] if image.ndim == 3 else 1
+    return image, _pointer(image, _ubyte_p), image.shape[1], image.shape[0], image.strides[0], channels
+
+
+class LandmarkTracker:
+    """
+    Detect-then-track (see ar_tracker_* in native/include/arnative.h): the
+    detector's landmarks are followed into the next frames with pyramidal
+    Lucas-Kanade optical flow, and the detector only runs when track() says
+    so. Points are objects x points_per_object x 2 pixel coordinates.
+    Keyword arguments override the parameters.
+
+        if tracker.track(frame) is None:
+            points = detect(frame)
+            tracker.set_points(points)      # reuses the frame given to track()
+    """
+
+    def __init__(self, points_per_object, **params):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self.points_per_object = points_per_object
+        config = _TrackerParams()
+        _lib.ar_tracker_default_params(ctypes.byref(config))
+        for name, value in params.items():
+            setattr(config, name, value)
+        self._handle = _lib.ar_tracker_create(points_per_object, ctypes.byref(config))
+        self._points = np.empty((0, points_per_object, 2), dtype=np.float32)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.ar_tracker_destroy(self._handle)
+            self._handle = None
+
+    def set_points(self, points, image=None):
+        """
+        Restart tracking from the detector's points on image (H x W or
+        H x W x 3/4 uint8, any channel order), by default the frame of the
+        last track() call.
+        """
+        points = np.ascontiguousarray(points, dtype=np.float32).reshape(-1, self.points_per_object, 2)
+        if image is None:
+            arguments = (None, 0, 0, 0, 0)
+        else:
+            image, *arguments = _image_arguments(image)
+        if not _lib.ar_tracker_set_points(self._handle, *arguments, _pointer(points, _float_p), len(points)):
+            raise ValueError("Bad tracker arguments")
+        self._points = points.copy()
+
+    def track(self, image):
+        """
+        Follow the points into a new frame. Returns (points, status, errors),
+        the tracked points, 1 per point still tracked and the forward-backward
+        errors, or None when the detector should run on this frame.
+        """
+        image, *arguments = _image_arguments(image)
+        points = np.empty_like(self._points)
+        status = np.zeros(points.shape[:2], dtype=np.uint8)
+        errors = np.empty(points.shape[:2], dtype=np.float32)
+        good = _lib.ar_tracker_track(self._handle, *arguments, _pointer(points, _float_p),
+                                     _pointer(status, _ubyte_p), _pointer(errors, _float_p))
+        if _lib.ar_tracker_object_count(self._handle) != len(self._points):
+            self._points = np.empty((0, self.points_per_object, 2), dtype=np.float32)
+            return None
+        self._points = points
+        return (points, status, errors) if good else None
+
+
+class SharedSlot:
+    """
+    A slot of a SharedRing, between begin_write/begin_read and the matching
+    end_*. frame() and record() are numpy views of the shared memory itself,
+    valid until then; header is the ArShmHeader, also in place.
+    """
+
+    def __init__(self, slot, frame_capacity, record_capacity):
+        self.header = slot.header.contents
+        self._frame = np.ctypeslib.as_array(slot.frame, (frame_capacity,)) if frame_capacity else None
+        self._record = np.ctypeslib.as_array(slot.record, (record_capacity,)) if record_capacity else None
+
+    def frame(self):
+        """The frame as height x width (x channels) uint8, as described by the header."""
+        h = self.header
+        if not h.frame_size:
+            return None
+        rows = self._frame[:h.height * h.stride].reshape(h.height, h.stride)[:, :h.width * h.channels]
+        return rows.reshape(h.height, h.width, h.channels) if h.channels > 1 else rows
+
+    def record(self, dtype=np.float32, shape=None):
+        """The record_size bytes of the record as dtype, reshaped to shape."""
+        values = self._record[:self.header.record_size].view(dtype)
+        return values if shape is None else values.reshape(shape)
+
+    def set_frame(self, image):
+        """Copy an 8-bit image (H x W or H x W x C) into the slot and describe it in the header."""
+        image = np.asarray(image, dtype=np.uint8)
+        height, width = image.shape[:2]
+        channels = image.shape[2] if image.ndim == 3 else 1
+        size = height * width * channels
+        if size > len(self._frame if self._frame is not None else ()):
+            raise ValueError("Frame larger than the slots of the ring")
+        self._frame[:size].reshape(image.shape)[...] = image
+        h = self.header
+        h.width, h.height, h.stride, h.channels, h.frame_size = width, height, width * channels, channels, size
+
+    def set_record(self, values, count=None):
+        """Copy an array into the record, count (default len(values)) as record_count."""
+        data = np.ascontiguousarray(values).view(np.uint8).ravel()
+        if len(data) > len(self._record if self._record is not None else ()):
+            raise ValueError("Record larger than the slots of the ring")
+        self._record[:len(data)] = data
+        self.header.record_size = len(data)
+        self.header.record_count = len(values) if count is None else count
+
+
+class SharedRing:
+    """
+    Frames and records between processes in a shared memory ring (see
+    ar_shm_* in native/include/arnative.h), one writer and one reader.
+    The writer creates the ring, the reader opens it by name:
+
+        ring = SharedRing("/ar_frames", create=True, frame_capacity=1920 * 1080 * 3, record_capacity=4096)
+        slot = ring.begin_write()
+        slot.set_frame(image)
+        slot.set_record(landmarks)
+        ring.end_write()
+
+        ring = SharedRing("/ar_frames")
+        slot = ring.begin_read(latest=True)
+        if slot is not None:
+            use(slot.frame(), slot.record(shape=(-1, 21, 3)))
+            ring.end_read()
+
+    header.publish_time_ns is on the clock of time.monotonic_ns().
+    """
+
+    def __init__(self, name, create=False, slots=3, frame_capacity=0, record_capacity=0, timeout_ms=5000):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        if create:
+            self._handle = _lib.ar_shm_create(name.encode(), slots, frame_capacity, record_capacity)
+        else:
+            self._handle = _lib.ar_shm_open(name.encode(), timeout_ms)
+        if not self._handle:
+            raise OSError(f"Could not {'create' if create else 'open'} the shared ring {name}")
+        count = ctypes.c_int()
+        frame = ctypes.c_uint64()
+        record = ctypes.c_uint64()
+        _lib.ar_shm_capacity(self._handle, ctypes.byref(count), ctypes.byref(frame), ctypes.byref(record))
+        self.slots, self.frame_capacity, self.record_capacity = count.value, frame.value, record.value
+        self.closed = False
+        self._slot = _ShmSlot()
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.ar_shm_destroy(self._handle)
+            self._handle = None
+
+    def begin_write(self, timeout_ms=-1):
+        """The next free slot, or None if the ring stayed full for timeout_ms."""
+        if not _lib.ar_shm_begin_write(self._handle, ctypes.byref(self._slot), timeout_ms):
+            return None
+        return SharedSlot(self._slot, self.frame_capacity, self.record_capacity)
+
+    def end_write(self):
+        _lib.ar_shm_end_write(self._handle)
+
+    def close_writer(self):
+        _lib.ar_shm_close_writer(self._handle)
+
+    def begin_read(self, timeout_ms=-1, latest=False):
+        """
+        The oldest unread slot, or the newest one with latest. None on
+        timeout, or with closed set once the writer is done.
+        """
+        result = _lib.ar_shm_begin_read(self._handle, ctypes.byref(self._slot), timeout_ms, int(latest))
+        if result < 0:
+            self.closed = True
+        if result <= 0:
+            return None
+        return SharedSlot(self._slot, self.frame_capacity, self.record_capacity)
+
+    def end_read(self):
+        _lib.ar_shm_end_read(self._handle)
+
+    def stats(self):
+        """Slots written, read and skipped by latest reads."""
+        values = [ctypes.c_uint64() for _ in range(3)]
+        _lib.ar_shm_stats(self._handle, *[ctypes.byref(v) for v in values])
+        return tuple(v.value for v in values)
+
+
+def image_transform(mirror=False):
+    """
+    Column major transform from normalized image coordinates (x right, y down,
+    in [0, 1], as MediaPipe gives them) to clip space, for Overlay.draw.
+    """
+    x_scale = -2.0 if mirror else 2.0
+    return np.array([
+        x_scale, 0, 0, 0,
+        0, -2, 0, 0,
+        0, 0, 0, 0,
+        -x_scale / 2, 1, 0, 1,
+    ], dtype=np.float32)
+
+
+class Overlay:
+    """
+    Landmark markers and connections of many hands or faces in two draw
+    calls (see ar_overlay_* in native/include/arnative.h). connections are
+    (a, b) landmark index pairs within one object, e.g.
+    mp.solutions.face_mesh.FACEMESH_TESSELATION. The GL context must be
+    current.
+    """
+
+    def __init__(self, points_per_object, max_objects, connections=()):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self.points_per_object = points_per_object
+        self.max_objects = max_objects
+        edges = np.ascontiguousarray(np.array(sorted(connections), dtype=np.int32).reshape(-1, 2))
+        self._handle = _lib.ar_overlay_create(points_per_object, max_objects,
+                                              _pointer(edges, ctypes.POINTER(ctypes.c_int)), len(edges))
+        if not self._handle:
+            raise RuntimeError("Failed to create the overlay renderer")
+
+    def release(self):
+        if self._handle:
+            _lib.ar_overlay_destroy(self._handle)
+            self._handle = None
+
+    def set_marker_mesh(self, vertices, indices):
+        """Marker geometry: V x 3 positions and triangle indices, scaled by the marker size."""
+        vertices = np.ascontiguousarray(vertices, dtype=np.float32)
+        indices = np.ascontiguousarray(indices, dtype=np.uint32)
+        return bool(_lib.ar_overlay_set_marker_mesh(self._handle, _pointer(vertices, _float_p), len(vertices.reshape(-1, 3)),
+                                                    _pointer(indices, ctypes.POINTER(ctypes.c_uint)), indices.size))
+
+    def draw(self, points, transform, marker_size=4.0, screen_space=True,
+             marker_color=(1.0, 1.0, 1.0, 1.0), line_color=(1.0, 1.0, 1.0, 1.0)):
+        """
+        points: objects x points_per_object x 2 or 3. transform: 4 x 4 column
+        major (a pyrr Matrix44 as is), e.g. image_transform(). marker_size is in
+        pixels in screen space, else in point units. A color of None skips the
+        markers or the lines.
+        """
+        points = np.asarray(points, dtype=np.float32)
+        points = points.reshape(-1, self.points_per_object, points.shape[-1])
+        if points.shape[2] == 2:
+            points = np.concatenate([points, np.zeros(points.shape[:2] + (1,), dtype=np.float32)], axis=2)
+        points = np.ascontiguousarray(points)
+        transform = np.ascontiguousarray(transform, dtype=np.float32).reshape(16)
+        marker = None if marker_color is None else np.array(marker_color, dtype=np.float32)
+        line = None if line_color is None else np.array(line_color, dtype=np.float32)
+        _lib.ar_overlay_draw(self._handle, _pointer(points, _float_p), len(points), _pointer(transform, _float_p),
+                             marker_size, int(screen_space),
+                             None if marker is None else _pointer(marker, _float_p),
+                             None if line is None else _pointer(line, _float_p))
+
+
+class Interaction:
+    """
+    Fingertip contacts and pinch grabs of hands against many spherical
+    objects in a spatial hash grid (see ar_interaction_* in
+    native/include/arnative.h). Units are those of the landmarks passed to
+    update(), e.g. centimeters in gl.py.
+    """
+
+    def __init__(self, cell_size=5.0, max_events=256):
+        if _lib is None:
+            raise RuntimeError("The native library is not built, see native/CMakeLists.txt")
+        self._handle = _lib.ar_interaction_create(cell_size)
+        self._events = (_ContactEvent * max_events)()
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.ar_interaction_destroy(self._handle)
+            self._handle = None
+
+    def add_object(self, position, radius):
+        position = np.ascontiguousarray(position, dtype=np.float32)
+        return _lib.ar_interaction_add_object(self._handle, _pointer(position, _float_p), radius)
+
+    def remove_object(self, object_id):
+        _lib.ar_interaction_remove_object(self._handle, object_id)
+
+    def move_objects(self, ids, positions):
+        """Batch move: N ids and N x 3 positions."""
+        ids = np.ascontiguousarray(ids, dtype=np.int32)
+        positions = np.ascontiguousarray(positions, dtype=np.float32)
+        _lib.ar_interaction_move_objects(self._handle, _pointer(ids, ctypes.POINTER(ctypes.c_int)),
+                                         _pointer(positions, _float_p), ids.size)
+
+    def query_sphere(self, center, radius, max_ids=1024):
+        center = np.ascontiguousarray(center, dtype=np.float32)
+        ids = np.empty(max_ids, dtype=np.int32)
+        count = _lib.ar_interaction_query_sphere(self._handle, _pointer(center, _float_p), radius,
+                                                 _pointer(ids, ctypes.POINTER(ctypes.c_int)), max_ids)
+        return ids[:min(count, max_ids)]
+
+    def update(self, hand_landmarks, fingertip_radius=1.5, pinch_distance=2.0):
+        """
+        One frame of H x 21 x 3 hand landmarks. Returns the events as a list
+        of (hand, object, type, distance), type one of CONTACT_BEGIN,
+        CONTACT_END, GRAB_BEGIN, GRAB_END.
+        """
+        landmarks = np.ascontiguousarray(hand_landmarks, dtype=np.float32).reshape(-1, HAND_LANDMARKS, 3)
+        count = _lib.ar_interaction_update_hands(self._handle, _pointer(landmarks, _float_p), len(landmarks),
+                                                 fingertip_radius, pinch_distance, self._events, len(self._events))
+        return [(e.hand, e.object, e.type, e.distance) for e in self._events[:count]]
+
+    def grabbed(self, hand):
+        """Object held by the hand, or -1."""
+        return _lib.ar_interaction_grabbed(self._handle, hand)
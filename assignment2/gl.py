@@ -5,9 +5,11 @@ from pyrr import Matrix44
 import cv2
 import numpy as np
 import os
+import threading
 from array import array
 
-from prediction import predict, get_camera_matrix, get_fov_y, solvepnp
+import arnative
+from prediction import predict, get_camera_matrix, get_fov_y, solvepnp, landmarks_array
 
 
 class CameraAR(mglw.WindowConfig):
@@ -119,6 +121,71 @@ class CameraAR(mglw.WindowConfig):
         self.window_size = (int(720.0 * self.aspect_ratio), 720)
         print("[DEBUG] Window size set to:", self.window_size)
 
+        # The native compositor streams frames into one persistent texture and
+        # flips/converts them on the GPU; without it, a texture per frame
+        self.compositor = None
+        if arnative.available():
+            self.compositor = arnative.Compositor(frame.shape[1], frame.shape[0])
+            print("[DEBUG] Using the native background compositor")
+
+        # Hand landmark markers and bones in two draw calls for all hands,
+        # instead of one marker draw per landmark
+        self.overlay = None
+        if arnative.available():
+            from mediapipe import solutions
+            self.overlay = arnative.Overlay(21, 2, solutions.hands.HAND_CONNECTIONS)
+
+        # Grab checks against every grabbable object through a spatial hash,
+        # in centimeters like the rest of the scene
+        self.interaction = None
+        if arnative.available():
+            self.interaction = arnative.Interaction(cell_size=8.0)
+            self.cube_id = self.interaction.add_object(self.object_pos, 4.0)
+
+        # Capture, hand inference and pose solving run on their own threads
+        # (see arnative.Pipeline); render() only draws the newest finished
+        # frame with the hands found in it, holding it until a newer one
+        self.pipeline = None
+        self.pipeline_frame = None
+        if arnative.available():
+            frame_height, frame_width = frame.shape[:2]
+            self.pipeline = arnative.Pipeline(source=arnative.SOURCE_EXTERNAL, width=frame_width, height=frame_height,
+                                              inference=self.infer_hands, camera_matrix=get_camera_matrix(frame_width, frame_height))
+            self.pipeline.start()
+            self.capturing = True
+            self.capture_thread = threading.Thread(target=self.capture_loop, daemon=True)
+            self.capture_thread.start()
+            print("[DEBUG] Using the native pipeline")
+
+    def capture_loop(self):
+        # the only thread that pushes frames
+        while self.capturing:
+            ret, frame = self.capture.read()
+            if not ret:
+                break
+            self.pipeline.push_frame(frame)
+
+    @staticmethod
+    def infer_hands(bgr_image):
+        # runs on the pipeline's inference thread
+        detection_result = predict(cv2.cvtColor(bgr_image, cv2.COLOR_BGR2RGB))
+        if not detection_result or not detection_result.hand_landmarks:
+            return np.empty((0, 21, 3), dtype=np.float32), np.empty((0, 21, 2), dtype=np.float32)
+        frame_height, frame_width = bgr_image.shape[:2]
+        model_points = landmarks_array(detection_result.hand_world_landmarks)
+        image_points = landmarks_array(detection_result.hand_landmarks)[:, :, :2] * np.float32([frame_width, frame_height])
+        return model_points, image_points
+
+    def close(self):
+        if self.pipeline is not None:
+            self.capturing = False
+            self.capture_thread.join()
+            if self.pipeline_frame is not None:
+                self.pipeline.release(self.pipeline_frame)
+                self.pipeline_frame = None
+            self.pipeline.stop()
+            self.pipeline.close()
+
     def render(self, time: float, frame_time: float):
         print("[DEBUG] render() running")
         self.ctx.clear(1.0, 1.0, 1.0)
@@ -131,18 +198,30 @@ class CameraAR(mglw.WindowConfig):
         Render the frame to a screen-sized rectange. 
         ---------------------------------------------------------------
         """
-        ret, frame = self.capture.read()
-        if not ret:
-            return
-        print("[DEBUG] frame captured:", ret)
-        # flip and convert to rgb
-        frame = cv2.flip(frame, 1)
-        frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB)
-        # upload as texture
-        frame_tex = self.ctx.texture(frame.shape[1::-1], 3, frame.tobytes())
-        frame_tex.use()
-        print("[DEBUG] rendering quad")
-        self.quad.render(moderngl.TRIANGLE_STRIP)
+        if self.pipeline is not None:
+            # the newest finished frame, on this thread since it owns the GL context
+            newer = self.pipeline.acquire(timeout_ms=0)
+            if newer is not None:
+                if self.pipeline_frame is not None:
+                    self.pipeline.release(self.pipeline_frame)
+                self.pipeline_frame = newer
+                self.compositor.upload(newer.pixels)
+            if self.pipeline_frame is None:
+                return
+            self.compositor.draw(mirror=True)
+        else:
+            ret, frame = self.capture.read()
+            if not ret:
+                return
+            print("[DEBUG] frame captured:", ret)
+            # flip and convert to rgb
+            frame = cv2.flip(frame, 1)
+            frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB)
+            # upload as texture
+            frame_tex = self.ctx.texture(frame.shape[1::-1], 3, frame.tobytes())
+            frame_tex.use()
+            print("[DEBUG] rendering quad")
+            self.quad.render(moderngl.TRIANGLE_STRIP)
         
         """
         ---------------------------------------------------------------
@@ -154,6 +233,10 @@ class CameraAR(mglw.WindowConfig):
         
         # Solve the landmarks in world space
         world_landmarks_list = []
+        if self.pipeline_frame is not None:
+            # solved on the pipeline's pose thread, without the failed hands
+            solved = self.pipeline_frame.errors >= 0
+            world_landmarks_list = self.pipeline_frame.world_points[solved]
         
         # OpenCV to OpenGL conversion
         # The world points from OpenCV need some changes to be OpenGL ready. 
@@ -175,6 +258,12 @@ class CameraAR(mglw.WindowConfig):
         grabbed = False
         # It is recommended to work on this task last after all landmarks are in place.
         
+        # centimeters, OpenCV to OpenGL camera axes, and x mirrored like the background
+        hand_points = np.float32(world_landmarks_list).reshape(-1, 21, 3) * np.float32([-100, -100, -100])
+        if self.interaction is not None:
+            self.interaction.update(hand_points)
+            grabbed = any(self.interaction.grabbed(h) == self.cube_id for h in range(len(hand_points)))
+        
         
         """
         ----------------------------------------------------------------------
@@ -211,6 +300,9 @@ class CameraAR(mglw.WindowConfig):
         
         # Render the landmarks
         # ...
+        if self.overlay is not None and len(hand_points):
+            self.overlay.draw(hand_points, proj.astype('f4'), marker_size=1.0, screen_space=False,
+                              marker_color=(0.0, 1.0, 0.0, 1.0), line_color=(1.0, 1.0, 1.0, 1.0))
 
 
 if __name__ == '__main__':
@@ -0,0 +1,457 @@
+#ifndef _ARNATIVE_H_
+#define _ARNATIVE_H_
+
+/*
+ * C interface of the native AR library, for ctypes (see ../arnative.py).
+ * Arrays are C-contiguous and owned by the caller; numpy arrays are passed
+ * by pointer without copies. Output pointers may be NULL when the result
+ * is not needed.
+ */
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define ARNATIVE_API __declspec(dllexport)
+#else
+#define ARNATIVE_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change of this interface */
+#define ARNATIVE_ABI_VERSION 9
+
+ARNATIVE_API int ar_abi_version(void);
+
+/*
+ * Pose of every hand of a frame in one call: EPnP followed by
+ * Levenberg-Marquardt refinement, with the reprojection computed in the
+ * final residual pass. 21 points per hand use a solver specialized for
+ * that count; other counts (4 to 64) take a generic path.
+ *
+ *   model_points   hand_count x point_count x 3, model space
+ *   image_points   hand_count x point_count x 2, pixels
+ *   camera_matrix  3 x 3 intrinsics, row major, no distortion
+ *   rvecs, tvecs   hand_count x 3, rotation vector and translation
+ *   world_points   hand_count x point_count x 3, R * model + t
+ *   reprojected    hand_count x point_count x 2, pixels
+ *   errors         hand_count, norm of the residuals / point_count, -1 on failure
+ *
+ * Returns the number of hands solved.
+ */
+ARNATIVE_API int ar_solve_pnp_batch(int hand_count, int point_count,
+	const float *model_points, const float *image_points, const double *camera_matrix,
+	double *rvecs, double *tvecs, float *world_points, float *reprojected, double *errors);
+
+/*
+ * Pipeline runtime: capture, landmark inference, pose solving and
+ * rendering on their own threads, connected by bounded lock-free queues.
+ * A stage always takes the newest frame waiting for it and drops the
+ * older ones, so a slow stage costs frame rate but not latency.
+ */
+
+#define AR_MAX_HANDS 4
+#define AR_HAND_LANDMARKS 21
+
+enum ArSourceType {
+	AR_SOURCE_SYNTHETIC = 0,	/* Moving pattern with one hand of known pose */
+	AR_SOURCE_Y4M = 1,			/* YUV4MPEG2 video file */
+	AR_SOURCE_EXTERNAL = 2,		/* Frames pushed with ar_pipeline_push_frame */
+};
+
+typedef struct ArFrame {
+	uint64_t sequence;
+	uint64_t capture_time_ns;		/* Monotonic clock */
+	int width, height, stride;
+	const unsigned char *pixels;	/* BGR */
+	int hand_count;
+	const float *model_points;		/* hand_count x 21 x 3 */
+	const float *image_points;		/* hand_count x 21 x 2, pixels */
+	const double *rvecs, *tvecs;	/* hand_count x 3 */
+	const float *world_points;		/* hand_count x 21 x 3 */
+	const float *reprojected;		/* hand_count x 21 x 2 */
+	const double *errors;			/* hand_count */
+} ArFrame;
+
+/*
+ * Landmark inference on the inference thread: fill up to max_hands hands
+ * of model (21 x 3) and image (21 x 2, pixels) landmarks, return the count.
+ */
+typedef int (*ArInferenceCallback)(void *user, const unsigned char *bgr, int width, int height, int stride,
+	float *model_points, float *image_points, int max_hands);
+
+/* Rendering on the render thread, for headless use */
+typedef void (*ArRenderCallback)(void *user, const ArFrame *frame);
+
+typedef struct ArPipelineConfig {
+	int source;						/* ArSourceType */
+	const char *video_path;
+	int loop;						/* Restart the video at its end */
+	int width, height;				/* Synthetic and external sources */
+	double source_fps;				/* Synthetic source pacing, 0 for as fast as possible */
+	int queue_capacity;				/* Frames between two stages */
+
+	/*
+	 * Inference, in order of preference: the callback, a subprocess, or
+	 * the source's true landmarks after synthetic_inference_ms. The
+	 * subprocess (run with /bin/sh -c) reads int32 width, int32 height
+	 * and the BGR pixels for each frame on stdin, and answers on stdout
+	 * with int32 hand_count, the float32 model points, then the image
+	 * points of all hands.
+	 */
+	ArInferenceCallback inference;
+	void *inference_user;
+	const char *inference_command;
+	double synthetic_inference_ms;
+
+	/* If not set, the caller takes frames with ar_pipeline_acquire */
+	ArRenderCallback render;
+	void *render_user;
+
+	/* Row major; all zero for focal length = width, center of the image */
+	double camera_matrix[9];
+} ArPipelineConfig;
+
+typedef struct ArStageStats {
+	char name[16];
+	uint64_t processed;
+	uint64_t dropped;				/* Stale frames skipped, or no room downstream */
+	double fps;
+	double busy_ms;					/* Mean processing time per frame */
+	double latency_p50_ms;			/* Capture to the end of this stage */
+	double latency_p90_ms;
+	double latency_p99_ms;
+} ArStageStats;
+
+typedef struct ArPipeline ArPipeline;
+
+ARNATIVE_API void ar_pipeline_default_config(ArPipelineConfig *config);
+ARNATIVE_API ArPipeline *ar_pipeline_create(const ArPipelineConfig *config);
+ARNATIVE_API int ar_pipeline_start(ArPipeline *pipeline);
+ARNATIVE_API void ar_pipeline_stop(ArPipeline *pipeline);
+ARNATIVE_API void ar_pipeline_destroy(ArPipeline *pipeline);
+
+/*
+ * External source only, from one thread. The frame must have the configured
+ * size and a stride of at least width * 3. Returns 0 if the frame was
+ * refused or dropped.
+ */
+ARNATIVE_API int ar_pipeline_push_frame(ArPipeline *pipeline, const unsigned char *bgr, int width, int height, int stride);
+
+/*
+ * Take the newest finished frame, waiting up to timeout_ms. The frame stays
+ * valid until it is released. One consumer thread only.
+ */
+ARNATIVE_API int ar_pipeline_acquire(ArPipeline *pipeline, ArFrame *frame, int timeout_ms);
+ARNATIVE_API void ar_pipeline_release(ArPipeline *pipeline, const ArFrame *frame);
+
+/* Statistics of up to max_stages stages, returns the number of stages */
+ARNATIVE_API int ar_pipeline_stats(ArPipeline *pipeline, ArStageStats *stats, int max_stages);
+
+/*
+ * Camera background compositor. Frames stream through a ring of pixel
+ * buffer objects into one persistent texture, and a blit shader does the
+ * vertical flip, optional mirroring and BGR to RGB swizzle on the GPU.
+ * All calls need the host's GL 3.3 context to be current on the calling
+ * thread; the GL functions are looked up from the process at create time.
+ */
+
+typedef struct ArCompositor ArCompositor;
+
+ARNATIVE_API ArCompositor *ar_compositor_create(int width, int height);
+ARNATIVE_API void ar_compositor_destroy(ArCompositor *compositor);
+
+/*
+ * Map the next pixel buffer for writing one BGR frame (width * 3 byte rows,
+ * top row first), e.g. by the camera capture directly, then hand it to the
+ * GPU with end_upload. Returns NULL on failure.
+ */
+ARNATIVE_API unsigned char *ar_compositor_begin_upload(ArCompositor *compositor);
+ARNATIVE_API void ar_compositor_end_upload(ArCompositor *compositor);
+
+/* Copy a BGR frame with any row stride. Returns 0 on failure. */
+ARNATIVE_API int ar_compositor_upload(ArCompositor *compositor, const unsigned char *bgr, int stride);
+
+/* Fullscreen draw of the latest frame, without depth test or depth writes */
+ARNATIVE_API void ar_compositor_draw(ArCompositor *compositor, int mirror);
+
+/* Frames uploaded, and uploads that found their buffer still in use */
+ARNATIVE_API void ar_compositor_stats(ArCompositor *compositor, uint64_t *uploads, uint64_t *orphaned);
+
+/*
+ * Landmark overlays: markers at the landmarks and lines along their
+ * connections (e.g. the face mesh tessellation) for up to max_objects
+ * objects of points_per_object landmarks, in two draw calls a frame. The
+ * connectivity is given once, as edge_count pairs of landmark indices
+ * within one object. Same GL context rules as the compositor.
+ */
+
+typedef struct ArOverlay ArOverlay;
+
+ARNATIVE_API ArOverlay *ar_overlay_create(int points_per_object, int max_objects, const int *edges, int edge_count);
+ARNATIVE_API void ar_overlay_destroy(ArOverlay *overlay);
+
+/* Marker geometry, scaled by the marker size; an octahedron of diameter 1 by default */
+ARNATIVE_API int ar_overlay_set_marker_mesh(ArOverlay *overlay, const float *vertices, int vertex_count,
+	const unsigned int *indices, int index_count);
+
+/*
+ *   points        object_count x points_per_object x 3
+ *   transform     4 x 4 column major (OpenGL order), points to clip space
+ *   marker_size   pixels if screen_space, else units of the points
+ *   screen_space  markers face the viewer and keep their size on screen
+ *   marker_color  RGBA, NULL for no markers
+ *   line_color    RGBA, NULL for no lines
+ *
+ * Depth test and blending are left as the caller set them.
+ */
+ARNATIVE_API void ar_overlay_draw(ArOverlay *overlay, const float *points, int object_count, const float *transform,
+	float marker_size, int screen_space, const float *marker_color, const float *line_color);
+
+/*
+ * Frame preparation for inference in one pass instead of resize, flip and
+ * cvtColor: bilinear resize (OpenCV INTER_LINEAR sample positions, within
+ * one or two levels), optional horizontal mirror and red/blue swap, split
+ * over a pool of threads by bands of output rows. Images are 8-bit, three
+ * channels; the destination is caller memory.
+ */
+
+#define AR_PREPROCESS_MIRROR 1		/* cv2.flip(image, 1) */
+#define AR_PREPROCESS_SWAP_RB 2		/* BGR <-> RGB */
+
+typedef struct ArPreprocessor ArPreprocessor;
+
+/* thread_count 0 uses every hardware thread */
+ARNATIVE_API ArPreprocessor *ar_preprocess_create(int thread_count);
+ARNATIVE_API void ar_preprocess_destroy(ArPreprocessor *preprocessor);
+ARNATIVE_API int ar_preprocess_thread_count(ArPreprocessor *preprocessor);
+
+/* Strides in bytes. One call at a time per preprocessor. Returns 0 on bad arguments. */
+ARNATIVE_API int ar_preprocess_frame(ArPreprocessor *preprocessor, const unsigned char *source, int source_width,
+	int source_height, int source_stride, unsigned char *destination, int width, int height, int stride, int flags);
+
+/*
+ * Hand interaction with many grabbable objects (spheres), kept in a
+ * spatial hash grid that follows them incrementally. cell_size should be
+ * about the fingertip radius plus the largest object radius; queries then
+ * visit a handful of cells however many objects there are.
+ */
+
+enum ArContactType {
+	AR_CONTACT_BEGIN = 0,		/* A fingertip sphere started touching the object */
+	AR_CONTACT_END = 1,
+	AR_GRAB_BEGIN = 2,			/* A pinch started at the object */
+	AR_GRAB_END = 3,
+};
+
+typedef struct ArContactEvent {
+	int hand;
+	int object;
+	int type;					/* ArContactType */
+	float distance;				/* Begin: from the fingertip or pinch point to the center */
+} ArContactEvent;
+
+typedef struct ArInteraction ArInteraction;
+
+ARNATIVE_API ArInteraction *ar_interaction_create(float cell_size);
+ARNATIVE_API void ar_interaction_destroy(ArInteraction *world);
+
+/* Returns the object id; ids of removed objects are reused */
+ARNATIVE_API int ar_interaction_add_object(ArInteraction *world, const float *position, float radius);
+ARNATIVE_API void ar_interaction_remove_object(ArInteraction *world, int id);
+ARNATIVE_API void ar_interaction_move_objects(ArInteraction *world, const int *ids, const float *positions, int count);
+
+/* Objects intersecting the sphere; returns the total count, stores up to max_ids */
+ARNATIVE_API int ar_interaction_query_sphere(ArInteraction *world, const float *center, float radius, int *ids, int max_ids);
+
+/*
+ * One frame of hands: landmarks is hand_count x 21 x 3, in the objects'
+ * space. Fingertips are spheres of fingertip_radius; thumb and index tips
+ * closer than pinch_distance grab the nearest object within reach of the
+ * point between them, until they open again. Hand i is assumed to be the
+ * same hand as in the previous frame. Returns the number of events stored.
+ */
+ARNATIVE_API int ar_interaction_update_hands(ArInteraction *world, const float *landmarks, int hand_count,
+	float fingertip_radius, float pinch_distance, ArContactEvent *events, int max_events);
+
+/* Object held by the hand, or -1 */
+ARNATIVE_API int ar_interaction_grabbed(ArInteraction *world, int hand);
+
+/*
+ * Landmark filtering: every coordinate of every landmark is an independent
+ * channel (e.g. hands x 21 x 3 flattened), filtered in SIMD batches. Besides
+ * the smoothed values, an update extrapolates them by predict_s seconds with
+ * the estimated velocity, to make up for the inference latency.
+ *
+ * One Euro (Casiez et al. 2012): the cutoff frequency rises with speed, so
+ * slow movement is smoothed and fast movement does not lag.
+ *   min_cutoff         Hz, cutoff at rest; lower is smoother
+ *   beta               cutoff increase per unit/s of speed
+ *   derivative_cutoff  Hz, smoothing of the speed estimate
+ *
+ * Kalman: constant velocity model with white noise acceleration.
+ *   process_noise      acceleration spectral density, units^2/s^3
+ *   measurement_noise  variance of a measurement, units^2
+ *
+ * The defaults suit pixel coordinates at camera frame rates.
+ */
+
+enum ArFilterType {
+	AR_FILTER_ONE_EURO = 0,
+	AR_FILTER_KALMAN = 1,
+};
+
+typedef struct ArFilterParams {
+	int type;						/* ArFilterType */
+	float min_cutoff;
+	float beta;
+	float derivative_cutoff;
+	float process_noise;
+	float measurement_noise;
+} ArFilterParams;
+
+typedef struct ArFilter ArFilter;
+
+ARNATIVE_API void ar_filter_default_params(ArFilterParams *params, int type);
+ARNATIVE_API ArFilter *ar_filter_create(int channel_count, const ArFilterParams *params);
+ARNATIVE_API void ar_filter_destroy(ArFilter *filter);
+
+/* The next update takes these channels' measurements as they are */
+ARNATIVE_API void ar_filter_reset(ArFilter *filter, int first, int count);
+
+/*
+ * measurements, filtered and predicted hold channel_count floats; the
+ * outputs may be NULL or alias measurements. timestamp_s is the capture
+ * time of the measurements.
+ */
+ARNATIVE_API void ar_filter_update(ArFilter *filter, const float *measurements, double timestamp_s, float predict_s,
+	float *filtered, float *predicted);
+
+/*
+ * Detect-then-track: the detector's landmarks followed into the next frames
+ * with pyramidal Lucas-Kanade optical flow, so the detector only has to run
+ * every few frames. Each point is tracked forward and back again; a point
+ * fails when the forward-backward distance or the mean difference of its
+ * window is too large, or its window has too little texture. Failed points
+ * move with the median motion of their object's tracked points.
+ *
+ * Points are object_count x points_per_object x 2 floats, in pixels.
+ * Images are 8-bit with 1, 3 or 4 channels (gray is (R + 2 G + B) / 4,
+ * so BGR and RGB are the same), all of one size.
+ *
+ *   window_radius         window of 2 r + 1 pixels square
+ *   levels                pyramid levels above the full resolution
+ *   iterations, epsilon   per level, stop once a step is below epsilon px
+ *   min_eigenvalue        of the window's gradient matrix over its area,
+ *                         (grey levels / px)^2; OpenCV's 1e-4 is about 0.1
+ *   max_fb_error          px, forward-backward distance
+ *   max_match_error       grey levels, mean absolute window difference
+ *   min_tracked_fraction  of an object's points; below it detection is due
+ *   max_track_frames      frames tracked before detection is due anyway
+ */
+
+typedef struct ArTrackerParams {
+	int window_radius;
+	int levels;
+	int iterations;
+	float epsilon;
+	float min_eigenvalue;
+	float max_fb_error;
+	float max_match_error;
+	float min_tracked_fraction;
+	int max_track_frames;
+} ArTrackerParams;
+
+typedef struct ArTracker ArTracker;
+
+ARNATIVE_API void ar_tracker_default_params(ArTrackerParams *params);
+ARNATIVE_API ArTracker *ar_tracker_create(int points_per_object, const ArTrackerParams *params);
+ARNATIVE_API void ar_tracker_destroy(ArTracker *tracker);
+
+/*
+ * The detector's points on this frame, which restarts tracking. image NULL
+ * means the frame of the last ar_tracker_track call, whose pyramid is then
+ * reused. Returns 0 on bad arguments.
+ */
+ARNATIVE_API int ar_tracker_set_points(ArTracker *tracker, const unsigned char *image, int width, int height,
+	int stride, int channels, const float *points, int object_count);
+
+/*
+ * Follow the points into a new frame. points receives them, status 1 per
+ * tracked point and errors the forward-backward distances (FLT_MAX if lost);
+ * each may be NULL. Returns 1 while tracking is good, 0 when the detector
+ * should run on this frame: too many points of an object lost, the
+ * max_track_frames limit reached, no points, or a new frame size (then
+ * nothing is written).
+ */
+ARNATIVE_API int ar_tracker_track(ArTracker *tracker, const unsigned char *image, int width, int height, int stride,
+	int channels, float *points, unsigned char *status, float *errors);
+
+ARNATIVE_API int ar_tracker_object_count(ArTracker *tracker);
+
+/*
+ * Shared memory ring between two processes, e.g. the Python detector and a
+ * native renderer: fixed-size slots of a frame and a record (landmarks or
+ * other results), written by one process and read by the other in place,
+ * without copies. One writer and one reader; waits spin for a few
+ * microseconds, then sleep on a futex. POSIX shared memory, named like
+ * "/ar_frames"; without Linux futexes, waits poll.
+ */
+
+typedef struct ArShmHeader {
+	uint64_t sequence;				/* Position in the stream, set by end_write */
+	uint64_t timestamp_ns;			/* For the writer, e.g. the capture time */
+	uint64_t publish_time_ns;		/* CLOCK_MONOTONIC at end_write (time.monotonic_ns() in Python) */
+	int32_t width, height, stride, channels;	/* Frame layout, 0 without a frame */
+	int32_t record_count;			/* e.g. hands */
+	int32_t user;					/* For the application */
+	uint32_t frame_size;			/* Bytes used */
+	uint32_t record_size;
+} ArShmHeader;
+
+/* Local view of a slot; frame and record are 64-byte aligned */
+typedef struct ArShmSlot {
+	ArShmHeader *header;
+	unsigned char *frame;			/* frame_capacity bytes */
+	unsigned char *record;			/* record_capacity bytes */
+} ArShmSlot;
+
+typedef struct ArShmRing ArShmRing;
+
+/* Replaces a ring of the same name; the creator removes the name again on destroy */
+ARNATIVE_API ArShmRing *ar_shm_create(const char *name, int slot_count, uint64_t frame_capacity,
+	uint64_t record_capacity);
+/* Waits up to timeout_ms (-1 forever) for the ring to be created */
+ARNATIVE_API ArShmRing *ar_shm_open(const char *name, int timeout_ms);
+ARNATIVE_API void ar_shm_destroy(ArShmRing *ring);
+ARNATIVE_API void ar_shm_capacity(ArShmRing *ring, int *slot_count, uint64_t *frame_capacity,
+	uint64_t *record_capacity);
+
+/*
+ * Writer: the next free slot, waiting up to timeout_ms (-1 forever, 0 not
+ * at all) while the ring is full. Returns 0 on timeout. end_write
+ * publishes it; close_writer ends the stream for the reader.
+ */
+ARNATIVE_API int ar_shm_begin_write(ArShmRing *ring, ArShmSlot *slot, int timeout_ms);
+ARNATIVE_API void ar_shm_end_write(ArShmRing *ring);
+ARNATIVE_API void ar_shm_close_writer(ArShmRing *ring);
+
+/*
+ * Reader: the oldest published slot, or with latest the newest one, the
+ * older ones being skipped. Returns 1 with a slot, 0 on timeout and -1
+ * once the writer closed the stream and everything was read. end_read
+ * hands the slot back to the writer.
+ */
+ARNATIVE_API int ar_shm_begin_read(ArShmRing *ring, ArShmSlot *slot, int timeout_ms, int latest);
+ARNATIVE_API void ar_shm_end_read(ArShmRing *ring);
+
+/* Slots published, read and skipped by latest reads */
+ARNATIVE_API void ar_shm_stats(ArShmRing *ring, uint64_t *written, uint64_t *read, uint64_t *skipped);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
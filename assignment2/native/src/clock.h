@@ -0,0 +1,14 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+
+#include <chrono>
+
+// Monotonic time in nanoseconds, for latencies between threads
+inline uint64_t MonotonicTimeNs() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "compositor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Fullscreen triangle from the vertex index, no vertex buffers needed
+static const char *BLIT_VERTEX_SHADER = R"(#version 330 core
+out vec2 uv;
+void main() {
+	vec2 position = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+	uv = position * 0.5 + 0.5;
+	gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+// The first texture row is the top of the camera image
+static const char *BLIT_FRAGMENT_SHADER = R"(#version 330 core
+in vec2 uv;
+out vec4 color;
+uniform sampler2D frameSampler;
+uniform bool Mirror;
+void main() {
+	vec2 texcoord = vec2(Mirror ? 1.0 - uv.x : uv.x, 1.0 - uv.y);
+	color = vec4(texture(frameSampler, texcoord).bgr, 1.0);
+}
+)";
+
+bool BackgroundCompositor::initialize(const GLFunctions *gl, int width, int height) {
+	if (!gl || width <= 0 || height <= 0) return false;
+	this->gl = gl;
+	this->width = width;
+	this->height = height;
+
+	program = BuildProgram(gl, BLIT_VERTEX_SHADER, BLIT_FRAGMENT_SHADER, "blit");
+	if (!program) {
+		cleanup();
+		return false;
+	}
+	mirrorLocation = gl->GetUniformLocation(program, "Mirror");
+
+	GLint previousProgram = 0, previousTexture = 0, previousActive = 0, previousUnpack = 0;
+	gl->GetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	gl->GetIntegerv(GL_ACTIVE_TEXTURE, &previousActive);
+	gl->ActiveTexture(GL_TEXTURE0);
+	gl->GetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	gl->GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &previousUnpack);
+
+	gl->UseProgram(program);
+	gl->Uniform1i(gl->GetUniformLocation(program, "frameSampler"), 0);
+
+	// The texture is allocated once; frames only replace its contents
+	gl->GenTextures(1, &texture);
+	gl->BindTexture(GL_TEXTURE_2D, texture);
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	gl->TexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	gl->GenBuffers(UPLOAD_BUFFERS, buffers);
+	for (int i = 0; i < UPLOAD_BUFFERS; ++i) {
+		gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[i]);
+		gl->BufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)width * height * 3, nullptr, GL_STREAM_DRAW);
+	}
+
+	gl->GenVertexArrays(1, &vertexArray);
+
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, previousUnpack);
+	gl->BindTexture(GL_TEXTURE_2D, previousTexture);
+	gl->ActiveTexture(previousActive);
+	gl->UseProgram(previousProgram);
+	return true;
+}
+
+void BackgroundCompositor::cleanup() {
+	if (!gl) return;
+	if (mapped) endUpload();
+	for (int i = 0; i < UPLOAD_BUFFERS; ++i) {
+		if (fences[i]) gl->DeleteSync(fences[i]);
+		fences[i] = nullptr;
+	}
+	if (buffers[0]) gl->DeleteBuffers(UPLOAD_BUFFERS, buffers);
+	memset(buffers, 0, sizeof(buffers));
+	if (texture) gl->DeleteTextures(1, &texture);
+	if (vertexArray) gl->DeleteVertexArrays(1, &vertexArray);
+	if (program) gl->DeleteProgram(program);
+	texture = vertexArray = program = 0;
+	hasFrame = false;
+	gl = nullptr;
+}
+
+uint8_t *BackgroundCompositor::beginUpload() {
+	if (!gl || mapped) return nullptr;
+	current = (current + 1) % UPLOAD_BUFFERS;
+
+	// A buffer whose copy is done can be written without synchronization.
+	// Otherwise invalidating it lets the driver hand out fresh storage
+	// instead of stalling until the GPU is finished with the old one.
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+	if (fences[current]) {
+		GLenum state = gl->ClientWaitSync(fences[current], 0, 0);
+		if (state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED) access |= GL_MAP_UNSYNCHRONIZED_BIT;
+		else ++orphaned;
+		gl->DeleteSync(fences[current]);
+		fences[current] = nullptr;
+	} else {
+		access |= GL_MAP_UNSYNCHRONIZED_BIT;
+	}
+
+	GLint previousUnpack = 0;
+	gl->GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &previousUnpack);
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[current]);
+	void *pixels = gl->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)width * height * 3, access);
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, previousUnpack);
+	mapped = pixels != nullptr;
+	return (uint8_t *)pixels;
+}
+
+void BackgroundCompositor::endUpload() {
+	if (!gl || !mapped) return;
+	mapped = false;
+
+	GLint previousUnpack = 0, previousTexture = 0, previousActive = 0, previousAlignment = 0, previousRowLength = 0;
+	gl->GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &previousUnpack);
+	gl->GetIntegerv(GL_ACTIVE_TEXTURE, &previousActive);
+	gl->ActiveTexture(GL_TEXTURE0);
+	gl->GetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	gl->GetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+	gl->GetIntegerv(GL_UNPACK_ROW_LENGTH, &previousRowLength);
+
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[current]);
+	if (gl->UnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+		// Sourced from the bound buffer, so this returns at once and the copy
+		// runs on the GPU while the frame is being rendered. The BGR bytes go
+		// in unchanged; the blit shader swizzles them.
+		gl->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		gl->PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		gl->BindTexture(GL_TEXTURE_2D, texture);
+		gl->TexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		fences[current] = gl->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		hasFrame = true;
+		++uploads;
+	}
+
+	gl->PixelStorei(GL_UNPACK_ROW_LENGTH, previousRowLength);
+	gl->PixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+	gl->BindTexture(GL_TEXTURE_2D, previousTexture);
+	gl->ActiveTexture(previousActive);
+	gl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, previousUnpack);
+}
+
+bool BackgroundCompositor::upload(const uint8_t *bgr, int stride) {
+	uint8_t *pixels = beginUpload();
+	if (!pixels) return false;
+	size_t row = (size_t)width * 3;
+	if ((size_t)stride == row) {
+		memcpy(pixels, bgr, row * height);
+	} else {
+		for (int y = 0; y < height; ++y) memcpy(pixels + y * row, bgr + (size_t)y * stride, row);
+	}
+	endUpload();
+	return true;
+}
+
+void BackgroundCompositor::draw(bool mirror) {
+	if (!gl || !hasFrame) return;
+
+	GLint previousProgram = 0, previousVertexArray = 0, previousTexture = 0, previousActive = 0;
+	GLint previousDepthMask = GL_TRUE;
+	gl->GetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	gl->GetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	gl->GetIntegerv(GL_ACTIVE_TEXTURE, &previousActive);
+	gl->ActiveTexture(GL_TEXTURE0);
+	gl->GetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	gl->GetIntegerv(GL_DEPTH_WRITEMASK, &previousDepthMask);
+	GLboolean depthTest = gl->IsEnabled(GL_DEPTH_TEST);
+	GLboolean cullFace = gl->IsEnabled(GL_CULL_FACE);
+	GLboolean blend = gl->IsEnabled(GL_BLEND);
+
+	gl->Disable(GL_DEPTH_TEST);
+	gl->Disable(GL_CULL_FACE);
+	gl->Disable(GL_BLEND);
+	gl->DepthMask(GL_FALSE);
+	gl->UseProgram(program);
+	gl->Uniform1i(mirrorLocation, mirror ? 1 : 0);
+	gl->BindTexture(GL_TEXTURE_2D, texture);
+	gl->BindVertexArray(vertexArray);
+	gl->DrawArrays(GL_TRIANGLES, 0, 3);
+
+	gl->BindVertexArray(previousVertexArray);
+	gl->BindTexture(GL_TEXTURE_2D, previousTexture);
+	gl->ActiveTexture(previousActive);
+	gl->UseProgram(previousProgram);
+	gl->DepthMask((GLboolean)previousDepthMask);
+	if (depthTest) gl->Enable(GL_DEPTH_TEST);
+	if (cullFace) gl->Enable(GL_CULL_FACE);
+	if (blend) gl->Enable(GL_BLEND);
+}
+
+// C interface
+
+ArCompositor *ar_compositor_create(int width, int height) {
+	BackgroundCompositor *compositor = new BackgroundCompositor();
+	if (!compositor->initialize(LoadGLFunctions(), width, height)) {
+		delete compositor;
+		return nullptr;
+	}
+	return (ArCompositor *)compositor;
+}
+
+void ar_compositor_destroy(ArCompositor *compositor) {
+	if (!compositor) return;
+	((BackgroundCompositor *)compositor)->cleanup();
+	delete (BackgroundCompositor *)compositor;
+}
+
+unsigned char *ar_compositor_begin_upload(ArCompositor *compositor) {
+	return compositor ? ((BackgroundCompositor *)compositor)->beginUpload() : nullptr;
+}
+
+void ar_compositor_end_upload(ArCompositor *compositor) {
+	if (compositor) ((BackgroundCompositor *)compositor)->endUpload();
+}
+
+int ar_compositor_upload(ArCompositor *compositor, const unsigned char *bgr, int stride) {
+	return compositor && bgr && ((BackgroundCompositor *)compositor)->upload(bgr, stride) ? 1 : 0;
+}
+
+void ar_compositor_draw(ArCompositor *compositor, int mirror) {
+	if (compositor) ((BackgroundCompositor *)compositor)->draw(mirror != 0);
+}
+
+void ar_compositor_stats(ArCompositor *compositor, uint64_t *uploads, uint64_t *orphaned) {
+	if (!compositor) return;
+	if (uploads) *uploads = ((BackgroundCompositor *)compositor)->uploads;
+	if (orphaned) *orphaned = ((BackgroundCompositor *)compositor)->orphaned;
+}
@@ -0,0 +1,53 @@
+#ifndef _COMPOSITOR_H_
+#define _COMPOSITOR_H_
+
+#include <arnative.h>
+
+#include "gl_loader.h"
+
+#include <stdint.h>
+
+// Pixel buffers in flight; the third lets the CPU fill one while the GPU
+// is still copying the previous two into the texture
+static const int UPLOAD_BUFFERS = 3;
+
+// Camera background of the AR view: BGR frames are streamed through a ring
+// of pixel buffer objects into one persistent texture and drawn with a
+// shader that does the vertical flip, optional mirroring and the BGR to RGB
+// swizzle. Every method needs the GL context of create() to be current.
+class BackgroundCompositor {
+public:
+	bool initialize(const GLFunctions *gl, int width, int height);
+	void cleanup();
+
+	// The next pixel buffer, mapped for writing width * 3 byte rows of BGR,
+	// top row first. endUpload() hands it to the GPU.
+	uint8_t *beginUpload();
+	void endUpload();
+
+	// Copy a frame with any row stride; convenience for beginUpload/endUpload
+	bool upload(const uint8_t *bgr, int stride);
+
+	// Full viewport quad, without depth test or depth writes. GL state
+	// touched here is restored afterwards, the host caches some of it.
+	void draw(bool mirror);
+
+	int width = 0;
+	int height = 0;
+	uint64_t uploads = 0;
+	uint64_t orphaned = 0;		// Buffer still in use by the GPU when reused
+
+private:
+	const GLFunctions *gl = nullptr;
+	GLuint texture = 0;
+	GLuint program = 0;
+	GLuint vertexArray = 0;
+	GLint mirrorLocation = -1;
+	GLuint buffers[UPLOAD_BUFFERS] = {};
+	GLsync fences[UPLOAD_BUFFERS] = {};
+	int current = 0;
+	bool mapped = false;
+	bool hasFrame = false;
+};
+
+#endif
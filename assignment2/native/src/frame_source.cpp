@@ -0,0 +1,175 @@
+#include "frame_source.h"
+#include "linalg.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+// A right hand in MediaPipe order (wrist, then four joints per finger from
+// thumb to pinky), in meters around the palm center
+static void buildHandModel(float *model) {
+	static const float BASE_X[5] = { -0.035f, -0.02f, 0.0f, 0.018f, 0.034f };
+	static const float LENGTH[5] = { 0.025f, 0.03f, 0.033f, 0.031f, 0.025f };
+	model[0] = 0.0f;
+	model[1] = 0.045f;
+	model[2] = 0.0f;
+	for (int finger = 0; finger < 5; ++finger) {
+		float spread = (finger - 2) * 0.12f;
+		float curl = 0.15f + 0.05f * finger;
+		float x = BASE_X[finger];
+		float y = finger == 0 ? 0.025f : 0.0f;
+		float z = 0.0f;
+		for (int joint = 0; joint < 4; ++joint) {
+			float *p = model + (1 + finger * 4 + joint) * 3;
+			p[0] = x;
+			p[1] = y;
+			p[2] = z;
+			float step = (joint == 0) ? 0.6f * LENGTH[finger] : LENGTH[finger] / (1.0f + 0.3f * joint);
+			x += step * sinf(spread);
+			y -= step * cosf(spread);
+			z -= step * sinf(curl * joint);
+		}
+	}
+}
+
+SyntheticSource::SyntheticSource(int width, int height, const double *camera_matrix) {
+	this->width = width;
+	this->height = height;
+	memcpy(camera, camera_matrix, sizeof(camera));
+	buildHandModel(model);
+}
+
+bool SyntheticSource::read(uint8_t *pixels, int stride, float *truth_model, float *truth_image, int max_hands, int &truth_hands) {
+	uint64_t frame = frameIndex++;
+	for (int y = 0; y < height; ++y) {
+		uint8_t *row = pixels + (size_t)y * stride;
+		for (int x = 0; x < width; ++x) {
+			row[x * 3] = (uint8_t)(x + frame);
+			row[x * 3 + 1] = (uint8_t)(y + 2 * frame);
+			row[x * 3 + 2] = (uint8_t)((x ^ y) >> 2);
+		}
+	}
+
+	truth_hands = 0;
+	if (max_hands < 1) return true;
+
+	double t = frame / fps;
+	double rvec[3] = { 0.3 * sin(t), 0.5 * sin(0.7 * t), 0.2 * cos(0.5 * t) };
+	double translation[3] = { 0.05 * sin(0.9 * t), 0.03 * cos(1.1 * t), 0.5 };
+	double rotation[9];
+	RotationFromVector(rvec, rotation);
+
+	for (int i = 0; i < HAND_LANDMARKS; ++i) {
+		const float *p = model + i * 3;
+		double c[3];
+		for (int k = 0; k < 3; ++k) {
+			c[k] = rotation[k * 3] * p[0] + rotation[k * 3 + 1] * p[1] + rotation[k * 3 + 2] * p[2] + translation[k];
+		}
+		float u = (float)(camera[0] * c[0] / c[2] + camera[2]);
+		float v = (float)(camera[4] * c[1] / c[2] + camera[5]);
+		memcpy(truth_model + i * 3, p, 3 * sizeof(float));
+		truth_image[i * 2] = u;
+		truth_image[i * 2 + 1] = v;
+
+		// A white dot on the landmark
+		int px = (int)u, py = (int)v;
+		for (int dy = -2; dy <= 2; ++dy) {
+			for (int dx = -2; dx <= 2; ++dx) {
+				int x = px + dx, y = py + dy;
+				if (x < 0 || y < 0 || x >= width || y >= height) continue;
+				memset(pixels + (size_t)y * stride + x * 3, 255, 3);
+			}
+		}
+	}
+	truth_hands = 1;
+	return true;
+}
+
+Y4mSource::~Y4mSource() {
+	if (file) fclose(file);
+}
+
+bool Y4mSource::open(const char *path, bool loop) {
+	file = fopen(path, "rb");
+	if (!file) return false;
+	this->loop = loop;
+	if (!readHeader()) {
+		fclose(file);
+		file = nullptr;
+		return false;
+	}
+	dataStart = ftell(file);
+	return true;
+}
+
+bool Y4mSource::readHeader() {
+	char line[256];
+	if (!fgets(line, sizeof(line), file) || strncmp(line, "YUV4MPEG2 ", 10) != 0) return false;
+
+	std::string colorspace = "420jpeg";
+	char *token = strtok(line + 10, " \n");
+	while (token) {
+		switch (token[0]) {
+		case 'W': width = atoi(token + 1); break;
+		case 'H': height = atoi(token + 1); break;
+		case 'F': {
+			int num = 0, den = 1;
+			if (sscanf(token + 1, "%d:%d", &num, &den) == 2 && den > 0) fps = (double)num / den;
+			break;
+		}
+		case 'C': colorspace = token + 1; break;
+		}
+		token = strtok(NULL, " \n");
+	}
+	if (width <= 0 || height <= 0) return false;
+
+	if (colorspace.compare(0, 3, "444") == 0) chroma444 = true;
+	else if (colorspace.compare(0, 3, "420") != 0) return false;
+	fullRange = colorspace.find("jpeg") != std::string::npos || chroma444;
+
+	size_t chroma = chroma444 ? (size_t)width * height : (size_t)((width + 1) / 2) * ((height + 1) / 2);
+	planes.resize((size_t)width * height + 2 * chroma);
+	return true;
+}
+
+// A video has no ground truth landmarks
+bool Y4mSource::read(uint8_t *pixels, int stride, float *, float *, int, int &truth_hands) {
+	truth_hands = 0;
+	char line[128];
+	if (!fgets(line, sizeof(line), file)) {
+		if (!loop) return false;
+		fseek(file, dataStart, SEEK_SET);
+		if (!fgets(line, sizeof(line), file)) return false;
+	}
+	if (strncmp(line, "FRAME", 5) != 0) return false;
+	if (fread(&planes[0], 1, planes.size(), file) != planes.size()) return false;
+
+	int chromaWidth = chroma444 ? width : (width + 1) / 2;
+	int chromaHeight = chroma444 ? height : (height + 1) / 2;
+	const uint8_t *yPlane = &planes[0];
+	const uint8_t *uPlane = yPlane + (size_t)width * height;
+	const uint8_t *vPlane = uPlane + (size_t)chromaWidth * chromaHeight;
+
+	// BT.601, fixed point
+	for (int y = 0; y < height; ++y) {
+		uint8_t *row = pixels + (size_t)y * stride;
+		int cy = chroma444 ? y : y / 2;
+		for (int x = 0; x < width; ++x) {
+			int cx = chroma444 ? x : x / 2;
+			int l = yPlane[(size_t)y * width + x];
+			int u = uPlane[(size_t)cy * chromaWidth + cx] - 128;
+			int v = vPlane[(size_t)cy * chromaWidth + cx] - 128;
+			int luma = fullRange ? l * 256 : (l - 16) * 298;
+			int uScale = fullRange ? 256 : 292;
+			int r = (luma + 359 * v * uScale / 256 + 128) >> 8;
+			int g = (luma - (88 * u + 183 * v) * uScale / 256 + 128) >> 8;
+			int b = (luma + 454 * u * uScale / 256 + 128) >> 8;
+			row[x * 3] = (uint8_t)std::min(std::max(b, 0), 255);
+			row[x * 3 + 1] = (uint8_t)std::min(std::max(g, 0), 255);
+			row[x * 3 + 2] = (uint8_t)std::min(std::max(r, 0), 255);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#ifndef _FRAME_SOURCE_H_
+#define _FRAME_SOURCE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+static const int HAND_LANDMARKS = 21;
+
+// Frames for the pipeline when there is no camera. Sources may also know
+// the true hand landmarks of each frame, for headless testing.
+class FrameSource {
+public:
+	virtual ~FrameSource() {}
+
+	// Read the next frame as BGR into pixels (stride in bytes). truth_model
+	// and truth_image receive up to max_hands hands of 21 landmarks (model
+	// space and pixels); returns false at the end of the source.
+	virtual bool read(uint8_t *pixels, int stride, float *truth_model, float *truth_image, int max_hands, int &truth_hands) = 0;
+
+	int width = 0;
+	int height = 0;
+	double fps = 30.0;
+};
+
+// A moving gradient with one synthetic hand under a known, smoothly
+// changing pose, projected with the given intrinsics
+class SyntheticSource : public FrameSource {
+public:
+	SyntheticSource(int width, int height, const double *camera_matrix);
+
+	bool read(uint8_t *pixels, int stride, float *truth_model, float *truth_image, int max_hands, int &truth_hands) override;
+
+private:
+	double camera[9];
+	float model[HAND_LANDMARKS * 3];
+	uint64_t frameIndex = 0;
+};
+
+// YUV4MPEG2 file, 8-bit 4:2:0 or 4:4:4, played in a loop
+class Y4mSource : public FrameSource {
+public:
+	~Y4mSource();
+
+	bool open(const char *path, bool loop);
+
+	bool read(uint8_t *pixels, int stride, float *truth_model, float *truth_image, int max_hands, int &truth_hands) override;
+
+private:
+	bool readHeader();
+
+	FILE *file = nullptr;
+	long dataStart = 0;
+	bool loop = true;
+	bool chroma444 = false;
+	bool fullRange = false;
+	std::vector<uint8_t> planes;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "gl_loader.h"
+
+#include <stdio.h>
+
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+typedef void *(*ProcAddressFunction)(const char *name);
+
+#ifdef _WIN32
+
+static void *getProcAddress(const char *name) {
+	// wglGetProcAddress only knows extension and post 1.1 functions
+	void *function = (void *)wglGetProcAddress(name);
+	if (function == nullptr || function == (void *)1 || function == (void *)2 || function == (void *)3 || function == (void *)-1) {
+		static HMODULE opengl = LoadLibraryA("opengl32.dll");
+		function = opengl ? (void *)GetProcAddress(opengl, name) : nullptr;
+	}
+	return function;
+}
+
+#else
+
+static void *getProcAddress(const char *name) {
+	// The host has loaded its GL library already; look in there first, then
+	// ask GLX or EGL for what is not exported directly
+	static void *library = nullptr;
+	static ProcAddressFunction glxProcAddress = nullptr;
+	static ProcAddressFunction eglProcAddress = nullptr;
+	static std::once_flag once;
+	std::call_once(once, []() {
+#ifdef __APPLE__
+		library = dlopen("/System/Library/Frameworks/OpenGL.framework/OpenGL", RTLD_LAZY | RTLD_LOCAL);
+#else
+		library = dlopen("libGL.so.1", RTLD_LAZY | RTLD_LOCAL);
+		if (!library) library = dlopen("libGL.so", RTLD_LAZY | RTLD_LOCAL);
+		if (library) glxProcAddress = (ProcAddressFunction)dlsym(library, "glXGetProcAddressARB");
+		void *egl = dlopen("libEGL.so.1", RTLD_LAZY | RTLD_LOCAL);
+		if (egl) eglProcAddress = (ProcAddressFunction)dlsym(egl, "eglGetProcAddress");
+#endif
+	});
+
+	void *function = dlsym(RTLD_DEFAULT, name);
+	if (!function && library) function = dlsym(library, name);
+	if (!function && glxProcAddress) function = glxProcAddress(name);
+	if (!function && eglProcAddress) function = eglProcAddress(name);
+	return function;
+}
+
+#endif
+
+const GLFunctions *LoadGLFunctions() {
+	static GLFunctions functions;
+	static bool loaded = false;
+	static std::mutex mutex;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (loaded) return &functions;
+
+	bool complete = true;
+#define GL_LOAD(ret, name, args) \
+	functions.name = (ret (GLAPIENTRY *) args)getProcAddress("gl" #name); \
+	if (!functions.name) { \
+		fprintf(stderr, "arnative: missing GL function gl%s\n", #name); \
+		complete = false; \
+	}
+	GL_FUNCTIONS(GL_LOAD)
+#undef GL_LOAD
+
+	if (!complete) return nullptr;
+	loaded = true;
+	return &functions;
+}
+
+static GLuint compileShader(const GLFunctions *gl, GLenum type, const char *source, const char *name) {
+	GLuint shader = gl->CreateShader(type);
+	gl->ShaderSource(shader, 1, &source, nullptr);
+	gl->CompileShader(shader);
+
+	GLint status = GL_FALSE;
+	gl->GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE) {
+		GLint length = 0;
+		gl->GetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		std::vector<char> log(length + 1, 0);
+		gl->GetShaderInfoLog(shader, length, nullptr, &log[0]);
+		fprintf(stderr, "arnative: %s shader: %s\n", name, &log[0]);
+		gl->DeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+GLuint BuildProgram(const GLFunctions *gl, const char *vertex_source, const char *fragment_source, const char *name) {
+	GLuint vertexShader = compileShader(gl, GL_VERTEX_SHADER, vertex_source, name);
+	GLuint fragmentShader = compileShader(gl, GL_FRAGMENT_SHADER, fragment_source, name);
+	if (!vertexShader || !fragmentShader) {
+		if (vertexShader) gl->DeleteShader(vertexShader);
+		if (fragmentShader) gl->DeleteShader(fragmentShader);
+		return 0;
+	}
+
+	GLuint program = gl->CreateProgram();
+	gl->AttachShader(program, vertexShader);
+	gl->AttachShader(program, fragmentShader);
+	gl->LinkProgram(program);
+	gl->DeleteShader(vertexShader);
+	gl->DeleteShader(fragmentShader);
+
+	GLint status = GL_FALSE;
+	gl->GetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE) {
+		GLint length = 0;
+		gl->GetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::vector<char> log(length + 1, 0);
+		gl->GetProgramInfoLog(program, length, nullptr, &log[0]);
+		fprintf(stderr, "arnative: %s program: %s\n", name, &log[0]);
+		gl->DeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
@@ -0,0 +1,151 @@
+#ifndef _GL_LOADER_H_
+#define _GL_LOADER_H_
+
+// The few GL 3.3 core entry points the native library uses. The context
+// belongs to the host (moderngl in Python), so the functions are looked up
+// at runtime from whatever GL library the process already has loaded,
+// rather than linking one.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define GLAPIENTRY __stdcall
+#else
+#define GLAPIENTRY
+#endif
+
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef unsigned int GLbitfield;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef char GLchar;
+typedef ptrdiff_t GLintptr;
+typedef ptrdiff_t GLsizeiptr;
+typedef uint64_t GLuint64;
+typedef struct __GLsync *GLsync;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_LINES 0x0001
+#define GL_TRIANGLES 0x0004
+#define GL_DEPTH_TEST 0x0B71
+#define GL_CULL_FACE 0x0B44
+#define GL_BLEND 0x0BE2
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_DEPTH_WRITEMASK 0x0B72
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_TEXTURE_BINDING_2D 0x8069
+#define GL_VIEWPORT 0x0BA2
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_UNSIGNED_INT 0x1405
+#define GL_FLOAT 0x1406
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_ARRAY_BUFFER_BINDING 0x8894
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_RGB 0x1907
+#define GL_RGB8 0x8051
+#define GL_LINEAR 0x2601
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_CLAMP_TO_EDGE 0x812F
+#define GL_TEXTURE0 0x84C0
+#define GL_ACTIVE_TEXTURE 0x84E0
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#define GL_PIXEL_UNPACK_BUFFER_BINDING 0x88EF
+#define GL_STREAM_DRAW 0x88E0
+#define GL_MAP_WRITE_BIT 0x0002
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#define GL_CURRENT_PROGRAM 0x8B8D
+#define GL_VERTEX_ARRAY_BINDING 0x85B5
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+
+#define GL_FUNCTIONS(F) \
+	F(void, GetIntegerv, (GLenum pname, GLint *data)) \
+	F(GLboolean, IsEnabled, (GLenum cap)) \
+	F(void, Enable, (GLenum cap)) \
+	F(void, Disable, (GLenum cap)) \
+	F(void, DepthMask, (GLboolean flag)) \
+	F(void, PixelStorei, (GLenum pname, GLint param)) \
+	F(void, GenTextures, (GLsizei n, GLuint *textures)) \
+	F(void, DeleteTextures, (GLsizei n, const GLuint *textures)) \
+	F(void, BindTexture, (GLenum target, GLuint texture)) \
+	F(void, ActiveTexture, (GLenum texture)) \
+	F(void, TexParameteri, (GLenum target, GLenum pname, GLint param)) \
+	F(void, TexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)) \
+	F(void, TexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)) \
+	F(void, GenBuffers, (GLsizei n, GLuint *buffers)) \
+	F(void, DeleteBuffers, (GLsizei n, const GLuint *buffers)) \
+	F(void, BindBuffer, (GLenum target, GLuint buffer)) \
+	F(void, BufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage)) \
+	F(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data)) \
+	F(void *, MapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)) \
+	F(GLboolean, UnmapBuffer, (GLenum target)) \
+	F(GLsync, FenceSync, (GLenum condition, GLbitfield flags)) \
+	F(GLenum, ClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout)) \
+	F(void, DeleteSync, (GLsync sync)) \
+	F(GLuint, CreateShader, (GLenum type)) \
+	F(void, DeleteShader, (GLuint shader)) \
+	F(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)) \
+	F(void, CompileShader, (GLuint shader)) \
+	F(void, GetShaderiv, (GLuint shader, GLenum pname, GLint *params)) \
+	F(void, GetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)) \
+	F(GLuint, CreateProgram, (void)) \
+	F(void, DeleteProgram, (GLuint program)) \
+	F(void, AttachShader, (GLuint program, GLuint shader)) \
+	F(void, LinkProgram, (GLuint program)) \
+	F(void, GetProgramiv, (GLuint program, GLenum pname, GLint *params)) \
+	F(void, GetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)) \
+	F(void, UseProgram, (GLuint program)) \
+	F(GLint, GetUniformLocation, (GLuint program, const GLchar *name)) \
+	F(void, Uniform1i, (GLint location, GLint v0)) \
+	F(void, Uniform1f, (GLint location, GLfloat v0)) \
+	F(void, Uniform2f, (GLint location, GLfloat v0, GLfloat v1)) \
+	F(void, Uniform4fv, (GLint location, GLsizei count, const GLfloat *value)) \
+	F(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)) \
+	F(void, GenVertexArrays, (GLsizei n, GLuint *arrays)) \
+	F(void, DeleteVertexArrays, (GLsizei n, const GLuint *arrays)) \
+	F(void, BindVertexArray, (GLuint array)) \
+	F(void, EnableVertexAttribArray, (GLuint index)) \
+	F(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)) \
+	F(void, VertexAttribDivisor, (GLuint index, GLuint divisor)) \
+	F(void, DrawArrays, (GLenum mode, GLint first, GLsizei count)) \
+	F(void, DrawElements, (GLenum mode, GLsizei count, GLenum type, const void *indices)) \
+	F(void, DrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount))
+
+struct GLFunctions {
+#define GL_DECLARE(ret, name, args) ret (GLAPIENTRY *name) args;
+	GL_FUNCTIONS(GL_DECLARE)
+#undef GL_DECLARE
+};
+
+// Functions of the current context's GL library, or nullptr if any is
+// missing. Looked up once; all contexts of a process share the pointers
+// on the platforms this runs on.
+const GLFunctions *LoadGLFunctions();
+
+// Compile and link a vertex and fragment shader; 0 on failure, with the
+// log on stderr under the given name
+GLuint BuildProgram(const GLFunctions *gl, const char *vertex_source, const char *fragment_source, const char *name);
+
+#endif
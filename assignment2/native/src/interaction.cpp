@@ -0,0 +1,295 @@
+#include "interaction.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+// MediaPipe hand landmarks
+static const int THUMB_TIP = 4;
+static const int INDEX_TIP = 8;
+static const int FINGERTIPS[] = { 4, 8, 12, 16, 20 };
+
+// A pinch ends only when the fingers open this much wider than the pinch
+// distance, so a grab does not flicker at the threshold
+static const float PINCH_RELEASE_FACTOR = 1.5f;
+
+SpatialHash::SpatialHash(float cell_size) {
+	cellSize = cell_size > 0.0f ? cell_size : 1.0f;
+	inverseCellSize = 1.0f / cellSize;
+	buckets.assign(64, -1);
+}
+
+int SpatialHash::bucketOfCell(int x, int y, int z) const {
+	uint32_t hash = ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u) ^ ((uint32_t)z * 83492791u);
+	return (int)(hash & (uint32_t)(buckets.size() - 1));
+}
+
+int SpatialHash::bucketOf(const float *position) const {
+	return bucketOfCell((int)floorf(position[0] * inverseCellSize), (int)floorf(position[1] * inverseCellSize),
+		(int)floorf(position[2] * inverseCellSize));
+}
+
+void SpatialHash::link(int id) {
+	Object &object = objects[id];
+	object.bucket = bucketOf(object.position);
+	object.prev = -1;
+	object.next = buckets[object.bucket];
+	if (object.next >= 0) objects[object.next].prev = id;
+	buckets[object.bucket] = id;
+}
+
+void SpatialHash::unlink(int id) {
+	Object &object = objects[id];
+	if (object.prev >= 0) objects[object.prev].next = object.next;
+	else buckets[object.bucket] = object.next;
+	if (object.next >= 0) objects[object.next].prev = object.prev;
+}
+
+void SpatialHash::rehash(size_t bucket_count) {
+	buckets.assign(bucket_count, -1);
+	for (size_t i = 0; i < objects.size(); ++i) {
+		if (objects[i].alive && !objects[i].large) link((int)i);
+	}
+}
+
+int SpatialHash::add(const float *position, float radius) {
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	} else {
+		id = (int)objects.size();
+		objects.emplace_back();
+	}
+
+	Object &object = objects[id];
+	memcpy(object.position, position, sizeof(object.position));
+	object.radius = std::max(radius, 0.0f);
+	object.stamp = 0;
+	object.alive = true;
+	object.large = object.radius > cellSize;
+	++liveCount;
+
+	if (object.large) {
+		largeIds.push_back(id);
+		return id;
+	}
+
+	// Keep at least two buckets per object, so chains stay short
+	if ((size_t)liveCount * 2 > buckets.size()) rehash(buckets.size() * 2);
+	else link(id);
+	return id;
+}
+
+void SpatialHash::remove(int id) {
+	if (!contains(id)) return;
+	if (objects[id].large) largeIds.erase(std::find(largeIds.begin(), largeIds.end(), id));
+	else unlink(id);
+	objects[id].alive = false;
+	freeIds.push_back(id);
+	--liveCount;
+}
+
+void SpatialHash::move(int id, const float *position) {
+	if (!contains(id)) return;
+	Object &object = objects[id];
+	memcpy(object.position, position, sizeof(object.position));
+	if (object.large) return;
+	int bucket = bucketOf(position);
+	if (bucket == object.bucket) return;
+	unlink(id);
+	link(id);
+}
+
+template <typename Callback>
+void SpatialHash::query(const float *center, float radius, Callback found) {
+	// A bucket shared by two cells must be read only once
+	if (++queryStamp == 0) {
+		for (Object &object : objects) object.stamp = 0;
+		queryStamp = 1;
+	}
+	auto test = [&](int id) {
+		Object &object = objects[id];
+		if (object.stamp == queryStamp) return;
+		object.stamp = queryStamp;
+
+		float dx = object.position[0] - center[0];
+		float dy = object.position[1] - center[1];
+		float dz = object.position[2] - center[2];
+		float limit = radius + object.radius;
+		float squared = dx * dx + dy * dy + dz * dz;
+		if (squared <= limit * limit) found(id, sqrtf(squared));
+	};
+
+	// Objects are filed under their centers, so the cells to visit are those
+	// of the query sphere grown by the largest radius in the grid, a cell
+	float reach = radius + cellSize;
+	int lower[3], upper[3];
+	double cellCount = 1.0;
+	for (int k = 0; k < 3; ++k) {
+		lower[k] = (int)floorf((center[k] - reach) * inverseCellSize);
+		upper[k] = (int)floorf((center[k] + reach) * inverseCellSize);
+		cellCount *= (double)upper[k] - lower[k] + 1.0;
+	}
+
+	if (cellCount > (double)buckets.size()) {
+		// More cells than buckets: every bucket would be read anyway
+		for (size_t id = 0; id < objects.size(); ++id) {
+			if (objects[id].alive && !objects[id].large) test((int)id);
+		}
+	} else {
+		for (int x = lower[0]; x <= upper[0]; ++x) {
+			for (int y = lower[1]; y <= upper[1]; ++y) {
+				for (int z = lower[2]; z <= upper[2]; ++z) {
+					for (int id = buckets[bucketOfCell(x, y, z)]; id >= 0; id = objects[id].next) test(id);
+				}
+			}
+		}
+	}
+
+	for (int id : largeIds) test(id);
+}
+
+void InteractionWorld::emit(int hand, int object, int type, float distance) {
+	ArContactEvent event = { hand, object, type, distance };
+	pending.push_back(event);
+}
+
+int InteractionWorld::update(const float *landmarks, int hand_count, float fingertip_radius, float pinch_distance,
+	ArContactEvent *events, int max_events) {
+	pending.clear();
+	hand_count = std::max(hand_count, 0);
+	if ((int)hands.size() < hand_count) hands.resize(hand_count);
+
+	for (int h = 0; h < (int)hands.size(); ++h) {
+		HandState &state = hands[h];
+
+		// Hands that are gone let go of everything
+		if (h >= hand_count) {
+			for (int object : state.contacts) emit(h, object, AR_CONTACT_END, 0.0f);
+			if (state.grabbed >= 0) emit(h, state.grabbed, AR_GRAB_END, 0.0f);
+			state.contacts.clear();
+			state.grabbed = -1;
+			state.pinching = false;
+			continue;
+		}
+		const float *hand = landmarks + (size_t)h * AR_HAND_LANDMARKS * 3;
+
+		// Fingertip spheres
+		touched.clear();
+		for (int tip : FINGERTIPS) {
+			objects.query(hand + tip * 3, fingertip_radius, [this](int id, float) { touched.push_back(id); });
+		}
+		std::sort(touched.begin(), touched.end());
+		touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+		std::vector<int>::const_iterator previous = state.contacts.begin();
+		std::vector<int>::const_iterator current = touched.begin();
+		while (previous != state.contacts.end() || current != touched.end()) {
+			if (current == touched.end() || (previous != state.contacts.end() && *previous < *current)) {
+				emit(h, *previous++, AR_CONTACT_END, 0.0f);
+			} else if (previous == state.contacts.end() || *current < *previous) {
+				emit(h, *current++, AR_CONTACT_BEGIN, 0.0f);
+			} else {
+				++previous;
+				++current;
+			}
+		}
+		state.contacts.swap(touched);
+
+		// Pinch: thumb and index tips together. A new pinch grabs the object
+		// nearest to the point between them.
+		const float *thumb = hand + THUMB_TIP * 3;
+		const float *index = hand + INDEX_TIP * 3;
+		float pinchPoint[3], gap = 0.0f;
+		for (int k = 0; k < 3; ++k) {
+			pinchPoint[k] = 0.5f * (thumb[k] + index[k]);
+			gap += (thumb[k] - index[k]) * (thumb[k] - index[k]);
+		}
+		gap = sqrtf(gap);
+		bool wasPinching = state.pinching;
+		state.pinching = gap < pinch_distance * (wasPinching ? PINCH_RELEASE_FACTOR : 1.0f);
+
+		if (state.pinching && !wasPinching) {
+			int nearest = -1;
+			float nearestDistance = 0.0f;
+			objects.query(pinchPoint, fingertip_radius, [&](int id, float distance) {
+				if (nearest < 0 || distance < nearestDistance) {
+					nearest = id;
+					nearestDistance = distance;
+				}
+			});
+			if (nearest >= 0) {
+				state.grabbed = nearest;
+				emit(h, nearest, AR_GRAB_BEGIN, nearestDistance);
+			}
+		} else if (!state.pinching && state.grabbed >= 0) {
+			emit(h, state.grabbed, AR_GRAB_END, gap);
+			state.grabbed = -1;
+		}
+	}
+	if ((int)hands.size() > hand_count) hands.resize(hand_count);
+
+	int count = std::min((int)pending.size(), std::max(max_events, 0));
+	if (events && count > 0) memcpy(events, &pending[0], count * sizeof(ArContactEvent));
+	return count;
+}
+
+void InteractionWorld::removeObject(int id) {
+	// The id may be reused right away, so no end events refer to it later
+	for (HandState &state : hands) {
+		state.contacts.erase(std::remove(state.contacts.begin(), state.contacts.end(), id), state.contacts.end());
+		if (state.grabbed == id) state.grabbed = -1;
+	}
+	objects.remove(id);
+}
+
+int InteractionWorld::grabbed(int hand) const {
+	return hand >= 0 && hand < (int)hands.size() ? hands[hand].grabbed : -1;
+}
+
+// C interface
+
+ArInteraction *ar_interaction_create(float cell_size) {
+	return (ArInteraction *)new InteractionWorld(cell_size);
+}
+
+void ar_interaction_destroy(ArInteraction *world) {
+	delete (InteractionWorld *)world;
+}
+
+int ar_interaction_add_object(ArInteraction *world, const float *position, float radius) {
+	if (!world || !position) return -1;
+	return ((InteractionWorld *)world)->objects.add(position, radius);
+}
+
+void ar_interaction_remove_object(ArInteraction *world, int id) {
+	if (world) ((InteractionWorld *)world)->removeObject(id);
+}
+
+void ar_interaction_move_objects(ArInteraction *world, const int *ids, const float *positions, int count) {
+	if (!world || !ids || !positions) return;
+	SpatialHash &objects = ((InteractionWorld *)world)->objects;
+	for (int i = 0; i < count; ++i) objects.move(ids[i], positions + i * 3);
+}
+
+int ar_interaction_query_sphere(ArInteraction *world, const float *center, float radius, int *ids, int max_ids) {
+	if (!world || !center) return 0;
+	int count = 0;
+	((InteractionWorld *)world)->objects.query(center, radius, [&](int id, float) {
+		if (ids && count < max_ids) ids[count] = id;
+		++count;
+	});
+	return count;
+}
+
+int ar_interaction_update_hands(ArInteraction *world, const float *landmarks, int hand_count,
+	float fingertip_radius, float pinch_distance, ArContactEvent *events, int max_events) {
+	if (!world || (hand_count > 0 && !landmarks)) return 0;
+	return ((InteractionWorld *)world)->update(landmarks, hand_count, fingertip_radius, pinch_distance, events, max_events);
+}
+
+int ar_interaction_grabbed(ArInteraction *world, int hand) {
+	return world ? ((InteractionWorld *)world)->grabbed(hand) : -1;
+}
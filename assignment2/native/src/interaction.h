@@ -0,0 +1,88 @@
+#ifndef _INTERACTION_H_
+#define _INTERACTION_H_
+
+#include <arnative.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Grabbable objects (spheres) in a uniform grid hashed into buckets, as in
+// Teschner et al. 2003: an object lives in the bucket of the cell of its
+// center, so moving it is an unlink and a link in O(1), and a query only
+// visits the buckets of the cells its sphere overlaps. Cells of different
+// coordinates may share a bucket; the exact distance test sorts them out.
+// Objects larger than a cell are kept out of the grid, in a list every
+// query tests, so that one large object does not widen all queries.
+class SpatialHash {
+public:
+	explicit SpatialHash(float cell_size = 5.0f);
+
+	int add(const float *position, float radius);
+	void remove(int id);
+	void move(int id, const float *position);
+	bool contains(int id) const { return id >= 0 && id < (int)objects.size() && objects[id].alive; }
+
+	// Objects whose sphere intersects the query sphere, each once.
+	// Calls found(id, distance between the centers).
+	template <typename Callback>
+	void query(const float *center, float radius, Callback found);
+
+	int objectCount() const { return liveCount; }
+
+private:
+	struct Object {
+		float position[3];
+		float radius;
+		int bucket;
+		int next, prev;			// Within the bucket
+		uint32_t stamp;			// Last query that reported it
+		bool alive;
+		bool large;				// Radius above the cell size, in largeIds instead of a bucket
+	};
+
+	int bucketOf(const float *position) const;
+	int bucketOfCell(int x, int y, int z) const;
+	void link(int id);
+	void unlink(int id);
+	void rehash(size_t bucket_count);
+
+	float cellSize;
+	float inverseCellSize;
+	std::vector<Object> objects;
+	std::vector<int> freeIds;
+	std::vector<int> largeIds;
+	std::vector<int> buckets;	// First object of each bucket, -1 if empty
+	int liveCount = 0;
+	uint32_t queryStamp = 0;
+};
+
+// Hands against a SpatialHash, frame by frame: fingertip contacts and
+// pinch grabs, reported as begin and end events
+class InteractionWorld {
+public:
+	explicit InteractionWorld(float cell_size) : objects(cell_size) {}
+
+	int update(const float *landmarks, int hand_count, float fingertip_radius, float pinch_distance,
+		ArContactEvent *events, int max_events);
+	void removeObject(int id);
+	int grabbed(int hand) const;
+
+	SpatialHash objects;
+
+private:
+	struct HandState {
+		std::vector<int> contacts;	// Sorted
+		int grabbed = -1;
+		bool pinching = false;
+	};
+
+	void emit(int hand, int object, int type, float distance);
+
+	std::vector<HandState> hands;
+	std::vector<int> touched;
+	std::vector<ArContactEvent> pending;
+};
+
+#endif
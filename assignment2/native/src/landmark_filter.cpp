@@ -0,0 +1,183 @@
+#include "landmark_filter.h"
+#include "simd.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+static const float TWO_PI = 6.28318530718f;
+
+// Velocity variance of a fresh Kalman channel, relative to the measurement
+// variance: large enough that the second measurement sets the velocity
+static const float INITIAL_VELOCITY_VARIANCE = 1e6f;
+
+// Shortest time step, for repeated timestamps
+static const double MIN_TIME_STEP = 1e-6;
+
+struct LandmarkFilter::Step {
+	float dt;
+	float predict;
+	float alphaDerivative;	// One Euro smoothing of the derivative
+	float processNoise[3];	// Kalman Q for this step: q dt^3/3, q dt^2/2, q dt
+};
+
+void LandmarkFilter::initialize(int channel_count, const ArFilterParams &params) {
+	this->params = params;
+	channelCount = std::max(channel_count, 0);
+	hasTimestamp = false;
+
+	size_t padded = (size_t)PaddedCount(channelCount);
+	position.assign(padded, 0.0f);
+	velocity.assign(padded, 0.0f);
+	fresh.assign(padded, 1.0f);
+	if (params.type == AR_FILTER_KALMAN) {
+		p00.assign(padded, 0.0f);
+		p01.assign(padded, 0.0f);
+		p11.assign(padded, 0.0f);
+	}
+}
+
+void LandmarkFilter::reset(int first, int count) {
+	first = std::max(first, 0);
+	int end = std::min(first + count, channelCount);
+	for (int i = first; i < end; ++i) fresh[i] = 1.0f;
+}
+
+template <bool Kalman>
+void LandmarkFilter::run(const Step &step, int begin, int end, const float *z, float *filtered, float *predicted) {
+	const FloatBatch zero(0.0f);
+	const FloatBatch one(1.0f);
+	const FloatBatch predict(step.predict);
+
+	// One Euro constants
+	const FloatBatch invDt(1.0f / step.dt);
+	const FloatBatch alphaDerivative(step.alphaDerivative);
+	const FloatBatch minCutoff(params.min_cutoff);
+	const FloatBatch beta(params.beta);
+	const FloatBatch twoPiDt(TWO_PI * step.dt);
+
+	// Kalman constants
+	const FloatBatch dt(step.dt);
+	const FloatBatch q00(step.processNoise[0]), q01(step.processNoise[1]), q11(step.processNoise[2]);
+	const FloatBatch r(params.measurement_noise);
+	const FloatBatch initialVariance(params.measurement_noise * INITIAL_VELOCITY_VARIANCE);
+
+	for (int i = begin; i < end; i += FloatBatch::WIDTH) {
+		FloatBatch x = FloatBatch::load(z + i - begin);
+		FloatBatch isFresh = FloatBatch::load(&fresh[i]);
+		FloatBatch p = FloatBatch::load(&position[i]);
+		FloatBatch v = FloatBatch::load(&velocity[i]);
+
+		if (Kalman) {
+			FloatBatch a = FloatBatch::load(&p00[i]);
+			FloatBatch b = FloatBatch::load(&p01[i]);
+			FloatBatch c = FloatBatch::load(&p11[i]);
+
+			// Constant velocity prediction, white noise acceleration
+			p = p + v * dt;
+			a = a + dt * (b + b + dt * c) + q00;
+			b = b + dt * c + q01;
+			c = c + q11;
+
+			// Position measurement
+			FloatBatch s = a + r;
+			FloatBatch k0 = a / s;
+			FloatBatch k1 = b / s;
+			FloatBatch residual = x - p;
+			p = p + k0 * residual;
+			v = v + k1 * residual;
+			c = c - k1 * b;
+			a = (one - k0) * a;
+			b = (one - k0) * b;
+
+			Select(isFresh, r, a).store(&p00[i]);
+			Select(isFresh, zero, b).store(&p01[i]);
+			Select(isFresh, initialVariance, c).store(&p11[i]);
+		} else {
+			// Derivative smoothed at a fixed cutoff, which then raises the
+			// position cutoff with speed
+			FloatBatch dx = (x - p) * invDt;
+			v = v + alphaDerivative * (dx - v);
+			FloatBatch tau = twoPiDt * (minCutoff + beta * Abs(v));
+			FloatBatch alpha = tau / (tau + one);
+			p = p + alpha * (x - p);
+		}
+
+		p = Select(isFresh, x, p);
+		v = Select(isFresh, zero, v);
+		p.store(&position[i]);
+		v.store(&velocity[i]);
+		zero.store(&fresh[i]);
+		if (filtered) p.store(filtered + i - begin);
+		if (predicted) (p + v * predict).store(predicted + i - begin);
+	}
+}
+
+void LandmarkFilter::update(const float *measurements, double timestamp, float predict_seconds, float *filtered, float *predicted) {
+	if (channelCount == 0) return;
+
+	// Without a previous frame every channel starts over
+	if (!hasTimestamp) reset(0, channelCount);
+	double dt = hasTimestamp ? std::max(timestamp - lastTimestamp, MIN_TIME_STEP) : 1.0;
+	lastTimestamp = timestamp;
+	hasTimestamp = true;
+
+	Step step;
+	step.dt = (float)dt;
+	step.predict = predict_seconds;
+	float tau = TWO_PI * step.dt * params.derivative_cutoff;
+	step.alphaDerivative = tau / (tau + 1.0f);
+	step.processNoise[0] = params.process_noise * step.dt * step.dt * step.dt / 3.0f;
+	step.processNoise[1] = params.process_noise * step.dt * step.dt / 2.0f;
+	step.processNoise[2] = params.process_noise * step.dt;
+
+	// Whole batches straight from the caller's arrays, the rest through a
+	// batch sized copy; the state arrays are padded
+	int whole = channelCount / FloatBatch::WIDTH * FloatBatch::WIDTH;
+	bool kalman = params.type == AR_FILTER_KALMAN;
+	if (kalman) run<true>(step, 0, whole, measurements, filtered, predicted);
+	else run<false>(step, 0, whole, measurements, filtered, predicted);
+
+	int rest = channelCount - whole;
+	if (rest > 0) {
+		float z[FloatBatch::WIDTH] = {};
+		float f[FloatBatch::WIDTH], p[FloatBatch::WIDTH];
+		memcpy(z, measurements + whole, rest * sizeof(float));
+		if (kalman) run<true>(step, whole, whole + FloatBatch::WIDTH, z, filtered ? f : nullptr, predicted ? p : nullptr);
+		else run<false>(step, whole, whole + FloatBatch::WIDTH, z, filtered ? f : nullptr, predicted ? p : nullptr);
+		if (filtered) memcpy(filtered + whole, f, rest * sizeof(float));
+		if (predicted) memcpy(predicted + whole, p, rest * sizeof(float));
+	}
+}
+
+// C interface
+
+void ar_filter_default_params(ArFilterParams *params, int type) {
+	memset(params, 0, sizeof(*params));
+	params->type = type;
+	params->min_cutoff = 1.0f;
+	params->beta = 0.05f;
+	params->derivative_cutoff = 1.0f;
+	params->process_noise = 1e4f;
+	params->measurement_noise = 4.0f;
+}
+
+ArFilter *ar_filter_create(int channel_count, const ArFilterParams *params) {
+	if (channel_count < 0 || !params) return nullptr;
+	LandmarkFilter *filter = new LandmarkFilter();
+	filter->initialize(channel_count, *params);
+	return (ArFilter *)filter;
+}
+
+void ar_filter_destroy(ArFilter *filter) {
+	delete (LandmarkFilter *)filter;
+}
+
+void ar_filter_reset(ArFilter *filter, int first, int count) {
+	if (filter) ((LandmarkFilter *)filter)->reset(first, count);
+}
+
+void ar_filter_update(ArFilter *filter, const float *measurements, double timestamp_s, float predict_s,
+	float *filtered, float *predicted) {
+	if (filter && measurements) ((LandmarkFilter *)filter)->update(measurements, timestamp_s, predict_s, filtered, predicted);
+}
@@ -0,0 +1,44 @@
+#ifndef _LANDMARK_FILTER_H_
+#define _LANDMARK_FILTER_H_
+
+#include <arnative.h>
+
+#include <vector>
+
+// Smoothing and latency compensation of many independent coordinates at
+// once, e.g. all landmarks of all hands or faces of a frame flattened. The
+// state of each filter lives in one array per quantity (SoA), so an update
+// runs a batch of channels per instruction. All channels share the frame
+// timestamp.
+class LandmarkFilter {
+public:
+	void initialize(int channel_count, const ArFilterParams &params);
+
+	// The next update takes the measurements of these channels as they are,
+	// e.g. after a hand was lost
+	void reset(int first, int count);
+
+	// filtered and predicted (filtered + velocity * predict_seconds) may be
+	// null; both may alias measurements
+	void update(const float *measurements, double timestamp, float predict_seconds, float *filtered, float *predicted);
+
+	int channelCount = 0;
+
+private:
+	struct Step;
+	template <bool Kalman>
+	void run(const Step &step, int begin, int end, const float *z, float *filtered, float *predicted);
+
+	ArFilterParams params;
+	double lastTimestamp = 0.0;
+	bool hasTimestamp = false;
+
+	// One Euro: position and smoothed derivative. Kalman: position, velocity
+	// and the covariance (p00, p01, p11).
+	std::vector<float> position;
+	std::vector<float> velocity;
+	std::vector<float> p00, p01, p11;
+	std::vector<float> fresh;	// 1 until the first measurement after a reset
+};
+
+#endif
@@ -0,0 +1,556 @@
+#include "landmark_tracker.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRACKER_SSE2
+#endif
+
+// Bilinear weights are 14-bit fixed point. Window intensities keep 5
+// fractional bits, derivatives the Scharr scale; both are 32 times the
+// value per pixel, so the scales cancel in the flow equations.
+static const int W_BITS = 14;
+static const int I_SHIFT = W_BITS - 5;
+
+// Pixels processed per SIMD step along a window row
+static const int STEP = 8;
+
+// Smallest level size worth adding to the pyramid
+static const int MIN_LEVEL_SIZE = 16;
+
+// ---------------------------------------------------------------------------
+// Pyramid
+
+static void replicateBorder(ImagePyramid::Level &level) {
+	int border = level.border;
+	for (int y = 0; y < level.height; ++y) {
+		uint8_t *row = &level.pixels[level.offset(0, y)];
+		memset(row - border, row[0], border);
+		memset(row + level.width, row[level.width - 1], border);
+	}
+	const uint8_t *top = &level.pixels[level.offset(-border, 0)];
+	const uint8_t *bottom = &level.pixels[level.offset(-border, level.height - 1)];
+	for (int y = 1; y <= border; ++y) {
+		memcpy(&level.pixels[level.offset(-border, -y)], top, level.stride);
+		memcpy(&level.pixels[level.offset(-border, level.height - 1 + y)], bottom, level.stride);
+	}
+}
+
+// Scharr derivatives of every pixel but the outermost ring of the border
+static void computeDerivatives(ImagePyramid::Level &level) {
+	int stride = level.stride;
+	int rows = (int)(level.pixels.size() / stride);
+	level.dx.assign(level.pixels.size(), 0);
+	level.dy.assign(level.pixels.size(), 0);
+	for (int y = 1; y < rows - 1; ++y) {
+		const uint8_t *above = &level.pixels[(y - 1) * stride];
+		const uint8_t *row = above + stride;
+		const uint8_t *below = row + stride;
+		int16_t *dx = &level.dx[y * stride];
+		int16_t *dy = &level.dy[y * stride];
+		int x = 1;
+#if defined(TRACKER_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i three = _mm_set1_epi16(3);
+		const __m128i ten = _mm_set1_epi16(10);
+		for (; x + STEP + 1 <= stride; x += STEP) {
+			__m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(above + x - 1)), zero);
+			__m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(above + x)), zero);
+			__m128i a2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(above + x + 1)), zero);
+			__m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row + x - 1)), zero);
+			__m128i b2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row + x + 1)), zero);
+			__m128i c0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(below + x - 1)), zero);
+			__m128i c1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(below + x)), zero);
+			__m128i c2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(below + x + 1)), zero);
+
+			__m128i gx = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(c2, c0)), three),
+				_mm_mullo_epi16(_mm_sub_epi16(b2, b0), ten));
+			__m128i gy = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(_mm_sub_epi16(c0, a0), _mm_sub_epi16(c2, a2)), three),
+				_mm_mullo_epi16(_mm_sub_epi16(c1, a1), ten));
+			_mm_storeu_si128((__m128i *)(dx + x), gx);
+			_mm_storeu_si128((__m128i *)(dy + x), gy);
+		}
+#endif
+		for (; x < stride - 1; ++x) {
+			dx[x] = (int16_t)(3 * (above[x + 1] - above[x - 1] + below[x + 1] - below[x - 1]) + 10 * (row[x + 1] - row[x - 1]));
+			dy[x] = (int16_t)(3 * (below[x - 1] - above[x - 1] + below[x + 1] - above[x + 1]) + 10 * (below[x] - above[x]));
+		}
+	}
+}
+
+static void resizeLevel(ImagePyramid::Level &level, int width, int height, int border) {
+	level.width = width;
+	level.height = height;
+	level.border = border;
+	level.stride = width + 2 * border;
+	level.pixels.resize((size_t)level.stride * (height + 2 * border));
+}
+
+void ImagePyramid::build(const uint8_t *image, int width, int height, int stride, int channels, int level_count, int border) {
+	levels.resize(1);
+	Level &bottom = levels[0];
+	resizeLevel(bottom, width, height, border);
+
+	// Gray as (R + 2 G + B) / 4, the same for BGR and RGB
+	for (int y = 0; y < height; ++y) {
+		const uint8_t *in = image + (size_t)y * stride;
+		uint8_t *out = &bottom.pixels[bottom.offset(0, y)];
+		if (channels == 1) {
+			memcpy(out, in, width);
+		} else {
+			for (int x = 0; x < width; ++x, in += channels) out[x] = (uint8_t)((in[0] + 2 * in[1] + in[2] + 2) >> 2);
+		}
+	}
+	replicateBorder(bottom);
+	computeDerivatives(bottom);
+
+	for (int l = 1; l <= level_count; ++l) {
+		const Level &previous = levels[l - 1];
+		if (previous.width < 2 * MIN_LEVEL_SIZE || previous.height < 2 * MIN_LEVEL_SIZE) break;
+		levels.emplace_back();
+		downsample(levels[l - 1], levels[l]);
+	}
+}
+
+// Gaussian 5-tap [1 4 6 4 1] / 16 in both directions, every other pixel, as
+// cv2.pyrDown
+void ImagePyramid::downsample(const Level &source, Level &destination) {
+	int width = (source.width + 1) / 2;
+	int height = (source.height + 1) / 2;
+	resizeLevel(destination, width, height, source.border);
+
+	// Source columns -2 to 2 width + 2, enough for the horizontal taps
+	int columns = 2 * width + 4;
+	rowBuffer.resize(columns);
+	for (int y = 0; y < height; ++y) {
+		const uint8_t *r0 = &source.pixels[source.offset(-2, 2 * y - 2)];
+		const uint8_t *r1 = r0 + source.stride;
+		const uint8_t *r2 = r1 + source.stride;
+		const uint8_t *r3 = r2 + source.stride;
+		const uint8_t *r4 = r3 + source.stride;
+		uint16_t *v = rowBuffer.data();
+		for (int x = 0; x < columns; ++x) v[x] = (uint16_t)(r0[x] + r4[x] + 4 * (r1[x] + r3[x]) + 6 * r2[x]);
+
+		uint8_t *out = &destination.pixels[destination.offset(0, y)];
+		for (int x = 0; x < width; ++x) {
+			const uint16_t *t = v + 2 * x;
+			out[x] = (uint8_t)((t[0] + t[4] + 4 * (t[1] + t[3]) + 6 * t[2] + 128) >> 8);
+		}
+	}
+	replicateBorder(destination);
+	computeDerivatives(destination);
+}
+
+// ---------------------------------------------------------------------------
+// Lucas-Kanade
+
+struct BilinearWeights {
+	int w00, w01, w10, w11;
+
+	BilinearWeights(float a, float b) {
+		w00 = (int)lroundf((1.0f - a) * (1.0f - b) * (1 << W_BITS));
+		w01 = (int)lroundf(a * (1.0f - b) * (1 << W_BITS));
+		w10 = (int)lroundf((1.0f - a) * b * (1 << W_BITS));
+		w11 = (1 << W_BITS) - w00 - w01 - w10;
+	}
+};
+
+// Whether a window of rows x padded_width at (x, y), plus the column and row
+// the interpolation reads past it, lies within the level and its border
+static bool windowInside(const ImagePyramid::Level &level, int x, int y, int padded_width, int rows) {
+	return x >= -level.border && y >= -level.border &&
+		x + padded_width + 1 <= level.width + level.border && y + rows + 1 <= level.height + level.border;
+}
+
+// Window of pixels and derivatives at subpixel position (corner + weights).
+// Columns past window_size are zero, so they drop out of the sums.
+static void sampleWindow(const ImagePyramid::Level &level, int x, int y, const BilinearWeights &w,
+	int window_size, int padded_width, int16_t *out_i, int16_t *out_dx, int16_t *out_dy) {
+	int stride = level.stride;
+	for (int row = 0; row < window_size; ++row) {
+		int index = level.offset(x, y + row);
+		const uint8_t *p = &level.pixels[index];
+		const int16_t *dx = &level.dx[index];
+		const int16_t *dy = &level.dy[index];
+		int16_t *ri = out_i + row * padded_width;
+		int16_t *rdx = out_dx + row * padded_width;
+		int16_t *rdy = out_dy + row * padded_width;
+		int col = 0;
+#if defined(TRACKER_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i top = _mm_set1_epi32((w.w01 << 16) | w.w00);
+		const __m128i bottom = _mm_set1_epi32((w.w11 << 16) | w.w10);
+		const __m128i roundI = _mm_set1_epi32(1 << (I_SHIFT - 1));
+		const __m128i roundD = _mm_set1_epi32(1 << (W_BITS - 1));
+		for (; col < window_size; col += STEP) {
+			__m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + col)), zero);
+			__m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + col + 1)), zero);
+			__m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + stride + col)), zero);
+			__m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + stride + col + 1)), zero);
+			__m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpacklo_epi16(b0, b1), bottom));
+			__m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpackhi_epi16(b0, b1), bottom));
+			__m128i value = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, roundI), I_SHIFT), _mm_srai_epi32(_mm_add_epi32(hi, roundI), I_SHIFT));
+			_mm_storeu_si128((__m128i *)(ri + col), value);
+
+			const int16_t *d[2] = { dx + col, dy + col };
+			int16_t *o[2] = { rdx + col, rdy + col };
+			for (int k = 0; k < 2; ++k) {
+				a0 = _mm_loadu_si128((const __m128i *)d[k]);
+				a1 = _mm_loadu_si128((const __m128i *)(d[k] + 1));
+				b0 = _mm_loadu_si128((const __m128i *)(d[k] + stride));
+				b1 = _mm_loadu_si128((const __m128i *)(d[k] + stride + 1));
+				lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpacklo_epi16(b0, b1), bottom));
+				hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpackhi_epi16(b0, b1), bottom));
+				value = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, roundD), W_BITS), _mm_srai_epi32(_mm_add_epi32(hi, roundD), W_BITS));
+				_mm_storeu_si128((__m128i *)o[k], value);
+			}
+		}
+#else
+		for (; col < window_size; ++col) {
+			ri[col] = (int16_t)((p[col] * w.w00 + p[col + 1] * w.w01 + p[stride + col] * w.w10 +
+				p[stride + col + 1] * w.w11 + (1 << (I_SHIFT - 1))) >> I_SHIFT);
+			rdx[col] = (int16_t)((dx[col] * w.w00 + dx[col + 1] * w.w01 + dx[stride + col] * w.w10 +
+				dx[stride + col + 1] * w.w11 + (1 << (W_BITS - 1))) >> W_BITS);
+			rdy[col] = (int16_t)((dy[col] * w.w00 + dy[col + 1] * w.w01 + dy[stride + col] * w.w10 +
+				dy[stride + col + 1] * w.w11 + (1 << (W_BITS - 1))) >> W_BITS);
+		}
+#endif
+		for (col = window_size; col < padded_width; ++col) ri[col] = rdx[col] = rdy[col] = 0;
+	}
+}
+
+// Spatial gradient matrix of the window: sums of dx dx, dx dy, dy dy
+static void gradientMatrix(const int16_t *dx, const int16_t *dy, int count, float &a11, float &a12, float &a22) {
+	int i = 0;
+#if defined(TRACKER_SSE2)
+	__m128 s11 = _mm_setzero_ps(), s12 = _mm_setzero_ps(), s22 = _mm_setzero_ps();
+	for (; i < count; i += STEP) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(dx + i));
+		__m128i y = _mm_loadu_si128((const __m128i *)(dy + i));
+		s11 = _mm_add_ps(s11, _mm_cvtepi32_ps(_mm_madd_epi16(x, x)));
+		s12 = _mm_add_ps(s12, _mm_cvtepi32_ps(_mm_madd_epi16(x, y)));
+		s22 = _mm_add_ps(s22, _mm_cvtepi32_ps(_mm_madd_epi16(y, y)));
+	}
+	float sums[3][4];
+	_mm_storeu_ps(sums[0], s11);
+	_mm_storeu_ps(sums[1], s12);
+	_mm_storeu_ps(sums[2], s22);
+	a11 = sums[0][0] + sums[0][1] + sums[0][2] + sums[0][3];
+	a12 = sums[1][0] + sums[1][1] + sums[1][2] + sums[1][3];
+	a22 = sums[2][0] + sums[2][1] + sums[2][2] + sums[2][3];
+#else
+	a11 = a12 = a22 = 0.0f;
+	for (; i < count; ++i) {
+		a11 += (float)(dx[i] * dx[i]);
+		a12 += (float)(dx[i] * dy[i]);
+		a22 += (float)(dy[i] * dy[i]);
+	}
+#endif
+}
+
+// Mismatch vector of the window of the next image at (x, y) + weights
+// against the first image's window: sums of (J - I) dx and (J - I) dy
+static void mismatch(const ImagePyramid::Level &level, int x, int y, const BilinearWeights &w, int window_size,
+	int padded_width, const int16_t *window_i, const int16_t *window_dx, const int16_t *window_dy, float &b1, float &b2) {
+	int stride = level.stride;
+#if defined(TRACKER_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i top = _mm_set1_epi32((w.w01 << 16) | w.w00);
+	const __m128i bottom = _mm_set1_epi32((w.w11 << 16) | w.w10);
+	const __m128i roundI = _mm_set1_epi32(1 << (I_SHIFT - 1));
+	__m128 s1 = _mm_setzero_ps(), s2 = _mm_setzero_ps();
+#else
+	b1 = b2 = 0.0f;
+#endif
+	for (int row = 0; row < window_size; ++row) {
+		const uint8_t *p = &level.pixels[level.offset(x, y + row)];
+		const int16_t *ri = window_i + row * padded_width;
+		const int16_t *rdx = window_dx + row * padded_width;
+		const int16_t *rdy = window_dy + row * padded_width;
+#if defined(TRACKER_SSE2)
+		for (int col = 0; col < window_size; col += STEP) {
+			__m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + col)), zero);
+			__m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + col + 1)), zero);
+			__m128i c0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + stride + col)), zero);
+			__m128i c1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + stride + col + 1)), zero);
+			__m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpacklo_epi16(c0, c1), bottom));
+			__m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), top), _mm_madd_epi16(_mm_unpackhi_epi16(c0, c1), bottom));
+			__m128i j = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, roundI), I_SHIFT), _mm_srai_epi32(_mm_add_epi32(hi, roundI), I_SHIFT));
+			__m128i diff = _mm_sub_epi16(j, _mm_loadu_si128((const __m128i *)(ri + col)));
+			s1 = _mm_add_ps(s1, _mm_cvtepi32_ps(_mm_madd_epi16(diff, _mm_loadu_si128((const __m128i *)(rdx + col)))));
+			s2 = _mm_add_ps(s2, _mm_cvtepi32_ps(_mm_madd_epi16(diff, _mm_loadu_si128((const __m128i *)(rdy + col)))));
+		}
+#else
+		for (int col = 0; col < window_size; ++col) {
+			int j = (p[col] * w.w00 + p[col + 1] * w.w01 + p[stride + col] * w.w10 + p[stride + col + 1] * w.w11 +
+				(1 << (I_SHIFT - 1))) >> I_SHIFT;
+			int diff = j - ri[col];
+			b1 += (float)(diff * rdx[col]);
+			b2 += (float)(diff * rdy[col]);
+		}
+#endif
+	}
+#if defined(TRACKER_SSE2)
+	float sums[2][4];
+	_mm_storeu_ps(sums[0], s1);
+	_mm_storeu_ps(sums[1], s2);
+	b1 = sums[0][0] + sums[0][1] + sums[0][2] + sums[0][3];
+	b2 = sums[1][0] + sums[1][1] + sums[1][2] + sums[1][3];
+#endif
+}
+
+// Mean absolute difference of the windows, in grey levels
+static float matchError(const ImagePyramid::Level &level, int x, int y, const BilinearWeights &w, int window_size,
+	int padded_width, const int16_t *window_i) {
+	int stride = level.stride;
+	int sum = 0;
+	for (int row = 0; row < window_size; ++row) {
+		const uint8_t *p = &level.pixels[level.offset(x, y + row)];
+		const int16_t *ri = window_i + row * padded_width;
+		for (int col = 0; col < window_size; ++col) {
+			int j = (p[col] * w.w00 + p[col + 1] * w.w01 + p[stride + col] * w.w10 + p[stride + col + 1] * w.w11 +
+				(1 << (I_SHIFT - 1))) >> I_SHIFT;
+			sum += abs(j - ri[col]);
+		}
+	}
+	return sum / (32.0f * window_size * window_size);
+}
+
+LandmarkTracker::LandmarkTracker(int points_per_object, const ArTrackerParams &params)
+	: pointsPerObject(std::max(points_per_object, 1)), params(params) {
+	this->params.window_radius = std::min(std::max(params.window_radius, 1), 31);
+	this->params.levels = std::min(std::max(params.levels, 0), 8);
+	this->params.iterations = std::max(params.iterations, 1);
+	windowSize = 2 * this->params.window_radius + 1;
+	paddedWidth = (windowSize + STEP - 1) / STEP * STEP;
+	windowI.resize((size_t)windowSize * paddedWidth);
+	windowDx.resize(windowI.size());
+	windowDy.resize(windowI.size());
+}
+
+void LandmarkTracker::buildPyramid(ImagePyramid &pyramid, const uint8_t *image, int width, int height, int stride,
+	int channels) {
+	// Room for a window (and the column read past it) with its corner anywhere
+	// in the image
+	pyramid.build(image, width, height, stride, channels, params.levels, paddedWidth + 2);
+}
+
+bool LandmarkTracker::trackPoint(const ImagePyramid &from, const ImagePyramid &to, float x, float y,
+	float &next_x, float &next_y, float *match_error) {
+	int radius = params.window_radius;
+	int top = (int)std::min(from.levels.size(), to.levels.size()) - 1;
+	float area = (float)(windowSize * windowSize);
+	float epsilon2 = params.epsilon * params.epsilon;
+
+	// Window corners, at the scale of the current level
+	float scale = 1.0f / (1 << top);
+	float nextX = next_x * scale - radius;
+	float nextY = next_y * scale - radius;
+	for (int l = top; l >= 0; --l) {
+		const ImagePyramid::Level &first = from.levels[l];
+		const ImagePyramid::Level &second = to.levels[l];
+		scale = 1.0f / (1 << l);
+		if (l != top) {
+			nextX = (nextX + radius) * 2.0f - radius;
+			nextY = (nextY + radius) * 2.0f - radius;
+		}
+
+		float prevX = x * scale - radius;
+		float prevY = y * scale - radius;
+		int ix = (int)floorf(prevX), iy = (int)floorf(prevY);
+		if (!windowInside(first, ix, iy, paddedWidth, windowSize)) {
+			if (l == 0) return false;
+			continue;
+		}
+		sampleWindow(first, ix, iy, BilinearWeights(prevX - ix, prevY - iy), windowSize, paddedWidth,
+			windowI.data(), windowDx.data(), windowDy.data());
+
+		float a11, a12, a22;
+		gradientMatrix(windowDx.data(), windowDy.data(), windowSize * paddedWidth, a11, a12, a22);
+		// In (grey levels per pixel)^2, from the Scharr scale
+		a11 *= 1.0f / 1024.0f;
+		a12 *= 1.0f / 1024.0f;
+		a22 *= 1.0f / 1024.0f;
+		float det = a11 * a22 - a12 * a12;
+		float minEigenvalue = (a22 + a11 - sqrtf((a11 - a22) * (a11 - a22) + 4.0f * a12 * a12)) / (2.0f * area);
+		if (minEigenvalue < params.min_eigenvalue || det < FLT_EPSILON) {
+			if (l == 0) return false;
+			continue;
+		}
+		float invDet = 1.0f / det;
+
+		float prevDeltaX = 0.0f, prevDeltaY = 0.0f;
+		for (int iteration = 0; iteration < params.iterations; ++iteration) {
+			int jx = (int)floorf(nextX), jy = (int)floorf(nextY);
+			if (!windowInside(second, jx, jy, paddedWidth, windowSize)) {
+				if (l == 0) return false;
+				break;
+			}
+			float b1, b2;
+			mismatch(second, jx, jy, BilinearWeights(nextX - jx, nextY - jy), windowSize, paddedWidth,
+				windowI.data(), windowDx.data(), windowDy.data(), b1, b2);
+			b1 *= 1.0f / 1024.0f;
+			b2 *= 1.0f / 1024.0f;
+
+			float deltaX = (a12 * b2 - a22 * b1) * invDet;
+			float deltaY = (a12 * b1 - a11 * b2) * invDet;
+			nextX += deltaX;
+			nextY += deltaY;
+			if (deltaX * deltaX + deltaY * deltaY <= epsilon2) break;
+
+			// Oscillating between two positions: settle in the middle
+			if (iteration > 0 && fabsf(deltaX + prevDeltaX) < 0.01f && fabsf(deltaY + prevDeltaY) < 0.01f) {
+				nextX -= deltaX * 0.5f;
+				nextY -= deltaY * 0.5f;
+				break;
+			}
+			prevDeltaX = deltaX;
+			prevDeltaY = deltaY;
+		}
+
+		if (l == 0 && match_error) {
+			int jx = (int)floorf(nextX), jy = (int)floorf(nextY);
+			if (!windowInside(second, jx, jy, paddedWidth, windowSize)) return false;
+			*match_error = matchError(second, jx, jy, BilinearWeights(nextX - jx, nextY - jy), windowSize, paddedWidth,
+				windowI.data());
+		}
+	}
+
+	next_x = nextX + radius;
+	next_y = nextY + radius;
+	return true;
+}
+
+bool LandmarkTracker::setPoints(const uint8_t *image, int width, int height, int stride, int channels,
+	const float *points, int object_count) {
+	if (!image && !hasFrame) return false;
+	if (image) {
+		if (width <= 0 || height <= 0 || (channels != 1 && channels != 3 && channels != 4)) return false;
+		buildPyramid(pyramids[current], image, width, height, stride, channels);
+		hasFrame = true;
+	}
+	objects = (points && object_count > 0) ? object_count : 0;
+	positions.assign(points, points + (size_t)objects * pointsPerObject * 2);
+	framesTracked = 0;
+	return true;
+}
+
+bool LandmarkTracker::track(const uint8_t *image, int width, int height, int stride, int channels,
+	float *points, uint8_t *status, float *errors) {
+	if (!image || width <= 0 || height <= 0 || (channels != 1 && channels != 3 && channels != 4)) return false;
+
+	// A new frame size starts over
+	const ImagePyramid::Level *last = hasFrame ? &pyramids[current].levels[0] : nullptr;
+	bool sameSize = last && last->width == width && last->height == height;
+	if (!sameSize) objects = 0;
+
+	int previous = current;
+	current ^= 1;
+	buildPyramid(pyramids[current], image, width, height, stride, channels);
+	hasFrame = true;
+	if (objects == 0) return false;
+	++framesTracked;
+
+	// Forward into the new frame, then back again from where the point landed
+	int count = objects * pointsPerObject;
+	tracked.resize((size_t)count * 2);
+	lost.resize(count);
+	bool good = framesTracked < params.max_track_frames;
+	for (int object = 0; object < objects; ++object) {
+		int first = object * pointsPerObject;
+		displacement.clear();
+		for (int i = first; i < first + pointsPerObject; ++i) {
+			float x = positions[2 * i], y = positions[2 * i + 1];
+			float nextX = x, nextY = y, error = FLT_MAX;
+			float backX, backY;
+			bool ok = trackPoint(pyramids[previous], pyramids[current], x, y, nextX, nextY, &error);
+			float forwardBackward = FLT_MAX;
+			if (ok) {
+				backX = nextX;
+				backY = nextY;
+				if (trackPoint(pyramids[current], pyramids[previous], nextX, nextY, backX, backY, nullptr)) {
+					forwardBackward = sqrtf((backX - x) * (backX - x) + (backY - y) * (backY - y));
+				}
+			}
+			ok = ok && forwardBackward <= params.max_fb_error && error <= params.max_match_error;
+
+			tracked[2 * i] = ok ? nextX : x;
+			tracked[2 * i + 1] = ok ? nextY : y;
+			lost[i] = !ok;
+			if (ok) {
+				displacement.push_back(nextX - x);
+				displacement.push_back(nextY - y);
+			}
+			if (status) status[i] = ok ? 1 : 0;
+			if (errors) errors[i] = forwardBackward;
+		}
+
+		// Lost points follow the median motion of the object's tracked ones
+		int trackedCount = (int)displacement.size() / 2;
+		if (trackedCount < params.min_tracked_fraction * pointsPerObject) good = false;
+		if (trackedCount > 0 && trackedCount < pointsPerObject) {
+			float median[2];
+			for (int axis = 0; axis < 2; ++axis) {
+				std::vector<float> values;
+				for (int k = axis; k < (int)displacement.size(); k += 2) values.push_back(displacement[k]);
+				std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+				median[axis] = values[values.size() / 2];
+			}
+			for (int i = first; i < first + pointsPerObject; ++i) {
+				if (!lost[i]) continue;
+				tracked[2 * i] += median[0];
+				tracked[2 * i + 1] += median[1];
+			}
+		}
+	}
+
+	positions.swap(tracked);
+	if (points) memcpy(points, positions.data(), positions.size() * sizeof(float));
+	return good;
+}
+
+// ---------------------------------------------------------------------------
+// C interface
+
+void ar_tracker_default_params(ArTrackerParams *params) {
+	memset(params, 0, sizeof(*params));
+	params->window_radius = 7;
+	params->levels = 3;
+	params->iterations = 10;
+	params->epsilon = 0.03f;
+	params->min_eigenvalue = 0.1f;
+	params->max_fb_error = 1.0f;
+	params->max_match_error = 16.0f;
+	params->min_tracked_fraction = 0.7f;
+	params->max_track_frames = 5;
+}
+
+ArTracker *ar_tracker_create(int points_per_object, const ArTrackerParams *params) {
+	if (points_per_object <= 0 || !params) return nullptr;
+	return (ArTracker *)new LandmarkTracker(points_per_object, *params);
+}
+
+void ar_tracker_destroy(ArTracker *tracker) {
+	delete (LandmarkTracker *)tracker;
+}
+
+int ar_tracker_set_points(ArTracker *tracker, const unsigned char *image, int width, int height, int stride,
+	int channels, const float *points, int object_count) {
+	if (!tracker) return 0;
+	return ((LandmarkTracker *)tracker)->setPoints(image, width, height, stride, channels, points, object_count) ? 1 : 0;
+}
+
+int ar_tracker_track(ArTracker *tracker, const unsigned char *image, int width, int height, int stride, int channels,
+	float *points, unsigned char *status, float *errors) {
+	if (!tracker) return 0;
+	return ((LandmarkTracker *)tracker)->track(image, width, height, stride, channels, points, status, errors) ? 1 : 0;
+}
+
+int ar_tracker_object_count(ArTracker *tracker) {
+	return tracker ? ((LandmarkTracker *)tracker)->objectCount() : 0;
+}
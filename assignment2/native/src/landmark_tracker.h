@@ -0,0 +1,84 @@
+#ifndef _LANDMARK_TRACKER_H_
+#define _LANDMARK_TRACKER_H_
+
+#include <arnative.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+// Gray image pyramid for optical flow, with the Scharr derivatives of every
+// level (32 times the gradient per pixel). Levels have a replicated border
+// wide enough for a whole tracking window, so windows near or partly past
+// the edge of the image are read without checks.
+class ImagePyramid {
+public:
+	struct Level {
+		int width = 0, height = 0;
+		int border = 0;
+		int stride = 0;						// Pixels per row, borders included
+		std::vector<uint8_t> pixels;
+		std::vector<int16_t> dx, dy;
+
+		// Index of pixel (x, y), which may lie in the border
+		int offset(int x, int y) const { return (y + border) * stride + x + border; }
+	};
+
+	// Bottom level from an 8-bit image of 1, 3 or 4 channels
+	void build(const uint8_t *image, int width, int height, int stride, int channels, int level_count, int border);
+
+	std::vector<Level> levels;
+
+private:
+	void downsample(const Level &source, Level &destination);
+
+	std::vector<uint16_t> rowBuffer;
+};
+
+// Detect-then-track: the detector's landmarks are followed from frame to
+// frame with pyramidal Lucas-Kanade optical flow (Bouguet's formulation,
+// with OpenCV's fixed point windows) and checked by tracking them back.
+// Detection is asked for when too many points of an object fail, or after
+// max_track_frames frames.
+class LandmarkTracker {
+public:
+	LandmarkTracker(int points_per_object, const ArTrackerParams &params);
+
+	// image NULL: the frame of the last track() call
+	bool setPoints(const uint8_t *image, int width, int height, int stride, int channels,
+		const float *points, int object_count);
+
+	// Returns true while tracking is good enough to skip the detector
+	bool track(const uint8_t *image, int width, int height, int stride, int channels,
+		float *points, uint8_t *status, float *errors);
+
+	int objectCount() const { return objects; }
+
+private:
+	// Follow (x, y) of pyramid from into pyramid to, starting at (next_x,
+	// next_y). Returns false if the point is lost.
+	bool trackPoint(const ImagePyramid &from, const ImagePyramid &to, float x, float y,
+		float &next_x, float &next_y, float *match_error);
+
+	void buildPyramid(ImagePyramid &pyramid, const uint8_t *image, int width, int height, int stride, int channels);
+
+	int pointsPerObject;
+	ArTrackerParams params;
+	int windowSize;							// 2 radius + 1
+	int paddedWidth;						// windowSize rounded up to whole SIMD steps
+
+	ImagePyramid pyramids[2];
+	int current = 0;						// Pyramid of the newest frame
+	bool hasFrame = false;
+
+	int objects = 0;
+	int framesTracked = 0;
+	std::vector<float> positions;			// x, y per point, on the newest frame
+
+	// Window scratch of the point being tracked: I, dI/dx, dI/dy
+	std::vector<int16_t> windowI, windowDx, windowDy;
+	std::vector<float> tracked, displacement;
+	std::vector<uint8_t> lost;
+};
+
+#endif
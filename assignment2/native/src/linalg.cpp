@@ -0,0 +1,59 @@
+#include "linalg.h"
+
+void RotationFromVector(const double *rvec, double *rotation) {
+	double theta = sqrt(rvec[0] * rvec[0] + rvec[1] * rvec[1] + rvec[2] * rvec[2]);
+	double c, s, c1;
+	double k[3];
+	if (theta < 1e-12) {
+		// First order: I + [r]x
+		rotation[0] = 1.0;      rotation[1] = -rvec[2]; rotation[2] = rvec[1];
+		rotation[3] = rvec[2];  rotation[4] = 1.0;      rotation[5] = -rvec[0];
+		rotation[6] = -rvec[1]; rotation[7] = rvec[0];  rotation[8] = 1.0;
+		return;
+	}
+	c = cos(theta);
+	s = sin(theta);
+	c1 = 1.0 - c;
+	for (int i = 0; i < 3; ++i) k[i] = rvec[i] / theta;
+
+	rotation[0] = c + c1 * k[0] * k[0];
+	rotation[1] = c1 * k[0] * k[1] - s * k[2];
+	rotation[2] = c1 * k[0] * k[2] + s * k[1];
+	rotation[3] = c1 * k[1] * k[0] + s * k[2];
+	rotation[4] = c + c1 * k[1] * k[1];
+	rotation[5] = c1 * k[1] * k[2] - s * k[0];
+	rotation[6] = c1 * k[2] * k[0] - s * k[1];
+	rotation[7] = c1 * k[2] * k[1] + s * k[0];
+	rotation[8] = c + c1 * k[2] * k[2];
+}
+
+void VectorFromRotation(const double *rotation, double *rvec) {
+	double trace = rotation[0] + rotation[4] + rotation[8];
+	double cosTheta = (trace - 1.0) * 0.5;
+	if (cosTheta > 1.0) cosTheta = 1.0;
+	if (cosTheta < -1.0) cosTheta = -1.0;
+	double theta = acos(cosTheta);
+
+	double axis[3] = {
+		rotation[7] - rotation[5],
+		rotation[2] - rotation[6],
+		rotation[3] - rotation[1],
+	};
+	double sinTheta2 = sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);	// 2 sin(theta)
+
+	if (sinTheta2 > 1e-6) {
+		for (int i = 0; i < 3; ++i) rvec[i] = axis[i] / sinTheta2 * theta;
+	} else if (cosTheta > 0.0) {
+		// Near identity: the antisymmetric part is the rotation vector
+		for (int i = 0; i < 3; ++i) rvec[i] = axis[i] * 0.5;
+	} else {
+		// Near a half turn: the axis is the largest column of R + I
+		int k = 0;
+		if (rotation[4] > rotation[k * 4]) k = 1;
+		if (rotation[8] > rotation[k * 4]) k = 2;
+		double column[3];
+		for (int i = 0; i < 3; ++i) column[i] = rotation[i * 3 + k] + (i == k ? 1.0 : 0.0);
+		double length = sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+		for (int i = 0; i < 3; ++i) rvec[i] = column[i] / length * theta;
+	}
+}
@@ -0,0 +1,130 @@
+#ifndef _LINALG_H_
+#define _LINALG_H_
+
+#include <math.h>
+
+// Small dense linear algebra on fixed-size row-major double arrays. The
+// sizes are template parameters so every loop has a constant trip count.
+
+// Eigen decomposition of a symmetric n x n matrix by cyclic Jacobi
+// rotations. a is destroyed. On return values[i] is the i-th eigenvalue in
+// descending order and row i of vectors its unit eigenvector.
+template <int n>
+void SymmetricEigen(double *a, double *values, double *vectors) {
+	double v[n * n];
+	for (int i = 0; i < n * n; ++i) v[i] = 0.0;
+	for (int i = 0; i < n; ++i) v[i * n + i] = 1.0;
+
+	for (int sweep = 0; sweep < 50; ++sweep) {
+		double off = 0.0;
+		for (int p = 0; p < n; ++p) {
+			for (int q = p + 1; q < n; ++q) off += a[p * n + q] * a[p * n + q];
+		}
+		if (off < 1e-30) break;
+
+		for (int p = 0; p < n; ++p) {
+			for (int q = p + 1; q < n; ++q) {
+				double apq = a[p * n + q];
+				if (fabs(apq) < 1e-300) continue;
+				double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+				double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+				double c = 1.0 / sqrt(t * t + 1.0);
+				double s = t * c;
+				for (int k = 0; k < n; ++k) {
+					double akp = a[k * n + p];
+					double akq = a[k * n + q];
+					a[k * n + p] = c * akp - s * akq;
+					a[k * n + q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < n; ++k) {
+					double apk = a[p * n + k];
+					double aqk = a[q * n + k];
+					a[p * n + k] = c * apk - s * aqk;
+					a[q * n + k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < n; ++k) {
+					double vkp = v[k * n + p];
+					double vkq = v[k * n + q];
+					v[k * n + p] = c * vkp - s * vkq;
+					v[k * n + q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	// Selection sort by eigenvalue, descending; eigenvectors are the columns of v
+	int order[n];
+	for (int i = 0; i < n; ++i) order[i] = i;
+	for (int i = 0; i < n; ++i) {
+		int best = i;
+		for (int j = i + 1; j < n; ++j) {
+			if (a[order[j] * n + order[j]] > a[order[best] * n + order[best]]) best = j;
+		}
+		int swap = order[i];
+		order[i] = order[best];
+		order[best] = swap;
+	}
+	for (int i = 0; i < n; ++i) {
+		values[i] = a[order[i] * n + order[i]];
+		for (int k = 0; k < n; ++k) vectors[i * n + k] = v[k * n + order[i]];
+	}
+}
+
+// Solve a x = b by Gaussian elimination with partial pivoting. a and b are
+// destroyed. Returns false if a is singular.
+template <int n>
+bool SolveLinear(double *a, double *b, double *x) {
+	for (int col = 0; col < n; ++col) {
+		int pivot = col;
+		for (int r = col + 1; r < n; ++r) {
+			if (fabs(a[r * n + col]) > fabs(a[pivot * n + col])) pivot = r;
+		}
+		if (fabs(a[pivot * n + col]) < 1e-300) return false;
+		if (pivot != col) {
+			for (int k = 0; k < n; ++k) {
+				double swap = a[col * n + k];
+				a[col * n + k] = a[pivot * n + k];
+				a[pivot * n + k] = swap;
+			}
+			double swap = b[col];
+			b[col] = b[pivot];
+			b[pivot] = swap;
+		}
+		for (int r = col + 1; r < n; ++r) {
+			double f = a[r * n + col] / a[col * n + col];
+			for (int k = col; k < n; ++k) a[r * n + k] -= f * a[col * n + k];
+			b[r] -= f * b[col];
+		}
+	}
+	for (int r = n - 1; r >= 0; --r) {
+		double sum = b[r];
+		for (int k = r + 1; k < n; ++k) sum -= a[r * n + k] * x[k];
+		x[r] = sum / a[r * n + r];
+	}
+	return true;
+}
+
+// Least squares solution of the overdetermined m x n system a x = b,
+// through the normal equations
+template <int m, int n>
+bool SolveLeastSquares(const double *a, const double *b, double *x) {
+	double ata[n * n];
+	double atb[n];
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			double sum = 0.0;
+			for (int r = 0; r < m; ++r) sum += a[r * n + i] * a[r * n + j];
+			ata[i * n + j] = sum;
+		}
+		double sum = 0.0;
+		for (int r = 0; r < m; ++r) sum += a[r * n + i] * b[r];
+		atb[i] = sum;
+	}
+	return SolveLinear<n>(ata, atb, x);
+}
+
+// Rotation matrix (row major) from a rotation vector, and back
+void RotationFromVector(const double *rvec, double *rotation);
+void VectorFromRotation(const double *rotation, double *rvec);
+
+#endif
@@ -0,0 +1,231 @@
+#include "overlay.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+// Lines take the landmark as the vertex. Markers are instanced: the vertex
+// is a marker mesh vertex and the landmark comes per instance.
+static const char *OVERLAY_VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 instancePosition;
+uniform mat4 Transform;
+uniform bool Markers;
+uniform bool ScreenSpace;
+uniform float MarkerSize;
+uniform vec2 ViewportSize;
+void main() {
+	if (!Markers) {
+		gl_Position = Transform * vec4(vertexPosition, 1.0);
+	} else if (ScreenSpace) {
+		vec4 center = Transform * vec4(instancePosition, 1.0);
+		center.xy += vertexPosition.xy * MarkerSize * 2.0 / ViewportSize * center.w;
+		gl_Position = center;
+	} else {
+		gl_Position = Transform * vec4(instancePosition + vertexPosition * MarkerSize, 1.0);
+	}
+}
+)";
+
+static const char *OVERLAY_FRAGMENT_SHADER = R"(#version 330 core
+out vec4 color;
+uniform vec4 Color;
+void main() {
+	color = Color;
+}
+)";
+
+static const float OCTAHEDRON_VERTICES[] = {
+	0.5f, 0, 0, -0.5f, 0, 0,
+	0, 0.5f, 0, 0, -0.5f, 0,
+	0, 0, 0.5f, 0, 0, -0.5f,
+};
+
+static const uint32_t OCTAHEDRON_INDICES[] = {
+	0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4,
+	2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5,
+};
+
+bool OverlayRenderer::initialize(const GLFunctions *gl, int points_per_object, int max_objects, const int *edges, int edge_count) {
+	if (!gl || points_per_object <= 0 || max_objects <= 0 || edge_count < 0 || (edge_count > 0 && !edges)) return false;
+	for (int e = 0; e < edge_count * 2; ++e) {
+		if (edges[e] < 0 || edges[e] >= points_per_object) {
+			fprintf(stderr, "arnative: overlay edge %d references point %d of %d\n", e / 2, edges[e], points_per_object);
+			return false;
+		}
+	}
+	this->gl = gl;
+	pointsPerObject = points_per_object;
+	maxObjects = max_objects;
+	edgeCount = edge_count;
+
+	program = BuildProgram(gl, OVERLAY_VERTEX_SHADER, OVERLAY_FRAGMENT_SHADER, "overlay");
+	if (!program) {
+		cleanup();
+		return false;
+	}
+	transformLocation = gl->GetUniformLocation(program, "Transform");
+	markersLocation = gl->GetUniformLocation(program, "Markers");
+	screenSpaceLocation = gl->GetUniformLocation(program, "ScreenSpace");
+	markerSizeLocation = gl->GetUniformLocation(program, "MarkerSize");
+	viewportLocation = gl->GetUniformLocation(program, "ViewportSize");
+	colorLocation = gl->GetUniformLocation(program, "Color");
+
+	GLint previousArrayBuffer = 0, previousVertexArray = 0;
+	gl->GetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+	gl->GetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+
+	gl->GenBuffers(1, &pointBuffer);
+	gl->BindBuffer(GL_ARRAY_BUFFER, pointBuffer);
+	gl->BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)points_per_object * max_objects * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+
+	// The connectivity of one object repeated for every object slot, so any
+	// number of objects is a prefix of the index buffer
+	gl->GenVertexArrays(1, &lineArray);
+	gl->BindVertexArray(lineArray);
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+	if (edge_count > 0) {
+		std::vector<uint32_t> indices((size_t)edge_count * 2 * max_objects);
+		for (int o = 0; o < max_objects; ++o) {
+			for (int e = 0; e < edge_count * 2; ++e) {
+				indices[(size_t)o * edge_count * 2 + e] = (uint32_t)(o * points_per_object + edges[e]);
+			}
+		}
+		gl->GenBuffers(1, &edgeBuffer);
+		gl->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, edgeBuffer);
+		gl->BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
+	}
+
+	gl->GenVertexArrays(1, &markerArray);
+	gl->BindVertexArray(markerArray);
+	gl->GenBuffers(1, &markerVertexBuffer);
+	gl->GenBuffers(1, &markerIndexBuffer);
+	gl->BindBuffer(GL_ARRAY_BUFFER, markerVertexBuffer);
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+	gl->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, markerIndexBuffer);
+	gl->BindBuffer(GL_ARRAY_BUFFER, pointBuffer);
+	gl->EnableVertexAttribArray(1);
+	gl->VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+	gl->VertexAttribDivisor(1, 1);
+
+	gl->BindVertexArray(previousVertexArray);
+	gl->BindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+
+	return setMarkerMesh(OCTAHEDRON_VERTICES, 6, OCTAHEDRON_INDICES, 24);
+}
+
+void OverlayRenderer::cleanup() {
+	if (!gl) return;
+	GLuint buffers[] = { pointBuffer, edgeBuffer, markerVertexBuffer, markerIndexBuffer };
+	GLuint arrays[] = { lineArray, markerArray };
+	for (GLuint buffer : buffers) {
+		if (buffer) gl->DeleteBuffers(1, &buffer);
+	}
+	for (GLuint array : arrays) {
+		if (array) gl->DeleteVertexArrays(1, &array);
+	}
+	if (program) gl->DeleteProgram(program);
+	pointBuffer = edgeBuffer = markerVertexBuffer = markerIndexBuffer = 0;
+	lineArray = markerArray = 0;
+	program = 0;
+	gl = nullptr;
+}
+
+bool OverlayRenderer::setMarkerMesh(const float *vertices, int vertex_count, const uint32_t *indices, int index_count) {
+	if (!gl || !vertices || !indices || vertex_count <= 0 || index_count <= 0) return false;
+	for (int i = 0; i < index_count; ++i) {
+		if (indices[i] >= (uint32_t)vertex_count) return false;
+	}
+
+	GLint previousArrayBuffer = 0, previousVertexArray = 0;
+	gl->GetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+	gl->GetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+
+	gl->BindVertexArray(markerArray);
+	gl->BindBuffer(GL_ARRAY_BUFFER, markerVertexBuffer);
+	gl->BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertex_count * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
+	gl->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, markerIndexBuffer);
+	gl->BufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)index_count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+	markerIndexCount = index_count;
+
+	gl->BindVertexArray(previousVertexArray);
+	gl->BindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+	return true;
+}
+
+void OverlayRenderer::draw(const float *points, int object_count, const float *transform, float marker_size, bool screen_space,
+	const float *marker_color, const float *line_color) {
+	object_count = std::min(object_count, maxObjects);
+	if (!gl || !points || !transform || object_count <= 0) return;
+	int pointCount = object_count * pointsPerObject;
+
+	GLint previousProgram = 0, previousVertexArray = 0, previousArrayBuffer = 0;
+	GLint viewport[4] = { 0, 0, 1, 1 };
+	gl->GetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	gl->GetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	gl->GetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+	gl->GetIntegerv(GL_VIEWPORT, viewport);
+
+	// Orphan the buffer so the upload does not wait for the last frame's draws
+	gl->BindBuffer(GL_ARRAY_BUFFER, pointBuffer);
+	gl->BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)pointsPerObject * maxObjects * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+	gl->BufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)pointCount * 3 * sizeof(float), points);
+
+	gl->UseProgram(program);
+	gl->UniformMatrix4fv(transformLocation, 1, GL_FALSE, transform);
+
+	if (line_color && edgeCount > 0) {
+		gl->Uniform1i(markersLocation, 0);
+		gl->Uniform4fv(colorLocation, 1, line_color);
+		gl->BindVertexArray(lineArray);
+		gl->DrawElements(GL_LINES, object_count * edgeCount * 2, GL_UNSIGNED_INT, nullptr);
+		++drawCalls;
+	}
+	if (marker_color) {
+		gl->Uniform1i(markersLocation, 1);
+		gl->Uniform1i(screenSpaceLocation, screen_space ? 1 : 0);
+		gl->Uniform1f(markerSizeLocation, marker_size);
+		gl->Uniform2f(viewportLocation, (float)std::max(viewport[2], 1), (float)std::max(viewport[3], 1));
+		gl->Uniform4fv(colorLocation, 1, marker_color);
+		gl->BindVertexArray(markerArray);
+		gl->DrawElementsInstanced(GL_TRIANGLES, markerIndexCount, GL_UNSIGNED_INT, nullptr, pointCount);
+		++drawCalls;
+	}
+
+	gl->BindVertexArray(previousVertexArray);
+	gl->BindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+	gl->UseProgram(previousProgram);
+}
+
+// C interface
+
+ArOverlay *ar_overlay_create(int points_per_object, int max_objects, const int *edges, int edge_count) {
+	OverlayRenderer *overlay = new OverlayRenderer();
+	if (!overlay->initialize(LoadGLFunctions(), points_per_object, max_objects, edges, edge_count)) {
+		delete overlay;
+		return nullptr;
+	}
+	return (ArOverlay *)overlay;
+}
+
+void ar_overlay_destroy(ArOverlay *overlay) {
+	if (!overlay) return;
+	((OverlayRenderer *)overlay)->cleanup();
+	delete (OverlayRenderer *)overlay;
+}
+
+int ar_overlay_set_marker_mesh(ArOverlay *overlay, const float *vertices, int vertex_count,
+	const unsigned int *indices, int index_count) {
+	if (!overlay) return 0;
+	return ((OverlayRenderer *)overlay)->setMarkerMesh(vertices, vertex_count, indices, index_count) ? 1 : 0;
+}
+
+void ar_overlay_draw(ArOverlay *overlay, const float *points, int object_count, const float *transform,
+	float marker_size, int screen_space, const float *marker_color, const float *line_color) {
+	if (overlay) {
+		((OverlayRenderer *)overlay)->draw(points, object_count, transform, marker_size, screen_space != 0,
+			marker_color, line_color);
+	}
+}
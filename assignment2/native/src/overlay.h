@@ -0,0 +1,58 @@
+#ifndef _OVERLAY_H_
+#define _OVERLAY_H_
+
+#include <arnative.h>
+
+#include "gl_loader.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+// Landmark overlays on the GPU: the landmarks of all objects (hands, faces)
+// of a frame are streamed into one vertex buffer, the connections of all of
+// them are one indexed line draw from a static index buffer, and a marker
+// at every landmark is one instanced draw. Every method needs the GL
+// context of initialize() to be current.
+class OverlayRenderer {
+public:
+	bool initialize(const GLFunctions *gl, int points_per_object, int max_objects, const int *edges, int edge_count);
+	void cleanup();
+
+	// Marker geometry in marker units (the marker size scales it); an
+	// octahedron of diameter 1 by default
+	bool setMarkerMesh(const float *vertices, int vertex_count, const uint32_t *indices, int index_count);
+
+	// points: object_count x points_per_object x 3, transformed to clip space
+	// by the column major transform. In screen space the marker size is in
+	// pixels and markers face the viewer, otherwise it is in point units.
+	// A null color skips the markers or the lines.
+	void draw(const float *points, int object_count, const float *transform, float marker_size, bool screen_space,
+		const float *marker_color, const float *line_color);
+
+	int pointsPerObject = 0;
+	int maxObjects = 0;
+	uint64_t drawCalls = 0;
+
+private:
+	const GLFunctions *gl = nullptr;
+	GLuint program = 0;
+	GLint transformLocation = -1;
+	GLint markersLocation = -1;
+	GLint screenSpaceLocation = -1;
+	GLint markerSizeLocation = -1;
+	GLint viewportLocation = -1;
+	GLint colorLocation = -1;
+
+	GLuint pointBuffer = 0;		// Streamed landmarks, all objects
+	GLuint edgeBuffer = 0;		// Connections of all objects, static
+	GLuint lineArray = 0;
+	int edgeCount = 0;
+
+	GLuint markerVertexBuffer = 0;
+	GLuint markerIndexBuffer = 0;
+	GLuint markerArray = 0;
+	int markerIndexCount = 0;
+};
+
+#endif
@@ -0,0 +1,436 @@
+#include "pipeline.h"
+#include "clock.h"
+#include "pnp.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+static const char *STAGE_NAMES[PipelineStageCount] = { "capture", "inference", "pose", "render" };
+
+// Latency samples kept per stage for the percentiles
+static const size_t LATENCY_SAMPLES = 1024;
+
+// Idle stages spin briefly for low latency, then sleep to leave the cores
+// to the busy ones
+static void idleWait(int &idle) {
+	if (++idle < 64) std::this_thread::yield();
+	else std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+void StageCounters::record(uint64_t busy_ns, uint64_t latency_ns) {
+	processed.fetch_add(1, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(mutex);
+	busyNs += (double)busy_ns;
+	if (latencyMs.size() < LATENCY_SAMPLES) latencyMs.push_back((float)(latency_ns / 1e6));
+	else latencyMs[latencyCount % LATENCY_SAMPLES] = (float)(latency_ns / 1e6);
+	++latencyCount;
+}
+
+Pipeline::Pipeline(const ArPipelineConfig &config) :
+	config(config),
+	captured(config.queue_capacity),
+	inferred(config.queue_capacity),
+	posed(config.queue_capacity) {
+	if (config.video_path) videoPath = config.video_path;
+	if (config.inference_command) inferenceCommand = config.inference_command;
+	this->config.video_path = nullptr;
+	this->config.inference_command = nullptr;
+
+	// Every queue full, one frame in each stage and one held by the consumer
+	size_t frameCount = captured.capacity() * 3 + PipelineStageCount + 1;
+	for (size_t i = 0; i < frameCount; ++i) pool.emplace_back(new PipelineFrame());
+}
+
+Pipeline::~Pipeline() {
+	stop();
+}
+
+bool Pipeline::start() {
+	if (running) return true;
+
+	if (config.source == AR_SOURCE_SYNTHETIC) {
+		if (config.width <= 0 || config.height <= 0) return false;
+	} else if (config.source == AR_SOURCE_Y4M) {
+		Y4mSource *video = new Y4mSource();
+		source.reset(video);
+		if (!video->open(videoPath.c_str(), config.loop != 0)) return false;
+		config.width = video->width;
+		config.height = video->height;
+	} else if (config.source != AR_SOURCE_EXTERNAL || config.width <= 0 || config.height <= 0) {
+		return false;
+	}
+
+	bool defaultCamera = true;
+	for (int i = 0; i < 9; ++i) defaultCamera = defaultCamera && config.camera_matrix[i] == 0.0;
+	if (defaultCamera) {
+		// Same guess as get_camera_matrix() in prediction.py
+		double camera[9] = { (double)config.width, 0, config.width / 2.0, 0, (double)config.width, config.height / 2.0, 0, 0, 1 };
+		memcpy(config.camera_matrix, camera, sizeof(camera));
+	}
+	if (config.source == AR_SOURCE_SYNTHETIC) {
+		source.reset(new SyntheticSource(config.width, config.height, config.camera_matrix));
+		if (config.source_fps > 0) source->fps = config.source_fps;
+	}
+
+	if (!config.inference && !inferenceCommand.empty() && !inferenceProcess.open(inferenceCommand.c_str())) return false;
+	inferenceFailed = false;
+
+	for (size_t i = 0; i < pool.size(); ++i) {
+		pool[i]->width = config.width;
+		pool[i]->height = config.height;
+		pool[i]->stride = config.width * 3;
+		pool[i]->pixels.resize((size_t)pool[i]->stride * config.height);
+	}
+
+	startTime = MonotonicTimeNs();
+	running = true;
+	if (config.source != AR_SOURCE_EXTERNAL) threads.emplace_back(&Pipeline::captureLoop, this);
+	threads.emplace_back(&Pipeline::inferenceLoop, this);
+	threads.emplace_back(&Pipeline::poseLoop, this);
+	if (config.render) threads.emplace_back(&Pipeline::renderLoop, this);
+	return true;
+}
+
+void Pipeline::stop() {
+	running = false;
+	// The inference thread may be blocked on a process that does not answer
+	if (!threads.empty()) inferenceProcess.kill();
+	for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+	threads.clear();
+	inferenceProcess.close();
+
+	// The stages are gone: drop what they left queued, so that a restart
+	// does not deliver frames of the previous run
+	SpscQueue<PipelineFrame *> *queues[] = { &captured, &inferred, &posed };
+	for (SpscQueue<PipelineFrame *> *queue : queues) {
+		PipelineFrame *frame;
+		while (queue->pop(frame)) releaseFrame(frame);
+	}
+}
+
+PipelineFrame *Pipeline::allocateFrame() {
+	for (size_t i = 0; i < pool.size(); ++i) {
+		bool expected = false;
+		if (pool[i]->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) return pool[i].get();
+	}
+	return nullptr;
+}
+
+void Pipeline::releaseFrame(PipelineFrame *frame) {
+	frame->inUse.store(false, std::memory_order_release);
+}
+
+bool Pipeline::popLatest(SpscQueue<PipelineFrame *> &queue, PipelineFrame *&frame, PipelineStage stage) {
+	if (!queue.pop(frame)) return false;
+	PipelineFrame *newer;
+	while (queue.pop(newer)) {
+		releaseFrame(frame);
+		counters[stage].dropped.fetch_add(1, std::memory_order_relaxed);
+		frame = newer;
+	}
+	return true;
+}
+
+void Pipeline::forward(SpscQueue<PipelineFrame *> &queue, PipelineFrame *frame, PipelineStage stage) {
+	if (!queue.push(frame)) {
+		releaseFrame(frame);
+		counters[stage].dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool Pipeline::pushFrame(const uint8_t *bgr, int width, int height, int stride) {
+	if (!running || config.source != AR_SOURCE_EXTERNAL) return false;
+	// The rows are copied at the configured size
+	if (width != config.width || height != config.height || stride < width * 3) return false;
+
+	uint64_t begin = MonotonicTimeNs();
+	PipelineFrame *frame = allocateFrame();
+	if (!frame) {
+		counters[CaptureStage].dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	frame->sequence = nextSequence++;
+	frame->captureTime = begin;
+	frame->truthHands = 0;
+	for (int y = 0; y < frame->height; ++y) {
+		memcpy(&frame->pixels[(size_t)y * frame->stride], bgr + (size_t)y * stride, frame->width * 3);
+	}
+	counters[CaptureStage].record(MonotonicTimeNs() - begin, 0);
+
+	if (!captured.push(frame)) {
+		releaseFrame(frame);
+		counters[CaptureStage].dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void Pipeline::captureLoop() {
+	uint64_t frameInterval = config.source_fps > 0 ? (uint64_t)(1e9 / config.source_fps) : 0;
+	uint64_t nextCapture = MonotonicTimeNs();
+	int idle = 0;
+
+	while (running) {
+		if (frameInterval) {
+			uint64_t now = MonotonicTimeNs();
+			if (now < nextCapture) {
+				std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(nextCapture - now, 1000000)));
+				continue;
+			}
+			nextCapture += frameInterval;
+			// Do not try to catch up after a stall
+			if (nextCapture < now) nextCapture = now + frameInterval;
+		}
+
+		PipelineFrame *frame = allocateFrame();
+		if (!frame) {
+			counters[CaptureStage].dropped.fetch_add(1, std::memory_order_relaxed);
+			idleWait(idle);
+			continue;
+		}
+		idle = 0;
+
+		uint64_t begin = MonotonicTimeNs();
+		frame->captureTime = begin;
+		frame->sequence = nextSequence++;
+		if (!source->read(&frame->pixels[0], frame->stride, frame->truthModel, frame->truthImage, AR_MAX_HANDS, frame->truthHands)) {
+			releaseFrame(frame);
+			break;
+		}
+		counters[CaptureStage].record(MonotonicTimeNs() - begin, MonotonicTimeNs() - begin);
+		forward(captured, frame, CaptureStage);
+	}
+}
+
+void Pipeline::infer(PipelineFrame &frame) {
+	if (config.inference) {
+		int hands = config.inference(config.inference_user, &frame.pixels[0], frame.width, frame.height, frame.stride,
+			frame.model, frame.image, AR_MAX_HANDS);
+		frame.handCount = std::min(std::max(hands, 0), AR_MAX_HANDS);
+	} else if (inferenceProcess.isOpen() && !inferenceFailed) {
+		int32_t header[2] = { frame.width, frame.height };
+		int32_t hands = 0;
+		bool ok = inferenceProcess.write(header, sizeof(header)) &&
+			inferenceProcess.write(&frame.pixels[0], frame.pixels.size()) &&
+			inferenceProcess.read(&hands, sizeof(hands)) &&
+			hands >= 0 && hands <= AR_MAX_HANDS &&
+			inferenceProcess.read(frame.model, hands * HAND_LANDMARKS * 3 * sizeof(float)) &&
+			inferenceProcess.read(frame.image, hands * HAND_LANDMARKS * 2 * sizeof(float));
+		frame.handCount = ok ? hands : 0;
+		if (!ok) inferenceFailed = true;
+	} else {
+		// Stand-in for a detector: the source's own landmarks, late
+		if (config.synthetic_inference_ms > 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(config.synthetic_inference_ms * 1000)));
+		}
+		frame.handCount = frame.truthHands;
+		memcpy(frame.model, frame.truthModel, frame.truthHands * HAND_LANDMARKS * 3 * sizeof(float));
+		memcpy(frame.image, frame.truthImage, frame.truthHands * HAND_LANDMARKS * 2 * sizeof(float));
+	}
+}
+
+void Pipeline::inferenceLoop() {
+	int idle = 0;
+	while (running) {
+		PipelineFrame *frame;
+		if (!popLatest(captured, frame, InferenceStage)) {
+			idleWait(idle);
+			continue;
+		}
+		idle = 0;
+
+		uint64_t begin = MonotonicTimeNs();
+		infer(*frame);
+		uint64_t end = MonotonicTimeNs();
+		counters[InferenceStage].record(end - begin, end - frame->captureTime);
+		forward(inferred, frame, InferenceStage);
+	}
+}
+
+void Pipeline::solvePoses(PipelineFrame &frame) {
+	static thread_local PnPSolver<HAND_LANDMARKS> solver;
+	PnPCamera camera = { config.camera_matrix[0], config.camera_matrix[4], config.camera_matrix[2], config.camera_matrix[5] };
+
+	for (int h = 0; h < frame.handCount; ++h) {
+		const float *model = frame.model + h * HAND_LANDMARKS * 3;
+		PnPResult result;
+		if (!solver.solve(model, frame.image + h * HAND_LANDMARKS * 2, HAND_LANDMARKS, camera, result,
+			frame.reprojected + h * HAND_LANDMARKS * 2)) {
+			memset(frame.rvecs + h * 3, 0, 3 * sizeof(double));
+			memset(frame.tvecs + h * 3, 0, 3 * sizeof(double));
+			memset(frame.world + h * HAND_LANDMARKS * 3, 0, HAND_LANDMARKS * 3 * sizeof(float));
+			frame.errors[h] = -1.0;
+			continue;
+		}
+
+		VectorFromRotation(result.rotation, frame.rvecs + h * 3);
+		memcpy(frame.tvecs + h * 3, result.translation, 3 * sizeof(double));
+		float *world = frame.world + h * HAND_LANDMARKS * 3;
+		for (int i = 0; i < HAND_LANDMARKS; ++i) {
+			const float *p = model + i * 3;
+			for (int k = 0; k < 3; ++k) {
+				world[i * 3 + k] = (float)(result.rotation[k * 3] * p[0] + result.rotation[k * 3 + 1] * p[1] +
+					result.rotation[k * 3 + 2] * p[2] + result.translation[k]);
+			}
+		}
+		frame.errors[h] = result.error;
+	}
+}
+
+void Pipeline::poseLoop() {
+	int idle = 0;
+	while (running) {
+		PipelineFrame *frame;
+		if (!popLatest(inferred, frame, PoseStage)) {
+			idleWait(idle);
+			continue;
+		}
+		idle = 0;
+
+		uint64_t begin = MonotonicTimeNs();
+		solvePoses(*frame);
+		uint64_t end = MonotonicTimeNs();
+		counters[PoseStage].record(end - begin, end - frame->captureTime);
+		forward(posed, frame, PoseStage);
+	}
+}
+
+void Pipeline::renderLoop() {
+	int idle = 0;
+	while (running) {
+		PipelineFrame *frame;
+		if (!popLatest(posed, frame, RenderStage)) {
+			idleWait(idle);
+			continue;
+		}
+		idle = 0;
+
+		ArFrame view;
+		fillView(*frame, view);
+		uint64_t begin = MonotonicTimeNs();
+		config.render(config.render_user, &view);
+		uint64_t end = MonotonicTimeNs();
+		counters[RenderStage].record(end - begin, end - frame->captureTime);
+		releaseFrame(frame);
+	}
+}
+
+void Pipeline::fillView(const PipelineFrame &frame, ArFrame &view) {
+	view.sequence = frame.sequence;
+	view.capture_time_ns = frame.captureTime;
+	view.width = frame.width;
+	view.height = frame.height;
+	view.stride = frame.stride;
+	view.pixels = &frame.pixels[0];
+	view.hand_count = frame.handCount;
+	view.model_points = frame.model;
+	view.image_points = frame.image;
+	view.rvecs = frame.rvecs;
+	view.tvecs = frame.tvecs;
+	view.world_points = frame.world;
+	view.reprojected = frame.reprojected;
+	view.errors = frame.errors;
+}
+
+bool Pipeline::acquire(ArFrame &view, int timeout_ms) {
+	if (config.render) return false;
+
+	uint64_t deadline = MonotonicTimeNs() + (uint64_t)std::max(timeout_ms, 0) * 1000000;
+	PipelineFrame *frame;
+	int idle = 0;
+	while (!popLatest(posed, frame, RenderStage)) {
+		if (!running || MonotonicTimeNs() >= deadline) return false;
+		idleWait(idle);
+	}
+	fillView(*frame, view);
+	return true;
+}
+
+void Pipeline::release(const ArFrame &view) {
+	for (size_t i = 0; i < pool.size(); ++i) {
+		PipelineFrame *frame = pool[i].get();
+		if (frame->inUse && frame->sequence.load(std::memory_order_relaxed) == view.sequence && &frame->pixels[0] == view.pixels) {
+			// Rendering ends when the consumer gives the frame back
+			uint64_t end = MonotonicTimeNs();
+			counters[RenderStage].record(0, end - frame->captureTime);
+			releaseFrame(frame);
+			return;
+		}
+	}
+}
+
+int Pipeline::stats(ArStageStats *stats, int max_stages) {
+	double elapsed = (MonotonicTimeNs() - startTime) / 1e9;
+	int count = std::min(max_stages, (int)PipelineStageCount);
+	for (int s = 0; s < count; ++s) {
+		StageCounters &counter = counters[s];
+		ArStageStats &out = stats[s];
+		memset(&out, 0, sizeof(out));
+		strncpy(out.name, STAGE_NAMES[s], sizeof(out.name) - 1);
+		out.processed = counter.processed.load(std::memory_order_relaxed);
+		out.dropped = counter.dropped.load(std::memory_order_relaxed);
+		out.fps = elapsed > 0 ? out.processed / elapsed : 0.0;
+
+		std::vector<float> samples;
+		{
+			std::lock_guard<std::mutex> lock(counter.mutex);
+			out.busy_ms = out.processed ? counter.busyNs / 1e6 / out.processed : 0.0;
+			samples = counter.latencyMs;
+		}
+		if (samples.empty()) continue;
+		std::sort(samples.begin(), samples.end());
+		out.latency_p50_ms = samples[(samples.size() - 1) * 50 / 100];
+		out.latency_p90_ms = samples[(samples.size() - 1) * 90 / 100];
+		out.latency_p99_ms = samples[(samples.size() - 1) * 99 / 100];
+	}
+	return count;
+}
+
+// C interface
+
+void ar_pipeline_default_config(ArPipelineConfig *config) {
+	memset(config, 0, sizeof(*config));
+	config->source = AR_SOURCE_SYNTHETIC;
+	config->loop = 1;
+	config->width = 1280;
+	config->height = 720;
+	config->source_fps = 30.0;
+	config->queue_capacity = 2;
+	config->synthetic_inference_ms = 20.0;
+}
+
+ArPipeline *ar_pipeline_create(const ArPipelineConfig *config) {
+	if (!config) return nullptr;
+	return (ArPipeline *)new Pipeline(*config);
+}
+
+int ar_pipeline_start(ArPipeline *pipeline) {
+	return pipeline && ((Pipeline *)pipeline)->start() ? 1 : 0;
+}
+
+void ar_pipeline_stop(ArPipeline *pipeline) {
+	if (pipeline) ((Pipeline *)pipeline)->stop();
+}
+
+void ar_pipeline_destroy(ArPipeline *pipeline) {
+	delete (Pipeline *)pipeline;
+}
+
+int ar_pipeline_push_frame(ArPipeline *pipeline, const unsigned char *bgr, int width, int height, int stride) {
+	return pipeline && bgr && ((Pipeline *)pipeline)->pushFrame(bgr, width, height, stride) ? 1 : 0;
+}
+
+int ar_pipeline_acquire(ArPipeline *pipeline, ArFrame *frame, int timeout_ms) {
+	return pipeline && frame && ((Pipeline *)pipeline)->acquire(*frame, timeout_ms) ? 1 : 0;
+}
+
+void ar_pipeline_release(ArPipeline *pipeline, const ArFrame *frame) {
+	if (pipeline && frame) ((Pipeline *)pipeline)->release(*frame);
+}
+
+int ar_pipeline_stats(ArPipeline *pipeline, ArStageStats *stats, int max_stages) {
+	if (!pipeline || !stats) return 0;
+	return ((Pipeline *)pipeline)->stats(stats, max_stages);
+}
@@ -0,0 +1,110 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <arnative.h>
+
+#include "frame_source.h"
+#include "spsc_queue.h"
+#include "subprocess.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PipelineFrame {
+	std::atomic<bool> inUse{ false };
+	// Written by the stage that fills the frame, read by release() on the consumer's thread
+	std::atomic<uint64_t> sequence{ 0 };
+	uint64_t captureTime = 0;
+	int width = 0, height = 0, stride = 0;
+	std::vector<uint8_t> pixels;
+
+	int handCount = 0;
+	float model[AR_MAX_HANDS * HAND_LANDMARKS * 3];
+	float image[AR_MAX_HANDS * HAND_LANDMARKS * 2];
+	double rvecs[AR_MAX_HANDS * 3];
+	double tvecs[AR_MAX_HANDS * 3];
+	float world[AR_MAX_HANDS * HAND_LANDMARKS * 3];
+	float reprojected[AR_MAX_HANDS * HAND_LANDMARKS * 2];
+	double errors[AR_MAX_HANDS];
+
+	// Landmarks known to the source, for synthetic inference
+	int truthHands = 0;
+	float truthModel[AR_MAX_HANDS * HAND_LANDMARKS * 3];
+	float truthImage[AR_MAX_HANDS * HAND_LANDMARKS * 2];
+};
+
+enum PipelineStage {
+	CaptureStage,
+	InferenceStage,
+	PoseStage,
+	RenderStage,
+	PipelineStageCount,
+};
+
+// Counters of one stage. Only the stage's own thread records; the latency
+// samples are guarded because stats() reads them from another thread.
+struct StageCounters {
+	std::atomic<uint64_t> processed{ 0 };
+	std::atomic<uint64_t> dropped{ 0 };
+	std::mutex mutex;
+	double busyNs = 0;
+	std::vector<float> latencyMs;	// Ring of recent samples
+	size_t latencyCount = 0;
+
+	void record(uint64_t busy_ns, uint64_t latency_ns);
+};
+
+class Pipeline {
+public:
+	explicit Pipeline(const ArPipelineConfig &config);
+	~Pipeline();
+
+	bool start();
+	void stop();
+
+	bool pushFrame(const uint8_t *bgr, int width, int height, int stride);
+	bool acquire(ArFrame &frame, int timeout_ms);
+	void release(const ArFrame &frame);
+	int stats(ArStageStats *stats, int max_stages);
+
+private:
+	PipelineFrame *allocateFrame();
+	void releaseFrame(PipelineFrame *frame);
+
+	// Newest frame in the queue, the older ones are dropped as stale
+	bool popLatest(SpscQueue<PipelineFrame *> &queue, PipelineFrame *&frame, PipelineStage stage);
+	void forward(SpscQueue<PipelineFrame *> &queue, PipelineFrame *frame, PipelineStage stage);
+
+	void captureLoop();
+	void inferenceLoop();
+	void poseLoop();
+	void renderLoop();
+
+	void infer(PipelineFrame &frame);
+	void solvePoses(PipelineFrame &frame);
+	static void fillView(const PipelineFrame &frame, ArFrame &view);
+
+	ArPipelineConfig config;
+	std::string videoPath;
+	std::string inferenceCommand;
+	std::unique_ptr<FrameSource> source;
+	Subprocess inferenceProcess;		// Opened by start() and closed by stop() only
+	bool inferenceFailed = false;	// The process broke off, the source's landmarks are used
+
+	std::vector<std::unique_ptr<PipelineFrame>> pool;
+	SpscQueue<PipelineFrame *> captured;
+	SpscQueue<PipelineFrame *> inferred;
+	SpscQueue<PipelineFrame *> posed;
+
+	std::vector<std::thread> threads;
+	std::atomic<bool> running{ false };
+	std::atomic<uint64_t> nextSequence{ 0 };
+	uint64_t startTime = 0;
+	StageCounters counters[PipelineStageCount];
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "pnp.h"
+
+#include <arnative.h>
+
+#include <string.h>
+
+// Hand landmarks, the common case
+template class PnPSolver<21>;
+template class PnPSolver<0>;
+
+int ar_abi_version(void) {
+	return ARNATIVE_ABI_VERSION;
+}
+
+template <int N>
+static int solveBatch(int hand_count, int point_count, const float *model_points, const float *image_points,
+	const PnPCamera &camera, double *rvecs, double *tvecs, float *world_points, float *reprojected, double *errors) {
+	PnPSolver<N> solver;
+	int solved = 0;
+	for (int h = 0; h < hand_count; ++h) {
+		const float *model = model_points + (size_t)h * point_count * 3;
+		const float *image = image_points + (size_t)h * point_count * 2;
+		float *handReprojected = reprojected ? reprojected + (size_t)h * point_count * 2 : nullptr;
+
+		PnPResult result;
+		if (!solver.solve(model, image, point_count, camera, result, handReprojected)) {
+			if (rvecs) memset(rvecs + h * 3, 0, 3 * sizeof(double));
+			if (tvecs) memset(tvecs + h * 3, 0, 3 * sizeof(double));
+			if (world_points) memset(world_points + (size_t)h * point_count * 3, 0, point_count * 3 * sizeof(float));
+			if (handReprojected) memset(handReprojected, 0, point_count * 2 * sizeof(float));
+			if (errors) errors[h] = -1.0;
+			continue;
+		}
+		++solved;
+
+		if (rvecs) VectorFromRotation(result.rotation, rvecs + h * 3);
+		if (tvecs) {
+			for (int k = 0; k < 3; ++k) tvecs[h * 3 + k] = result.translation[k];
+		}
+		if (world_points) {
+			const double *r = result.rotation;
+			const double *t = result.translation;
+			float *world = world_points + (size_t)h * point_count * 3;
+			for (int i = 0; i < point_count; ++i) {
+				const float *p = model + i * 3;
+				for (int k = 0; k < 3; ++k) {
+					world[i * 3 + k] = (float)(r[k * 3] * p[0] + r[k * 3 + 1] * p[1] + r[k * 3 + 2] * p[2] + t[k]);
+				}
+			}
+		}
+		if (errors) errors[h] = result.error;
+	}
+	return solved;
+}
+
+int ar_solve_pnp_batch(int hand_count, int point_count,
+	const float *model_points, const float *image_points, const double *camera_matrix,
+	double *rvecs, double *tvecs, float *world_points, float *reprojected, double *errors) {
+	if (hand_count <= 0 || !model_points || !image_points || !camera_matrix) return 0;
+
+	PnPCamera camera = { camera_matrix[0], camera_matrix[4], camera_matrix[2], camera_matrix[5] };
+	if (point_count == 21) {
+		return solveBatch<21>(hand_count, point_count, model_points, image_points, camera,
+			rvecs, tvecs, world_points, reprojected, errors);
+	}
+	return solveBatch<0>(hand_count, point_count, model_points, image_points, camera,
+		rvecs, tvecs, world_points, reprojected, errors);
+}
@@ -0,0 +1,512 @@
+#ifndef _PNP_H_
+#define _PNP_H_
+
+#include "linalg.h"
+
+#include <float.h>
+
+struct PnPCamera {
+	double fx, fy, cx, cy;
+};
+
+struct PnPResult {
+	double rotation[9];		// Row major, model to camera space
+	double translation[3];
+	double error;			// Norm of all reprojection residuals / point count
+	int iterations;			// Levenberg-Marquardt iterations
+	bool valid;
+};
+
+// Perspective-n-point for a fixed number of points: EPnP (Lepetit et al.)
+// for the initial pose, refined by Levenberg-Marquardt on the reprojection
+// error. N is a template parameter so all per-point loops have a constant
+// trip count and the points are kept as structure-of-arrays; N = 0 takes
+// the count at run time, up to 64 points.
+template <int N>
+class PnPSolver {
+public:
+	static const int CAPACITY = N > 0 ? N : 64;
+
+	// model: n x 3, image: n x 2 in pixels. reprojected (n x 2) is filled
+	// in the final residual pass if not null.
+	bool solve(const float *model, const float *image, int point_count, const PnPCamera &camera,
+		PnPResult &result, float *reprojected = nullptr);
+
+private:
+	int count() const { return N > 0 ? N : runtimeCount; }
+
+	// EPnP
+	void chooseControlPoints();
+	void computeNullSpace();
+	double poseFromBetas(const double *betas, double *rotation, double *translation) const;
+	void gaussNewton(double *betas) const;
+	double reprojectionError(const double *rotation, const double *translation) const;
+
+	// Levenberg-Marquardt
+	double residuals(const double *rotation, const double *translation, double *jtj, double *jtr, float *reprojected) const;
+	int refine(double *rotation, double *translation, float *reprojected) const;
+
+	int runtimeCount = N;
+	PnPCamera camera;
+
+	// Points, structure-of-arrays
+	double x[CAPACITY], y[CAPACITY], z[CAPACITY];
+	double u[CAPACITY], v[CAPACITY];
+
+	double controlPoints[4][3];
+	double alphas[4][CAPACITY];
+	double nullSpace[4][12];		// Eigenvectors of M^T M, smallest eigenvalue first
+	double l6x10[6][10];
+	double rho[6];
+};
+
+// Edges between the four control points, for the distance constraints
+static const int CONTROL_PAIRS[6][2] = { { 0, 1 }, { 0, 2 }, { 0, 3 }, { 1, 2 }, { 1, 3 }, { 2, 3 } };
+
+template <int N>
+void PnPSolver<N>::chooseControlPoints() {
+	const int n = count();
+
+	// Centroid and the principal axes of the points
+	double c[3] = { 0, 0, 0 };
+	for (int i = 0; i < n; ++i) {
+		c[0] += x[i];
+		c[1] += y[i];
+		c[2] += z[i];
+	}
+	for (int k = 0; k < 3; ++k) c[k] /= n;
+
+	double covariance[9] = {};
+	for (int i = 0; i < n; ++i) {
+		double d[3] = { x[i] - c[0], y[i] - c[1], z[i] - c[2] };
+		for (int r = 0; r < 3; ++r) {
+			for (int k = 0; k < 3; ++k) covariance[r * 3 + k] += d[r] * d[k];
+		}
+	}
+	double values[3], axes[9];
+	SymmetricEigen<3>(covariance, values, axes);
+
+	double scale[3];
+	for (int k = 0; k < 3; ++k) {
+		// Keep nearly planar point sets well conditioned
+		double value = values[k] > 1e-6 * values[0] ? values[k] : 1e-6 * values[0] + 1e-30;
+		scale[k] = sqrt(value / n);
+	}
+
+	for (int k = 0; k < 3; ++k) controlPoints[0][k] = c[k];
+	for (int j = 0; j < 3; ++j) {
+		for (int k = 0; k < 3; ++k) controlPoints[j + 1][k] = c[k] + scale[j] * axes[j * 3 + k];
+	}
+
+	// Barycentric coordinates. The axes are orthonormal, so the inverse
+	// of the control point basis is a projection.
+	for (int i = 0; i < n; ++i) {
+		double d[3] = { x[i] - c[0], y[i] - c[1], z[i] - c[2] };
+		double sum = 0.0;
+		for (int j = 0; j < 3; ++j) {
+			alphas[j + 1][i] = (d[0] * axes[j * 3] + d[1] * axes[j * 3 + 1] + d[2] * axes[j * 3 + 2]) / scale[j];
+			sum += alphas[j + 1][i];
+		}
+		alphas[0][i] = 1.0 - sum;
+	}
+}
+
+template <int N>
+void PnPSolver<N>::computeNullSpace() {
+	const int n = count();
+
+	// M^T M of the 2n x 12 projection constraints, accumulated row by row
+	double mtm[144] = {};
+	for (int i = 0; i < n; ++i) {
+		double rowU[12], rowV[12];
+		for (int j = 0; j < 4; ++j) {
+			double a = alphas[j][i];
+			rowU[j * 3] = a * camera.fx;
+			rowU[j * 3 + 1] = 0.0;
+			rowU[j * 3 + 2] = a * (camera.cx - u[i]);
+			rowV[j * 3] = 0.0;
+			rowV[j * 3 + 1] = a * camera.fy;
+			rowV[j * 3 + 2] = a * (camera.cy - v[i]);
+		}
+		for (int r = 0; r < 12; ++r) {
+			for (int k = r; k < 12; ++k) mtm[r * 12 + k] += rowU[r] * rowU[k] + rowV[r] * rowV[k];
+		}
+	}
+	for (int r = 0; r < 12; ++r) {
+		for (int k = 0; k < r; ++k) mtm[r * 12 + k] = mtm[k * 12 + r];
+	}
+
+	double values[12], vectors[144];
+	SymmetricEigen<12>(mtm, values, vectors);
+	for (int k = 0; k < 4; ++k) {
+		for (int j = 0; j < 12; ++j) nullSpace[k][j] = vectors[(11 - k) * 12 + j];
+	}
+
+	// Distances between control points must be preserved: L * betas' = rho,
+	// with betas' the 10 products of the four betas
+	for (int p = 0; p < 6; ++p) {
+		int a = CONTROL_PAIRS[p][0];
+		int b = CONTROL_PAIRS[p][1];
+		double dv[4][3];
+		for (int k = 0; k < 4; ++k) {
+			for (int j = 0; j < 3; ++j) dv[k][j] = nullSpace[k][a * 3 + j] - nullSpace[k][b * 3 + j];
+		}
+		double dot[4][4];
+		for (int k = 0; k < 4; ++k) {
+			for (int l = 0; l < 4; ++l) dot[k][l] = dv[k][0] * dv[l][0] + dv[k][1] * dv[l][1] + dv[k][2] * dv[l][2];
+		}
+		double *row = l6x10[p];
+		row[0] = dot[0][0];
+		row[1] = 2.0 * dot[0][1];
+		row[2] = dot[1][1];
+		row[3] = 2.0 * dot[0][2];
+		row[4] = 2.0 * dot[1][2];
+		row[5] = dot[2][2];
+		row[6] = 2.0 * dot[0][3];
+		row[7] = 2.0 * dot[1][3];
+		row[8] = 2.0 * dot[2][3];
+		row[9] = dot[3][3];
+
+		double d[3];
+		for (int j = 0; j < 3; ++j) d[j] = controlPoints[a][j] - controlPoints[b][j];
+		rho[p] = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+	}
+}
+
+template <int N>
+void PnPSolver<N>::gaussNewton(double *betas) const {
+	for (int iteration = 0; iteration < 5; ++iteration) {
+		double a[6 * 4], b[6];
+		for (int p = 0; p < 6; ++p) {
+			const double *l = l6x10[p];
+			a[p * 4 + 0] = 2 * l[0] * betas[0] + l[1] * betas[1] + l[3] * betas[2] + l[6] * betas[3];
+			a[p * 4 + 1] = l[1] * betas[0] + 2 * l[2] * betas[1] + l[4] * betas[2] + l[7] * betas[3];
+			a[p * 4 + 2] = l[3] * betas[0] + l[4] * betas[1] + 2 * l[5] * betas[2] + l[8] * betas[3];
+			a[p * 4 + 3] = l[6] * betas[0] + l[7] * betas[1] + l[8] * betas[2] + 2 * l[9] * betas[3];
+			b[p] = rho[p] - (l[0] * betas[0] * betas[0] + l[1] * betas[0] * betas[1] + l[2] * betas[1] * betas[1] +
+				l[3] * betas[0] * betas[2] + l[4] * betas[1] * betas[2] + l[5] * betas[2] * betas[2] +
+				l[6] * betas[0] * betas[3] + l[7] * betas[1] * betas[3] + l[8] * betas[2] * betas[3] +
+				l[9] * betas[3] * betas[3]);
+		}
+		double step[4];
+		if (!SolveLeastSquares<6, 4>(a, b, step)) return;
+		for (int k = 0; k < 4; ++k) betas[k] += step[k];
+	}
+}
+
+// Camera space control points from the betas, then the rigid transform
+// that best maps the model onto the camera space points (Horn's method)
+template <int N>
+double PnPSolver<N>::poseFromBetas(const double *betas, double *rotation, double *translation) const {
+	const int n = count();
+
+	double cameraControl[4][3];
+	for (int j = 0; j < 4; ++j) {
+		for (int k = 0; k < 3; ++k) {
+			cameraControl[j][k] = betas[0] * nullSpace[0][j * 3 + k] + betas[1] * nullSpace[1][j * 3 + k] +
+				betas[2] * nullSpace[2][j * 3 + k] + betas[3] * nullSpace[3][j * 3 + k];
+		}
+	}
+
+	double pc[3][CAPACITY];
+	for (int k = 0; k < 3; ++k) {
+		for (int i = 0; i < n; ++i) {
+			pc[k][i] = alphas[0][i] * cameraControl[0][k] + alphas[1][i] * cameraControl[1][k] +
+				alphas[2][i] * cameraControl[2][k] + alphas[3][i] * cameraControl[3][k];
+		}
+	}
+
+	// The null space has no sign, the points must be in front of the camera
+	if (pc[2][0] < 0) {
+		for (int k = 0; k < 3; ++k) {
+			for (int i = 0; i < n; ++i) pc[k][i] = -pc[k][i];
+		}
+	}
+
+	double cw[3] = { 0, 0, 0 }, cc[3] = { 0, 0, 0 };
+	for (int i = 0; i < n; ++i) {
+		cw[0] += x[i]; cw[1] += y[i]; cw[2] += z[i];
+		cc[0] += pc[0][i]; cc[1] += pc[1][i]; cc[2] += pc[2][i];
+	}
+	for (int k = 0; k < 3; ++k) {
+		cw[k] /= n;
+		cc[k] /= n;
+	}
+
+	// s[a][b] = sum of model_a * camera_b, centered
+	double s[3][3] = {};
+	for (int i = 0; i < n; ++i) {
+		double w[3] = { x[i] - cw[0], y[i] - cw[1], z[i] - cw[2] };
+		double c[3] = { pc[0][i] - cc[0], pc[1][i] - cc[1], pc[2][i] - cc[2] };
+		for (int a = 0; a < 3; ++a) {
+			for (int b = 0; b < 3; ++b) s[a][b] += w[a] * c[b];
+		}
+	}
+	double horn[16] = {
+		s[0][0] + s[1][1] + s[2][2], s[1][2] - s[2][1], s[2][0] - s[0][2], s[0][1] - s[1][0],
+		s[1][2] - s[2][1], s[0][0] - s[1][1] - s[2][2], s[0][1] + s[1][0], s[2][0] + s[0][2],
+		s[2][0] - s[0][2], s[0][1] + s[1][0], -s[0][0] + s[1][1] - s[2][2], s[1][2] + s[2][1],
+		s[0][1] - s[1][0], s[2][0] + s[0][2], s[1][2] + s[2][1], -s[0][0] - s[1][1] + s[2][2],
+	};
+	double values[4], vectors[16];
+	SymmetricEigen<4>(horn, values, vectors);
+	double qw = vectors[0], qx = vectors[1], qy = vectors[2], qz = vectors[3];
+
+	rotation[0] = 1 - 2 * (qy * qy + qz * qz);
+	rotation[1] = 2 * (qx * qy - qw * qz);
+	rotation[2] = 2 * (qx * qz + qw * qy);
+	rotation[3] = 2 * (qx * qy + qw * qz);
+	rotation[4] = 1 - 2 * (qx * qx + qz * qz);
+	rotation[5] = 2 * (qy * qz - qw * qx);
+	rotation[6] = 2 * (qx * qz - qw * qy);
+	rotation[7] = 2 * (qy * qz + qw * qx);
+	rotation[8] = 1 - 2 * (qx * qx + qy * qy);
+
+	for (int k = 0; k < 3; ++k) {
+		translation[k] = cc[k] - (rotation[k * 3] * cw[0] + rotation[k * 3 + 1] * cw[1] + rotation[k * 3 + 2] * cw[2]);
+	}
+	return reprojectionError(rotation, translation);
+}
+
+template <int N>
+double PnPSolver<N>::reprojectionError(const double *rotation, const double *translation) const {
+	const int n = count();
+	double sum = 0.0;
+	for (int i = 0; i < n; ++i) {
+		double px = rotation[0] * x[i] + rotation[1] * y[i] + rotation[2] * z[i] + translation[0];
+		double py = rotation[3] * x[i] + rotation[4] * y[i] + rotation[5] * z[i] + translation[1];
+		double pz = rotation[6] * x[i] + rotation[7] * y[i] + rotation[8] * z[i] + translation[2];
+		double du = camera.fx * px / pz + camera.cx - u[i];
+		double dv = camera.fy * py / pz + camera.cy - v[i];
+		sum += sqrt(du * du + dv * dv);
+	}
+	return sum / n;
+}
+
+// Squared residual norm at a pose. With jtj/jtr, also the normal equations
+// of the 6 pose parameters: a rotation vector applied on the left and the
+// translation.
+template <int N>
+double PnPSolver<N>::residuals(const double *rotation, const double *translation, double *jtj, double *jtr,
+	float *reprojected) const {
+	const int n = count();
+
+	// Per-point terms as arrays over the points, so each loop vectorizes
+	double qx[CAPACITY], qy[CAPACITY], qz[CAPACITY];
+	double ru[CAPACITY], rv[CAPACITY], invZ[CAPACITY];
+	for (int i = 0; i < n; ++i) {
+		qx[i] = rotation[0] * x[i] + rotation[1] * y[i] + rotation[2] * z[i];
+		qy[i] = rotation[3] * x[i] + rotation[4] * y[i] + rotation[5] * z[i];
+		qz[i] = rotation[6] * x[i] + rotation[7] * y[i] + rotation[8] * z[i];
+	}
+	double cost = 0.0;
+	for (int i = 0; i < n; ++i) {
+		double pz = qz[i] + translation[2];
+		invZ[i] = 1.0 / pz;
+		ru[i] = camera.fx * (qx[i] + translation[0]) * invZ[i] + camera.cx - u[i];
+		rv[i] = camera.fy * (qy[i] + translation[1]) * invZ[i] + camera.cy - v[i];
+		cost += ru[i] * ru[i] + rv[i] * rv[i];
+	}
+
+	if (reprojected) {
+		for (int i = 0; i < n; ++i) {
+			reprojected[i * 2] = (float)(ru[i] + u[i]);
+			reprojected[i * 2 + 1] = (float)(rv[i] + v[i]);
+		}
+	}
+	if (!jtj) return cost;
+
+	// d(u, v)/dP for P = q + t, and dP/domega = -[q]x
+	double ju[6][CAPACITY], jv[6][CAPACITY];
+	for (int i = 0; i < n; ++i) {
+		double px = qx[i] + translation[0];
+		double py = qy[i] + translation[1];
+		double au = camera.fx * invZ[i];			// du/dPx
+		double cu = -camera.fx * px * invZ[i] * invZ[i];	// du/dPz
+		double bv = camera.fy * invZ[i];			// dv/dPy
+		double cv = -camera.fy * py * invZ[i] * invZ[i];	// dv/dPz
+
+		ju[0][i] = cu * qy[i];
+		ju[1][i] = au * qz[i] - cu * qx[i];
+		ju[2][i] = -au * qy[i];
+		ju[3][i] = au;
+		ju[4][i] = 0.0;
+		ju[5][i] = cu;
+
+		jv[0][i] = cv * qy[i] - bv * qz[i];
+		jv[1][i] = -cv * qx[i];
+		jv[2][i] = bv * qx[i];
+		jv[3][i] = 0.0;
+		jv[4][i] = bv;
+		jv[5][i] = cv;
+	}
+	for (int a = 0; a < 6; ++a) {
+		for (int b = a; b < 6; ++b) {
+			double sum = 0.0;
+			for (int i = 0; i < n; ++i) sum += ju[a][i] * ju[b][i] + jv[a][i] * jv[b][i];
+			jtj[a * 6 + b] = jtj[b * 6 + a] = sum;
+		}
+		double sum = 0.0;
+		for (int i = 0; i < n; ++i) sum += ju[a][i] * ru[i] + jv[a][i] * rv[i];
+		jtr[a] = sum;
+	}
+	return cost;
+}
+
+template <int N>
+int PnPSolver<N>::refine(double *rotation, double *translation, float *reprojected) const {
+	const int MAX_ITERATIONS = 20;
+	double lambda = 1e-3;
+	double jtj[36], jtr[6];
+	double cost = residuals(rotation, translation, jtj, jtr, nullptr);
+
+	int iteration = 0;
+	for (; iteration < MAX_ITERATIONS; ++iteration) {
+		// Damped normal equations, scaled by the diagonal
+		double a[36], b[6], step[6];
+		for (int k = 0; k < 36; ++k) a[k] = jtj[k];
+		for (int k = 0; k < 6; ++k) {
+			a[k * 6 + k] += lambda * (jtj[k * 6 + k] + 1e-12);
+			b[k] = -jtr[k];
+		}
+		if (!SolveLinear<6>(a, b, step)) break;
+
+		double delta[9], candidateRotation[9], candidateTranslation[3];
+		RotationFromVector(step, delta);
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				candidateRotation[r * 3 + c] = delta[r * 3] * rotation[c] + delta[r * 3 + 1] * rotation[3 + c] +
+					delta[r * 3 + 2] * rotation[6 + c];
+			}
+			candidateTranslation[r] = translation[r] + step[3 + r];
+		}
+
+		double candidateJtj[36], candidateJtr[6];
+		double candidateCost = residuals(candidateRotation, candidateTranslation, candidateJtj, candidateJtr, nullptr);
+		if (candidateCost < cost) {
+			bool converged = cost - candidateCost < 1e-10 * cost;
+			for (int k = 0; k < 9; ++k) rotation[k] = candidateRotation[k];
+			for (int k = 0; k < 3; ++k) translation[k] = candidateTranslation[k];
+			for (int k = 0; k < 36; ++k) jtj[k] = candidateJtj[k];
+			for (int k = 0; k < 6; ++k) jtr[k] = candidateJtr[k];
+			cost = candidateCost;
+			lambda = lambda * 0.1 > 1e-9 ? lambda * 0.1 : 1e-9;
+			if (converged) {
+				++iteration;
+				break;
+			}
+		} else {
+			lambda *= 10.0;
+			if (lambda > 1e9) break;
+		}
+	}
+
+	// Final residual pass for the reprojected points
+	if (reprojected) residuals(rotation, translation, nullptr, nullptr, reprojected);
+	return iteration;
+}
+
+template <int N>
+bool PnPSolver<N>::solve(const float *model, const float *image, int point_count, const PnPCamera &camera,
+	PnPResult &result, float *reprojected) {
+	result.valid = false;
+	if (N > 0 ? point_count != N : (point_count < 4 || point_count > CAPACITY)) return false;
+	runtimeCount = point_count;
+	this->camera = camera;
+
+	const int n = count();
+	for (int i = 0; i < n; ++i) {
+		x[i] = model[i * 3];
+		y[i] = model[i * 3 + 1];
+		z[i] = model[i * 3 + 2];
+		u[i] = image[i * 2];
+		v[i] = image[i * 2 + 1];
+	}
+
+	chooseControlPoints();
+	computeNullSpace();
+
+	// EPnP with one, two and three null space vectors, each linearized
+	// first and then refined on the betas; keep the best
+	double bestError = DBL_MAX;
+	double betas[4], b[5];
+	double l6[6 * 5];
+
+	// One vector: betas' 0, 1, 3, 6 (b11, b12, b13, b14)
+	static const int COLUMNS1[4] = { 0, 1, 3, 6 };
+	for (int p = 0; p < 6; ++p) {
+		for (int k = 0; k < 4; ++k) l6[p * 4 + k] = l6x10[p][COLUMNS1[k]];
+	}
+	if (SolveLeastSquares<6, 4>(l6, rho, b)) {
+		double s = sqrt(fabs(b[0]));
+		double sign = b[0] < 0 ? -1.0 : 1.0;
+		betas[0] = s;
+		for (int k = 1; k < 4; ++k) betas[k] = s > 0 ? sign * b[k] / s : 0.0;
+		gaussNewton(betas);
+		double rotation[9], translation[3];
+		double error = poseFromBetas(betas, rotation, translation);
+		if (error < bestError) {
+			bestError = error;
+			for (int k = 0; k < 9; ++k) result.rotation[k] = rotation[k];
+			for (int k = 0; k < 3; ++k) result.translation[k] = translation[k];
+		}
+	}
+
+	// Two vectors: b11, b12, b22
+	for (int p = 0; p < 6; ++p) {
+		for (int k = 0; k < 3; ++k) l6[p * 3 + k] = l6x10[p][k];
+	}
+	if (SolveLeastSquares<6, 3>(l6, rho, b)) {
+		if (b[0] < 0) {
+			betas[0] = sqrt(-b[0]);
+			betas[1] = b[2] < 0 ? sqrt(-b[2]) : 0.0;
+		} else {
+			betas[0] = sqrt(b[0]);
+			betas[1] = b[2] > 0 ? sqrt(b[2]) : 0.0;
+		}
+		if (b[1] < 0) betas[0] = -betas[0];
+		betas[2] = betas[3] = 0.0;
+		gaussNewton(betas);
+		double rotation[9], translation[3];
+		double error = poseFromBetas(betas, rotation, translation);
+		if (error < bestError) {
+			bestError = error;
+			for (int k = 0; k < 9; ++k) result.rotation[k] = rotation[k];
+			for (int k = 0; k < 3; ++k) result.translation[k] = translation[k];
+		}
+	}
+
+	// Three vectors: b11, b12, b22, b13, b23
+	for (int p = 0; p < 6; ++p) {
+		for (int k = 0; k < 5; ++k) l6[p * 5 + k] = l6x10[p][k];
+	}
+	if (SolveLeastSquares<6, 5>(l6, rho, b)) {
+		if (b[0] < 0) {
+			betas[0] = sqrt(-b[0]);
+			betas[1] = b[2] < 0 ? sqrt(-b[2]) : 0.0;
+		} else {
+			betas[0] = sqrt(b[0]);
+			betas[1] = b[2] > 0 ? sqrt(b[2]) : 0.0;
+		}
+		if (b[1] < 0) betas[0] = -betas[0];
+		betas[2] = betas[0] != 0.0 ? b[3] / betas[0] : 0.0;
+		betas[3] = 0.0;
+		gaussNewton(betas);
+		double rotation[9], translation[3];
+		double error = poseFromBetas(betas, rotation, translation);
+		if (error < bestError) {
+			bestError = error;
+			for (int k = 0; k < 9; ++k) result.rotation[k] = rotation[k];
+			for (int k = 0; k < 3; ++k) result.translation[k] = translation[k];
+		}
+	}
+
+	if (!(bestError < DBL_MAX)) return false;
+
+	result.iterations = refine(result.rotation, result.translation, reprojected);
+	result.error = sqrt(residuals(result.rotation, result.translation, nullptr, nullptr, nullptr)) / n;
+	result.valid = result.error == result.error;
+	return result.valid;
+}
+
+#endif
@@ -0,0 +1,272 @@
+#include "preprocess.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PREPROCESS_SSE2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PREPROCESS_SSE2
+#endif
+
+// Values past the end of a blended row, read but unused by the pixel loads
+static const int ROW_PADDING = 8;
+
+FramePreprocessor::FramePreprocessor(int thread_count) {
+	if (thread_count <= 0) thread_count = (int)std::thread::hardware_concurrency();
+	thread_count = std::max(std::min(thread_count, 64), 1);
+	for (int i = 1; i < thread_count; ++i) workers.emplace_back(&FramePreprocessor::workerLoop, this, i);
+}
+
+FramePreprocessor::~FramePreprocessor() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (std::thread &worker : workers) worker.join();
+}
+
+// Same sample positions as OpenCV's INTER_LINEAR: pixel centers aligned,
+// clamped at the borders
+static void samplePosition(int x, double scale, int size, int &first, int &second, double &weight) {
+	double position = (x + 0.5) * scale - 0.5;
+	first = (int)floor(position);
+	weight = position - first;
+	if (first < 0) {
+		first = 0;
+		weight = 0.0;
+	}
+	if (first >= size - 1) {
+		first = size - 1;
+		weight = 0.0;
+	}
+	second = std::min(first + 1, size - 1);
+}
+
+void FramePreprocessor::buildTables(int source_width, int source_height, int width, int height, int flags) {
+	if (tables.sourceWidth == source_width && tables.sourceHeight == source_height && tables.width == width &&
+		tables.height == height && tables.flags == flags) return;
+	tables.sourceWidth = source_width;
+	tables.sourceHeight = source_height;
+	tables.width = width;
+	tables.height = height;
+	tables.flags = flags;
+
+	bool mirror = (flags & AR_PREPROCESS_MIRROR) != 0;
+	double scaleX = (double)source_width / width;
+	tables.offset0.resize(width);
+	tables.offset1.resize(width);
+	tables.weights.resize(width);
+	for (int x = 0; x < width; ++x) {
+		int first, second;
+		double weight;
+		samplePosition(mirror ? width - 1 - x : x, scaleX, source_width, first, second, weight);
+		uint32_t fixedWeight = (uint32_t)lround(weight * 256.0);
+		tables.offset0[x] = first * 3;
+		tables.offset1[x] = second * 3;
+		tables.weights[x] = (fixedWeight << 16) | (256 - fixedWeight);
+	}
+
+	double scaleY = (double)source_height / height;
+	tables.row0.resize(height);
+	tables.row1.resize(height);
+	tables.rowWeight0.resize(height);
+	tables.rowWeight1.resize(height);
+	for (int y = 0; y < height; ++y) {
+		int first, second;
+		double weight;
+		samplePosition(y, scaleY, source_height, first, second, weight);
+		int fixedWeight = (int)lround(weight * 32768.0);
+		tables.row0[y] = first;
+		tables.row1[y] = second;
+		tables.rowWeight0[y] = (uint16_t)(32768 - fixedWeight);
+		tables.rowWeight1[y] = (uint16_t)fixedWeight;
+	}
+}
+
+// Two source rows blended to source_width * 3 values of 16 bits, 8.7 fixed
+// point: ((a << 8) * wa >> 16) + ((b << 8) * wb >> 16) with wa + wb = 32768
+static void blendRows(const uint8_t *a, const uint8_t *b, uint16_t wa, uint16_t wb, uint16_t *out, int count) {
+	int i = 0;
+#if defined(__AVX2__)
+	const __m256i weightA = _mm256_set1_epi16((short)wa);
+	const __m256i weightB = _mm256_set1_epi16((short)wb);
+	const __m256i zero = _mm256_setzero_si256();
+	for (; i + 32 <= count; i += 32) {
+		// Unpacking works within 128 bit lanes, so the byte order is fixed
+		// up once up front rather than on the 16 bit results
+		__m256i sa = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(a + i)), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i sb = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(b + i)), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i lo = _mm256_add_epi16(
+			_mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, sa), weightA),
+			_mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, sb), weightB));
+		__m256i hi = _mm256_add_epi16(
+			_mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, sa), weightA),
+			_mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, sb), weightB));
+		_mm256_storeu_si256((__m256i *)(out + i), lo);
+		_mm256_storeu_si256((__m256i *)(out + i + 16), hi);
+	}
+#elif defined(PREPROCESS_SSE2)
+	const __m128i weightA = _mm_set1_epi16((short)wa);
+	const __m128i weightB = _mm_set1_epi16((short)wb);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		__m128i sa = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i sb = _mm_loadu_si128((const __m128i *)(b + i));
+		__m128i lo = _mm_add_epi16(
+			_mm_mulhi_epu16(_mm_unpacklo_epi8(zero, sa), weightA),
+			_mm_mulhi_epu16(_mm_unpacklo_epi8(zero, sb), weightB));
+		__m128i hi = _mm_add_epi16(
+			_mm_mulhi_epu16(_mm_unpackhi_epi8(zero, sa), weightA),
+			_mm_mulhi_epu16(_mm_unpackhi_epi8(zero, sb), weightB));
+		_mm_storeu_si128((__m128i *)(out + i), lo);
+		_mm_storeu_si128((__m128i *)(out + i + 8), hi);
+	}
+#endif
+	for (; i < count; ++i) {
+		out[i] = (uint16_t)((((uint32_t)a[i] << 8) * wa >> 16) + (((uint32_t)b[i] << 8) * wb >> 16));
+	}
+}
+
+#if defined(PREPROCESS_SSE2)
+// Four 16 bit values from the blended row, the pixel and one spare
+static inline __m128i loadPixel(const uint16_t *row, int32_t offset) {
+	return _mm_loadl_epi64((const __m128i *)(row + offset));
+}
+#endif
+
+// One blended row to width * 3 output bytes, mirrored by the tables. The
+// row has ROW_PADDING values past its end for the four value loads.
+void FramePreprocessor::resampleRow(const uint16_t *row, uint8_t *out) const {
+	const int32_t *offset0 = &tables.offset0[0];
+	const int32_t *offset1 = &tables.offset1[0];
+	const uint32_t *weights = &tables.weights[0];
+	bool swap = (tables.flags & AR_PREPROCESS_SWAP_RB) != 0;
+	int width = tables.width;
+	int x = 0;
+
+#if defined(PREPROCESS_SSE2)
+	// Two pixels per step: the samples of each channel are interleaved with
+	// their pair of weights for pmaddwd, which also leaves one pixel per 32
+	// bit lane after packing. Each pixel is stored as four bytes, the
+	// fourth overwritten by the next pixel, so the last one is left to the
+	// scalar loop.
+	const __m128i round = _mm_set1_epi32(1 << 14);
+	for (; x + 3 <= width; x += 2) {
+		__m128i a = _mm_unpacklo_epi64(loadPixel(row, offset0[x]), loadPixel(row, offset0[x + 1]));
+		__m128i b = _mm_unpacklo_epi64(loadPixel(row, offset1[x]), loadPixel(row, offset1[x + 1]));
+		if (swap) {
+			a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+			b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+		}
+		__m128i first = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), _mm_set1_epi32((int)weights[x]));
+		__m128i second = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), _mm_set1_epi32((int)weights[x + 1]));
+		first = _mm_srli_epi32(_mm_add_epi32(first, round), 15);
+		second = _mm_srli_epi32(_mm_add_epi32(second, round), 15);
+		__m128i words = _mm_packs_epi32(first, second);
+		__m128i bytes = _mm_packus_epi16(words, words);
+		uint32_t pixels[2] = { (uint32_t)_mm_cvtsi128_si32(bytes), (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(bytes, 4)) };
+		memcpy(out + x * 3, &pixels[0], 4);
+		memcpy(out + x * 3 + 3, &pixels[1], 4);
+	}
+#endif
+
+	for (; x < width; ++x) {
+		uint32_t w1 = weights[x] >> 16, w0 = weights[x] & 0xFFFF;
+		for (int c = 0; c < 3; ++c) {
+			int channel = swap ? 2 - c : c;
+			uint32_t value = row[offset0[x] + channel] * w0 + row[offset1[x] + channel] * w1;
+			out[x * 3 + c] = (uint8_t)std::min((value + (1 << 14)) >> 15, 255u);
+		}
+	}
+}
+
+void FramePreprocessor::processBand(int band, int band_count) {
+	int height = tables.height;
+	int begin = (int)((int64_t)height * band / band_count);
+	int end = (int)((int64_t)height * (band + 1) / band_count);
+	if (begin >= end) return;
+
+	// Vertical first: the blend runs over contiguous memory at full SIMD
+	// width, and the sampled horizontal pass then only touches output values
+	int count = tables.sourceWidth * 3;
+	std::vector<uint16_t> blended(count + ROW_PADDING, 0);
+	for (int y = begin; y < end; ++y) {
+		blendRows(source + (size_t)tables.row0[y] * sourceStride, source + (size_t)tables.row1[y] * sourceStride,
+			tables.rowWeight0[y], tables.rowWeight1[y], &blended[0], count);
+		resampleRow(&blended[0], destination + (size_t)y * destinationStride);
+	}
+}
+
+void FramePreprocessor::workerLoop(int index) {
+	uint64_t seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return quit || generation != seen; });
+			if (quit) return;
+			seen = generation;
+		}
+		processBand(index, threadCount());
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--pending == 0) done.notify_one();
+		}
+	}
+}
+
+void FramePreprocessor::runBands() {
+	if (!workers.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending = (int)workers.size();
+			++generation;
+		}
+		wake.notify_all();
+	}
+	processBand(0, threadCount());
+	if (!workers.empty()) {
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&]() { return pending == 0; });
+	}
+}
+
+bool FramePreprocessor::process(const uint8_t *source, int source_width, int source_height, int source_stride,
+	uint8_t *destination, int width, int height, int stride, int flags) {
+	if (!source || !destination || source_width <= 0 || source_height <= 0 || width <= 0 || height <= 0) return false;
+	if (source_stride < source_width * 3 || stride < width * 3) return false;
+
+	buildTables(source_width, source_height, width, height, flags);
+	this->source = source;
+	this->sourceStride = source_stride;
+	this->destination = destination;
+	this->destinationStride = stride;
+	runBands();
+	return true;
+}
+
+// C interface
+
+ArPreprocessor *ar_preprocess_create(int thread_count) {
+	return (ArPreprocessor *)new FramePreprocessor(thread_count);
+}
+
+void ar_preprocess_destroy(ArPreprocessor *preprocessor) {
+	delete (FramePreprocessor *)preprocessor;
+}
+
+int ar_preprocess_frame(ArPreprocessor *preprocessor, const unsigned char *source, int source_width, int source_height,
+	int source_stride, unsigned char *destination, int width, int height, int stride, int flags) {
+	if (!preprocessor) return 0;
+	return ((FramePreprocessor *)preprocessor)->process(source, source_width, source_height, source_stride,
+		destination, width, height, stride, flags) ? 1 : 0;
+}
+
+int ar_preprocess_thread_count(ArPreprocessor *preprocessor) {
+	return preprocessor ? ((FramePreprocessor *)preprocessor)->threadCount() : 0;
+}
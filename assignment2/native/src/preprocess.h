@@ -0,0 +1,63 @@
+#ifndef _PREPROCESS_H_
+#define _PREPROCESS_H_
+
+#include <arnative.h>
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Camera frame preparation for inference in one pass: bilinear resize,
+// horizontal mirror and red/blue swap. The mirror and the swap are folded
+// into the horizontal sampling tables, so they cost nothing extra: each
+// output row is a SIMD blend of two source rows followed by one sampled
+// pass that writes the destination. Output rows are split into bands, one
+// per thread.
+class FramePreprocessor {
+public:
+	explicit FramePreprocessor(int thread_count);
+	~FramePreprocessor();
+
+	bool process(const uint8_t *source, int source_width, int source_height, int source_stride,
+		uint8_t *destination, int width, int height, int stride, int flags);
+
+	int threadCount() const { return (int)workers.size() + 1; }
+
+private:
+	struct Tables {
+		int sourceWidth = 0, sourceHeight = 0, width = 0, height = 0, flags = -1;
+		std::vector<int32_t> offset0, offset1;	// First source value of each output pixel
+		std::vector<uint32_t> weights;			// 16 bit pairs for the two samples, sum 256
+		std::vector<int32_t> row0, row1;
+		std::vector<uint16_t> rowWeight0, rowWeight1;	// Sum to 32768
+	};
+
+	void buildTables(int source_width, int source_height, int width, int height, int flags);
+	void processBand(int band, int band_count);
+	void resampleRow(const uint16_t *row, uint8_t *out) const;
+
+	void workerLoop(int index);
+	void runBands();
+
+	Tables tables;
+
+	// Current job
+	const uint8_t *source = nullptr;
+	int sourceStride = 0;
+	uint8_t *destination = nullptr;
+	int destinationStride = 0;
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	uint64_t generation = 0;
+	int pending = 0;
+	bool quit = false;
+};
+
+#endif
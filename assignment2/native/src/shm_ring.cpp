@@ -0,0 +1,398 @@
+#include "shm_ring.h"
+#include "clock.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef _WIN32
+
+struct ShmRingHeader {};
+
+ShmRing::~ShmRing() {}
+bool ShmRing::create(const char *name, int slot_count, size_t frame_capacity, size_t record_capacity) { return false; }
+bool ShmRing::open(const char *name, int timeout_ms) { return false; }
+bool ShmRing::beginWrite(ArShmSlot &slot, int timeout_ms) { return false; }
+void ShmRing::endWrite() {}
+void ShmRing::closeWriter() {}
+int ShmRing::beginRead(ArShmSlot &slot, int timeout_ms, bool latest) { return -1; }
+void ShmRing::endRead() {}
+int ShmRing::slotCount() const { return 0; }
+size_t ShmRing::frameCapacity() const { return 0; }
+size_t ShmRing::recordCapacity() const { return 0; }
+void ShmRing::stats(uint64_t &written, uint64_t &read, uint64_t &skipped) const { written = read = skipped = 0; }
+void ShmRing::slotView(uint64_t position, ArShmSlot &slot) const {}
+void ShmRing::unmap() {}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() ((void)0)
+#endif
+
+static const uint32_t MAGIC = 0x41524E47;		// "ARNG"
+static const uint32_t LAYOUT_VERSION = 1;
+static const size_t ALIGNMENT = 64;
+
+// How long a waiting side spins before it sleeps, when another CPU can
+// make progress meanwhile
+static const uint64_t SPIN_NS = 20000;
+
+// Polling period where there is no futex
+static const int POLL_US = 100;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "Shared counters must be lock-free");
+
+// Start of the shared memory. Each side's counters are on their own cache
+// line, so the two processes do not write to the same line.
+struct ShmRingHeader {
+	uint32_t magic;
+	uint32_t version;
+	std::atomic<uint32_t> ready;			// Set last by the creator
+	uint32_t slotCount;
+	uint64_t frameCapacity;
+	uint64_t recordCapacity;
+	uint64_t slotStride;
+
+	// Writer
+	alignas(64) std::atomic<uint64_t> written;
+	std::atomic<uint32_t> dataSignal;		// Futex, bumped on every publish
+	std::atomic<uint32_t> readerSleeping;
+	std::atomic<uint32_t> closed;
+
+	// Reader
+	alignas(64) std::atomic<uint64_t> read;
+	std::atomic<uint32_t> spaceSignal;		// Futex, bumped on every release
+	std::atomic<uint32_t> writerSleeping;
+	std::atomic<uint64_t> skipped;
+};
+
+static size_t alignUp(size_t value) {
+	return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+static size_t headerSize() {
+	return alignUp(sizeof(ShmRingHeader));
+}
+
+// Sleep until signal no longer holds expected, or timeout_ns (< 0 forever)
+static void sleepOn(std::atomic<uint32_t> &signal, uint32_t expected, int64_t timeout_ns) {
+#if defined(__linux__)
+	struct timespec timeout;
+	timeout.tv_sec = (time_t)(timeout_ns / 1000000000);
+	timeout.tv_nsec = (long)(timeout_ns % 1000000000);
+	// Not FUTEX_PRIVATE_FLAG: the word is shared between processes
+	syscall(SYS_futex, (uint32_t *)&signal, FUTEX_WAIT, expected, timeout_ns < 0 ? nullptr : &timeout, nullptr, 0);
+#else
+	(void)expected;
+	int64_t us = timeout_ns < 0 ? POLL_US : std::min<int64_t>(POLL_US, timeout_ns / 1000);
+	usleep((useconds_t)std::max<int64_t>(us, 1));
+#endif
+}
+
+static void wake(std::atomic<uint32_t> &signal) {
+#if defined(__linux__)
+	syscall(SYS_futex, (uint32_t *)&signal, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+	(void)signal;
+#endif
+}
+
+// Wait for ready() on one side: spin, then sleep on signal with sleeping
+// set so the other side knows to wake us. Returns false on timeout.
+template <typename Ready>
+static bool waitFor(Ready ready, std::atomic<uint32_t> &signal, std::atomic<uint32_t> &sleeping, int timeout_ms) {
+	if (ready()) return true;
+	if (timeout_ms == 0) return false;
+
+	uint64_t start = MonotonicTimeNs();
+	uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : start + (uint64_t)timeout_ms * 1000000;
+	static const bool spin = std::thread::hardware_concurrency() > 1;
+	if (spin) {
+		while (MonotonicTimeNs() - start < SPIN_NS) {
+			for (int i = 0; i < 64; ++i) CPU_RELAX();
+			if (ready()) return true;
+		}
+	}
+
+	for (;;) {
+		// The signal is read before the last check: a publish after the check
+		// changes it, and the futex then returns at once
+		uint32_t expected = signal.load(std::memory_order_acquire);
+		sleeping.store(1, std::memory_order_seq_cst);
+		if (ready()) {
+			sleeping.store(0, std::memory_order_relaxed);
+			return true;
+		}
+		uint64_t now = MonotonicTimeNs();
+		if (now >= deadline) {
+			sleeping.store(0, std::memory_order_relaxed);
+			return false;
+		}
+		sleepOn(signal, expected, deadline == UINT64_MAX ? -1 : (int64_t)(deadline - now));
+		sleeping.store(0, std::memory_order_relaxed);
+		if (ready()) return true;
+	}
+}
+
+static void signalOther(std::atomic<uint32_t> &signal, std::atomic<uint32_t> &sleeping) {
+	signal.fetch_add(1, std::memory_order_seq_cst);
+	if (sleeping.load(std::memory_order_seq_cst)) wake(signal);
+}
+
+ShmRing::~ShmRing() {
+	unmap();
+}
+
+void ShmRing::unmap() {
+	if (memory) munmap(memory, size);
+	if (owner) shm_unlink(name.c_str());
+	memory = nullptr;
+	header = nullptr;
+	slots = nullptr;
+	owner = false;
+}
+
+bool ShmRing::create(const char *name, int slot_count, size_t frame_capacity, size_t record_capacity) {
+	unmap();
+	if (!name || slot_count < 1) return false;
+	size_t slotStride = alignUp(sizeof(ArShmHeader)) + alignUp(frame_capacity) + alignUp(record_capacity);
+	size = headerSize() + slotStride * slot_count;
+
+	// A ring left behind by a crashed process is replaced
+	shm_unlink(name);
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0) return false;
+	bool mapped = ftruncate(fd, (off_t)size) == 0;
+	if (mapped) {
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		mapped = memory != MAP_FAILED;
+	}
+	::close(fd);
+	if (!mapped) {
+		memory = nullptr;
+		shm_unlink(name);
+		return false;
+	}
+	this->name = name;
+	owner = true;
+
+	// The memory starts zeroed, which is the initial state of every counter
+	header = (ShmRingHeader *)memory;
+	slots = (uint8_t *)memory + headerSize();
+	header->magic = MAGIC;
+	header->version = LAYOUT_VERSION;
+	header->slotCount = (uint32_t)slot_count;
+	header->frameCapacity = frame_capacity;
+	header->recordCapacity = record_capacity;
+	header->slotStride = slotStride;
+	header->ready.store(1, std::memory_order_release);
+	writing = reading = -1;
+	return true;
+}
+
+bool ShmRing::open(const char *name, int timeout_ms) {
+	unmap();
+	if (!name) return false;
+	uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : MonotonicTimeNs() + (uint64_t)timeout_ms * 1000000;
+
+	// Until the creator has made it and sized it
+	for (;;) {
+		int fd = shm_open(name, O_RDWR, 0);
+		if (fd >= 0) {
+			struct stat info;
+			if (fstat(fd, &info) == 0 && (size_t)info.st_size >= headerSize()) {
+				size = (size_t)info.st_size;
+				memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if (memory == MAP_FAILED) memory = nullptr;
+			}
+			::close(fd);
+		}
+		if (memory) {
+			header = (ShmRingHeader *)memory;
+			if (header->ready.load(std::memory_order_acquire)) break;
+			munmap(memory, size);
+			memory = nullptr;
+			header = nullptr;
+		}
+		if (MonotonicTimeNs() >= deadline) return false;
+		usleep(1000);
+	}
+
+	if (header->magic != MAGIC || header->version != LAYOUT_VERSION ||
+		headerSize() + header->slotStride * header->slotCount > size) {
+		unmap();
+		return false;
+	}
+	this->name = name;
+	slots = (uint8_t *)memory + headerSize();
+	writing = reading = -1;
+	return true;
+}
+
+void ShmRing::slotView(uint64_t position, ArShmSlot &slot) const {
+	uint8_t *base = slots + (position % header->slotCount) * header->slotStride;
+	slot.header = (ArShmHeader *)base;
+	slot.frame = base + alignUp(sizeof(ArShmHeader));
+	slot.record = slot.frame + alignUp((size_t)header->frameCapacity);
+}
+
+bool ShmRing::beginWrite(ArShmSlot &slot, int timeout_ms) {
+	if (!header) return false;
+	uint64_t position = header->written.load(std::memory_order_relaxed);
+	uint64_t count = header->slotCount;
+	bool free = waitFor([&] { return position - header->read.load(std::memory_order_acquire) < count; },
+		header->spaceSignal, header->writerSleeping, timeout_ms);
+	if (!free) return false;
+
+	writing = (int64_t)position;
+	slotView(position, slot);
+	memset(slot.header, 0, sizeof(ArShmHeader));
+	return true;
+}
+
+void ShmRing::endWrite() {
+	if (!header || writing < 0) return;
+	ArShmSlot slot;
+	slotView((uint64_t)writing, slot);
+	slot.header->sequence = (uint64_t)writing;
+	slot.header->publish_time_ns = MonotonicTimeNs();
+	header->written.store((uint64_t)writing + 1, std::memory_order_release);
+	writing = -1;
+	signalOther(header->dataSignal, header->readerSleeping);
+}
+
+void ShmRing::closeWriter() {
+	if (!header) return;
+	header->closed.store(1, std::memory_order_release);
+	signalOther(header->dataSignal, header->readerSleeping);
+}
+
+int ShmRing::beginRead(ArShmSlot &slot, int timeout_ms, bool latest) {
+	if (!header) return -1;
+	uint64_t position = header->read.load(std::memory_order_relaxed);
+	bool closed = false;
+	bool available = waitFor([&] {
+			closed = header->closed.load(std::memory_order_acquire) != 0;
+			return header->written.load(std::memory_order_acquire) > position || closed;
+		}, header->dataSignal, header->readerSleeping, timeout_ms);
+	uint64_t written = header->written.load(std::memory_order_acquire);
+	if (written == position) return (available && closed) ? -1 : 0;
+
+	if (latest && written - position > 1) {
+		// Hand the older slots back at once
+		header->skipped.fetch_add(written - 1 - position, std::memory_order_relaxed);
+		position = written - 1;
+		header->read.store(position, std::memory_order_release);
+		signalOther(header->spaceSignal, header->writerSleeping);
+	}
+	reading = (int64_t)position;
+	slotView(position, slot);
+	return 1;
+}
+
+void ShmRing::endRead() {
+	if (!header || reading < 0) return;
+	header->read.store((uint64_t)reading + 1, std::memory_order_release);
+	reading = -1;
+	signalOther(header->spaceSignal, header->writerSleeping);
+}
+
+int ShmRing::slotCount() const {
+	return header ? (int)header->slotCount : 0;
+}
+
+size_t ShmRing::frameCapacity() const {
+	return header ? (size_t)header->frameCapacity : 0;
+}
+
+size_t ShmRing::recordCapacity() const {
+	return header ? (size_t)header->recordCapacity : 0;
+}
+
+void ShmRing::stats(uint64_t &written, uint64_t &read, uint64_t &skipped) const {
+	written = header ? header->written.load(std::memory_order_relaxed) : 0;
+	read = header ? header->read.load(std::memory_order_relaxed) : 0;
+	skipped = header ? header->skipped.load(std::memory_order_relaxed) : 0;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// C interface
+
+ArShmRing *ar_shm_create(const char *name, int slot_count, uint64_t frame_capacity, uint64_t record_capacity) {
+	ShmRing *ring = new ShmRing();
+	if (!ring->create(name, slot_count, (size_t)frame_capacity, (size_t)record_capacity)) {
+		delete ring;
+		return nullptr;
+	}
+	return (ArShmRing *)ring;
+}
+
+ArShmRing *ar_shm_open(const char *name, int timeout_ms) {
+	ShmRing *ring = new ShmRing();
+	if (!ring->open(name, timeout_ms)) {
+		delete ring;
+		return nullptr;
+	}
+	return (ArShmRing *)ring;
+}
+
+void ar_shm_destroy(ArShmRing *ring) {
+	delete (ShmRing *)ring;
+}
+
+void ar_shm_capacity(ArShmRing *ring, int *slot_count, uint64_t *frame_capacity, uint64_t *record_capacity) {
+	ShmRing *r = (ShmRing *)ring;
+	if (slot_count) *slot_count = r ? r->slotCount() : 0;
+	if (frame_capacity) *frame_capacity = r ? r->frameCapacity() : 0;
+	if (record_capacity) *record_capacity = r ? r->recordCapacity() : 0;
+}
+
+int ar_shm_begin_write(ArShmRing *ring, ArShmSlot *slot, int timeout_ms) {
+	if (!ring || !slot) return 0;
+	return ((ShmRing *)ring)->beginWrite(*slot, timeout_ms) ? 1 : 0;
+}
+
+void ar_shm_end_write(ArShmRing *ring) {
+	if (ring) ((ShmRing *)ring)->endWrite();
+}
+
+void ar_shm_close_writer(ArShmRing *ring) {
+	if (ring) ((ShmRing *)ring)->closeWriter();
+}
+
+int ar_shm_begin_read(ArShmRing *ring, ArShmSlot *slot, int timeout_ms, int latest) {
+	if (!ring || !slot) return 0;
+	return ((ShmRing *)ring)->beginRead(*slot, timeout_ms, latest != 0);
+}
+
+void ar_shm_end_read(ArShmRing *ring) {
+	if (ring) ((ShmRing *)ring)->endRead();
+}
+
+void ar_shm_stats(ArShmRing *ring, uint64_t *written, uint64_t *read, uint64_t *skipped) {
+	uint64_t w = 0, r = 0, s = 0;
+	if (ring) ((ShmRing *)ring)->stats(w, r, s);
+	if (written) *written = w;
+	if (read) *read = r;
+	if (skipped) *skipped = s;
+}
@@ -0,0 +1,58 @@
+#ifndef _SHM_RING_H_
+#define _SHM_RING_H_
+
+#include <arnative.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+struct ShmRingHeader;
+
+// Single producer, single consumer ring of fixed-size slots in POSIX shared
+// memory, between two processes (or threads). Each slot is a frame area and
+// a record area (e.g. landmarks) behind an ArShmHeader. Written and read
+// counts only grow and each is written by one side; a side that has to wait
+// spins briefly, then sleeps on a futex that the other side only wakes when
+// someone sleeps on it. POSIX only; the futex needs Linux, elsewhere waits
+// poll.
+class ShmRing {
+public:
+	~ShmRing();
+
+	bool create(const char *name, int slot_count, size_t frame_capacity, size_t record_capacity);
+	bool open(const char *name, int timeout_ms);
+
+	// Writer side
+	bool beginWrite(ArShmSlot &slot, int timeout_ms);
+	void endWrite();
+	void closeWriter();
+
+	// Reader side: 1 with a slot, 0 on timeout, -1 once the writer closed
+	// and everything was read
+	int beginRead(ArShmSlot &slot, int timeout_ms, bool latest);
+	void endRead();
+
+	int slotCount() const;
+	size_t frameCapacity() const;
+	size_t recordCapacity() const;
+	void stats(uint64_t &written, uint64_t &read, uint64_t &skipped) const;
+
+private:
+	void slotView(uint64_t position, ArShmSlot &slot) const;
+	void unmap();
+
+	std::string name;
+	bool owner = false;						// Created the memory, removes the name
+	void *memory = nullptr;
+	size_t size = 0;
+	ShmRingHeader *header = nullptr;
+	uint8_t *slots = nullptr;
+
+	// Stream position of the slot taken by begin*, -1 for none
+	int64_t writing = -1;
+	int64_t reading = -1;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+// A batch of floats in the widest vector registers the build targets (AVX,
+// SSE2, or one float without either), so kernels over SoA arrays are
+// written once. Loads and stores are unaligned.
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2
+#endif
+
+#include <math.h>
+
+#if defined(__AVX__)
+
+struct FloatBatch {
+	static const int WIDTH = 8;
+	__m256 v;
+
+	FloatBatch() {}
+	FloatBatch(__m256 value) : v(value) {}
+	explicit FloatBatch(float value) : v(_mm256_set1_ps(value)) {}
+
+	static FloatBatch load(const float *p) { return _mm256_loadu_ps(p); }
+	void store(float *p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline FloatBatch operator+(FloatBatch a, FloatBatch b) { return _mm256_add_ps(a.v, b.v); }
+inline FloatBatch operator-(FloatBatch a, FloatBatch b) { return _mm256_sub_ps(a.v, b.v); }
+inline FloatBatch operator*(FloatBatch a, FloatBatch b) { return _mm256_mul_ps(a.v, b.v); }
+inline FloatBatch operator/(FloatBatch a, FloatBatch b) { return _mm256_div_ps(a.v, b.v); }
+inline FloatBatch Abs(FloatBatch a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline FloatBatch Min(FloatBatch a, FloatBatch b) { return _mm256_min_ps(a.v, b.v); }
+inline FloatBatch Max(FloatBatch a, FloatBatch b) { return _mm256_max_ps(a.v, b.v); }
+// mask is 1.0 or 0.0 per lane
+inline FloatBatch Select(FloatBatch mask, FloatBatch a, FloatBatch b) {
+	return _mm256_blendv_ps(b.v, a.v, _mm256_cmp_ps(mask.v, _mm256_setzero_ps(), _CMP_NEQ_OQ));
+}
+
+#elif defined(SIMD_SSE2)
+
+struct FloatBatch {
+	static const int WIDTH = 4;
+	__m128 v;
+
+	FloatBatch() {}
+	FloatBatch(__m128 value) : v(value) {}
+	explicit FloatBatch(float value) : v(_mm_set1_ps(value)) {}
+
+	static FloatBatch load(const float *p) { return _mm_loadu_ps(p); }
+	void store(float *p) const { _mm_storeu_ps(p, v); }
+};
+
+inline FloatBatch operator+(FloatBatch a, FloatBatch b) { return _mm_add_ps(a.v, b.v); }
+inline FloatBatch operator-(FloatBatch a, FloatBatch b) { return _mm_sub_ps(a.v, b.v); }
+inline FloatBatch operator*(FloatBatch a, FloatBatch b) { return _mm_mul_ps(a.v, b.v); }
+inline FloatBatch operator/(FloatBatch a, FloatBatch b) { return _mm_div_ps(a.v, b.v); }
+inline FloatBatch Abs(FloatBatch a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline FloatBatch Min(FloatBatch a, FloatBatch b) { return _mm_min_ps(a.v, b.v); }
+inline FloatBatch Max(FloatBatch a, FloatBatch b) { return _mm_max_ps(a.v, b.v); }
+inline FloatBatch Select(FloatBatch mask, FloatBatch a, FloatBatch b) {
+	__m128 m = _mm_cmpneq_ps(mask.v, _mm_setzero_ps());
+	return _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v));
+}
+
+#else
+
+struct FloatBatch {
+	static const int WIDTH = 1;
+	float v;
+
+	FloatBatch() {}
+	explicit FloatBatch(float value) : v(value) {}
+
+	static FloatBatch load(const float *p) { return FloatBatch(*p); }
+	void store(float *p) const { *p = v; }
+};
+
+inline FloatBatch operator+(FloatBatch a, FloatBatch b) { return FloatBatch(a.v + b.v); }
+inline FloatBatch operator-(FloatBatch a, FloatBatch b) { return FloatBatch(a.v - b.v); }
+inline FloatBatch operator*(FloatBatch a, FloatBatch b) { return FloatBatch(a.v * b.v); }
+inline FloatBatch operator/(FloatBatch a, FloatBatch b) { return FloatBatch(a.v / b.v); }
+inline FloatBatch Abs(FloatBatch a) { return FloatBatch(fabsf(a.v)); }
+inline FloatBatch Min(FloatBatch a, FloatBatch b) { return FloatBatch(a.v < b.v ? a.v : b.v); }
+inline FloatBatch Max(FloatBatch a, FloatBatch b) { return FloatBatch(a.v > b.v ? a.v : b.v); }
+inline FloatBatch Select(FloatBatch mask, FloatBatch a, FloatBatch b) { return mask.v != 0.0f ? a : b; }
+
+#endif
+
+// Number of floats to allocate so whole batches cover count values
+inline int PaddedCount(int count) {
+	return (count + FloatBatch::WIDTH - 1) / FloatBatch::WIDTH * FloatBatch::WIDTH;
+}
+
+#endif
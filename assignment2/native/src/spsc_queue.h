@@ -0,0 +1,59 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer and one consumer
+// thread. The capacity is rounded up to a power of two. Head and tail only
+// grow and are each written by one side, on separate cache lines. Padding
+// rather than alignas keeps the queue usable as a member of heap objects,
+// which C++14 new does not over-align.
+template <typename T>
+class SpscQueue {
+public:
+	explicit SpscQueue(size_t capacity = 4) {
+		size_t size = 2;
+		while (size < capacity) size *= 2;
+		items.resize(size);
+		mask = size - 1;
+	}
+
+	SpscQueue(const SpscQueue &) = delete;
+	SpscQueue &operator=(const SpscQueue &) = delete;
+
+	// Producer side. Returns false if the queue is full.
+	bool push(const T &item) {
+		size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - headIndex.load(std::memory_order_acquire) > mask) return false;
+		items[tail & mask] = item;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns false if the queue is empty.
+	bool pop(T &item) {
+		size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == tailIndex.load(std::memory_order_acquire)) return false;
+		item = items[head & mask];
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t capacity() const { return mask + 1; }
+
+private:
+	static const size_t CACHE_LINE = 64;
+
+	std::vector<T> items;
+	size_t mask;
+	char padding0[CACHE_LINE];
+	std::atomic<size_t> headIndex{ 0 };
+	char padding1[CACHE_LINE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tailIndex{ 0 };
+	char padding2[CACHE_LINE - sizeof(std::atomic<size_t>)];
+};
+
+#endif
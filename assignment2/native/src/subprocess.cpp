@@ -0,0 +1,98 @@
+#include "subprocess.h"
+
+#ifdef _WIN32
+
+bool Subprocess::open(const char *command) { return false; }
+void Subprocess::close() {}
+void Subprocess::kill() {}
+bool Subprocess::write(const void *data, size_t size) { return false; }
+bool Subprocess::read(void *data, size_t size) { return false; }
+
+#else
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool Subprocess::open(const char *command) {
+	close();
+	int toChild[2], fromChild[2];
+	if (pipe(toChild) != 0) return false;
+	if (pipe(fromChild) != 0) {
+		::close(toChild[0]);
+		::close(toChild[1]);
+		return false;
+	}
+
+	pid = fork();
+	if (pid == 0) {
+		// A process group of its own, for kill()
+		setpgid(0, 0);
+		dup2(toChild[0], STDIN_FILENO);
+		dup2(fromChild[1], STDOUT_FILENO);
+		::close(toChild[0]);
+		::close(toChild[1]);
+		::close(fromChild[0]);
+		::close(fromChild[1]);
+		execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+		_exit(127);
+	}
+
+	::close(toChild[0]);
+	::close(fromChild[1]);
+	if (pid > 0) setpgid(pid, pid);	// Also here, in case kill() comes before the child gets to it
+	if (pid < 0) {
+		::close(toChild[1]);
+		::close(fromChild[0]);
+		return false;
+	}
+	input = toChild[1];
+	output = fromChild[0];
+
+	// A dead child must fail the write, not kill us
+	signal(SIGPIPE, SIG_IGN);
+	return true;
+}
+
+void Subprocess::close() {
+	if (input >= 0) ::close(input);
+	if (output >= 0) ::close(output);
+	input = output = -1;
+	if (pid > 0) {
+		// Closing stdin asks the child to finish
+		int status;
+		waitpid(pid, &status, 0);
+	}
+	pid = -1;
+}
+
+void Subprocess::kill() {
+	if (pid > 0) ::kill(-pid, SIGKILL);
+}
+
+bool Subprocess::write(const void *data, size_t size) {
+	const char *bytes = (const char *)data;
+	while (size > 0) {
+		ssize_t n = ::write(input, bytes, size);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		bytes += n;
+		size -= n;
+	}
+	return true;
+}
+
+bool Subprocess::read(void *data, size_t size) {
+	char *bytes = (char *)data;
+	while (size > 0) {
+		ssize_t n = ::read(output, bytes, size);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		bytes += n;
+		size -= n;
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef _SUBPROCESS_H_
+#define _SUBPROCESS_H_
+
+#include <stddef.h>
+
+// A child process with pipes to its stdin and stdout, for blocking binary
+// request/response protocols. POSIX only.
+class Subprocess {
+public:
+	~Subprocess() { close(); }
+
+	bool open(const char *command);
+	void close();
+
+	// Kill the child and everything it started, so that a read() or write()
+	// blocked in another thread fails. close() still has to reap it.
+	void kill();
+
+	bool write(const void *data, size_t size);
+	bool read(void *data, size_t size);
+
+	bool isOpen() const { return pid > 0; }
+
+private:
+	int pid = -1;
+	int input = -1;		// Child's stdin
+	int output = -1;	// Child's stdout
+};
+
+#endif
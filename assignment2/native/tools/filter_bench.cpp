@@ -0,0 +1,85 @@
+// Times landmark filter updates for hand and face sized batches, and
+// measures smoothing and prediction error on a noisy moving signal.
+//
+//   filter_bench [iterations]
+
+#include <arnative.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+static double timeUpdates(ArFilter *filter, int channels, int iterations) {
+	std::vector<float> measurements(channels), filtered(channels), predicted(channels);
+	std::mt19937 random(1);
+	std::normal_distribution<float> noise(0.0f, 2.0f);
+	for (int i = 0; i < channels; ++i) measurements[i] = 100.0f + noise(random);
+
+	auto begin = std::chrono::steady_clock::now();
+	for (int n = 0; n < iterations; ++n) {
+		measurements[n % channels] += 0.5f;
+		ar_filter_update(filter, &measurements[0], n / 30.0, 0.05f, &filtered[0], &predicted[0]);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+
+// A point moving on a circle of 100 px at 0.5 Hz, with 2 px noise at 30 fps.
+// The filter output is compared with the true position, the prediction
+// with the true position latency seconds later.
+static void measureAccuracy(int type, float latency) {
+	ArFilterParams params;
+	ar_filter_default_params(&params, type);
+	ArFilter *filter = ar_filter_create(2, &params);
+
+	std::mt19937 random(2);
+	std::normal_distribution<float> noise(0.0f, 2.0f);
+	double rawError = 0, filteredError = 0, staleError = 0, predictedError = 0;
+	int frames = 300, counted = 0;
+	for (int n = 0; n < frames; ++n) {
+		double t = n / 30.0;
+		double x = 100 * cos(M_PI * t), y = 100 * sin(M_PI * t);
+		double xLater = 100 * cos(M_PI * (t + latency)), yLater = 100 * sin(M_PI * (t + latency));
+		float measured[2] = { (float)x + noise(random), (float)y + noise(random) };
+		float filtered[2], predicted[2];
+		ar_filter_update(filter, measured, t, latency, filtered, predicted);
+		if (n < 30) continue;
+
+		rawError += hypot(measured[0] - x, measured[1] - y);
+		filteredError += hypot(filtered[0] - x, filtered[1] - y);
+		staleError += hypot(filtered[0] - xLater, filtered[1] - yLater);
+		predictedError += hypot(predicted[0] - xLater, predicted[1] - yLater);
+		++counted;
+	}
+	ar_filter_destroy(filter);
+
+	printf("%-9s raw %6.2f px  filtered %6.2f px  | %3.0f ms later: filtered %6.2f px  predicted %6.2f px\n",
+		type == AR_FILTER_KALMAN ? "Kalman" : "One Euro", rawError / counted, filteredError / counted,
+		latency * 1000, staleError / counted, predictedError / counted);
+}
+
+int main(int argc, char **argv) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+
+	// Two hands, and five faces of 478 landmarks, of x, y, z
+	const int CHANNELS[] = { 2 * 21 * 3, 5 * 478 * 3 };
+	for (int type = AR_FILTER_ONE_EURO; type <= AR_FILTER_KALMAN; ++type) {
+		for (int channels : CHANNELS) {
+			ArFilterParams params;
+			ar_filter_default_params(&params, type);
+			ArFilter *filter = ar_filter_create(channels, &params);
+			timeUpdates(filter, channels, iterations / 10);
+			double us = timeUpdates(filter, channels, iterations);
+			printf("%-9s %6d channels: %8.3f us per update, %6.2f ns per channel\n",
+				type == AR_FILTER_KALMAN ? "Kalman" : "One Euro", channels, us, us * 1000 / channels);
+			ar_filter_destroy(filter);
+		}
+	}
+
+	for (int type = AR_FILTER_ONE_EURO; type <= AR_FILTER_KALMAN; ++type) measureAccuracy(type, 0.05f);
+	return 0;
+}
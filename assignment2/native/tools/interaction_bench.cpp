@@ -0,0 +1,130 @@
+// Times a frame of hand interaction (moving 1% of the objects, then the
+// fingertip and pinch queries of two hands) against the object count, at
+// a constant density, and checks the grid against a brute force search of
+// the same fingertips.
+//
+//   interaction_bench [frames]
+
+#include <arnative.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Objects of 1-3 cm radius, one per 10 cm cube on average
+static const float OBJECT_SPACING = 10.0f;
+
+static void makeHand(float *hand, const float *center, bool pinching) {
+	for (int i = 0; i < AR_HAND_LANDMARKS; ++i) {
+		hand[i * 3] = center[0] + (i % 5) * 2.0f - 4.0f;
+		hand[i * 3 + 1] = center[1] + (i / 5) * 2.0f;
+		hand[i * 3 + 2] = center[2];
+	}
+	// Thumb and index tips
+	float gap = pinching ? 0.5f : 6.0f;
+	hand[4 * 3] = center[0] - gap / 2;
+	hand[8 * 3] = center[0] + gap / 2;
+	hand[4 * 3 + 1] = hand[8 * 3 + 1] = center[1];
+	hand[4 * 3 + 2] = hand[8 * 3 + 2] = center[2];
+}
+
+int main(int argc, char **argv) {
+	int frames = argc > 1 ? atoi(argv[1]) : 2000;
+	const float FINGERTIP_RADIUS = 1.5f;
+	const float PINCH_DISTANCE = 2.0f;
+
+	printf("%9s %10s %14s %14s %10s\n", "objects", "moves us", "hands us", "brute us", "mismatches");
+	for (int count = 1000; count <= 1000000; count *= 10) {
+		std::mt19937 random(count);
+		float extent = cbrtf((float)count) * OBJECT_SPACING;
+		std::uniform_real_distribution<float> coordinate(0.0f, extent);
+		std::uniform_real_distribution<float> radius(1.0f, 3.0f);
+
+		ArInteraction *world = ar_interaction_create(FINGERTIP_RADIUS + 3.0f);
+		std::vector<float> positions((size_t)count * 3), radii(count);
+		for (int i = 0; i < count; ++i) {
+			for (int k = 0; k < 3; ++k) positions[i * 3 + k] = coordinate(random);
+			radii[i] = radius(random);
+			ar_interaction_add_object(world, &positions[i * 3], radii[i]);
+		}
+
+		int moved = std::max(count / 100, 1);
+		std::vector<int> movedIds(moved);
+		std::vector<float> movedPositions(moved * 3);
+		float hands[2 * AR_HAND_LANDMARKS * 3];
+		ArContactEvent events[256];
+		int ids[4096];
+		int mismatches = 0;
+
+		double moveUs = 0.0, handUs = 0.0, bruteUs = 0.0;
+		for (int f = 0; f < frames; ++f) {
+			for (int i = 0; i < moved; ++i) {
+				int id = random() % count;
+				movedIds[i] = id;
+				for (int k = 0; k < 3; ++k) {
+					positions[id * 3 + k] = std::min(std::max(positions[id * 3 + k] + coordinate(random) * 0.001f - extent * 0.0005f, 0.0f), extent);
+					movedPositions[i * 3 + k] = positions[id * 3 + k];
+				}
+			}
+			float center[3] = { coordinate(random), coordinate(random), coordinate(random) };
+			makeHand(hands, center, f % 10 < 5);
+			center[0] = coordinate(random);
+			makeHand(hands + AR_HAND_LANDMARKS * 3, center, false);
+
+			auto begin = std::chrono::steady_clock::now();
+			ar_interaction_move_objects(world, &movedIds[0], &movedPositions[0], moved);
+			auto middle = std::chrono::steady_clock::now();
+			ar_interaction_update_hands(world, hands, 2, FINGERTIP_RADIUS, PINCH_DISTANCE, events, 256);
+			auto end = std::chrono::steady_clock::now();
+			moveUs += std::chrono::duration<double, std::micro>(middle - begin).count();
+			handUs += std::chrono::duration<double, std::micro>(end - middle).count();
+
+			// The same fingertip queries by brute force, on a few frames
+			if (f % 20 != 0) continue;
+			begin = std::chrono::steady_clock::now();
+			for (int h = 0; h < 2; ++h) {
+				for (int tip = 4; tip <= 20; tip += 4) {
+					const float *p = hands + (h * AR_HAND_LANDMARKS + tip) * 3;
+					std::vector<int> expected;
+					for (int i = 0; i < count; ++i) {
+						float dx = positions[i * 3] - p[0], dy = positions[i * 3 + 1] - p[1], dz = positions[i * 3 + 2] - p[2];
+						float limit = FINGERTIP_RADIUS + radii[i];
+						if (dx * dx + dy * dy + dz * dz <= limit * limit) expected.push_back(i);
+					}
+					int found = ar_interaction_query_sphere(world, p, FINGERTIP_RADIUS, ids, 4096);
+					std::sort(ids, ids + found);
+					if (expected != std::vector<int>(ids, ids + found)) ++mismatches;
+				}
+			}
+			end = std::chrono::steady_clock::now();
+			bruteUs += std::chrono::duration<double, std::micro>(end - begin).count();
+		}
+		ar_interaction_destroy(world);
+
+		printf("%9d %10.2f %14.2f %14.2f %10d\n", count, moveUs / frames, handUs / frames, bruteUs / ((frames + 19) / 20), mismatches);
+	}
+
+	// Grab sequence: touch, pinch, hold, open
+	ArInteraction *world = ar_interaction_create(5.0f);
+	float object[3] = { 0, 0, 0 };
+	int cube = ar_interaction_add_object(world, object, 3.0f);
+	float hand[AR_HAND_LANDMARKS * 3];
+	const char *NAMES[] = { "contact begin", "contact end", "grab begin", "grab end" };
+	for (int step = 0; step < 4; ++step) {
+		float center[3] = { 0, 0, step == 3 ? 50.0f : 1.0f };
+		makeHand(hand, center, step == 1 || step == 2);
+		ArContactEvent events[16];
+		int count = ar_interaction_update_hands(world, hand, 1, 1.5f, 2.0f, events, 16);
+		printf("step %d: grabbed %d;", step, ar_interaction_grabbed(world, 0));
+		for (int i = 0; i < count; ++i) printf(" %s %d", NAMES[events[i].type], events[i].object);
+		printf("\n");
+	}
+	(void)cube;
+	ar_interaction_destroy(world);
+	return 0;
+}
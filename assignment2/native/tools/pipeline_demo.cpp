@@ -0,0 +1,54 @@
+// Runs the pipeline headless on the synthetic source and prints the stage
+// statistics, to measure throughput and latency without a camera or GPU.
+//
+//   pipeline_demo [seconds] [inference_ms] [source_fps]
+
+#include <arnative.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <thread>
+
+int main(int argc, char **argv) {
+	double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+
+	ArPipelineConfig config;
+	ar_pipeline_default_config(&config);
+	if (argc > 2) config.synthetic_inference_ms = atof(argv[2]);
+	if (argc > 3) config.source_fps = atof(argv[3]);
+
+	ArPipeline *pipeline = ar_pipeline_create(&config);
+	if (!ar_pipeline_start(pipeline)) {
+		fprintf(stderr, "Failed to start the pipeline\n");
+		ar_pipeline_destroy(pipeline);
+		return 1;
+	}
+
+	// Consume frames on this thread the way a render loop would
+	auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+	double worstError = 0.0;
+	while (std::chrono::steady_clock::now() < end) {
+		ArFrame frame;
+		if (!ar_pipeline_acquire(pipeline, &frame, 100)) continue;
+		for (int h = 0; h < frame.hand_count; ++h) {
+			if (frame.errors[h] > worstError) worstError = frame.errors[h];
+		}
+		ar_pipeline_release(pipeline, &frame);
+	}
+
+	ArStageStats stats[8];
+	int count = ar_pipeline_stats(pipeline, stats, 8);
+	ar_pipeline_stop(pipeline);
+	ar_pipeline_destroy(pipeline);
+
+	printf("%-10s %9s %8s %8s %8s %8s %8s %8s\n", "stage", "processed", "dropped", "fps", "busy ms", "p50 ms", "p90 ms", "p99 ms");
+	for (int i = 0; i < count; ++i) {
+		printf("%-10s %9llu %8llu %8.1f %8.3f %8.2f %8.2f %8.2f\n", stats[i].name,
+			(unsigned long long)stats[i].processed, (unsigned long long)stats[i].dropped, stats[i].fps,
+			stats[i].busy_ms, stats[i].latency_p50_ms, stats[i].latency_p90_ms, stats[i].latency_p99_ms);
+	}
+	printf("Worst reprojection error: %.4f px\n", worstError);
+	return 0;
+}
@@ -0,0 +1,135 @@
+// Times the fused resize + mirror + BGR->RGB kernel against the same work
+// done as three separate passes over the frame (resize, then flip, then
+// channel swap, as cv2.resize/flip/cvtColor do), for 720p and 1080p camera
+// frames scaled to typical network input sizes.
+//
+//   preprocess_bench [iterations] [threads]
+
+#include <arnative.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+struct Image {
+	int width, height;
+	std::vector<unsigned char> pixels;
+
+	Image(int w, int h) : width(w), height(h), pixels((size_t)w * h * 3) {}
+	unsigned char *row(int y) { return &pixels[(size_t)y * width * 3]; }
+};
+
+static void sampleTable(int size, int source_size, std::vector<int> &first, std::vector<float> &weight) {
+	double scale = (double)source_size / size;
+	first.resize(size);
+	weight.resize(size);
+	for (int i = 0; i < size; ++i) {
+		double position = std::max((i + 0.5) * scale - 0.5, 0.0);
+		int f = std::min((int)position, source_size - 1);
+		first[i] = f;
+		weight[i] = f < source_size - 1 ? (float)(position - f) : 0.0f;
+	}
+}
+
+static void resizePass(Image &source, Image &destination) {
+	std::vector<int> xs, ys;
+	std::vector<float> wx, wy;
+	sampleTable(destination.width, source.width, xs, wx);
+	sampleTable(destination.height, source.height, ys, wy);
+	for (int y = 0; y < destination.height; ++y) {
+		const unsigned char *a = source.row(ys[y]);
+		const unsigned char *b = source.row(std::min(ys[y] + 1, source.height - 1));
+		unsigned char *out = destination.row(y);
+		for (int x = 0; x < destination.width; ++x) {
+			int x0 = xs[x] * 3, x1 = std::min(xs[x] + 1, source.width - 1) * 3;
+			for (int c = 0; c < 3; ++c) {
+				float top = a[x0 + c] + (a[x1 + c] - a[x0 + c]) * wx[x];
+				float bottom = b[x0 + c] + (b[x1 + c] - b[x0 + c]) * wx[x];
+				out[x * 3 + c] = (unsigned char)(top + (bottom - top) * wy[y] + 0.5f);
+			}
+		}
+	}
+}
+
+static void flipPass(Image &image) {
+	for (int y = 0; y < image.height; ++y) {
+		unsigned char *row = image.row(y);
+		for (int x = 0, mirrored = image.width - 1; x < mirrored; ++x, --mirrored) {
+			for (int c = 0; c < 3; ++c) std::swap(row[x * 3 + c], row[mirrored * 3 + c]);
+		}
+	}
+}
+
+static void swapPass(Image &image) {
+	unsigned char *p = &image.pixels[0];
+	for (size_t i = 0; i < image.pixels.size(); i += 3) std::swap(p[i], p[i + 2]);
+}
+
+template <class Function>
+static double timeMicroseconds(int iterations, Function function) {
+	function();
+	auto begin = std::chrono::steady_clock::now();
+	for (int n = 0; n < iterations; ++n) function();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 100;
+	int threads = argc > 2 ? atoi(argv[2]) : 0;
+
+	ArPreprocessor *single = ar_preprocess_create(1);
+	ArPreprocessor *pool = ar_preprocess_create(threads);
+	printf("%d threads in the pool\n\n", ar_preprocess_thread_count(pool));
+	printf("%-22s %12s %12s %12s %9s\n", "frame", "3 passes us", "fused 1t us", "fused Nt us", "max diff");
+
+	const int sizes[][4] = {
+		{ 1280, 720, 256, 256 },
+		{ 1280, 720, 640, 360 },
+		{ 1920, 1080, 256, 256 },
+		{ 1920, 1080, 640, 360 },
+		{ 1920, 1080, 1280, 720 },
+	};
+	std::mt19937 random(1);
+	for (const int *size : sizes) {
+		Image source(size[0], size[1]);
+		for (int y = 0; y < source.height; ++y) {
+			for (int x = 0; x < source.width * 3; ++x) {
+				source.row(y)[x] = (unsigned char)(128 + 100 * sin(x * 0.01 + y * 0.02) + random() % 16);
+			}
+		}
+		Image reference(size[2], size[3]), fused(size[2], size[3]);
+		int flags = AR_PREPROCESS_MIRROR | AR_PREPROCESS_SWAP_RB;
+
+		double separate = timeMicroseconds(iterations, [&]() {
+			resizePass(source, reference);
+			flipPass(reference);
+			swapPass(reference);
+		});
+		double one = timeMicroseconds(iterations, [&]() {
+			ar_preprocess_frame(single, &source.pixels[0], source.width, source.height, source.width * 3,
+				&fused.pixels[0], fused.width, fused.height, fused.width * 3, flags);
+		});
+		double many = timeMicroseconds(iterations, [&]() {
+			ar_preprocess_frame(pool, &source.pixels[0], source.width, source.height, source.width * 3,
+				&fused.pixels[0], fused.width, fused.height, fused.width * 3, flags);
+		});
+
+		int difference = 0;
+		for (size_t i = 0; i < fused.pixels.size(); ++i) {
+			difference = std::max(difference, abs((int)fused.pixels[i] - (int)reference.pixels[i]));
+		}
+		char name[32];
+		snprintf(name, sizeof(name), "%dx%d -> %dx%d", size[0], size[1], size[2], size[3]);
+		printf("%-22s %12.1f %12.1f %12.1f %9d\n", name, separate, one, many, difference);
+	}
+
+	ar_preprocess_destroy(single);
+	ar_preprocess_destroy(pool);
+	return 0;
+}
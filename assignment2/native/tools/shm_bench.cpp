@@ -0,0 +1,187 @@
+// Shared memory ring between two processes: a forked reader takes slots
+// from this process. Reports the latency from end_write in the writer to
+// begin_read returning in the reader, for small records sent one at a time,
+// and the rate of full 1080p RGB frames, next to the same frames through a
+// pipe.
+//
+//   shm_bench [messages] [frames]
+//   shm_bench --read NAME        read a ring written by another process (e.g. capture.py --shm)
+
+#include <arnative.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+static const int FRAME_WIDTH = 1920;
+static const int FRAME_HEIGHT = 1080;
+static const size_t FRAME_SIZE = (size_t)FRAME_WIDTH * FRAME_HEIGHT * 3;
+static const size_t RECORD_SIZE = 2 * 21 * 3 * sizeof(float);		// Two hands of 21 landmarks
+
+static uint64_t nowNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void sleepUs(int us) {
+	struct timespec delay = {0, us * 1000L};
+	nanosleep(&delay, nullptr);
+}
+
+static double percentile(std::vector<double> values, double p) {
+	if (values.empty()) return 0.0;
+	size_t index = std::min((size_t)(p * values.size()), values.size() - 1);
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+// Reads until the writer closes; latencies in microseconds. Touches every
+// frame so the pages are really read.
+static void readRing(ArShmRing *ring, std::vector<double> &latencies, uint64_t &bytes) {
+	ArShmSlot slot;
+	unsigned checksum = 0;
+	while (ar_shm_begin_read(ring, &slot, -1, 0) > 0) {
+		latencies.push_back((nowNs() - slot.header->publish_time_ns) / 1000.0);
+		for (uint32_t i = 0; i < slot.header->frame_size; i += 4096) checksum += slot.frame[i];
+		for (uint32_t i = 0; i < slot.header->record_size; ++i) checksum += slot.record[i];
+		bytes += slot.header->frame_size + slot.header->record_size;
+		ar_shm_end_read(ring);
+	}
+	if (checksum == 1) printf(" ");
+}
+
+static void printLatencies(const char *label, const std::vector<double> &latencies) {
+	printf("%-18s %zu messages, latency median %.1f us, p99 %.1f us, max %.1f us\n", label, latencies.size(),
+		percentile(latencies, 0.5), percentile(latencies, 0.99), percentile(latencies, 1.0));
+}
+
+static int readExternal(const char *name) {
+	ArShmRing *ring = ar_shm_open(name, 10000);
+	if (!ring) {
+		fprintf(stderr, "No ring %s\n", name);
+		return 1;
+	}
+	std::vector<double> latencies;
+	uint64_t bytes = 0;
+	uint64_t start = nowNs();
+	readRing(ring, latencies, bytes);
+	double seconds = (nowNs() - start) / 1e9;
+	printLatencies(name, latencies);
+	printf("%-18s %.1f slots/s, %.1f MB/s\n", "", latencies.size() / seconds, bytes / seconds / 1e6);
+	ar_shm_destroy(ring);
+	return 0;
+}
+
+// Child: reads the ring and reports; returns the exit status
+static int childReader(const char *name, const char *label) {
+	ArShmRing *ring = ar_shm_open(name, 5000);
+	if (!ring) return 1;
+	std::vector<double> latencies;
+	uint64_t bytes = 0;
+	readRing(ring, latencies, bytes);
+	printLatencies(label, latencies);
+	fflush(stdout);					// _exit does not
+	ar_shm_destroy(ring);
+	return 0;
+}
+
+static void runLatency(int messages) {
+	const char *name = "/arnative_bench_latency";
+	ArShmRing *ring = ar_shm_create(name, 4, 0, RECORD_SIZE);
+	pid_t reader = fork();
+	if (reader == 0) _exit(childReader(name, "records"));
+
+	// One at a time, so the time is the wakeup and not the queue
+	std::vector<float> landmarks(RECORD_SIZE / sizeof(float), 0.5f);
+	ArShmSlot slot;
+	for (int i = 0; i < messages; ++i) {
+		ar_shm_begin_write(ring, &slot, -1);
+		memcpy(slot.record, landmarks.data(), RECORD_SIZE);
+		slot.header->record_size = (uint32_t)RECORD_SIZE;
+		slot.header->record_count = 2;
+		ar_shm_end_write(ring);
+		sleepUs(500);
+	}
+	ar_shm_close_writer(ring);
+	waitpid(reader, nullptr, 0);
+	ar_shm_destroy(ring);
+}
+
+static void runFrames(int frames) {
+	const char *name = "/arnative_bench_frames";
+	ArShmRing *ring = ar_shm_create(name, 3, FRAME_SIZE, RECORD_SIZE);
+	pid_t reader = fork();
+	if (reader == 0) _exit(childReader(name, "1080p frames"));
+
+	// The writer fills the slot in place, as a capture would
+	std::vector<unsigned char> source(FRAME_SIZE, 128);
+	ArShmSlot slot;
+	uint64_t start = nowNs();
+	for (int i = 0; i < frames; ++i) {
+		ar_shm_begin_write(ring, &slot, -1);
+		source[0] = (unsigned char)i;
+		memcpy(slot.frame, source.data(), FRAME_SIZE);
+		ArShmHeader *header = slot.header;
+		header->width = FRAME_WIDTH;
+		header->height = FRAME_HEIGHT;
+		header->stride = FRAME_WIDTH * 3;
+		header->channels = 3;
+		header->frame_size = (uint32_t)FRAME_SIZE;
+		ar_shm_end_write(ring);
+	}
+	ar_shm_close_writer(ring);
+	waitpid(reader, nullptr, 0);
+	double seconds = (nowNs() - start) / 1e9;
+	printf("%-18s %.1f frames/s, %.2f GB/s\n", "", frames / seconds, frames * FRAME_SIZE / seconds / 1e9);
+	ar_shm_destroy(ring);
+}
+
+// The same frames written to a pipe and read into a buffer of the reader
+static void runPipe(int frames) {
+	int fds[2];
+	if (pipe(fds) != 0) return;
+	pid_t reader = fork();
+	if (reader == 0) {
+		close(fds[1]);
+		std::vector<unsigned char> frame(FRAME_SIZE);
+		size_t done = 0;
+		ssize_t got;
+		while ((got = read(fds[0], frame.data() + done, FRAME_SIZE - done)) > 0) done = (done + got) % FRAME_SIZE;
+		_exit(0);
+	}
+	close(fds[0]);
+	std::vector<unsigned char> source(FRAME_SIZE, 128);
+	uint64_t start = nowNs();
+	for (int i = 0; i < frames; ++i) {
+		size_t done = 0;
+		while (done < FRAME_SIZE) {
+			ssize_t put = write(fds[1], source.data() + done, FRAME_SIZE - done);
+			if (put <= 0) break;
+			done += put;
+		}
+	}
+	close(fds[1]);
+	waitpid(reader, nullptr, 0);
+	double seconds = (nowNs() - start) / 1e9;
+	printf("%-18s %.1f frames/s, %.2f GB/s\n", "1080p pipe", frames / seconds, frames * FRAME_SIZE / seconds / 1e9);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 2 && strcmp(argv[1], "--read") == 0) return readExternal(argv[2]);
+
+	int messages = argc > 1 ? atoi(argv[1]) : 2000;
+	int frames = argc > 2 ? atoi(argv[2]) : 300;
+	printf("%ld CPUs online\n", sysconf(_SC_NPROCESSORS_ONLN));
+	fflush(stdout);
+	runLatency(messages);
+	runFrames(frames);
+	runPipe(frames);
+	return 0;
+}
@@ -0,0 +1,198 @@
+// Detect-then-track on a synthetic sequence with known landmark positions:
+// two textured discs ("hands", 21 landmarks each) turning, scaling and
+// moving over a textured background, with sensor noise. The detector is
+// simulated by the true positions plus Gaussian jitter, and only runs when
+// the tracker asks for it. Reports how often the detector ran, the error
+// of the landmarks against the truth next to the error of running the
+// detector on every frame, and the tracking time per frame.
+//
+//   tracker_bench [frames] [max speed px/frame] [detector jitter px] [max track frames]
+
+#include <arnative.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+static const int WIDTH = 960;
+static const int HEIGHT = 540;
+static const int OBJECTS = 2;
+static const int LANDMARKS = 21;
+static const float DISC_RADIUS = 90.0f;
+
+// Smooth value noise, three octaves, in [0, 255]
+static float hashValue(int x, int y, int seed) {
+	uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u + (uint32_t)seed * 2246822519u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	return (float)((h ^ (h >> 16)) & 0xFFFF) / 65535.0f;
+}
+
+static float valueNoise(float x, float y, int seed) {
+	int ix = (int)floorf(x), iy = (int)floorf(y);
+	float fx = x - ix, fy = y - iy;
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fy = fy * fy * (3.0f - 2.0f * fy);
+	float a = hashValue(ix, iy, seed), b = hashValue(ix + 1, iy, seed);
+	float c = hashValue(ix, iy + 1, seed), d = hashValue(ix + 1, iy + 1, seed);
+	return a + (b - a) * fx + (c - a) * fy + (a - b - c + d) * fx * fy;
+}
+
+static float texture(float x, float y, int seed) {
+	return 255.0f * (0.5f * valueNoise(x / 40.0f, y / 40.0f, seed) + 0.3f * valueNoise(x / 9.0f, y / 9.0f, seed + 1) +
+		0.2f * valueNoise(x / 3.5f, y / 3.5f, seed + 2));
+}
+
+// Similarity transform of object k at frame t: local disc coordinates to image
+struct Pose {
+	float cx, cy, angle, scale;
+
+	void apply(float x, float y, float &u, float &v) const {
+		float c = cosf(angle) * scale, s = sinf(angle) * scale;
+		u = cx + c * x - s * y;
+		v = cy + s * x + c * y;
+	}
+	void invert(float u, float v, float &x, float &y) const {
+		float c = cosf(angle) / scale, s = sinf(angle) / scale;
+		u -= cx;
+		v -= cy;
+		x = c * u + s * v;
+		y = -s * u + c * v;
+	}
+};
+
+static Pose objectPose(int k, int t, float speed) {
+	// Sinusoidal paths whose peak speed is about speed px per frame
+	float phase = 1.7f * k;
+	float amplitude = 180.0f;
+	float w = speed / amplitude;
+	Pose pose;
+	pose.cx = WIDTH * (0.3f + 0.4f * k) + amplitude * 0.6f * sinf(w * t + phase);
+	pose.cy = HEIGHT * 0.5f + amplitude * 0.5f * sinf(0.7f * w * t + 2.0f * phase);
+	pose.angle = 0.4f * sinf(0.5f * w * t + phase);
+	pose.scale = 1.0f + 0.15f * sinf(0.3f * w * t + phase);
+	return pose;
+}
+
+static void renderFrame(int t, float speed, std::mt19937 &random, std::vector<unsigned char> &image) {
+	std::normal_distribution<float> noise(0.0f, 2.0f);
+	Pose poses[OBJECTS];
+	for (int k = 0; k < OBJECTS; ++k) poses[k] = objectPose(k, t, speed);
+	for (int v = 0; v < HEIGHT; ++v) {
+		for (int u = 0; u < WIDTH; ++u) {
+			float value = texture((float)u, (float)v, 1);
+			for (int k = OBJECTS - 1; k >= 0; --k) {
+				float x, y;
+				poses[k].invert((float)u, (float)v, x, y);
+				if (x * x + y * y < DISC_RADIUS * DISC_RADIUS) {
+					value = texture(x + 1000.0f * (k + 1), y, 10 + k);
+					break;
+				}
+			}
+			unsigned char gray = (unsigned char)std::min(std::max(value + noise(random), 0.0f), 255.0f);
+			unsigned char *pixel = &image[(v * WIDTH + u) * 3];
+			pixel[0] = pixel[1] = pixel[2] = gray;
+		}
+	}
+}
+
+static double percentile(std::vector<float> values, double p) {
+	if (values.empty()) return 0.0;
+	size_t index = std::min((size_t)(p * values.size()), values.size() - 1);
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+int main(int argc, char **argv) {
+	int frames = argc > 1 ? atoi(argv[1]) : 300;
+	float speed = argc > 2 ? (float)atof(argv[2]) : 6.0f;
+	float jitter = argc > 3 ? (float)atof(argv[3]) : 1.0f;
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::normal_distribution<float> detectorNoise(0.0f, jitter);
+
+	// Landmarks inside the discs
+	std::vector<float> local(OBJECTS * LANDMARKS * 2);
+	for (size_t i = 0; i < local.size(); i += 2) {
+		float x, y;
+		do {
+			x = unit(random);
+			y = unit(random);
+		} while (x * x + y * y > 1.0f);
+		local[i] = 0.75f * DISC_RADIUS * x;
+		local[i + 1] = 0.75f * DISC_RADIUS * y;
+	}
+
+	ArTrackerParams params;
+	ar_tracker_default_params(&params);
+	if (argc > 4) params.max_track_frames = atoi(argv[4]);
+	ArTracker *tracker = ar_tracker_create(LANDMARKS, &params);
+
+	std::vector<unsigned char> image(WIDTH * HEIGHT * 3);
+	std::vector<float> truth(local.size()), detected(local.size()), points(local.size());
+	std::vector<unsigned char> status(OBJECTS * LANDMARKS);
+	std::vector<float> trackedErrors, detectorErrors;
+	std::vector<double> trackMs;
+	int detections = 0;
+	int pointsLost = 0;
+
+	for (int t = 0; t < frames; ++t) {
+		renderFrame(t, speed, random, image);
+		for (int k = 0; k < OBJECTS; ++k) {
+			Pose pose = objectPose(k, t, speed);
+			for (int i = 0; i < LANDMARKS; ++i) {
+				int j = (k * LANDMARKS + i) * 2;
+				pose.apply(local[j], local[j + 1], truth[j], truth[j + 1]);
+				detected[j] = truth[j] + detectorNoise(random);
+				detected[j + 1] = truth[j + 1] + detectorNoise(random);
+			}
+		}
+
+		bool tracked = false;
+		if (t > 0) {
+			auto start = std::chrono::steady_clock::now();
+			tracked = ar_tracker_track(tracker, image.data(), WIDTH, HEIGHT, WIDTH * 3, 3, points.data(),
+				status.data(), nullptr) != 0;
+			trackMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			for (unsigned char s : status) pointsLost += s ? 0 : 1;
+		}
+		if (!tracked) {
+			// The tracker asked for the detector; its pyramid of this frame is reused
+			++detections;
+			points = detected;
+			ar_tracker_set_points(tracker, t > 0 ? nullptr : image.data(), WIDTH, HEIGHT, WIDTH * 3, 3,
+				points.data(), OBJECTS);
+		}
+
+		for (size_t j = 0; j < truth.size(); j += 2) {
+			trackedErrors.push_back(hypotf(points[j] - truth[j], points[j + 1] - truth[j + 1]));
+			detectorErrors.push_back(hypotf(detected[j] - truth[j], detected[j + 1] - truth[j + 1]));
+		}
+	}
+	ar_tracker_destroy(tracker);
+
+	double meanTracked = 0.0, meanDetector = 0.0;
+	for (float e : trackedErrors) meanTracked += e;
+	for (float e : detectorErrors) meanDetector += e;
+	meanTracked /= trackedErrors.size();
+	meanDetector /= detectorErrors.size();
+	std::vector<float> times(trackMs.begin(), trackMs.end());
+
+	printf("%d frames of %dx%d, %d x %d landmarks, up to %.1f px/frame, detector jitter %.1f px, detection at least every %d frames\n",
+		frames, WIDTH, HEIGHT, OBJECTS, LANDMARKS, speed, jitter, params.max_track_frames);
+	printf("detector runs       %d (%.1f%% of frames, %.1fx fewer)\n", detections, 100.0 * detections / frames,
+		(double)frames / detections);
+	printf("points lost         %.2f%% of tracked points\n",
+		100.0 * pointsLost / std::max((size_t)1, (size_t)(frames - 1) * status.size()));
+	printf("error, every frame  mean %.2f px, p95 %.2f px, max %.2f px\n", meanDetector,
+		percentile(detectorErrors, 0.95), percentile(detectorErrors, 1.0));
+	printf("error, tracked      mean %.2f px, p95 %.2f px, max %.2f px\n", meanTracked,
+		percentile(trackedErrors, 0.95), percentile(trackedErrors, 1.0));
+	printf("tracking            median %.3f ms, p95 %.3f ms per frame\n", percentile(times, 0.5), percentile(times, 0.95));
+	return 0;
+}
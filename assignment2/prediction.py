@@ -8,6 +8,8 @@ import numpy as np
 import cv2
 import time
 
+import arnative
+
 # Create a MediaPipe HandLandmarker detector. 
 # Requires MediaPipe 0.9.1 and above.
 base_options = python.BaseOptions(model_asset_path='hand_landmarker.task')
@@ -27,6 +29,31 @@ def predict(frame):
     detection_result = detector.detect(mp_image)
     return detection_result 
 
+def track_or_predict(frame, tracker, last_result):
+    """
+    Detect-then-track: follow the landmarks of last_result into frame with
+    optical flow (arnative.LandmarkTracker), and only run the detector when
+    the tracker asks for it. Returns the detection result for frame and
+    whether the detector ran. Tracked results keep the world landmarks of
+    the last detection.
+    """
+    frame_height, frame_width = frame.shape[:2]
+    scale = np.float32([frame_width, frame_height])
+    tracking = bool(last_result and last_result.hand_landmarks)
+    tracked = tracker.track(frame) if tracking else None
+    if tracked is None:
+        detection_result = predict(frame)
+        if detection_result and detection_result.hand_landmarks:
+            # without a track() call on this frame the tracker needs the frame itself
+            points = landmarks_array(detection_result.hand_landmarks)[:, :, :2] * scale
+            tracker.set_points(points, None if tracking else frame)
+        return detection_result, True
+
+    for points, landmarks in zip(tracked[0] / scale, last_result.hand_landmarks):
+        for p, l in zip(points, landmarks):
+            l.x, l.y = float(p[0]), float(p[1])
+    return last_result, False
+
 def draw_landmarks_on_image(image, detection_result):
     """
     A helper function to draw the detected 2D landmarks on an image 
@@ -102,6 +129,42 @@ def get_matrix44(rvec, tvec):
 	T[:3, 3] = tvec
 	return T
 
+def landmarks_array(landmarks_list):
+    """
+    Stack the landmarks of all hands into one H x 21 x 3 float32 array
+    """
+    if isinstance(landmarks_list, np.ndarray):
+        return landmarks_list.astype(np.float32, copy=False)
+    coordinates = [(l.x, l.y, l.z) for landmarks in landmarks_list for l in landmarks]
+    return np.array(coordinates, dtype=np.float32).reshape(len(landmarks_list), -1, 3)
+
+def solvepnp_batch(model_landmarks_list, image_landmarks_list, 
+                   camera_matrix, frame_width, frame_height): 
+    """
+    Same as solvepnp followed by reproject, for all hands in one call to the 
+    native library (see arnative.py). The reprojection comes out of the solver's 
+    last pass instead of a second loop.
+    
+    Output: 
+      world_landmarks_list, reprojection_error, reprojection_points_list, 
+      for the hands the solver succeeded on only
+    """
+    if not model_landmarks_list:
+        return [], 0.0, []
+    
+    model_points = landmarks_array(model_landmarks_list)
+    image_points = landmarks_array(image_landmarks_list)[:, :, :2] * np.float32([frame_width, frame_height])
+    rvecs, tvecs, world_points, reprojected, errors = arnative.solve_pnp_batch(model_points, image_points, camera_matrix)
+    
+    # Hands the solver failed on (error -1) have no pose: leave them out
+    solved = errors >= 0
+    if not solved.any():
+        return [], 0.0, []
+    
+    # Same error as reproject(): per point residual norm, averaged over the hands
+    reprojection_error = float(np.mean(errors[solved]))
+    return list(world_points[solved]), reprojection_error, list(reprojected[solved])
+
 def solvepnp(model_landmarks_list, image_landmarks_list, 
             camera_matrix, frame_width, frame_height): 
     """
@@ -118,6 +181,11 @@ def solvepnp(model_landmarks_list, image_landmarks_list,
     if not model_landmarks_list:
         return []
     
+    if arnative.available():
+        world_landmarks_list, _, _ = solvepnp_batch(model_landmarks_list, image_landmarks_list, 
+                                                    camera_matrix, frame_width, frame_height)
+        return world_landmarks_list
+    
     world_landmarks_list = []
     
     for (model_landmarks, image_landmarks) in zip(model_landmarks_list, image_landmarks_list):
@@ -165,7 +233,7 @@ def reproject(world_landmarks_list, image_landmarks_list,
         reprojection_points_list.append(output[:, :2])
     
         # Calculate the reprojection error, per point
-        image_points = np.float32([[l.x * frame_width, l.y * frame_height] for l in image_landmarks])
+        image_points = landmarks_array([image_landmarks])[0, :, :2] * np.float32([frame_width, frame_height])
         reprojection_error += np.linalg.norm(output[:, :2] - image_points) / len(output) / len(world_landmarks_list)
     
     return reprojection_error, reprojection_points_list
@@ -181,11 +249,29 @@ if __name__ == '__main__':
     previousTime = 0
     currentTime = 0
 
+    # Smooth the image landmarks, and extrapolate them by the time it takes
+    # from capture to display, so the overlay follows the hand and not where
+    # it was when the frame was captured
+    landmark_filter = None
+    preprocessor = None
+    tracker = None
+    if arnative.available():
+        landmark_filter = arnative.LandmarkFilter((2, 21, 2))
+        preprocessor = arnative.Preprocessor()
+        # the detector only runs every few frames, the landmarks are tracked in between
+        tracker = arnative.LandmarkTracker(21)
+    filtered_hands = 0
+    latency = 0.0
+    detection_result = None
+    frame_count = 0
+    detector_runs = 0
+
     print("[DEBUG] Webcam loop started")
     print("[DEBUG] Press ESC to quit")
     
     while capture.isOpened():
         # capture frame by frame
+        capture_time = time.perf_counter()
         ret, frame = capture.read()
         if not ret:
             print("[DEBUG] Failed to read frame from camera")
@@ -193,14 +279,24 @@ if __name__ == '__main__':
     
         # resizing the frame for better view
         aspect_ratio = frame.shape[1] / frame.shape[0]
-        frame = cv2.resize(frame, (int(720 * aspect_ratio), 720))
-        frame = cv2.flip(frame, 1)
+        if preprocessor is not None:
+            # resize, flip and BGR to RGB in one pass
+            frame = preprocessor(frame, (int(720 * aspect_ratio), 720), mirror=True, swap_rb=True)
+        else:
+            frame = cv2.resize(frame, (int(720 * aspect_ratio), 720))
+            frame = cv2.flip(frame, 1)
 
-        # Converting the from BGR to RGB
-        frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB)
+            # Converting the from BGR to RGB
+            frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB)
     
         # Making predictions
-        detection_result = predict(frame)
+        frame_count += 1
+        if tracker is not None:
+            detection_result, detected = track_or_predict(frame, tracker, detection_result)
+            detector_runs += int(detected)
+        else:
+            detection_result = predict(frame)
+            detector_runs += 1
     
         # Visualize 2D landmarks
         frame = draw_landmarks_on_image(frame, detection_result)
@@ -220,18 +316,41 @@ if __name__ == '__main__':
         if detection_result and detection_result.hand_landmarks:
             model_landmarks_list = detection_result.hand_world_landmarks
             image_landmarks_list = detection_result.hand_landmarks
-            # solve for hand pose in world space
-            world_landmarks_list = solvepnp(model_landmarks_list, image_landmarks_list, 
-                                            camera_matrix, frame_width, frame_height)
-            # reproject points for validation
-            reprojection_error, reprojection_points_list = reproject(world_landmarks_list, 
-                                                                        image_landmarks_list, 
-                                                                        camera_matrix, frame_width, frame_height)
+            if landmark_filter is not None:
+                hands = min(len(image_landmarks_list), 2)
+                if hands != filtered_hands:
+                    landmark_filter.reset()
+                    filtered_hands = hands
+                scale = np.float32([frame_width, frame_height])
+                image_landmarks = landmarks_array(image_landmarks_list[:hands])
+                measured = np.zeros((2, 21, 2), dtype=np.float32)
+                measured[:hands] = image_landmarks[:, :, :2] * scale
+                _, predicted = landmark_filter.update(measured, capture_time, latency)
+                image_landmarks[:, :, :2] = predicted[:hands] / scale
+                model_landmarks_list = model_landmarks_list[:hands]
+                image_landmarks_list = image_landmarks
+            if arnative.available():
+                # solve all hands and reproject in one native call
+                world_landmarks_list, reprojection_error, reprojection_points_list = solvepnp_batch(
+                    model_landmarks_list, image_landmarks_list, camera_matrix, frame_width, frame_height)
+            else:
+                # solve for hand pose in world space
+                world_landmarks_list = solvepnp(model_landmarks_list, image_landmarks_list, 
+                                                camera_matrix, frame_width, frame_height)
+                # reproject points for validation
+                reprojection_error, reprojection_points_list = reproject(world_landmarks_list, 
+                                                                            image_landmarks_list, 
+                                                                            camera_matrix, frame_width, frame_height)
+        else:
+            # the hands found next start new filter tracks
+            filtered_hands = 0
             
         for hand_landmarks in reprojection_points_list:
             for l in hand_landmarks:
                 cv2.circle(frame, (int(l[0]), int(l[1])), 3, (0, 0, 255), 2)
         
+        latency = 0.9 * latency + 0.1 * (time.perf_counter() - capture_time)
+        
         # Calculating the FPS
         currentTime = time.time()
         fps = 1 / (currentTime - previousTime)
@@ -249,6 +368,8 @@ if __name__ == '__main__':
             print("[DEBUG] ESC pressed, closing application")
             break
     
+    print(f"[DEBUG] Detector ran on {detector_runs} of {frame_count} frames")
+
     # When all the process is done
     # Release the capture and destroy all windows
     capture.release()
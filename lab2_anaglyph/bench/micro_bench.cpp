@@ -0,0 +1,460 @@
+// Micro-benchmarks of the math and simulation kernels the renderer runs
+// every frame: camera and projection matrices, the model transform chain,
+// mat4 products (scalar and glm's simd_mat4), sin, cos, atan2, exp and
+// inversesqrt (libm and glm's scalar fast_* next to the simd_math tiers),
+// the BlackHole update from 1K to 10M particles, the NBody step from 1K to
+// 1M bodies, and scene generation.
+//
+// Each benchmark is warmed up, then timed in repetitions of enough calls
+// to last --min-sample-ms; the statistics are over the repetitions, in
+// nanoseconds per item (matrix, particle, body, box).
+//
+//   micro_bench [--json file] [--filter text] [--repetitions n] [--cpu n]
+//               [--max-particles n] [--min-sample-ms ms]
+
+#include <scene/scene.h>
+#include <util/benchmark.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/fast_exponential.hpp>
+#include <glm/gtx/fast_square_root.hpp>
+#include <glm/gtx/fast_trigonometry.hpp>
+#include <glm/gtx/simd_math.hpp>
+#if GLM_ARCH & GLM_ARCH_SSE2
+#include <glm/gtx/simd_mat4.hpp>
+#define MICRO_BENCH_SIMD_MAT4
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Inputs cycle through this many values so nothing is constant folded
+static const int INPUT_COUNT = 1024;
+
+struct Benchmark {
+	std::string name;
+	int64_t items;					// Per call of run
+	std::function<void()> setup;	// Untimed, once before the warmup
+	std::function<void()> run;
+	std::function<void()> teardown = nullptr;	// Untimed, once after the samples
+};
+
+struct BenchmarkOptions {
+	int repetitions = 20;
+	double minSampleMs = 5.0;
+	double warmupMs = 50.0;
+	double maxSeconds = 5.0;		// Fewer repetitions (at least 3) for slow benchmarks
+};
+
+struct BenchmarkResult {
+	std::string name;
+	int64_t items;
+	int64_t callsPerSample;
+	SampleStats nsPerItem;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static BenchmarkResult runBenchmark(Benchmark &benchmark, const BenchmarkOptions &options) {
+	if (benchmark.setup) benchmark.setup();
+
+	// Warmup, which also measures the time of a call
+	auto begin = std::chrono::steady_clock::now();
+	int64_t warmupCalls = 0;
+	do {
+		benchmark.run();
+		++warmupCalls;
+	} while (elapsedMs(begin) < options.warmupMs);
+	double callMs = elapsedMs(begin) / warmupCalls;
+
+	int64_t calls = std::max((int64_t)(options.minSampleMs / callMs), (int64_t)1);
+	int repetitions = options.repetitions;
+	double sampleMs = calls * callMs;
+	if (sampleMs * repetitions > options.maxSeconds * 1000.0) {
+		repetitions = std::max((int)(options.maxSeconds * 1000.0 / sampleMs), 3);
+	}
+
+	std::vector<double> samples;
+	for (int r = 0; r < repetitions; ++r) {
+		auto sampleBegin = std::chrono::steady_clock::now();
+		for (int64_t c = 0; c < calls; ++c) benchmark.run();
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - sampleBegin).count();
+		samples.push_back(ns / ((double)calls * benchmark.items));
+	}
+
+	if (benchmark.teardown) benchmark.teardown();
+
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.items = benchmark.items;
+	result.callsPerSample = calls;
+	result.nsPerItem = ComputeStats(samples);
+	return result;
+}
+
+// Inputs shared by the matrix benchmarks
+struct MatrixInputs {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> axes;
+	std::vector<float> angles;
+	std::vector<glm::mat4> a, b, c;
+
+	MatrixInputs() {
+		srand(1);
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			glm::vec3 random(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX);
+			positions.push_back(200.0f * random - 100.0f);
+			axes.push_back(glm::normalize(random - 0.5f + glm::vec3(0.01f)));
+			angles.push_back(6.2831853f * random.x);
+		}
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			a.push_back(glm::rotate(glm::translate(glm::mat4(1.0f), positions[i]), angles[i], axes[i]));
+			b.push_back(glm::scale(glm::rotate(glm::mat4(1.0f), angles[(i + 1) % INPUT_COUNT], axes[(i + 7) % INPUT_COUNT]), glm::vec3(1.5f)));
+		}
+		c.resize(INPUT_COUNT);
+	}
+};
+
+static void addMatrixBenchmarks(std::vector<Benchmark> &benchmarks, MatrixInputs &in) {
+	benchmarks.push_back({ "lookAt", INPUT_COUNT, nullptr, [&in]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			in.c[i] = glm::lookAt(in.positions[i], glm::vec3(0.0f), glm::vec3(0, 1, 0));
+		}
+		DoNotOptimize(in.c[0]);
+	} });
+
+	benchmarks.push_back({ "perspective", INPUT_COUNT, nullptr, [&in]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			in.c[i] = glm::perspective(0.5f + 0.001f * i, 4.0f / 3.0f, 0.1f, 1000.0f);
+		}
+		DoNotOptimize(in.c[0]);
+	} });
+
+	benchmarks.push_back({ "frustum", INPUT_COUNT, nullptr, [&in]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			float shift = in.positions[i].x * 0.001f;
+			in.c[i] = glm::frustum(-0.1f + shift, 0.1f + shift, -0.075f, 0.075f, 0.1f, 1000.0f);
+		}
+		DoNotOptimize(in.c[0]);
+	} });
+
+	// The model matrix of a box, as built by the scenes
+	benchmarks.push_back({ "translate_rotate_scale", INPUT_COUNT, nullptr, [&in]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), in.positions[i]);
+			model = glm::rotate(model, in.angles[i], in.axes[i]);
+			in.c[i] = glm::scale(model, glm::vec3(2.0f));
+		}
+		DoNotOptimize(in.c[0]);
+	} });
+
+	benchmarks.push_back({ "mat4_multiply/scalar", INPUT_COUNT, nullptr, [&in]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.c[i] = in.a[i] * in.b[i];
+		DoNotOptimize(in.c[0]);
+	} });
+
+#ifdef MICRO_BENCH_SIMD_MAT4
+	// simdMat4 needs 16 byte alignment, which std::vector of it does not
+	// guarantee before C++17; the inputs are converted once, untimed
+	struct SimdInputs {
+		glm::simdMat4 *a = nullptr, *b = nullptr, *c = nullptr;
+		std::vector<char> storage;
+	};
+	std::shared_ptr<SimdInputs> simd = std::make_shared<SimdInputs>();
+	benchmarks.push_back({ "mat4_multiply/simd_mat4", INPUT_COUNT, [simd, &in]() {
+		simd->storage.resize(3 * INPUT_COUNT * sizeof(glm::simdMat4) + 16);
+		char *base = &simd->storage[0];
+		base += (16 - ((uintptr_t)base & 15)) & 15;
+		simd->a = (glm::simdMat4 *)base;
+		simd->b = simd->a + INPUT_COUNT;
+		simd->c = simd->b + INPUT_COUNT;
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			simd->a[i] = glm::simdMat4(in.a[i]);
+			simd->b[i] = glm::simdMat4(in.b[i]);
+		}
+	}, [simd]() {
+		for (int i = 0; i < INPUT_COUNT; ++i) simd->c[i] = simd->a[i] * simd->b[i];
+		DoNotOptimize(simd->c[0]);
+	} });
+#endif
+}
+
+// Inputs of the transcendental benchmarks: angles over several turns, as
+// the scenes pass, and arguments in the range the scenes use exp for
+struct MathInputs {
+	std::vector<float> angles, y, x, exponents, squares;
+	std::vector<float> a, b;
+
+	MathInputs() {
+		srand(3);
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			float random = rand() / (float)RAND_MAX;
+			angles.push_back(100.0f * random - 50.0f);
+			y.push_back(rand() / (float)RAND_MAX - 0.5f);
+			x.push_back(rand() / (float)RAND_MAX - 0.5f);
+			exponents.push_back(20.0f * random - 10.0f);
+			squares.push_back(0.01f + 1000.0f * random);
+		}
+		a.resize(INPUT_COUNT);
+		b.resize(INPUT_COUNT);
+	}
+};
+
+// The kernels of one function: loops over the inputs calling libm and
+// glm's scalar approximation (gtx fast_*), and the array function of
+// simd_math at each tier
+struct SinKernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = sinf(in.angles[i]);
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = glm::fastSin(in.angles[i]);
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdSin<P>(&in.angles[0], &in.a[0], INPUT_COUNT);
+	}
+};
+
+struct CosKernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = cosf(in.angles[i]);
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = glm::fastCos(in.angles[i]);
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdCos<P>(&in.angles[0], &in.a[0], INPUT_COUNT);
+	}
+};
+
+struct SinCosKernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			in.a[i] = sinf(in.angles[i]);
+			in.b[i] = cosf(in.angles[i]);
+		}
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			in.a[i] = glm::fastSin(in.angles[i]);
+			in.b[i] = glm::fastCos(in.angles[i]);
+		}
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdSinCos<P>(&in.angles[0], &in.a[0], &in.b[0], INPUT_COUNT);
+	}
+};
+
+struct Atan2Kernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = atan2f(in.y[i], in.x[i]);
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = glm::fastAtan(in.y[i], in.x[i]);
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdAtan2<P>(&in.y[0], &in.x[0], &in.a[0], INPUT_COUNT);
+	}
+};
+
+struct ExpKernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = expf(in.exponents[i]);
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = glm::fastExp(in.exponents[i]);
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdExp<P>(&in.exponents[0], &in.a[0], INPUT_COUNT);
+	}
+};
+
+struct InversesqrtKernels {
+	static void libm(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = 1.0f / sqrtf(in.squares[i]);
+	}
+	static void glmFast(MathInputs &in) {
+		for (int i = 0; i < INPUT_COUNT; ++i) in.a[i] = glm::fastInverseSqrt(in.squares[i]);
+	}
+	template <glm::precision P> static void simd(MathInputs &in) {
+		glm::simdInversesqrt<P>(&in.squares[0], &in.a[0], INPUT_COUNT);
+	}
+};
+
+template <typename Kernels>
+static void addMathBenchmark(std::vector<Benchmark> &benchmarks, MathInputs &in, const std::string &name) {
+	benchmarks.push_back({ "transcendental/" + name + "/libm", INPUT_COUNT, nullptr, [&in]() {
+		Kernels::libm(in);
+		DoNotOptimize(in.a[0]);
+	} });
+	benchmarks.push_back({ "transcendental/" + name + "/glm_fast", INPUT_COUNT, nullptr, [&in]() {
+		Kernels::glmFast(in);
+		DoNotOptimize(in.a[0]);
+	} });
+	benchmarks.push_back({ "transcendental/" + name + "/simd_highp", INPUT_COUNT, nullptr, [&in]() {
+		Kernels::template simd<glm::highp>(in);
+		DoNotOptimize(in.a[0]);
+	} });
+	benchmarks.push_back({ "transcendental/" + name + "/simd_mediump", INPUT_COUNT, nullptr, [&in]() {
+		Kernels::template simd<glm::mediump>(in);
+		DoNotOptimize(in.a[0]);
+	} });
+	benchmarks.push_back({ "transcendental/" + name + "/simd_lowp", INPUT_COUNT, nullptr, [&in]() {
+		Kernels::template simd<glm::lowp>(in);
+		DoNotOptimize(in.a[0]);
+	} });
+}
+
+static void addMathBenchmarks(std::vector<Benchmark> &benchmarks, MathInputs &in) {
+	addMathBenchmark<SinKernels>(benchmarks, in, "sin");
+	addMathBenchmark<CosKernels>(benchmarks, in, "cos");
+	addMathBenchmark<SinCosKernels>(benchmarks, in, "sincos");
+	addMathBenchmark<Atan2Kernels>(benchmarks, in, "atan2");
+	addMathBenchmark<ExpKernels>(benchmarks, in, "exp");
+	addMathBenchmark<InversesqrtKernels>(benchmarks, in, "inversesqrt");
+}
+
+static void addSceneBenchmarks(std::vector<Benchmark> &benchmarks, int max_particles) {
+	// One animation step of 1/60 s, the scene generated once before
+	for (int count = 1000; count <= max_particles; count *= 10) {
+		std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+		std::shared_ptr<double> time = std::make_shared<double>(0.0);
+		benchmarks.push_back({ "blackhole_update/" + std::to_string(count), count, [scene, count]() {
+			srand(2024);
+			scene->generate(SceneMode::BlackHole, count);
+		}, [scene, time]() {
+			*time += 1.0 / 60.0;
+			scene->update(*time, 1.0f / 60.0f);
+			DoNotOptimize(scene->boxTransforms[1]);
+		}, [scene]() {
+			// The state is large; free it once measured
+			*scene = Scene();
+		} });
+	}
+
+	// One step of 1/120 s of the NBody scene: sort, tree build and forces,
+	// on the shared thread pool. The opening angle trades accuracy for time.
+	const float thetas[] = { 0.3f, 0.5f, 0.8f };
+	for (int count = 1000; count <= std::min(max_particles, 1000000); count *= 10) {
+		for (float theta : thetas) {
+			if (theta != 0.5f && count != 100000) continue;
+			std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+			char name[64];
+			snprintf(name, sizeof(name), "nbody_step/%d/theta_%.1f", count, theta);
+			benchmarks.push_back({ name, count, [scene, count, theta]() {
+				srand(2024);
+				scene->nbody.theta = theta;
+				scene->generate(SceneMode::NBody, count);
+			}, [scene]() {
+				scene->nbody.step();
+				DoNotOptimize(scene->nbody.positions()[0]);
+			}, [scene]() {
+				*scene = Scene();
+			} });
+		}
+	}
+
+	const int generateCounts[] = { 100, 10000 };
+	for (int count : generateCounts) {
+		std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+		benchmarks.push_back({ "generate/random_boxes/" + std::to_string(count), count, nullptr, [scene, count]() {
+			scene->generate(SceneMode::RandomBoxes, count);
+			DoNotOptimize(scene->boxTransforms[0]);
+		} });
+		benchmarks.push_back({ "generate/blackhole/" + std::to_string(count), count, nullptr, [scene, count]() {
+			scene->generate(SceneMode::BlackHole, count);
+			DoNotOptimize(scene->boxTransforms[0]);
+		} });
+	}
+}
+
+int main(int argc, char **argv) {
+	const char *jsonPath = nullptr;
+	const char *filter = nullptr;
+	int cpu = 0;
+	int maxParticles = 10000000;
+	BenchmarkOptions options;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		} else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+			options.repetitions = std::max(atoi(argv[++i]), 3);
+		} else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+			cpu = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--max-particles") == 0 && i + 1 < argc) {
+			maxParticles = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--min-sample-ms") == 0 && i + 1 < argc) {
+			options.minSampleMs = atof(argv[++i]);
+		} else {
+			fprintf(stderr, "Usage: %s [--json file] [--filter text] [--repetitions n] [--cpu n (-1: not pinned)]\n"
+				"\t[--max-particles n] [--min-sample-ms ms]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bool pinned = cpu >= 0 && PinCurrentThread(cpu);
+	if (cpu >= 0 && !pinned) fprintf(stderr, "Could not pin to CPU %d, timings may be noisier\n", cpu);
+
+	MatrixInputs inputs;
+	MathInputs mathInputs;
+	std::vector<Benchmark> benchmarks;
+	addMatrixBenchmarks(benchmarks, inputs);
+	addMathBenchmarks(benchmarks, mathInputs);
+	addSceneBenchmarks(benchmarks, maxParticles);
+
+	std::string build = BuildDescription();
+	printf("%s\n\n", build.c_str());
+	printf("%-40s %12s %12s %12s %8s %14s\n", "benchmark", "median ns", "min ns", "p90 ns", "cv %", "items/s");
+
+	std::vector<BenchmarkResult> results;
+	for (Benchmark &benchmark : benchmarks) {
+		if (filter && benchmark.name.find(filter) == std::string::npos) continue;
+		BenchmarkResult result = runBenchmark(benchmark, options);
+		const SampleStats &s = result.nsPerItem;
+		printf("%-40s %12.3f %12.3f %12.3f %8.2f %14.4g\n", result.name.c_str(), s.median, s.min, s.p90,
+			s.mean > 0 ? 100.0 * s.stddev / s.mean : 0.0, 1e9 / s.median);
+		fflush(stdout);
+		results.push_back(result);
+	}
+
+	if (jsonPath) {
+		FILE *file = strcmp(jsonPath, "-") == 0 ? stdout : fopen(jsonPath, "w");
+		if (!file) {
+			fprintf(stderr, "Failed to open %s\n", jsonPath);
+			return 1;
+		}
+		JsonWriter json(file);
+		json.beginObject();
+		json.value("build", build);
+		json.value("pinned_cpu", pinned ? cpu : -1);
+		json.value("unit", "ns per item");
+		json.beginArray("benchmarks");
+		for (const BenchmarkResult &result : results) {
+			json.beginObject();
+			json.value("name", result.name);
+			json.value("items_per_call", result.items);
+			json.value("calls_per_sample", result.callsPerSample);
+			json.stats("ns_per_item", result.nsPerItem);
+			json.endObject();
+		}
+		json.endArray();
+		json.endObject();
+		if (file != stdout) fclose(file);
+	}
+	return 0;
+}
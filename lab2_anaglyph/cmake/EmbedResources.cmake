@@ -0,0 +1,50 @@
+# Compiles a list of asset files into a C++ source file holding one constexpr
+# byte array per asset and a name-sorted lookup table (see render/resource.h).
+#
+# Run in script mode:
+#   cmake -DOUTPUT=<file.cpp> -DBASE_DIR=<dir> -DRESOURCES="a;b;c" -P EmbedResources.cmake
+#
+# Resource names are the paths relative to BASE_DIR, with forward slashes.
+
+if(NOT OUTPUT OR NOT BASE_DIR OR NOT RESOURCES)
+	message(FATAL_ERROR "EmbedResources.cmake needs OUTPUT, BASE_DIR and RESOURCES")
+endif()
+
+# Sort by name so the runtime lookup can binary search the table
+set(names "")
+foreach(resource ${RESOURCES})
+	file(RELATIVE_PATH name "${BASE_DIR}" "${resource}")
+	string(REPLACE "\\" "/" name "${name}")
+	list(APPEND names "${name}")
+endforeach()
+list(SORT names)
+
+set(arrays "")
+set(entries "")
+set(index 0)
+foreach(name ${names})
+	file(READ "${BASE_DIR}/${name}" hex HEX)
+	string(LENGTH "${hex}" hexLength)
+	math(EXPR size "${hexLength} / 2")
+
+	# 16 bytes per line, then turn every byte into a 0x.. literal
+	string(REGEX REPLACE "([0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f])" "\\1\n\t" hex "${hex}")
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+
+	# The trailing zero is not counted in the size; it lets text resources
+	# such as shaders be used as C strings without a copy.
+	string(APPEND arrays "// ${name}\nconstexpr unsigned char resource${index}[] = {\n\t${bytes}0x00\n};\n\n")
+	string(APPEND entries "\t{ \"${name}\", resource${index}, ${size} },\n")
+	math(EXPR index "${index} + 1")
+endforeach()
+
+set(content "// Generated by cmake/EmbedResources.cmake, do not edit.\n\n#include <render/resource.h>\n\nnamespace {\n\n${arrays}} // namespace\n\nextern const ResourceEntry embeddedResources[] = {\n${entries}};\n\nextern const size_t embeddedResourceCount = ${index};\n")
+
+# Only touch the output when it changes to avoid needless recompiles
+if(EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" previous)
+	if(previous STREQUAL content)
+		return()
+	endif()
+endif()
+file(WRITE "${OUTPUT}" "${content}")
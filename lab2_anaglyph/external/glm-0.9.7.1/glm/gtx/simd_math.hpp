@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_simd_math
+/// @file glm/gtx/simd_math.hpp
+/// @date 2026-10-18 / 2026-10-18
+///
+/// @see core (dependence)
+/// @see gtx_fast_trigonometry
+/// @see gtx_simd_vec4
+///
+/// @defgroup gtx_simd_math GLM_GTX_simd_math
+/// @ingroup gtx
+///
+/// @brief Single precision sin, cos, sincos, atan2, exp and inversesqrt on
+/// packed lanes (SSE2 __m128, AVX2 __m256, AVX-512 __m512) and on arrays.
+///
+/// Every function takes the accuracy as a template argument: highp, mediump
+/// or lowp. Lower tiers use polynomials of lower degree (and lowp one term
+/// less of range reduction). Maximum errors, as measured by
+/// test/gtx/gtx_simd_math.cpp against double precision:
+///
+///   function       domain              highp      mediump    lowp
+///   sin, cos       |x| <= 8192         2 ULP      32 ULP     4.5e-5 rel
+///   atan2          finite              3 ULP      16 ULP     2.5e-5 rel
+///   exp            [-87.3, 88.7]       2 ULP      80 ULP     1.3e-4 rel
+///   inversesqrt    positive, normal    2 ULP      4 ULP      3.7e-4 rel
+///
+/// Where |sin x| or |cos x| is below 0.01 the error is counted absolute:
+/// below 2e-9 for highp and mediump, 2e-7 for lowp. Past |x| = 8192 the
+/// range reduction slowly loses bits, unless FMA is enabled. lowp
+/// inversesqrt is the hardware estimate (2^-14 with AVX-512). exp returns
+/// +inf above its domain and 0 below it, without denormals. With FMA
+/// (-mfma) results can differ in the last bit from builds without it.
+///
+/// The array functions run the widest lanes enabled at compile time
+/// (see simdMathLanes()), and may be called in place. The float overloads
+/// compute one value with the same polynomials, for scalar code and
+/// builds without SSE2.
+///
+/// <glm/gtx/simd_math.hpp> need to be included to use these functionalities.
+///////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include <cstddef>
+
+#if(GLM_ARCH & GLM_ARCH_SSE2)
+#	define GLM_SIMD_MATH_SSE2
+#endif
+#if(GLM_ARCH & GLM_ARCH_AVX2)
+#	define GLM_SIMD_MATH_AVX2
+#endif
+#if(GLM_ARCH & GLM_ARCH_AVX2) && defined(__AVX512F__)
+#	define GLM_SIMD_MATH_AVX512
+#endif
+
+#if(defined(GLM_MESSAGES) && !defined(GLM_EXT_INCLUDED))
+#	pragma message("GLM: GLM_GTX_simd_math extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_simd_math
+	/// @{
+
+	/// Lanes processed at once by the array functions: 16, 8, 4 or 1.
+	/// From GLM_GTX_simd_math extension.
+	GLM_FUNC_DECL int simdMathLanes();
+
+	/// Sine of one value.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL float simdSin(float x);
+
+	/// Cosine of one value.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL float simdCos(float x);
+
+	/// Sine and cosine of one value, with one range reduction.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSinCos(float x, float & s, float & c);
+
+	/// Arc tangent of y / x in [-pi, pi], from the signs of both.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL float simdAtan2(float y, float x);
+
+	/// Natural exponential of one value.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL float simdExp(float x);
+
+	/// 1 / sqrt(x) of one value.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL float simdInversesqrt(float x);
+
+	/// result[i] = sin(x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSin(float const * x, float * result, std::size_t count);
+
+	/// result[i] = cos(x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdCos(float const * x, float * result, std::size_t count);
+
+	/// s[i] = sin(x[i]), c[i] = cos(x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSinCos(float const * x, float * s, float * c, std::size_t count);
+
+	/// result[i] = atan2(y[i], x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdAtan2(float const * y, float const * x, float * result, std::size_t count);
+
+	/// result[i] = exp(x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdExp(float const * x, float * result, std::size_t count);
+
+	/// result[i] = 1 / sqrt(x[i]) for count values.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdInversesqrt(float const * x, float * result, std::size_t count);
+
+#	ifdef GLM_SIMD_MATH_SSE2
+	/// Sine of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m128 simdSin(__m128 const & x);
+
+	/// Cosine of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m128 simdCos(__m128 const & x);
+
+	/// Sine and cosine of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSinCos(__m128 const & x, __m128 & s, __m128 & c);
+
+	/// Arc tangent of y / x of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m128 simdAtan2(__m128 const & y, __m128 const & x);
+
+	/// Natural exponential of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m128 simdExp(__m128 const & x);
+
+	/// 1 / sqrt(x) of 4 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m128 simdInversesqrt(__m128 const & x);
+#	endif//GLM_SIMD_MATH_SSE2
+
+#	ifdef GLM_SIMD_MATH_AVX2
+	/// Sine of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m256 simdSin(__m256 const & x);
+
+	/// Cosine of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m256 simdCos(__m256 const & x);
+
+	/// Sine and cosine of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSinCos(__m256 const & x, __m256 & s, __m256 & c);
+
+	/// Arc tangent of y / x of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m256 simdAtan2(__m256 const & y, __m256 const & x);
+
+	/// Natural exponential of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m256 simdExp(__m256 const & x);
+
+	/// 1 / sqrt(x) of 8 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m256 simdInversesqrt(__m256 const & x);
+#	endif//GLM_SIMD_MATH_AVX2
+
+#	ifdef GLM_SIMD_MATH_AVX512
+	/// Sine of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m512 simdSin(__m512 const & x);
+
+	/// Cosine of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m512 simdCos(__m512 const & x);
+
+	/// Sine and cosine of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL void simdSinCos(__m512 const & x, __m512 & s, __m512 & c);
+
+	/// Arc tangent of y / x of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m512 simdAtan2(__m512 const & y, __m512 const & x);
+
+	/// Natural exponential of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m512 simdExp(__m512 const & x);
+
+	/// 1 / sqrt(x) of 16 packed lanes.
+	/// From GLM_GTX_simd_math extension.
+	template <precision P>
+	GLM_FUNC_DECL __m512 simdInversesqrt(__m512 const & x);
+#	endif//GLM_SIMD_MATH_AVX512
+
+	/// @}
+}//namespace glm
+
+#include "simd_math.inl"
@@ -0,0 +1,725 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @ref gtx_simd_math
+/// @file glm/gtx/simd_math.inl
+/// @date 2026-10-18 / 2026-10-18
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace glm{
+namespace detail
+{
+	// Operations on one register of lanes, so that each function below is
+	// written once for float, __m128, __m256 and __m512. f holds floats,
+	// i 32-bit integers and m the result of a comparison.
+	struct simd_math_lanes_float
+	{
+		typedef float f;
+		typedef int i;
+		typedef bool m;
+
+		static f set(float v){return v;}
+		static i seti(int v){return v;}
+
+		static f add(f a, f b){return a + b;}
+		static f sub(f a, f b){return a - b;}
+		static f mul(f a, f b){return a * b;}
+		static f div(f a, f b){return a / b;}
+		static f madd(f a, f b, f c){return a * b + c;}
+		static f min(f a, f b){return b < a ? b : a;}
+		static f max(f a, f b){return a < b ? b : a;}
+		static f sqrt(f a){return std::sqrt(a);}
+		static f rsqrt(f a)
+		{
+#			ifdef GLM_SIMD_MATH_SSE2
+				return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+#			else
+				return 1.0f / std::sqrt(a);
+#			endif
+		}
+
+		static i bits(f a){i r; std::memcpy(&r, &a, sizeof(r)); return r;}
+		static f from_bits(i a){f r; std::memcpy(&r, &a, sizeof(r)); return r;}
+		static i round(f a){return static_cast<int>(a < 0.0f ? a - 0.5f : a + 0.5f);}
+		static f to_float(i a){return static_cast<float>(a);}
+
+		static i iand(i a, i b){return a & b;}
+		static i iadd(i a, i b){return a + b;}
+		static i isub(i a, i b){return a - b;}
+		static i shl(i a, int n){return static_cast<int>(static_cast<unsigned int>(a) << n);}
+		static i sra(i a, int n){return a >> n;}
+		static f fxor(f a, i b){return from_bits(bits(a) ^ b);}
+		static f fand(f a, i b){return from_bits(bits(a) & b);}
+
+		static m lt(f a, f b){return a < b;}
+		static m gt(f a, f b){return a > b;}
+		static m eq(f a, f b){return a == b;}
+		static m nan(f a){return a != a;}
+		static m ieq(i a, i b){return a == b;}
+		static m mor(m a, m b){return a || b;}
+		static f select(m c, f a, f b){return c ? a : b;}
+	};
+
+#	ifdef GLM_SIMD_MATH_SSE2
+	struct simd_math_lanes_sse2
+	{
+		typedef __m128 f;
+		typedef __m128i i;
+		typedef __m128 m;
+
+		static f load(float const * p){return _mm_loadu_ps(p);}
+		static void store(float * p, f v){_mm_storeu_ps(p, v);}
+		static f set(float v){return _mm_set1_ps(v);}
+		static i seti(int v){return _mm_set1_epi32(v);}
+
+		static f add(f a, f b){return _mm_add_ps(a, b);}
+		static f sub(f a, f b){return _mm_sub_ps(a, b);}
+		static f mul(f a, f b){return _mm_mul_ps(a, b);}
+		static f div(f a, f b){return _mm_div_ps(a, b);}
+		static f madd(f a, f b, f c)
+		{
+#			ifdef __FMA__
+				return _mm_fmadd_ps(a, b, c);
+#			else
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+#			endif
+		}
+		static f min(f a, f b){return _mm_min_ps(a, b);}
+		static f max(f a, f b){return _mm_max_ps(a, b);}
+		static f sqrt(f a){return _mm_sqrt_ps(a);}
+		static f rsqrt(f a){return _mm_rsqrt_ps(a);}
+
+		static i bits(f a){return _mm_castps_si128(a);}
+		static f from_bits(i a){return _mm_castsi128_ps(a);}
+		static i round(f a){return _mm_cvtps_epi32(a);}
+		static f to_float(i a){return _mm_cvtepi32_ps(a);}
+
+		static i iand(i a, i b){return _mm_and_si128(a, b);}
+		static i iadd(i a, i b){return _mm_add_epi32(a, b);}
+		static i isub(i a, i b){return _mm_sub_epi32(a, b);}
+		static i shl(i a, int n){return _mm_slli_epi32(a, n);}
+		static i sra(i a, int n){return _mm_srai_epi32(a, n);}
+		static f fxor(f a, i b){return _mm_xor_ps(a, _mm_castsi128_ps(b));}
+		static f fand(f a, i b){return _mm_and_ps(a, _mm_castsi128_ps(b));}
+
+		static m lt(f a, f b){return _mm_cmplt_ps(a, b);}
+		static m gt(f a, f b){return _mm_cmpgt_ps(a, b);}
+		static m eq(f a, f b){return _mm_cmpeq_ps(a, b);}
+		static m nan(f a){return _mm_cmpunord_ps(a, a);}
+		static m ieq(i a, i b){return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b));}
+		static m mor(m a, m b){return _mm_or_ps(a, b);}
+		static f select(m c, f a, f b)
+		{
+#			if(GLM_ARCH & GLM_ARCH_SSE4) || defined(__SSE4_1__)
+				return _mm_blendv_ps(b, a, c);
+#			else
+				return _mm_or_ps(_mm_and_ps(c, a), _mm_andnot_ps(c, b));
+#			endif
+		}
+	};
+#	endif//GLM_SIMD_MATH_SSE2
+
+#	ifdef GLM_SIMD_MATH_AVX2
+	struct simd_math_lanes_avx2
+	{
+		typedef __m256 f;
+		typedef __m256i i;
+		typedef __m256 m;
+
+		static f load(float const * p){return _mm256_loadu_ps(p);}
+		static void store(float * p, f v){_mm256_storeu_ps(p, v);}
+		static f set(float v){return _mm256_set1_ps(v);}
+		static i seti(int v){return _mm256_set1_epi32(v);}
+
+		static f add(f a, f b){return _mm256_add_ps(a, b);}
+		static f sub(f a, f b){return _mm256_sub_ps(a, b);}
+		static f mul(f a, f b){return _mm256_mul_ps(a, b);}
+		static f div(f a, f b){return _mm256_div_ps(a, b);}
+		static f madd(f a, f b, f c)
+		{
+#			ifdef __FMA__
+				return _mm256_fmadd_ps(a, b, c);
+#			else
+				return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#			endif
+		}
+		static f min(f a, f b){return _mm256_min_ps(a, b);}
+		static f max(f a, f b){return _mm256_max_ps(a, b);}
+		static f sqrt(f a){return _mm256_sqrt_ps(a);}
+		static f rsqrt(f a){return _mm256_rsqrt_ps(a);}
+
+		static i bits(f a){return _mm256_castps_si256(a);}
+		static f from_bits(i a){return _mm256_castsi256_ps(a);}
+		static i round(f a){return _mm256_cvtps_epi32(a);}
+		static f to_float(i a){return _mm256_cvtepi32_ps(a);}
+
+		static i iand(i a, i b){return _mm256_and_si256(a, b);}
+		static i iadd(i a, i b){return _mm256_add_epi32(a, b);}
+		static i isub(i a, i b){return _mm256_sub_epi32(a, b);}
+		static i shl(i a, int n){return _mm256_slli_epi32(a, n);}
+		static i sra(i a, int n){return _mm256_srai_epi32(a, n);}
+		static f fxor(f a, i b){return _mm256_xor_ps(a, _mm256_castsi256_ps(b));}
+		static f fand(f a, i b){return _mm256_and_ps(a, _mm256_castsi256_ps(b));}
+
+		static m lt(f a, f b){return _mm256_cmp_ps(a, b, _CMP_LT_OQ);}
+		static m gt(f a, f b){return _mm256_cmp_ps(a, b, _CMP_GT_OQ);}
+		static m eq(f a, f b){return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);}
+		static m nan(f a){return _mm256_cmp_ps(a, a, _CMP_UNORD_Q);}
+		static m ieq(i a, i b){return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b));}
+		static m mor(m a, m b){return _mm256_or_ps(a, b);}
+		static f select(m c, f a, f b){return _mm256_blendv_ps(b, a, c);}
+	};
+#	endif//GLM_SIMD_MATH_AVX2
+
+#	ifdef GLM_SIMD_MATH_AVX512
+	struct simd_math_lanes_avx512
+	{
+		typedef __m512 f;
+		typedef __m512i i;
+		typedef __mmask16 m;
+
+		static f load(float const * p){return _mm512_loadu_ps(p);}
+		static void store(float * p, f v){_mm512_storeu_ps(p, v);}
+		static f set(float v){return _mm512_set1_ps(v);}
+		static i seti(int v){return _mm512_set1_epi32(v);}
+
+		static f add(f a, f b){return _mm512_add_ps(a, b);}
+		static f sub(f a, f b){return _mm512_sub_ps(a, b);}
+		static f mul(f a, f b){return _mm512_mul_ps(a, b);}
+		static f div(f a, f b){return _mm512_div_ps(a, b);}
+		static f madd(f a, f b, f c){return _mm512_fmadd_ps(a, b, c);}
+		static f min(f a, f b){return _mm512_min_ps(a, b);}
+		static f max(f a, f b){return _mm512_max_ps(a, b);}
+		static f sqrt(f a){return _mm512_sqrt_ps(a);}
+		static f rsqrt(f a){return _mm512_rsqrt14_ps(a);}
+
+		static i bits(f a){return _mm512_castps_si512(a);}
+		static f from_bits(i a){return _mm512_castsi512_ps(a);}
+		static i round(f a){return _mm512_cvtps_epi32(a);}
+		static f to_float(i a){return _mm512_cvtepi32_ps(a);}
+
+		static i iand(i a, i b){return _mm512_and_epi32(a, b);}
+		static i iadd(i a, i b){return _mm512_add_epi32(a, b);}
+		static i isub(i a, i b){return _mm512_sub_epi32(a, b);}
+		static i shl(i a, int n){return _mm512_slli_epi32(a, static_cast<unsigned int>(n));}
+		static i sra(i a, int n){return _mm512_srai_epi32(a, static_cast<unsigned int>(n));}
+		static f fxor(f a, i b){return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), b));}
+		static f fand(f a, i b){return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), b));}
+
+		static m lt(f a, f b){return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);}
+		static m gt(f a, f b){return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);}
+		static m eq(f a, f b){return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);}
+		static m nan(f a){return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q);}
+		static m ieq(i a, i b){return _mm512_cmpeq_epi32_mask(a, b);}
+		static m mor(m a, m b){return static_cast<m>(a | b);}
+		static f select(m c, f a, f b){return _mm512_mask_blend_ps(c, b, a);}
+	};
+#	endif//GLM_SIMD_MATH_AVX512
+
+	// sin and cos of x = j pi/2 + r, |r| <= pi/4, on [-pi/4, pi/4]. pi/2 is
+	// split in parts with few mantissa bits so that j times the leading
+	// parts is exact (Cody and Waite); lowp uses one part less.
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER void simd_math_reduce(typename L::f x, typename L::f & r, typename L::i & j)
+	{
+		j = L::round(L::mul(x, L::set(0.636619772f)));
+		typename L::f const fj = L::to_float(j);
+		if(P == lowp)
+			r = L::madd(fj, L::set(-4.83826792e-4f), L::madd(fj, L::set(-1.5703125f), x));
+		else
+			r = L::madd(fj, L::set(-7.54978995e-8f), L::madd(fj, L::set(-4.83751297e-4f), L::madd(fj, L::set(-1.5703125f), x)));
+	}
+
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_sin_poly(typename L::f r, typename L::f z)
+	{
+		typename L::f p;
+		if(P == highp)
+			p = L::madd(L::madd(z, L::set(-1.95152959e-4f), L::set(8.33216087e-3f)), z, L::set(-0.166666546f));
+		else
+			p = L::madd(z, L::set(8.16329941e-3f), L::set(-0.166633904f));
+		return L::madd(L::mul(r, z), p, r);
+	}
+
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_cos_poly(typename L::f z)
+	{
+		typename L::f p;
+		if(P == lowp)
+			p = L::set(4.08994220e-2f);
+		else if(P == mediump)
+			p = L::madd(z, L::set(-1.36487267e-3f), L::set(4.16610725e-2f));
+		else
+			p = L::madd(L::madd(z, L::set(2.44331571e-5f), L::set(-1.38873163e-3f)), z, L::set(4.16666457e-2f));
+		return L::madd(L::mul(z, z), p, L::madd(z, L::set(-0.5f), L::set(1.0f)));
+	}
+
+	// Quadrant j: sin is s, c, -s, -c for j mod 4 = 0, 1, 2, 3
+	template <typename L>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_quadrant(typename L::i j, typename L::f s, typename L::f c)
+	{
+		typename L::m const odd = L::ieq(L::iand(j, L::seti(1)), L::seti(1));
+		typename L::i const sign = L::shl(L::iand(j, L::seti(2)), 30);
+		return L::fxor(L::select(odd, c, s), sign);
+	}
+
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_sin(typename L::f x)
+	{
+		typename L::f r;
+		typename L::i j;
+		simd_math_reduce<L, P>(x, r, j);
+		typename L::f const z = L::mul(r, r);
+		return simd_math_quadrant<L>(j, simd_math_sin_poly<L, P>(r, z), simd_math_cos_poly<L, P>(z));
+	}
+
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_cos(typename L::f x)
+	{
+		// cos(x) = sin(x + pi/2): one quadrant further
+		typename L::f r;
+		typename L::i j;
+		simd_math_reduce<L, P>(x, r, j);
+		typename L::f const z = L::mul(r, r);
+		return simd_math_quadrant<L>(L::iadd(j, L::seti(1)), simd_math_sin_poly<L, P>(r, z), simd_math_cos_poly<L, P>(z));
+	}
+
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER void simd_math_sincos(typename L::f x, typename L::f & s, typename L::f & c)
+	{
+		typename L::f r;
+		typename L::i j;
+		simd_math_reduce<L, P>(x, r, j);
+		typename L::f const z = L::mul(r, r);
+		typename L::f const ps = simd_math_sin_poly<L, P>(r, z);
+		typename L::f const pc = simd_math_cos_poly<L, P>(z);
+		s = simd_math_quadrant<L>(j, ps, pc);
+		c = simd_math_quadrant<L>(L::iadd(j, L::seti(1)), ps, pc);
+	}
+
+	// atan of t = min(|x|, |y|) / max(|x|, |y|) in [0, 1], brought to
+	// [0, tan(pi/8)] with atan(t) = pi/4 + atan((t - 1) / (t + 1)), then
+	// unfolded by octant and the signs of x and y
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_atan2(typename L::f y, typename L::f x)
+	{
+		typename L::i const abs_mask = L::seti(0x7fffffff);
+		typename L::i const sign_mask = L::seti(static_cast<int>(0x80000000u));
+		typename L::f const ax = L::fand(x, abs_mask);
+		typename L::f const ay = L::fand(y, abs_mask);
+		typename L::f const high = L::max(ax, ay);
+		typename L::f const low = L::min(ax, ay);
+
+		typename L::m const folded = L::gt(low, L::mul(high, L::set(0.414213562f)));
+		typename L::f const num = L::select(folded, L::sub(low, high), low);
+		typename L::f const den = L::select(folded, L::add(low, high), high);
+		typename L::f t = L::div(num, den);
+		t = L::select(L::eq(high, L::set(0.0f)), L::set(0.0f), t);
+
+		typename L::f const z = L::mul(t, t);
+		typename L::f p;
+		if(P == lowp)
+			p = L::madd(z, L::set(0.170344666f), L::set(-0.331834078f));
+		else if(P == mediump)
+			p = L::madd(L::madd(z, L::set(-0.112252742f), L::set(0.197141662f)), z, L::set(-0.333255082f));
+		else
+			p = L::madd(L::madd(L::madd(z, L::set(8.05374449e-2f), L::set(-0.138776856f)), z, L::set(0.199777106f)), z, L::set(-0.333329491f));
+		typename L::f a = L::madd(L::mul(t, z), p, t);
+		a = L::add(a, L::select(folded, L::set(0.785398163f), L::set(0.0f)));
+
+		a = L::select(L::gt(ay, ax), L::sub(L::set(1.57079633f), a), a);
+		typename L::m const negative_x = L::ieq(L::iand(L::bits(x), sign_mask), sign_mask);
+		a = L::select(negative_x, L::sub(L::set(3.14159265f), a), a);
+		return L::fxor(a, L::iand(L::bits(y), sign_mask));
+	}
+
+	// exp(x) = 2^n exp(r), x = n ln2 + r, |r| <= ln2 / 2; 2^n is applied in
+	// two halves so that n = 128 does not overflow the exponent
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_exp(typename L::f x)
+	{
+		typename L::i const n = L::round(L::mul(x, L::set(1.44269504f)));
+		typename L::f const fn = L::to_float(n);
+		typename L::f const r = L::madd(fn, L::set(2.12194440e-4f), L::madd(fn, L::set(-0.693359375f), x));
+
+		typename L::f p;
+		if(P == lowp)
+			p = L::madd(r, L::set(0.166626349f), L::set(0.503939509f));
+		else if(P == mediump)
+			p = L::madd(L::madd(r, L::set(4.12775949e-2f), L::set(0.167534977f)), r, L::set(0.500051141f));
+		else
+			p = L::madd(L::madd(L::madd(L::madd(L::madd(r, L::set(1.98756915e-4f), L::set(1.39819995e-3f)), r,
+				L::set(8.33345191e-3f)), r, L::set(4.16657959e-2f)), r, L::set(0.166666655f)), r, L::set(0.500000012f));
+		typename L::f const e = L::madd(L::mul(r, r), p, L::add(r, L::set(1.0f)));
+
+		typename L::i const half = L::sra(n, 1);
+		typename L::f const scale1 = L::from_bits(L::shl(L::iadd(half, L::seti(127)), 23));
+		typename L::f const scale2 = L::from_bits(L::shl(L::iadd(L::isub(n, half), L::seti(127)), 23));
+		typename L::f result = L::mul(L::mul(e, scale1), scale2);
+
+		result = L::select(L::gt(x, L::set(88.7228394f)), L::set(std::numeric_limits<float>::infinity()), result);
+		result = L::select(L::lt(x, L::set(-87.3365479f)), L::set(0.0f), result);
+		return L::select(L::nan(x), x, result);
+	}
+
+	// highp: sqrt and division, each correctly rounded. mediump: the
+	// hardware estimate (12 or 14 bits) and one Newton step. lowp: the
+	// estimate alone.
+	template <typename L, precision P>
+	GLM_FUNC_QUALIFIER typename L::f simd_math_inversesqrt(typename L::f x)
+	{
+		if(P == highp)
+			return L::div(L::set(1.0f), L::sqrt(x));
+		typename L::f const e = L::rsqrt(x);
+		if(P == lowp)
+			return e;
+		typename L::f const refined = L::mul(L::mul(L::set(-0.5f), e), L::madd(L::mul(x, e), e, L::set(-3.0f)));
+		// 0 and +inf keep the estimate, inf and 0
+		return L::select(L::mor(L::eq(x, L::set(0.0f)), L::eq(x, L::set(std::numeric_limits<float>::infinity()))), e, refined);
+	}
+
+	template <precision P>
+	struct simd_math_sin_op
+	{
+		template <typename L>
+		static typename L::f call(typename L::f x){return simd_math_sin<L, P>(x);}
+	};
+
+	template <precision P>
+	struct simd_math_cos_op
+	{
+		template <typename L>
+		static typename L::f call(typename L::f x){return simd_math_cos<L, P>(x);}
+	};
+
+	template <precision P>
+	struct simd_math_exp_op
+	{
+		template <typename L>
+		static typename L::f call(typename L::f x){return simd_math_exp<L, P>(x);}
+	};
+
+	template <precision P>
+	struct simd_math_inversesqrt_op
+	{
+		template <typename L>
+		static typename L::f call(typename L::f x){return simd_math_inversesqrt<L, P>(x);}
+	};
+
+	template <precision P>
+	struct simd_math_atan2_op
+	{
+		template <typename L>
+		static typename L::f call(typename L::f y, typename L::f x){return simd_math_atan2<L, P>(y, x);}
+	};
+
+	// The widest lanes of this build
+#	if defined(GLM_SIMD_MATH_AVX512)
+		typedef simd_math_lanes_avx512 simd_math_array_lanes;
+		std::size_t const simd_math_array_width = 16;
+#	elif defined(GLM_SIMD_MATH_AVX2)
+		typedef simd_math_lanes_avx2 simd_math_array_lanes;
+		std::size_t const simd_math_array_width = 8;
+#	elif defined(GLM_SIMD_MATH_SSE2)
+		typedef simd_math_lanes_sse2 simd_math_array_lanes;
+		std::size_t const simd_math_array_width = 4;
+#	endif
+
+	// Whole registers, then the rest through a padded buffer, so the last
+	// values get the same results as they would in a full register
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void simd_math_map(float const * x, float * result, std::size_t count)
+	{
+#		ifdef GLM_SIMD_MATH_SSE2
+			typedef simd_math_array_lanes L;
+			std::size_t const W = simd_math_array_width;
+			std::size_t i = 0;
+			for(; i + W <= count; i += W)
+				L::store(result + i, Op::template call<L>(L::load(x + i)));
+			if(i < count)
+			{
+				float buffer[W] = {0.0f};
+				std::memcpy(buffer, x + i, (count - i) * sizeof(float));
+				L::store(buffer, Op::template call<L>(L::load(buffer)));
+				std::memcpy(result + i, buffer, (count - i) * sizeof(float));
+			}
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				result[i] = Op::template call<simd_math_lanes_float>(x[i]);
+#		endif
+	}
+
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void simd_math_map(float const * y, float const * x, float * result, std::size_t count)
+	{
+#		ifdef GLM_SIMD_MATH_SSE2
+			typedef simd_math_array_lanes L;
+			std::size_t const W = simd_math_array_width;
+			std::size_t i = 0;
+			for(; i + W <= count; i += W)
+				L::store(result + i, Op::template call<L>(L::load(y + i), L::load(x + i)));
+			if(i < count)
+			{
+				float bufferY[W] = {0.0f};
+				float bufferX[W] = {0.0f};
+				std::memcpy(bufferY, y + i, (count - i) * sizeof(float));
+				std::memcpy(bufferX, x + i, (count - i) * sizeof(float));
+				L::store(bufferY, Op::template call<L>(L::load(bufferY), L::load(bufferX)));
+				std::memcpy(result + i, bufferY, (count - i) * sizeof(float));
+			}
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				result[i] = Op::template call<simd_math_lanes_float>(y[i], x[i]);
+#		endif
+	}
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER int simdMathLanes()
+	{
+#		ifdef GLM_SIMD_MATH_SSE2
+			return static_cast<int>(detail::simd_math_array_width);
+#		else
+			return 1;
+#		endif
+	}
+
+	// float
+	template <precision P>
+	GLM_FUNC_QUALIFIER float simdSin(float x)
+	{
+		return detail::simd_math_sin<detail::simd_math_lanes_float, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER float simdCos(float x)
+	{
+		return detail::simd_math_cos<detail::simd_math_lanes_float, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSinCos(float x, float & s, float & c)
+	{
+		detail::simd_math_sincos<detail::simd_math_lanes_float, P>(x, s, c);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER float simdAtan2(float y, float x)
+	{
+		return detail::simd_math_atan2<detail::simd_math_lanes_float, P>(y, x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER float simdExp(float x)
+	{
+		return detail::simd_math_exp<detail::simd_math_lanes_float, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER float simdInversesqrt(float x)
+	{
+		return detail::simd_math_inversesqrt<detail::simd_math_lanes_float, P>(x);
+	}
+
+	// Arrays
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSin(float const * x, float * result, std::size_t count)
+	{
+		detail::simd_math_map<detail::simd_math_sin_op<P> >(x, result, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdCos(float const * x, float * result, std::size_t count)
+	{
+		detail::simd_math_map<detail::simd_math_cos_op<P> >(x, result, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSinCos(float const * x, float * s, float * c, std::size_t count)
+	{
+#		ifdef GLM_SIMD_MATH_SSE2
+			typedef detail::simd_math_array_lanes L;
+			std::size_t const W = detail::simd_math_array_width;
+			std::size_t i = 0;
+			L::f vs, vc;
+			for(; i + W <= count; i += W)
+			{
+				detail::simd_math_sincos<L, P>(L::load(x + i), vs, vc);
+				L::store(s + i, vs);
+				L::store(c + i, vc);
+			}
+			if(i < count)
+			{
+				float bufferS[W] = {0.0f};
+				float bufferC[W];
+				std::memcpy(bufferS, x + i, (count - i) * sizeof(float));
+				detail::simd_math_sincos<L, P>(L::load(bufferS), vs, vc);
+				L::store(bufferS, vs);
+				L::store(bufferC, vc);
+				std::memcpy(s + i, bufferS, (count - i) * sizeof(float));
+				std::memcpy(c + i, bufferC, (count - i) * sizeof(float));
+			}
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				detail::simd_math_sincos<detail::simd_math_lanes_float, P>(x[i], s[i], c[i]);
+#		endif
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdAtan2(float const * y, float const * x, float * result, std::size_t count)
+	{
+		detail::simd_math_map<detail::simd_math_atan2_op<P> >(y, x, result, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdExp(float const * x, float * result, std::size_t count)
+	{
+		detail::simd_math_map<detail::simd_math_exp_op<P> >(x, result, count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdInversesqrt(float const * x, float * result, std::size_t count)
+	{
+		detail::simd_math_map<detail::simd_math_inversesqrt_op<P> >(x, result, count);
+	}
+
+#	ifdef GLM_SIMD_MATH_SSE2
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 simdSin(__m128 const & x)
+	{
+		return detail::simd_math_sin<detail::simd_math_lanes_sse2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 simdCos(__m128 const & x)
+	{
+		return detail::simd_math_cos<detail::simd_math_lanes_sse2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSinCos(__m128 const & x, __m128 & s, __m128 & c)
+	{
+		detail::simd_math_sincos<detail::simd_math_lanes_sse2, P>(x, s, c);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 simdAtan2(__m128 const & y, __m128 const & x)
+	{
+		return detail::simd_math_atan2<detail::simd_math_lanes_sse2, P>(y, x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 simdExp(__m128 const & x)
+	{
+		return detail::simd_math_exp<detail::simd_math_lanes_sse2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m128 simdInversesqrt(__m128 const & x)
+	{
+		return detail::simd_math_inversesqrt<detail::simd_math_lanes_sse2, P>(x);
+	}
+#	endif//GLM_SIMD_MATH_SSE2
+
+#	ifdef GLM_SIMD_MATH_AVX2
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256 simdSin(__m256 const & x)
+	{
+		return detail::simd_math_sin<detail::simd_math_lanes_avx2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256 simdCos(__m256 const & x)
+	{
+		return detail::simd_math_cos<detail::simd_math_lanes_avx2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSinCos(__m256 const & x, __m256 & s, __m256 & c)
+	{
+		detail::simd_math_sincos<detail::simd_math_lanes_avx2, P>(x, s, c);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256 simdAtan2(__m256 const & y, __m256 const & x)
+	{
+		return detail::simd_math_atan2<detail::simd_math_lanes_avx2, P>(y, x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256 simdExp(__m256 const & x)
+	{
+		return detail::simd_math_exp<detail::simd_math_lanes_avx2, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m256 simdInversesqrt(__m256 const & x)
+	{
+		return detail::simd_math_inversesqrt<detail::simd_math_lanes_avx2, P>(x);
+	}
+#	endif//GLM_SIMD_MATH_AVX2
+
+#	ifdef GLM_SIMD_MATH_AVX512
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m512 simdSin(__m512 const & x)
+	{
+		return detail::simd_math_sin<detail::simd_math_lanes_avx512, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m512 simdCos(__m512 const & x)
+	{
+		return detail::simd_math_cos<detail::simd_math_lanes_avx512, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void simdSinCos(__m512 const & x, __m512 & s, __m512 & c)
+	{
+		detail::simd_math_sincos<detail::simd_math_lanes_avx512, P>(x, s, c);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m512 simdAtan2(__m512 const & y, __m512 const & x)
+	{
+		return detail::simd_math_atan2<detail::simd_math_lanes_avx512, P>(y, x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m512 simdExp(__m512 const & x)
+	{
+		return detail::simd_math_exp<detail::simd_math_lanes_avx512, P>(x);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER __m512 simdInversesqrt(__m512 const & x)
+	{
+		return detail::simd_math_inversesqrt<detail::simd_math_lanes_avx512, P>(x);
+	}
+#	endif//GLM_SIMD_MATH_AVX512
+}//namespace glm
@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////////////
+/// OpenGL Mathematics (glm.g-truc.net)
+///
+/// Copyright (c) 2005 - 2015 G-Truc Creation (www.g-truc.net)
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Restrictions:
+///		By making use of the Software for military purposes, you choose to make
+///		a Bunny unhappy.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// @file test/gtx/gtx_simd_math.cpp
+/// @date 2026-10-18 / 2026-10-18
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <glm/gtx/simd_math.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Sweeps each function of each tier against the double precision standard
+// library and checks the bounds documented in glm/gtx/simd_math.hpp. The
+// error of a value is in ULP, or relative for lowp; for sin and cos it is
+// absolute where the function is below 0.01.
+namespace accuracy
+{
+	std::size_t const Count = 1 << 20;
+
+	// Uniform in [Min, Max], from a fixed seed
+	struct random
+	{
+		unsigned int State;
+
+		random() : State(1) {}
+
+		float operator()(float Min, float Max)
+		{
+			State = State * 1664525u + 1013904223u;
+			return Min + (Max - Min) * static_cast<float>(State >> 8) / static_cast<float>(1 << 24);
+		}
+	};
+
+	double ulp(double Reference)
+	{
+		float const Value = std::abs(static_cast<float>(Reference));
+		float const Min = std::numeric_limits<float>::min();
+		float const Base = Value < Min ? Min : Value;
+		int Exponent = 0;
+		std::frexp(Base, &Exponent);
+		return std::ldexp(1.0, Exponent - 24);
+	}
+
+	struct bound
+	{
+		double Ulp;			// highp and mediump
+		double Relative;	// lowp
+		double Absolute;	// Near zeros of sin and cos
+	};
+
+	struct error
+	{
+		double Max;
+		double MaxAbsolute;
+		float Worst;
+
+		error() : Max(0), MaxAbsolute(0), Worst(0) {}
+	};
+
+	void measure(error & Error, float Input, float Result, double Reference, bool Relative, bool AbsoluteNearZero)
+	{
+		double const Difference = std::abs(static_cast<double>(Result) - Reference);
+		if(AbsoluteNearZero && std::abs(Reference) < 0.01)
+		{
+			Error.MaxAbsolute = Difference > Error.MaxAbsolute ? Difference : Error.MaxAbsolute;
+			return;
+		}
+		double const Value = Relative ? Difference / std::abs(Reference) : Difference / ulp(Reference);
+		if(!(Value <= Error.Max))
+		{
+			Error.Max = Value;
+			Error.Worst = Input;
+		}
+	}
+
+	int check(char const * Name, glm::precision P, error const & Error, bound const & Bound)
+	{
+		char const * Tier = P == glm::highp ? "highp" : P == glm::mediump ? "mediump" : "lowp";
+		bool const Relative = P == glm::lowp;
+		double const Limit = Relative ? Bound.Relative : Bound.Ulp;
+		int const Failed = Error.Max <= Limit && Error.MaxAbsolute <= Bound.Absolute ? 0 : 1;
+		std::printf("%-12s %-8s max %10.3g %s (limit %g) at %g, near zero %.3g%s\n", Name, Tier, Error.Max,
+			Relative ? "rel" : "ULP", Limit, Error.Worst, Error.MaxAbsolute, Failed ? "  FAILED" : "");
+		return Failed;
+	}
+
+	template <glm::precision P>
+	int test(bound const & SinCos, bound const & Atan2, bound const & Exp, bound const & Inversesqrt)
+	{
+		bool const Relative = P == glm::lowp;
+		int Error = 0;
+		random Random;
+		std::vector<float> X(Count), Y(Count), S(Count), C(Count);
+
+		// sin, cos and sincos, which must agree with them
+		{
+			for(std::size_t i = 0; i < Count; ++i)
+				X[i] = Random(-8192.0f, 8192.0f);
+			for(std::size_t i = 0; i < Count / 8; ++i)
+				X[i] *= 1.0f / 4096.0f;
+
+			glm::simdSin<P>(&X[0], &S[0], Count);
+			glm::simdCos<P>(&X[0], &C[0], Count);
+			error ErrorSin, ErrorCos;
+			for(std::size_t i = 0; i < Count; ++i)
+			{
+				measure(ErrorSin, X[i], S[i], std::sin(static_cast<double>(X[i])), Relative, true);
+				measure(ErrorCos, X[i], C[i], std::cos(static_cast<double>(X[i])), Relative, true);
+			}
+			Error += check("sin", P, ErrorSin, SinCos);
+			Error += check("cos", P, ErrorCos, SinCos);
+
+			std::vector<float> S2(Count), C2(Count);
+			glm::simdSinCos<P>(&X[0], &S2[0], &C2[0], Count);
+			for(std::size_t i = 0; i < Count; ++i)
+				Error += S2[i] == S[i] && C2[i] == C[i] ? 0 : 1;
+		}
+
+		// atan2, all quadrants and ratios from 1e-3 to 1e3
+		{
+			for(std::size_t i = 0; i < Count; ++i)
+			{
+				X[i] = Random(-10.0f, 10.0f);
+				Y[i] = Random(-10.0f, 10.0f) * (i % 3 == 0 ? 1e-3f : 1.0f);
+			}
+			glm::simdAtan2<P>(&Y[0], &X[0], &S[0], Count);
+			error ErrorAtan2;
+			for(std::size_t i = 0; i < Count; ++i)
+				measure(ErrorAtan2, X[i], S[i], std::atan2(static_cast<double>(Y[i]), static_cast<double>(X[i])), Relative, false);
+			Error += check("atan2", P, ErrorAtan2, Atan2);
+		}
+
+		// exp over its whole domain
+		{
+			for(std::size_t i = 0; i < Count; ++i)
+				X[i] = Random(-87.3f, 88.7f);
+			glm::simdExp<P>(&X[0], &S[0], Count);
+			error ErrorExp;
+			for(std::size_t i = 0; i < Count; ++i)
+				measure(ErrorExp, X[i], S[i], std::exp(static_cast<double>(X[i])), Relative, false);
+			Error += check("exp", P, ErrorExp, Exp);
+		}
+
+		// inversesqrt from 2^-100 to 2^100
+		{
+			for(std::size_t i = 0; i < Count; ++i)
+				X[i] = std::ldexp(Random(1.0f, 4.0f), static_cast<int>(Random(-100.0f, 100.0f)));
+			glm::simdInversesqrt<P>(&X[0], &S[0], Count);
+			error ErrorInversesqrt;
+			for(std::size_t i = 0; i < Count; ++i)
+				measure(ErrorInversesqrt, X[i], S[i], 1.0 / std::sqrt(static_cast<double>(X[i])), Relative, false);
+			Error += check("inversesqrt", P, ErrorInversesqrt, Inversesqrt);
+		}
+
+		return Error;
+	}
+}//namespace accuracy
+
+// Values the polynomials do not reach
+namespace special
+{
+	int test()
+	{
+		int Error = 0;
+		float const Inf = std::numeric_limits<float>::infinity();
+		float const Pi = 3.14159265f;
+
+		Error += glm::simdExp<glm::highp>(100.0f) == Inf ? 0 : 1;
+		Error += glm::simdExp<glm::highp>(-100.0f) == 0.0f ? 0 : 1;
+		Error += glm::simdExp<glm::highp>(0.0f) == 1.0f ? 0 : 1;
+		Error += glm::simdExp<glm::highp>(88.7f) < Inf ? 0 : 1;
+		float const NaN = std::numeric_limits<float>::quiet_NaN();
+		Error += glm::simdExp<glm::highp>(NaN) != glm::simdExp<glm::highp>(NaN) ? 0 : 1;
+
+		Error += glm::simdAtan2<glm::highp>(0.0f, 0.0f) == 0.0f ? 0 : 1;
+		Error += glm::simdAtan2<glm::highp>(0.0f, -0.0f) == Pi ? 0 : 1;
+		Error += glm::simdAtan2<glm::highp>(-0.0f, -1.0f) == -Pi ? 0 : 1;
+		Error += glm::simdAtan2<glm::highp>(1.0f, 0.0f) == Pi / 2.0f ? 0 : 1;
+		Error += glm::simdAtan2<glm::highp>(-1.0f, 0.0f) == -Pi / 2.0f ? 0 : 1;
+
+		Error += glm::simdInversesqrt<glm::highp>(0.0f) == Inf ? 0 : 1;
+		Error += glm::simdInversesqrt<glm::mediump>(0.0f) == Inf ? 0 : 1;
+		Error += glm::simdInversesqrt<glm::mediump>(Inf) == 0.0f ? 0 : 1;
+		Error += glm::simdInversesqrt<glm::highp>(4.0f) == 0.5f ? 0 : 1;
+
+		Error += glm::simdSin<glm::highp>(0.0f) == 0.0f ? 0 : 1;
+		Error += glm::simdCos<glm::highp>(0.0f) == 1.0f ? 0 : 1;
+
+		return Error;
+	}
+}//namespace special
+
+// The lanes overloads and the arrays, whose last values go through a
+// padded register, give the float overloads' results up to FMA contraction
+namespace lanes
+{
+	bool close(float A, float B)
+	{
+		return std::abs(A - B) <= 2.0f * std::numeric_limits<float>::epsilon() * (std::abs(A) > 1.0f ? std::abs(A) : 1.0f);
+	}
+
+	int test()
+	{
+		int Error = 0;
+		std::size_t const Count = 37;
+		float X[Count], Y[Count], Result[Count];
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			X[i] = -20.0f + 1.1f * static_cast<float>(i);
+			Y[i] = 3.0f - 0.3f * static_cast<float>(i);
+		}
+
+		glm::simdSin<glm::highp>(X, Result, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += close(Result[i], glm::simdSin<glm::highp>(X[i])) ? 0 : 1;
+		glm::simdAtan2<glm::highp>(Y, X, Result, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += close(Result[i], glm::simdAtan2<glm::highp>(Y[i], X[i])) ? 0 : 1;
+
+		// In place
+		float Copy[Count];
+		for(std::size_t i = 0; i < Count; ++i)
+			Copy[i] = X[i];
+		glm::simdExp<glm::highp>(Copy, Copy, Count);
+		for(std::size_t i = 0; i < Count; ++i)
+			Error += close(Copy[i], glm::simdExp<glm::highp>(X[i])) ? 0 : 1;
+
+#		ifdef GLM_SIMD_MATH_SSE2
+		{
+			float Out[4];
+			_mm_storeu_ps(Out, glm::simdCos<glm::highp>(_mm_loadu_ps(X)));
+			for(int i = 0; i < 4; ++i)
+				Error += close(Out[i], glm::simdCos<glm::highp>(X[i])) ? 0 : 1;
+		}
+#		endif
+#		ifdef GLM_SIMD_MATH_AVX2
+		{
+			float Out[8];
+			_mm256_storeu_ps(Out, glm::simdExp<glm::highp>(_mm256_loadu_ps(X)));
+			for(int i = 0; i < 8; ++i)
+				Error += close(Out[i], glm::simdExp<glm::highp>(X[i])) ? 0 : 1;
+		}
+#		endif
+#		ifdef GLM_SIMD_MATH_AVX512
+		{
+			float Out[16];
+			_mm512_storeu_ps(Out, glm::simdAtan2<glm::highp>(_mm512_loadu_ps(Y), _mm512_loadu_ps(X)));
+			for(int i = 0; i < 16; ++i)
+				Error += close(Out[i], glm::simdAtan2<glm::highp>(Y[i], X[i])) ? 0 : 1;
+		}
+#		endif
+
+		return Error;
+	}
+}//namespace lanes
+
+int main()
+{
+	int Error(0);
+
+	std::printf("%d lanes\n", glm::simdMathLanes());
+
+	// ULP for highp and mediump, relative for lowp, absolute near zero
+	accuracy::bound const SinCos = {2.0, 0.0, 2e-9};
+	accuracy::bound const Atan2 = {3.0, 0.0, 0.0};
+	accuracy::bound const Exp = {2.0, 0.0, 0.0};
+	accuracy::bound const Inversesqrt = {2.0, 0.0, 0.0};
+	Error += accuracy::test<glm::highp>(SinCos, Atan2, Exp, Inversesqrt);
+
+	accuracy::bound const SinCosMedium = {32.0, 0.0, 2e-9};
+	accuracy::bound const Atan2Medium = {16.0, 0.0, 0.0};
+	accuracy::bound const ExpMedium = {80.0, 0.0, 0.0};
+	accuracy::bound const InversesqrtMedium = {4.0, 0.0, 0.0};
+	Error += accuracy::test<glm::mediump>(SinCosMedium, Atan2Medium, ExpMedium, InversesqrtMedium);
+
+	accuracy::bound const SinCosLow = {0.0, 4.5e-5, 2e-7};
+	accuracy::bound const Atan2Low = {0.0, 2.5e-5, 0.0};
+	accuracy::bound const ExpLow = {0.0, 1.3e-4, 0.0};
+	accuracy::bound const InversesqrtLow = {0.0, 3.7e-4, 0.0};
+	Error += accuracy::test<glm::lowp>(SinCosLow, Atan2Low, ExpLow, InversesqrtLow);
+
+	Error += special::test();
+	Error += lanes::test();
+
+	return Error;
+}
@@ -10,10 +10,27 @@
 
 #include <render/shader.h>
 #include <render/texture.h>
+#include <render/render_queue.h>
+#include <render/camera_rig.h>
+#include <render/multiview.h>
+#include <render/foveated.h>
+#include <render/gpu_query.h>
+#include <render/reprojection.h>
+#include <render/frame_export.h>
 #include <models/box.h>
+#include <models/mesh.h>
+#include <scene/scene.h>
+#include <util/latency.h>
+#include <util/clock.h>
+#include <util/benchmark.h>
+#include <input/input_sampler.h>
 
 #include <vector>
+#include <functional>
 #include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -41,33 +58,16 @@ static float viewAzimuth = M_PI / 2;
 static float viewPolar = M_PI / 2;
 static float viewDistance = 100.0f;
 static bool rotating = false;
-static glm::mat4 projectionMatrix;
-
-
-// Scene control 
-static int numBoxes = 1;				// Debug: set numBoxes to 1.
-std::vector<glm::mat4> boxTransforms;	// We represent the scene by a single box and a number of transforms for drawing the box at different locations.
-
-// for Part 4: Black Hole
+static double animationTime = 0;		// Time of the last animation update
 
-static float bhInnerRadius = 8.0f;   // event horizon-ish
-static float bhOuterRadius = 200.0f; // spawn ring-ish
-static float bhMinRadius = 40.0f;  // initial min spawn radius
-static float bhMaxHeight = 50.0f;  // vertical spread
+// Arrow keys and joystick, integrated over real time each frame
+static InputSampler input;
+static glm::mat4 projectionMatrix;
 
-static float bhBaseAngSpeed = 1.6f;  // base orbital speed
-static float bhBaseFallSpeed = 6.0f; // base inward drift
 
-// Per-particle state
-static std::vector<float> bhAngle;
-static std::vector<float> bhRadius;
-static std::vector<float> bhAngSpeed;
-static std::vector<float> bhFallSpeed;
-static std::vector<float> bhHeight;
-static std::vector<float> bhYSpeed;
-static std::vector<float> bhSpinSpeed;
-static std::vector<float> bhScale;
-static std::vector<glm::vec3> bhSpinAxis;
+// Draw submission. Draws are sorted to minimize state changes.
+static RenderQueue renderQueue;
+static RenderStats lastFrameStats;
 
 // Anaglyph control 
 static float ipd = 2.0f;				// Distance between left/right eye.
@@ -77,6 +77,8 @@ enum AnaglyphMode {
 	None,
 	ToeIn, 
 	Asymmetric, 
+	Reprojected,
+	Multiview,
 	AnaglyphModeCount,
 };
 
@@ -84,18 +86,70 @@ static std::string strAnaglyphMode[] = {
 	"None", 
 	"Toe-in", 
 	"Asymmetric view frustum", 
+	"Asymmetric, reprojected right eye",
+	"Multiview (lenticular)",
 	"Invalid",
 };
 
 static AnaglyphMode anaglyphMode = AnaglyphMode::None;
 
-enum SceneMode {
-	Debug,
-	RandomBoxes,
-	BlackHole,
-};
+// Multiview control, for autostereoscopic displays
+static MultiviewRenderer multiview;
+static int multiviewCount = 8;
+static bool showQuilt = false;			// Show the quilt instead of the interleaved views
+static LenticularParameters lenticular;
+
+// Foveated (multi-resolution) eye buffers for the anaglyph modes
+static FoveatedRenderer foveated;
+static bool foveation = false;
+static SampleCounter eyeCounters[2];		// Full rate eye passes, for comparison
+static GLuint64 lastShadedPixels = 0;
+
+// Right eye synthesized from the left eye's color and depth
+static StereoReprojector reprojector;
+static bool rerenderHoles = false;		// Render the disoccluded tiles again (key T), at the geometry cost of a second eye
+static bool measureReprojection = false;	// Compare with a rendered right eye on the next frame
+
+// Motion-to-photon latency measurement (--latency, or --latency-test for
+// a headless run with synthetic input)
+static LatencyTracker latency;
+static bool latencyEnabled = false;
+static bool latencyHeadless = false;
+static int latencyTestFrames = 600;
+static const char *latencyCsvPath = NULL;
+static uint32_t frameInputSequence = 0;	// Newest input used by the current frame
 
-static SceneMode sceneMode = SceneMode::Debug;
+// Scene control 
+static int numBoxes = 1;				// Debug: set numBoxes to 1.
+static Scene scene;
+static int nbodyCount = 4096;			// Bodies of the NBody scene (--bodies)
+
+// OBJ mesh drawn at the center of every scene (--mesh), see models/obj_loader.h
+static Mesh mesh;
+static bool meshLoaded = false;
+static const char *meshPath = NULL;
+static const char *meshTexturePath = NULL;	// The box texture if not given
+static float meshScale = 10.0f;
+
+// Offline export (--export): a hidden window without vsync, the animation
+// stepped by exactly 1 / exportFps per frame, and every frame read back
+// and written to files, as fast as the machine allows
+static FrameExporter frameExporter;
+static const char *exportPath = NULL;
+static int exportFrames = 300;
+static int exportFps = 60;
+
+// Scene scaling benchmark (--benchmark): every scene and anaglyph mode at
+// each object count and window size, hidden and without vsync, with the
+// animation stepped as for the export. Percentiles of the CPU time up to
+// the swap, of the whole frame and of the GPU time of the rendering are
+// written to a JSON file.
+static const char *benchmarkPath = NULL;
+static std::vector<int> benchmarkCounts = { 100, 1000, 10000 };
+static std::vector<glm::ivec2> benchmarkSizes;	// The window size if empty
+static int benchmarkFrames = 120;
+static int benchmarkWarmup = 20;			// Frames run before the measured ones
+static GpuTimer gpuTimer;
 
 // Helper functions 
 
@@ -103,111 +157,361 @@ static void nextAnaglyphMode() {
 	anaglyphMode = (AnaglyphMode)(((int)anaglyphMode + 1) % (int)AnaglyphModeCount);
 }
 
-static int randomInt() {
-	return rand();
+// Animation clock in seconds: real time, or the fixed step when exporting
+// or benchmarking
+static double animationClock(int frame_count) {
+	return (exportPath || benchmarkPath) ? (double)frame_count / exportFps : glfwGetTime();
+}
+
+static void selectScene(SceneMode mode, int object_count = 100) {
+	if (mode == SceneMode::BlackHole || mode == SceneMode::NBody) eyeCenter = glm::vec3(0, 0, 150);
+	scene.generate(mode, object_count);
 }
 
-static float randomFloat() {
-	float r = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-	return r;
+static void drawScene(Box &box, const glm::mat4 &vp) {
+	renderQueue.clear();
+	for (size_t i = 0; i < scene.boxTransforms.size(); ++i) {
+		box.enqueue(renderQueue, vp, scene.boxTransforms[i]);
+	}
+	if (meshLoaded) mesh.enqueue(renderQueue, vp, glm::scale(glm::mat4(), glm::vec3(meshScale)));
+	renderQueue.sort();
+	renderQueue.submit();
 }
 
-static glm::vec3 randomVec3() {
-	return glm::vec3(randomFloat(), randomFloat(), randomFloat());
+static void drawSceneMultiview(Box &box, const CameraRig &rig) {
+	glm::vec3 forward = glm::normalize(rig.target - rig.eye);
+	renderQueue.clear();
+	for (size_t i = 0; i < scene.boxTransforms.size(); ++i) {
+		float distance = glm::dot(glm::vec3(scene.boxTransforms[i][3]) - rig.eye, forward);
+		multiview.enqueue(renderQueue, box.textureID, box.vertexArrayID, 36, scene.boxTransforms[i], distance);
+	}
+	if (meshLoaded) {
+		float distance = glm::dot(-rig.eye, forward);
+		multiview.enqueue(renderQueue, mesh.textureID, mesh.vertexArrayID, mesh.indexCount,
+			glm::scale(glm::mat4(), glm::vec3(meshScale)), distance);
+	}
+	renderQueue.sort();
+	renderQueue.submit();
 }
 
-static void generateScene() {
-	boxTransforms.clear();
-	if (sceneMode == SceneMode::Debug) {
-		// Use this for debugging
-		glm::mat4 modelMatrix = glm::mat4();
-		modelMatrix = glm::translate(modelMatrix, glm::vec3(0, 0, 0));
-		modelMatrix = glm::scale(modelMatrix, glm::vec3(16, 16, 16));
-		boxTransforms.push_back(modelMatrix);
-	} else if (sceneMode == SceneMode::RandomBoxes) {
-		// Generate boxes based on random position, rotation, and scale. 
-		// Store their transforms.
-		for (int i = 0; i < 100; ++i) {
-			glm::vec3 position = 100.0f * (randomVec3() - 0.5f);
-			float s = (1 + (randomInt() % 4)) * 1.0f;
-			glm::vec3 scale(s, s, s);
-			float angle = randomFloat() * M_PI * 2;
-			glm::vec3 axis = glm::normalize(randomVec3() - 0.5f);
-
-			glm::mat4 modelMatrix = glm::mat4();
-			modelMatrix = glm::translate(modelMatrix, position);
-			modelMatrix = glm::rotate(modelMatrix, angle, axis);
-			modelMatrix = glm::scale(modelMatrix, scale);
-			boxTransforms.push_back(modelMatrix);
-		}
+// Camera rig of view_count views around the current eye
+static CameraRig cameraRig(int view_count, float baseline) {
+	CameraRig rig;
+	rig.eye = eyeCenter;
+	rig.target = lookat;
+	rig.up = up;
+	rig.fovY = glm::radians(FoV);
+	rig.aspect = (float)windowWidth / (float)windowHeight;
+	rig.zNear = zNear;
+	rig.zFar = zFar;
+	rig.baseline = baseline;
+	rig.viewCount = view_count;
+	return rig;
+}
+
+// Move the orbit camera by the integrated input
+static void applyCameraMotion(const CameraMotion &motion) {
+	if (motion.azimuth != 0.0f) {
+		viewAzimuth += motion.azimuth;
+		eyeCenter.x = viewDistance * cos(viewAzimuth);
+		eyeCenter.z = viewDistance * sin(viewAzimuth);
+	}
+	if (motion.polar != 0.0f) {
+		viewPolar += motion.polar;
+		eyeCenter.y = viewDistance * cos(viewPolar);
 	}
-	else if (sceneMode == SceneMode::BlackHole) {
-		int particleCount = 100;
-		boxTransforms.resize(particleCount + 1);
-
-		// Resize particle state arrays
-		bhAngle.resize(particleCount);
-		bhRadius.resize(particleCount);
-		bhAngSpeed.resize(particleCount);
-		bhFallSpeed.resize(particleCount);
-		bhHeight.resize(particleCount);
-		bhYSpeed.resize(particleCount);
-		bhSpinSpeed.resize(particleCount);
-		bhScale.resize(particleCount);
-		bhSpinAxis.resize(particleCount);
-
-		// Black hole cube at origin (index 0)
-		{
-			glm::mat4 modelMatrix(1.0f);
-			modelMatrix = glm::translate(modelMatrix, glm::vec3(0, 0, 0));
-			modelMatrix = glm::scale(modelMatrix, glm::vec3(15, 15, 15));
-			boxTransforms[0] = modelMatrix;
+}
+
+// The fixation point follows the cursor sampled by the input subsystem
+static void applyCursor(GLFWwindow *window) {
+	float x, y;
+	if (!input.takeCursor(x, y)) return;
+
+	// Cursor coordinates are in screen units, which differ from framebuffer
+	// pixels on high-DPI displays
+	int width, height;
+	glfwGetWindowSize(window, &width, &height);
+	if (width > 0 && height > 0) {
+		foveated.setFixation(glm::vec2(2.0f * x / width - 1.0f, 1.0f - 2.0f * y / height));
+	}
+}
+
+// The frame's input sequence number goes into the bottom left pixel, so a
+// readback of the front buffer tells which input is on screen
+static void drawLatencyMarker(uint32_t sequence) {
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, 0, 1, 1);
+	glClearColor((sequence & 0xFF) / 255.0f, ((sequence >> 8) & 0xFF) / 255.0f, ((sequence >> 16) & 0xFF) / 255.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+}
+
+static uint32_t readLatencyMarker() {
+	unsigned char pixel[4];
+	glReadBuffer(GL_FRONT);
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+	glReadBuffer(GL_BACK);
+	uint32_t marker = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+	// The marker holds 24 bits, recover the rest from the newest sequence
+	return frameInputSequence - ((frameInputSequence - marker) & 0xFFFFFF);
+}
+
+// Render the current anaglyph mode into the window's framebuffer
+static void renderAnaglyph(Box &box) {
+	if (anaglyphMode == None) {
+		// Clear the screen
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Set camera view matrix 
+		glm::mat4 viewMatrix = glm::lookAt(eyeCenter, lookat, up);
+		glm::mat4 vp = projectionMatrix * viewMatrix;
+		
+		// Draw 
+		drawScene(box, vp);
+
+	} else if (anaglyphMode == Multiview) {
+		// All views in one instanced submission into the quilt, then
+		// interleaved for the lenticular display
+		std::vector<glm::mat4> viewProjections;
+		CameraRig rig = cameraRig(multiviewCount, 2.0f * ipd);
+		rig.viewProjections(OffAxisProjection, viewProjections);
+
+		multiview.resize(multiviewCount, windowWidth / 2, windowHeight / 2);
+		multiview.begin(viewProjections);
+		drawSceneMultiview(box, rig);
+		multiview.end();
+
+		multiview.composite(windowWidth, windowHeight, lenticular, showQuilt);
+
+	} else if (anaglyphMode == Reprojected) {
+		// The left eye is rendered, the right eye is warped from its color
+		// and depth. The parallel rig keeps the disparity horizontal.
+		CameraRig rig = cameraRig(2, ipd);
+		glm::mat4 vpLeft = rig.viewProjection(0, OffAxisProjection);
+		glm::mat4 vpRight = rig.viewProjection(1, OffAxisProjection);
+
+		std::function<void(const glm::mat4 &)> draw = [&box](const glm::mat4 &vp) { drawScene(box, vp); };
+		reprojector.resize(windowWidth, windowHeight);
+		reprojector.renderLeft(vpLeft, draw);
+		reprojector.synthesizeRight(vpLeft, vpRight, rerenderHoles, draw);
+
+		if (measureReprojection) {
+			ImageError error = reprojector.measureError(vpRight, draw);
+			std::cout << "Reprojected vs rendered right eye: mean absolute error " << error.meanAbsoluteError
+				<< ", PSNR " << error.psnr << " dB" << (rerenderHoles ? " (holes re-rendered)" : "") << std::endl;
+			measureReprojection = false;
 		}
 
-		for (int i = 0; i < particleCount; ++i) {
-			float angle = randomFloat() * (float)(2.0 * M_PI);
-
-			// spawn radius (biased outward)
-			float radius = bhMinRadius + (bhOuterRadius - bhMinRadius) * (0.35f + 0.65f * randomFloat());
-			float height = (randomFloat() * 2.0f - 1.0f) * bhMaxHeight;
-
-			// faster nearer center
-			float chaos = 0.4f + 1.6f * randomFloat();
-			float angSpd = bhBaseAngSpeed * sqrt(bhOuterRadius / radius);
-			float fallSpd = bhBaseFallSpeed * (0.35f + 0.65f * randomFloat());
-			float ySpd = (randomFloat() * 2.0f - 1.0f) * 2.0f;
-			float scale = 0.8f + 2.5f * (radius / bhOuterRadius);
-			float direction = (randomFloat() < 0.5f) ? -1.0f : 1.0f;
-
-			bhAngle[i] = angle;
-			bhRadius[i] = radius;
-			bhHeight[i] = height;
-			bhAngSpeed[i] = angSpd * chaos * direction;
-			bhFallSpeed[i] = fallSpd * chaos;
-			bhYSpeed[i] = ySpd;
-			bhScale[i] = scale;
-
-			bhSpinAxis[i] = glm::normalize(randomVec3() - 0.5f);
-			bhSpinSpeed[i] = 0.8f + 2.5f * randomFloat();
-
-			float x = cosf(angle) * radius;
-			float z = sinf(angle) * radius;
-
-			glm::mat4 modelMatrix(1.0f);
-			modelMatrix = glm::translate(modelMatrix, glm::vec3(x, height, z));
-			modelMatrix = glm::rotate(modelMatrix, angle, glm::vec3(0, 1, 0));
-			modelMatrix = glm::rotate(modelMatrix, randomFloat() * (float)(2.0 * M_PI), bhSpinAxis[i]);
-			modelMatrix = glm::scale(modelMatrix, glm::vec3(scale));
-			boxTransforms[i + 1] = modelMatrix;
+		glViewport(0, 0, windowWidth, windowHeight);
+		glDisable(GL_DEPTH_TEST);
+		glColorMask(GL_TRUE, GL_FALSE, GL_FALSE, GL_FALSE); // R only
+		DrawTexture(reprojector.leftTexture());
+		glColorMask(GL_FALSE, GL_TRUE, GL_TRUE, GL_FALSE); // G and B only
+		DrawTexture(reprojector.rightTexture());
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glEnable(GL_DEPTH_TEST);
+
+	} else {
+		// Left and right eye of a two-view camera rig, one ipd apart
+		CameraRig rig = cameraRig(2, ipd);
+
+		// Toe-in: both eyes look at the target with symmetric frustums.
+		// Asymmetric: parallel eyes, frustums shifted to converge at the target.
+		RigProjection projection = (anaglyphMode == ToeIn) ? ToeInProjection : OffAxisProjection;
+		glm::mat4 vpLeft = rig.viewProjection(0, projection);
+		glm::mat4 vpRight = rig.viewProjection(1, projection);
+
+		if (foveation) {
+			// Multi-resolution eye buffers around the fixation point,
+			// upsampled into the color channels of each eye
+			std::function<void(const glm::mat4 &)> draw = [&box](const glm::mat4 &vp) { drawScene(box, vp); };
+			foveated.renderEye(0, vpLeft, windowWidth, windowHeight, draw);
+			foveated.renderEye(1, vpRight, windowWidth, windowHeight, draw);
+
+			glClear(GL_COLOR_BUFFER_BIT);
+			glColorMask(GL_TRUE, GL_FALSE, GL_FALSE, GL_FALSE); // R only
+			foveated.composite(0, windowWidth, windowHeight);
+			glColorMask(GL_FALSE, GL_TRUE, GL_TRUE, GL_FALSE); // G and B only
+			foveated.composite(1, windowWidth, windowHeight);
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+			lastShadedPixels = foveated.shadedPixels();
+		} else {
+			// Two-pass rendering to draw the anaglyph
+
+			glClear(GL_COLOR_BUFFER_BIT); // Clear all color channels
+
+			// Left eye pass (red channel)
+			glColorMask(GL_TRUE, GL_FALSE, GL_FALSE, GL_FALSE); // R only
+			glClear(GL_DEPTH_BUFFER_BIT);
+			// Draw the boxes for the left eye
+			eyeCounters[0].begin();
+			drawScene(box, vpLeft);
+			eyeCounters[0].end();
+
+			// Right eye pass (cyan channel)
+			glColorMask(GL_FALSE, GL_TRUE, GL_TRUE, GL_FALSE); // G and B only
+			glClear(GL_DEPTH_BUFFER_BIT);
+			// Draw the boxes for the right eye
+			eyeCounters[1].begin();
+			drawScene(box, vpRight);
+			eyeCounters[1].end();
+			
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);  // Reset all channels
+
+			lastShadedPixels = eyeCounters[0].lastResult + eyeCounters[1].lastResult;
 		}
 	}
+}
 
+// Advance the camera rotation and the scene to current_time
+static void advanceAnimation(double current_time) {
+	float deltaTime = float(current_time - animationTime);
+	animationTime = current_time;
+	if (rotating) {
+		if (latencyEnabled) latency.recordInput(CameraUpdate);
+		viewAzimuth += 1.0f * deltaTime;
+		eyeCenter.x = viewDistance * cos(viewAzimuth);
+		eyeCenter.z = viewDistance * sin(viewAzimuth);
+	}
+	
+	scene.update(current_time, deltaTime);
+}
+
+// Milliseconds of the samples from index first on
+static SampleStats MillisecondStats(const std::vector<GLuint64> &nanoseconds, size_t first) {
+	std::vector<double> samples;
+	for (size_t i = first; i < nanoseconds.size(); ++i) samples.push_back(NanosecondsToMilliseconds(nanoseconds[i]));
+	return ComputeStats(samples);
+}
+
+// Run the scene scaling benchmark and write its results to benchmarkPath
+static bool runBenchmark(Box &box) {
+	static const char *sceneNames[] = { "debug", "boxes", "blackhole", "nbody" };
+
+	FILE *file = fopen(benchmarkPath, "w");
+	if (!file) return false;
+	if (benchmarkSizes.empty()) benchmarkSizes.push_back(glm::ivec2(windowWidth, windowHeight));
+
+	JsonWriter json(file);
+	json.beginObject();
+	json.value("build", BuildDescription());
+	json.value("renderer", (const char *)glGetString(GL_RENDERER));
+	json.value("gl_version", (const char *)glGetString(GL_VERSION));
+	json.value("frames", benchmarkFrames);
+	json.value("warmup", benchmarkWarmup);
+	json.value("rotating", rotating);
+	json.beginArray("results");
+
+	int frameCount = benchmarkWarmup + benchmarkFrames;
+	for (const glm::ivec2 &size : benchmarkSizes) {
+		glfwSetWindowSize(window, size.x, size.y);
+		glfwPollEvents();
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		framebuffer_size_callback(window, width, height);
+
+		for (int s = SceneMode::Debug; s <= SceneMode::NBody; ++s) {
+			// The debug scene is a single box, whatever the count
+			std::vector<int> counts = (s == SceneMode::Debug) ? std::vector<int>(1, 1) : benchmarkCounts;
+			for (int count : counts) {
+				for (int m = None; m < AnaglyphModeCount; ++m) {
+					// Every configuration starts from the same state
+					srand(2024);
+					eyeCenter = originalEyeCenter;
+					viewAzimuth = M_PI / 2;
+					selectScene((SceneMode)s, count);
+					anaglyphMode = (AnaglyphMode)m;
+					animationTime = animationClock(0);
+					gpuTimer.results.clear();
+
+					std::vector<GLuint64> cpuTimes, frameTimes;
+					for (int frame = 0; frame < frameCount; ++frame) {
+						if (frame == benchmarkWarmup) {
+							// Only measured frames in the GPU times; the timer
+							// skips frames when the GPU is far behind, so the
+							// warmup cannot be dropped by count afterwards
+							gpuTimer.flush();
+							gpuTimer.results.clear();
+						}
+						uint64_t start = MonotonicTimeNs();
+						renderQueue.resetStats();
+						glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+						gpuTimer.begin();
+						renderAnaglyph(box);
+						gpuTimer.end();
+						lastFrameStats = renderQueue.stats();
+
+						advanceAnimation(animationClock(frame + 1));
+						uint64_t submitted = MonotonicTimeNs();
+
+						glfwSwapBuffers(window);
+						glfwPollEvents();
+						cpuTimes.push_back(submitted - start);
+						frameTimes.push_back(MonotonicTimeNs() - start);
+					}
+					gpuTimer.flush();
+
+					SampleStats cpu = MillisecondStats(cpuTimes, benchmarkWarmup);
+					SampleStats frame = MillisecondStats(frameTimes, benchmarkWarmup);
+					SampleStats gpu = MillisecondStats(gpuTimer.results, 0);
+
+					json.beginObject();
+					json.value("scene", sceneNames[s]);
+					json.value("mode", strAnaglyphMode[m]);
+					json.value("objects", (int64_t)scene.boxTransforms.size());
+					json.value("width", width);
+					json.value("height", height);
+					json.stats("cpu_ms", cpu);
+					json.stats("gpu_ms", gpu);
+					json.stats("frame_ms", frame);
+					json.value("draw_calls", lastFrameStats.drawCalls);
+					json.value("triangles", lastFrameStats.triangles);
+					json.value("state_changes", lastFrameStats.stateChanges());
+					json.endObject();
+
+					printf("%-9s %-34s %6d objects %4dx%-4d  cpu %7.3f ms (p99 %7.3f)  gpu %7.3f ms (p99 %7.3f)  %6d draws %8d triangles\n",
+						sceneNames[s], strAnaglyphMode[m].c_str(), (int)scene.boxTransforms.size(), width, height,
+						cpu.median, cpu.p99, gpu.median, gpu.p99, lastFrameStats.drawCalls, lastFrameStats.triangles);
+					fflush(stdout);
+				}
+			}
+		}
+	}
+
+	json.endArray();
+	json.endObject();
+	fputc('\n', file);
+	return fclose(file) == 0;
 }
 
 // Debugging functions 
 
 static void printAnaglyphMode() {
-	std::cout << "Anaglyph mode: " << strAnaglyphMode[(int)anaglyphMode] << std::endl;
+	std::cout << "Anaglyph mode: " << strAnaglyphMode[(int)anaglyphMode];
+	if (anaglyphMode == Multiview) std::cout << ", " << multiviewCount << " views";
+	std::cout << std::endl;
+}
+
+static void printRenderStats() {
+	std::cout << "Render queue (" << (renderQueue.isSortingEnabled() ? "sorted" : "unsorted") << "): "
+		<< lastFrameStats.drawCalls << " draws, " << lastFrameStats.triangles << " triangles, "
+		<< lastFrameStats.stateChanges() << " state changes per frame ("
+		<< lastFrameStats.programChanges << " program, " << lastFrameStats.textureChanges << " texture, "
+		<< lastFrameStats.meshChanges << " mesh)" << std::endl;
+	if (anaglyphMode == ToeIn || anaglyphMode == Asymmetric) {
+		std::cout << "Shaded pixels per frame: " << lastShadedPixels << " (" << (foveation ? "foveated" : "full rate")
+			<< ", window has " << 2 * windowWidth * windowHeight << " over both eyes)" << std::endl;
+	}
+	if (anaglyphMode == Reprojected) {
+		std::cout << "Re-rendered hole pixels per frame: " << (rerenderHoles ? reprojector.rerenderedPixels() : 0)
+			<< " of " << windowWidth * windowHeight << std::endl;
+	}
 }
 
 static void printVec3(glm::vec3 v) {
@@ -222,8 +526,77 @@ static void printMat4(glm::mat4 m) {
 	std::cout << m[0][3] << " " << m[1][3] << " " << m[2][3] << " " << m[3][3] << std::endl;
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
+	static const char *usage = " [--latency] [--latency-test [frames]] [--latency-csv file]\n"
+		"\t[--export path [--frames n] [--fps n] [--size WxH]] [--scene debug|boxes|blackhole|nbody] [--mode 0-4] [--rotate]\n"
+		"\t[--bodies n] [--theta opening_angle] [--mesh file.obj [--mesh-texture image] [--mesh-scale s]]\n"
+		"\t[--benchmark [file.json] [--bench-counts n,n,...] [--bench-sizes WxH,WxH,...] [--bench-frames n] [--bench-warmup n]]";
+	SceneMode initialScene = SceneMode::Debug;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--latency") == 0) {
+			latencyEnabled = true;
+		} else if (strcmp(argv[i], "--latency-test") == 0) {
+			latencyEnabled = true;
+			latencyHeadless = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-') latencyTestFrames = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--latency-csv") == 0 && i + 1 < argc) {
+			latencyCsvPath = argv[++i];
+		} else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+			exportPath = argv[++i];
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			exportFrames = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			exportFps = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && sscanf(argv[i + 1], "%dx%d", &windowWidth, &windowHeight) == 2) {
+			++i;
+		} else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+			const char *name = argv[++i];
+			initialScene = strcmp(name, "boxes") == 0 ? SceneMode::RandomBoxes :
+				strcmp(name, "blackhole") == 0 ? SceneMode::BlackHole :
+				strcmp(name, "nbody") == 0 ? SceneMode::NBody : SceneMode::Debug;
+		} else if (strcmp(argv[i], "--bodies") == 0 && i + 1 < argc) {
+			nbodyCount = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--theta") == 0 && i + 1 < argc) {
+			scene.nbody.theta = std::max((float)atof(argv[++i]), 0.0f);
+		} else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc) {
+			meshPath = argv[++i];
+		} else if (strcmp(argv[i], "--mesh-texture") == 0 && i + 1 < argc) {
+			meshTexturePath = argv[++i];
+		} else if (strcmp(argv[i], "--mesh-scale") == 0 && i + 1 < argc) {
+			meshScale = (float)atof(argv[++i]);
+		} else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+			anaglyphMode = (AnaglyphMode)glm::clamp(atoi(argv[++i]), 0, (int)AnaglyphModeCount - 1);
+		} else if (strcmp(argv[i], "--benchmark") == 0) {
+			benchmarkPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "scene_bench.json";
+		} else if (strcmp(argv[i], "--bench-counts") == 0 && i + 1 < argc) {
+			benchmarkCounts.clear();
+			int count, length;
+			for (const char *list = argv[++i]; sscanf(list, "%d%n", &count, &length) == 1; list += length + 1) {
+				if (count > 0) benchmarkCounts.push_back(count);
+				if (list[length] != ',') break;
+			}
+		} else if (strcmp(argv[i], "--bench-sizes") == 0 && i + 1 < argc) {
+			benchmarkSizes.clear();
+			glm::ivec2 size;
+			int length;
+			for (const char *list = argv[++i]; sscanf(list, "%dx%d%n", &size.x, &size.y, &length) == 2; list += length + 1) {
+				if (size.x > 0 && size.y > 0) benchmarkSizes.push_back(size);
+				if (list[length] != ',') break;
+			}
+		} else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+			benchmarkFrames = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(argv[i], "--bench-warmup") == 0 && i + 1 < argc) {
+			benchmarkWarmup = std::max(atoi(argv[++i]), 0);
+		} else if (strcmp(argv[i], "--rotate") == 0) {
+			rotating = true;
+		} else {
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+			std::cerr << "Usage: " << argv[0] << usage << std::endl;
+			return -1;
+		}
+	}
+
 	// Initialise GLFW
 	if (!glfwInit())
 	{
@@ -235,6 +608,7 @@ int main(void)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // For MacOS
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	if (latencyHeadless || exportPath || benchmarkPath) glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
 
 	// Open a window and create its OpenGL context
 	window = glfwCreateWindow(windowWidth, windowHeight, "Anaglyph Rendering", NULL, NULL);
@@ -245,7 +619,8 @@ int main(void)
 		return -1;
 	}
 	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1); // Enable vsync
+	glfwSwapInterval((exportPath || benchmarkPath) ? 0 : 1); // Enable vsync, unless exporting or benchmarking
+	glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
 
 	// Ensure we can capture the escape key being pressed below
 	glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
@@ -277,206 +652,130 @@ int main(void)
 	Box box;
 	box.initialize();
 
+	// And the OBJ mesh, if any
+	if (meshPath) {
+		MeshData meshData;
+		if (!LoadObj(meshPath, meshData)) {
+			glfwTerminate();
+			return -1;
+		}
+		GLuint meshTexture = meshTexturePath ? LoadTexture(meshTexturePath) : box.textureID;
+		mesh.initialize(meshData, meshTexture ? meshTexture : box.textureID);
+		meshLoaded = true;
+	}
+
+	multiview.initialize();
+	foveated.initialize();
+	reprojector.initialize();
+
 	// Create the scene with a set of boxes represented by their transforms
-	generateScene();
+	selectScene(initialScene, initialScene == SceneMode::NBody ? nbodyCount : 100);
 
 	// Set a perspective camera 
 	projectionMatrix = glm::perspective(glm::radians(FoV), (float)windowWidth / windowHeight, zNear, zFar);
+	renderQueue.setDepthRange(zNear, zFar);
 
 	printAnaglyphMode();
 
-	do
-	{
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// Render anaglyph 
-
-		if (anaglyphMode == None) {
-			// Clear the screen
-			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-			// Set camera view matrix 
-			glm::mat4 viewMatrix = glm::lookAt(eyeCenter, lookat, up);
-			glm::mat4 vp = projectionMatrix * viewMatrix;
-			
-			// Draw 
-			for (int i = 0; i < boxTransforms.size(); ++i) {
-				box.render(vp, boxTransforms[i]);
-			}
+	if (exportPath) {
+		// Deterministic sequence: no input, and the same frames every run
+		glViewport(0, 0, windowWidth, windowHeight);
+		if (!frameExporter.initialize(windowWidth, windowHeight, exportPath, ExportFormatFromPath(exportPath), exportFps)) {
+			std::cerr << "Failed to open " << exportPath << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		std::cout << "Exporting " << exportFrames << " frames of " << windowWidth << "x" << windowHeight
+			<< " at " << exportFps << " fps to " << exportPath << std::endl;
+	} else if (benchmarkPath) {
+		if (!runBenchmark(box)) std::cerr << "Failed to write " << benchmarkPath << std::endl;
+		else std::cout << "Benchmark results written to " << benchmarkPath << std::endl;
+		glfwSetWindowShouldClose(window, GL_TRUE);
+	} else {
+		input.start();
+	}
 
-		} else {
-			// Declare left and right eye view-projection matrices
-			glm::mat4 vpLeft;
-			glm::mat4 vpRight;
-
-			if (anaglyphMode == ToeIn) {
-				// Toe-in projection here
-
-				// Left eye: offset the eye position to the left by ipd/2
-				glm::vec3 eyeLeft = eyeCenter - glm::vec3(ipd / 2.0f, 0.0f, 0.0f);
-				glm::mat4 viewMatrixLeft = glm::lookAt(eyeLeft, lookat, up);
-				vpLeft = projectionMatrix * viewMatrixLeft;
-
-				// Right eye: offset the eye position to the right by ipd/2
-				glm::vec3 eyeRight = eyeCenter + glm::vec3(ipd / 2.0f, 0.0f, 0.0f);
-				glm::mat4 viewMatrixRight = glm::lookAt(eyeRight, lookat, up);
-				vpRight = projectionMatrix * viewMatrixRight;
-
-			} else if (anaglyphMode == Asymmetric) {
-				// Asymmetric view frustum here
-				
-				glm::vec3 forward = glm::normalize(lookat - eyeCenter);
-				glm::vec3 right = glm::normalize(glm::cross(forward, up));
-
-				// Left eye orientation
-				glm::vec3 eyeLeft = eyeCenter - right * (ipd / 2.0f);
-				glm::mat4 viewMatrixLeft = glm::lookAt(eyeLeft, eyeLeft + forward, up);
-
-				// Right eye orientation
-				glm::vec3 eyeRight = eyeCenter + right * (ipd / 2.0f);
-				glm::mat4 viewMatrixRight = glm::lookAt(eyeRight, eyeRight + forward, up);
-
-				// Symmetric frustum parameters
-				float aspect = (float)windowWidth / (float)windowHeight;
-				float top = zNear * tanf(glm::radians(FoV) / 2.0f);
-				float bottom = -top;
-
-				// Calculate frustum shift
-				float shift = (ipd / 2.0f) * zNear / glm::length(lookat - eyeCenter);
-
-				// Left eye frustum
-				float leftL = -aspect * top + shift; // - near * (w - ipd) / 2d
-				float rightL = aspect * top + shift; // near * (w + ipd) / 2d
-				glm::mat4 projectionMatrixLeft = glm::frustum(leftL, rightL, bottom, top, zNear, zFar);
-				vpLeft = projectionMatrixLeft * viewMatrixLeft;
-
-				// Right eye frustum
-				float leftR = -aspect * top - shift; // - near * (w + ipd) / 2d
-				float rightR = aspect * top - shift; // near * (w - ipd) / 2d
-				glm::mat4 projectionMatrixRight = glm::frustum(leftR, rightR, bottom, top, zNear, zFar);
-				vpRight = projectionMatrixRight * viewMatrixRight;
+	animationTime = animationClock(0);
+	uint64_t exportStart = MonotonicTimeNs();
+	int frameCount = 0;
+	// Until the ESC key is pressed or the window is closed
+	while (!glfwWindowShouldClose(window))
+	{
+		renderQueue.resetStats();
+		if (latencyEnabled) frameInputSequence = latency.consumeInputs();
+
+		// Headless latency test: a synthetic key press every few frames,
+		// through the same path as real input
+		if (latencyHeadless) {
+			if (frameCount % 10 == 0 || frameCount % 10 == 5) {
+				key_callback(window, GLFW_KEY_LEFT, 0, (frameCount % 10 == 0) ? GLFW_PRESS : GLFW_RELEASE, 0);
+				frameInputSequence = latency.consumeInputs();
 			}
+			if (frameCount >= latencyTestFrames) glfwSetWindowShouldClose(window, GL_TRUE);
+		}
+		if (exportPath && frameCount + 1 >= exportFrames) glfwSetWindowShouldClose(window, GL_TRUE);
+		++frameCount;
 
-			// Two-pass rendering to draw the anaglyph
-
-			glClear(GL_COLOR_BUFFER_BIT); // Clear all color channels
-
-			// Left eye pass (red channel)
-			glColorMask(GL_TRUE, GL_FALSE, GL_FALSE, GL_FALSE); // R only
-			glClear(GL_DEPTH_BUFFER_BIT);
-			// Draw the boxes for the left eye
-			for (int i = 0; i < boxTransforms.size(); ++i) {
-				box.render(vpLeft, boxTransforms[i]);
-			}
+		if (!exportPath) {
+			input.sampleCursor(window);
+			applyCameraMotion(input.integrate(MonotonicTimeNs()));
+			applyCursor(window);
+		}
 
-			// Right eye pass (cyan channel)
-			glColorMask(GL_FALSE, GL_TRUE, GL_TRUE, GL_FALSE); // G and B only
-			glClear(GL_DEPTH_BUFFER_BIT);
-			// Draw the boxes for the right eye
-			for (int i = 0; i < boxTransforms.size(); ++i) {
-				box.render(vpRight, boxTransforms[i]);
-			}
-			
-			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);  // Reset all channels
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		}
+		// Render anaglyph 
+		renderAnaglyph(box);
+		lastFrameStats = renderQueue.stats();
 
 		// --------------------------------------------------------------------
 
 
 		// Animation
-		static double lastTime = glfwGetTime();
-		double currentTime = glfwGetTime();
-		float deltaTime = float(currentTime - lastTime);
-		lastTime = currentTime;
-		if (rotating) {
-			viewAzimuth += 1.0f * deltaTime;
-			eyeCenter.x = viewDistance * cos(viewAzimuth);
-			eyeCenter.z = viewDistance * sin(viewAzimuth);
-		}
-		
-		// Black hole animation update
-		if (sceneMode == SceneMode::BlackHole && boxTransforms.size() > 1) {
-			int particleCount = (int)boxTransforms.size() - 1;
-
-			// Rotate black hole cube slowly
-			glm::mat4 modelMatrix(1.0f);
-			modelMatrix = glm::rotate(modelMatrix, (float)currentTime * 0.3f, glm::vec3(1, 1, 1));
-			modelMatrix = glm::scale(modelMatrix, glm::vec3(15, 15, 15));
-			boxTransforms[0] = modelMatrix;
-
-			for (int i = 0; i < particleCount; ++i) {
-				// Orbital motion
-				bhAngle[i] += bhAngSpeed[i] * deltaTime * (1.0f + 2.0f / std::max(bhRadius[i], 20.0f));
-				// Vertical bobbing
-				float wobble = sinf((float)currentTime * 0.7f + i) * 0.2f;
-				bhAngle[i] += wobble * deltaTime;
-				// Radial pull inward
-				float pull = 1.0f + 40.0f / std::max(bhRadius[i], 20.0f);
-				bhRadius[i] -= bhFallSpeed[i] * pull * deltaTime;
-
-				// Vertical drift
-				bhHeight[i] += bhYSpeed[i] * deltaTime;
-				if (bhHeight[i] > bhMaxHeight) { bhHeight[i] = bhMaxHeight; bhYSpeed[i] *= -1.0f; }
-				if (bhHeight[i] < -bhMaxHeight) { bhHeight[i] = -bhMaxHeight; bhYSpeed[i] *= -1.0f; }
-
-				// Event horizon: respawn
-				if (bhRadius[i] < bhInnerRadius) {
-					// Reposition
-					bhAngle[i] = randomFloat() * (float)(2.0 * M_PI);
-					bhRadius[i] = bhMinRadius + (bhOuterRadius - bhMinRadius) * (0.4f + 0.3f * randomFloat());
-					bhHeight[i] = (randomFloat() * 2.0f - 1.0f) * bhMaxHeight;
-					float chaos = 0.4f + 1.6f * randomFloat();
-
-					// Re-roll orbital speeds
-					float direction = (randomFloat() < 0.5f) ? -1.0f : 1.0f;
-					bhAngSpeed[i] = bhBaseAngSpeed * sqrt(bhOuterRadius / bhRadius[i]) * chaos * direction;
-
-					// Radial + vertical speeds
-					bhFallSpeed[i] = bhBaseFallSpeed * (0.35f + 0.65f * randomFloat()) * chaos;
-					bhYSpeed[i] = (randomFloat() * 2.0f - 1.0f) * 2.0f;
-
-					// Visuals
-					bhSpinAxis[i] = glm::normalize(randomVec3() - 0.5f);
-					bhSpinSpeed[i] = 0.8f + 2.5f * randomFloat();
-				}
-
-				// Occasional energy injection
-				if (randomFloat() < 0.2f * deltaTime) {
-					bhRadius[i] *= 0.5f;
-				}
-
-				// Reposition the particle
-				float x = cosf(bhAngle[i]) * bhRadius[i];
-				float z = sinf(bhAngle[i]) * bhRadius[i];
-
-				// Tidal stretching (increases toward center)
-				float baseScale = 0.5f + 2.5f * (bhRadius[i] / bhOuterRadius);
-				float t = glm::clamp(1.0f - (bhRadius[i] / bhOuterRadius), 0.0f, 1.0f);
-				float sx = baseScale * (1.0f + t * 1.5f);
-				float sy = baseScale * (1.0f - t * 0.5f);
-				float sz = baseScale * (1.0f + t * 1.5f);
-
-				// Update transform
-				glm::mat4 modelMatrix(1.0f);
-				modelMatrix = glm::translate(modelMatrix, glm::vec3(x, bhHeight[i], z));
-				modelMatrix = glm::rotate(modelMatrix, bhAngle[i], glm::vec3(1, 1, 1));
-				modelMatrix = glm::rotate(modelMatrix, (float)currentTime * bhSpinSpeed[i], bhSpinAxis[i]);
-				modelMatrix = glm::scale(modelMatrix, glm::vec3(sx, sy, sz));
-				boxTransforms[i + 1] = modelMatrix;
-			}
-		}
+		advanceAnimation(animationClock(frameCount));
 
+		if (latencyEnabled) drawLatencyMarker(frameInputSequence);
+		if (exportPath) frameExporter.capture();
 
 		// Swap buffers
 		glfwSwapBuffers(window);
+		if (latencyEnabled) {
+			latency.frameSwapped(frameInputSequence);
+			if (latencyHeadless) latency.frameVisible(readLatencyMarker());
+		}
 		glfwPollEvents();
+	}
 
-	} // Check if the ESC key was pressed or the window was closed
-	while (!glfwWindowShouldClose(window));
+	if (latencyEnabled) {
+		latency.printReport(std::cout);
+		if (latencyCsvPath && !latency.writeCsv(latencyCsvPath)) {
+			std::cerr << "Failed to write " << latencyCsvPath << std::endl;
+		}
+	}
+
+	if (exportPath) {
+		frameExporter.finish();
+		ExportStats stats = frameExporter.stats();
+		double seconds = NanosecondsToMilliseconds(MonotonicTimeNs() - exportStart) / 1000.0;
+		std::cout << "Exported " << stats.frames << " frames in " << seconds << " s (" << stats.frames / seconds
+			<< " fps), " << stats.writeSeconds << " s encoding; " << stats.readbackWaits << " readback waits, "
+			<< stats.writerWaits << " waits for the writer" << std::endl;
+		if (frameExporter.failed()) std::cerr << "Failed to write some frames to " << exportPath << std::endl;
+	}
 
 	// Clean up
+	input.stop();
+	multiview.cleanup();
+	foveated.cleanup();
+	reprojector.cleanup();
+	frameExporter.cleanup();
+	eyeCounters[0].cleanup();
+	eyeCounters[1].cleanup();
+	gpuTimer.cleanup();
+	if (meshLoaded) {
+		if (mesh.textureID != box.textureID) glDeleteTextures(1, &mesh.textureID);
+		mesh.cleanup();
+	}
 	box.cleanup();
 
 	// Close OpenGL window and terminate GLFW
@@ -488,6 +787,8 @@ int main(void)
 // Is called whenever a key is pressed/released via GLFW
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+	if (latencyEnabled) latency.recordInput(KeyInput);
+
 	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
 	{
 		std::cout << "Space key is pressed." << std::endl;
@@ -503,31 +804,8 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 		viewPolar = M_PI / 2;
 	}
 
-	if (key == GLFW_KEY_UP && (action == GLFW_REPEAT || action == GLFW_PRESS))
-	{
-		viewPolar -= 0.1f;
-		eyeCenter.y = viewDistance * cos(viewPolar);
-	}
-
-	if (key == GLFW_KEY_DOWN && (action == GLFW_REPEAT || action == GLFW_PRESS))
-	{
-		viewPolar += 0.1f;
-		eyeCenter.y = viewDistance * cos(viewPolar);
-	}
-
-	if (key == GLFW_KEY_LEFT && (action == GLFW_REPEAT || action == GLFW_PRESS))
-	{
-		viewAzimuth -= 0.1f;
-		eyeCenter.x = viewDistance * cos(viewAzimuth);
-		eyeCenter.z = viewDistance * sin(viewAzimuth);
-	}
-
-	if (key == GLFW_KEY_RIGHT && (action == GLFW_REPEAT || action == GLFW_PRESS))
-	{
-		viewAzimuth += 0.1f;
-		eyeCenter.x = viewDistance * cos(viewAzimuth);
-		eyeCenter.z = viewDistance * sin(viewAzimuth);
-	}
+	// Arrow keys orbit the camera for as long as they are held, see InputSampler
+	input.pushKey(key, action);
 
 	if (key == GLFW_KEY_M && action == GLFW_PRESS) {
         nextAnaglyphMode(); 
@@ -549,21 +827,69 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 	}
 
 	if (key == GLFW_KEY_1) {
-		sceneMode = SceneMode::Debug;
-		generateScene();
+		selectScene(SceneMode::Debug);
 	}
 
 	if (key == GLFW_KEY_0) {
-		sceneMode = SceneMode::RandomBoxes;
-		generateScene();
+		selectScene(SceneMode::RandomBoxes);
 	}
 
 	// for Part 4: Black Hole
 	if (key == GLFW_KEY_A) {
-		sceneMode = SceneMode::BlackHole;
-		eyeCenter = glm::vec3(0, 0, 150);
 		std::cout << "Black Hole mode activated" << std::endl;
-		generateScene();
+		selectScene(SceneMode::BlackHole);
+	}
+
+	if (key == GLFW_KEY_N && action == GLFW_PRESS) {
+		std::cout << "N-body mode activated: " << nbodyCount << " bodies, opening angle " << scene.nbody.theta << std::endl;
+		selectScene(SceneMode::NBody, nbodyCount);
+	}
+
+	// Number of views in multiview mode
+	if (key == GLFW_KEY_LEFT_BRACKET && (action == GLFW_REPEAT || action == GLFW_PRESS)) {
+		multiviewCount = std::max(multiviewCount - 1, 2);
+		printAnaglyphMode();
+	}
+
+	if (key == GLFW_KEY_RIGHT_BRACKET && (action == GLFW_REPEAT || action == GLFW_PRESS)) {
+		multiviewCount = std::min(multiviewCount + 1, MAX_MULTIVIEW_VIEWS);
+		printAnaglyphMode();
+	}
+
+	if (key == GLFW_KEY_Q && action == GLFW_PRESS) {
+		showQuilt = !showQuilt;
+	}
+
+	// Foveated eye buffers; the fixation point follows the mouse
+	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+		foveation = !foveation;
+		std::cout << "Foveation " << (foveation ? "on" : "off") << std::endl;
+	}
+
+	// Reprojected right eye: hole re-rendering on/off, and error against
+	// the two-pass right eye
+	if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+		rerenderHoles = !rerenderHoles;
+		std::cout << "Hole tile re-rendering " << (rerenderHoles ? "on" : "off") << std::endl;
+	}
+
+	if (key == GLFW_KEY_E && action == GLFW_PRESS) {
+		measureReprojection = true;
+	}
+
+	// Latency distributions so far
+	if (key == GLFW_KEY_L && action == GLFW_PRESS && latencyEnabled) {
+		latency.printReport(std::cout);
+	}
+
+	// Render queue statistics, and sorting on/off to compare
+	if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+		printRenderStats();
+	}
+
+	if (key == GLFW_KEY_O && action == GLFW_PRESS) {
+		renderQueue.setSortingEnabled(!renderQueue.isSortingEnabled());
+		std::cout << "Render queue sorting " << (renderQueue.isSortingEnabled() ? "on" : "off") << std::endl;
 	}
 
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
@@ -571,7 +897,8 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 }
 
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
-	// Optionally, you can implement your own mouse support.
+	// The position itself is sampled by InputSampler, see applyCursor()
+	if (latencyEnabled) latency.recordInput(CursorInput);
 }
 
 static void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
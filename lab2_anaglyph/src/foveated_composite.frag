@@ -0,0 +1,28 @@
+#version 330 core
+
+// Upsample one foveation level into its region of the screen. Finer levels
+// are blended over coarser ones with a feathered border.
+
+in vec2 uv;
+
+uniform sampler2D levelSampler;
+uniform vec4 Region;	// Level rectangle in screen uv: min x, min y, max x, max y
+uniform vec2 Feather;	// Border width in screen uv, 0 for the coarsest level
+
+out vec4 finalColor;
+
+void main()
+{
+    vec2 local = (uv - Region.xy) / (Region.zw - Region.xy);
+    if (any(lessThan(local, vec2(0.0))) || any(greaterThan(local, vec2(1.0)))) discard;
+
+    // Distance to the closest border, relative to the feather width
+    vec2 edge = min(uv - Region.xy, Region.zw - uv);
+    float alpha = 1.0;
+    if (Feather.x > 0.0) {
+        vec2 weight = clamp(edge / Feather, 0.0, 1.0);
+        alpha = smoothstep(0.0, 1.0, min(weight.x, weight.y));
+    }
+
+    finalColor = vec4(texture(levelSampler, local).rgb, alpha);
+}
@@ -0,0 +1,225 @@
+#include "input_sampler.h"
+
+#include <util/clock.h>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/joystick.h>
+#endif
+
+// Camera speeds, in radians per second
+static const float KEY_ANGULAR_SPEED = 2.0f;
+static const float STICK_ANGULAR_SPEED = 3.0f;
+
+// Stick deflection below this is ignored
+static const float STICK_DEADZONE = 0.1f;
+
+enum CameraKey {
+	LeftKey,
+	RightKey,
+	UpKey,
+	DownKey,
+};
+
+// Interval between attempts to open a missing joystick
+static const uint64_t JOYSTICK_RETRY_NS = 1000000000ull;
+
+InputSampler::InputSampler() : running(false), joystickEvents(0), droppedEvents(0), lastTime(0), cursorMoved(false) {
+	for (int i = 0; i < 4; ++i) keyHeld[i] = false;
+	stick[0] = stick[1] = 0.0f;
+	sampledCursor[0] = sampledCursor[1] = -1;
+	cursor[0] = cursor[1] = 0.0f;
+}
+
+void InputSampler::start(const char *joystick_path, int rate_hz) {
+	if (running) return;
+	lastTime = MonotonicTimeNs();
+	running = true;
+	thread = std::thread(&InputSampler::run, this, std::string(joystick_path), std::max(rate_hz, 1));
+}
+
+void InputSampler::stop() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		running = false;
+	}
+	wake.notify_all();
+	if (thread.joinable()) thread.join();
+}
+
+#ifdef __linux__
+
+// Same device interface as GLFW's linux_joystick.c, read on our own thread
+void InputSampler::run(std::string path, int rate_hz) {
+	int periodMs = std::max(1, 1000 / rate_hz);
+	uint64_t lastAttempt = 0;
+	int fd = -1;
+
+	while (running) {
+		if (fd < 0) {
+			uint64_t now = MonotonicTimeNs();
+			if (now - lastAttempt >= JOYSTICK_RETRY_NS) {
+				fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+				lastAttempt = now;
+			}
+			if (fd < 0) {
+				// Nothing to sample until the next attempt
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wake.wait_for(lock, std::chrono::nanoseconds(lastAttempt + JOYSTICK_RETRY_NS - now), [this] { return !running; });
+				continue;
+			}
+		}
+
+		// Wake up on events, or at the sampling period to check for stop()
+		struct pollfd descriptor = { fd, POLLIN, 0 };
+		if (poll(&descriptor, 1, periodMs) <= 0) continue;
+		if (descriptor.revents & (POLLERR | POLLHUP)) {
+			close(fd);
+			fd = -1;
+			continue;
+		}
+
+		struct js_event e;
+		while (read(fd, &e, sizeof(e)) == sizeof(e)) {
+			InputEvent event;
+			event.time = MonotonicTimeNs();
+			event.number = e.number;
+			event.value = e.value;
+			e.type &= ~JS_EVENT_INIT;
+			if (e.type == JS_EVENT_AXIS) event.type = JoystickAxisEvent;
+			else if (e.type == JS_EVENT_BUTTON) event.type = JoystickButtonEvent;
+			else continue;
+
+			if (deviceRing.push(event)) joystickEvents.fetch_add(1, std::memory_order_relaxed);
+			else droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (fd >= 0) close(fd);
+}
+
+#else
+
+void InputSampler::run(std::string path, int rate_hz) {
+}
+
+#endif
+
+bool InputSampler::pushKey(int key, int action) {
+	int index;
+	switch (key) {
+	case GLFW_KEY_LEFT: index = LeftKey; break;
+	case GLFW_KEY_RIGHT: index = RightKey; break;
+	case GLFW_KEY_UP: index = UpKey; break;
+	case GLFW_KEY_DOWN: index = DownKey; break;
+	default: return false;
+	}
+	// Repeats carry no new state
+	if (action == GLFW_REPEAT) return true;
+
+	InputEvent event;
+	event.time = MonotonicTimeNs();
+	event.type = KeyEvent;
+	event.number = (uint8_t)index;
+	event.value = (action == GLFW_PRESS) ? 1 : 0;
+	if (!hostRing.push(event)) droppedEvents.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void InputSampler::sampleCursor(GLFWwindow *window) {
+	double x, y;
+	glfwGetCursorPos(window, &x, &y);
+	int position[2] = { (int)std::max(-32767.0, std::min(x, 32767.0)), (int)std::max(-32767.0, std::min(y, 32767.0)) };
+
+	InputEvent event;
+	event.time = MonotonicTimeNs();
+	event.type = CursorEvent;
+	for (int axis = 0; axis < 2; ++axis) {
+		if (position[axis] == sampledCursor[axis]) continue;
+		sampledCursor[axis] = position[axis];
+		event.number = (uint8_t)axis;
+		event.value = (int16_t)position[axis];
+		if (!hostRing.push(event)) droppedEvents.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool InputSampler::takeCursor(float &x, float &y) {
+	if (!cursorMoved) return false;
+	x = cursor[0];
+	y = cursor[1];
+	cursorMoved = false;
+	return true;
+}
+
+void InputSampler::apply(const InputEvent &event) {
+	if (event.type == KeyEvent) {
+		keyHeld[event.number] = event.value != 0;
+	} else if (event.type == JoystickAxisEvent && event.number < 2) {
+		float value = event.value / 32767.0f;
+		stick[event.number] = (fabsf(value) < STICK_DEADZONE) ? 0.0f : value;
+	} else if (event.type == CursorEvent && event.number < 2) {
+		cursor[event.number] = (float)event.value;
+		cursorMoved = true;
+	}
+}
+
+void InputSampler::rates(float &azimuth_rate, float &polar_rate) const {
+	azimuth_rate = KEY_ANGULAR_SPEED * ((keyHeld[RightKey] ? 1.0f : 0.0f) - (keyHeld[LeftKey] ? 1.0f : 0.0f));
+	polar_rate = KEY_ANGULAR_SPEED * ((keyHeld[DownKey] ? 1.0f : 0.0f) - (keyHeld[UpKey] ? 1.0f : 0.0f));
+	azimuth_rate += STICK_ANGULAR_SPEED * stick[0];
+	polar_rate += STICK_ANGULAR_SPEED * stick[1];
+}
+
+CameraMotion InputSampler::integrate(uint64_t time_ns) {
+	InputEvent event;
+	while (deviceRing.pop(event)) pending.push_back(event);
+	while (hostRing.pop(event)) pending.push_back(event);
+
+	// Keys and cursor, and the joystick, come from two timelines: merge them
+	std::stable_sort(pending.begin(), pending.end(), [](const InputEvent &a, const InputEvent &b) {
+		return a.time < b.time;
+	});
+
+	CameraMotion motion = { 0.0f, 0.0f };
+	size_t used = 0;
+	for (; used < pending.size() && pending[used].time <= time_ns; ++used) {
+		uint64_t eventTime = std::max(pending[used].time, lastTime);
+		float azimuthRate, polarRate;
+		rates(azimuthRate, polarRate);
+		float dt = (float)NanosecondsToMilliseconds(eventTime - lastTime) / 1000.0f;
+		motion.azimuth += azimuthRate * dt;
+		motion.polar += polarRate * dt;
+		lastTime = eventTime;
+		apply(pending[used]);
+	}
+	pending.erase(pending.begin(), pending.begin() + used);
+
+	if (time_ns > lastTime) {
+		CameraMotion rest = predict(time_ns);
+		motion.azimuth += rest.azimuth;
+		motion.polar += rest.polar;
+		lastTime = time_ns;
+	}
+	return motion;
+}
+
+CameraMotion InputSampler::predict(uint64_t time_ns) const {
+	CameraMotion motion = { 0.0f, 0.0f };
+	if (time_ns <= lastTime) return motion;
+	float azimuthRate, polarRate;
+	rates(azimuthRate, polarRate);
+	float dt = (float)NanosecondsToMilliseconds(time_ns - lastTime) / 1000.0f;
+	motion.azimuth = azimuthRate * dt;
+	motion.polar = polarRate * dt;
+	return motion;
+}
@@ -0,0 +1,104 @@
+#ifndef _INPUT_SAMPLER_H_
+#define _INPUT_SAMPLER_H_
+
+#include <util/spsc_ring.h>
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+enum InputEventType {
+	KeyEvent,			// number: GLFW key, value: 1 pressed, 0 released
+	JoystickAxisEvent,	// number: axis, value: -32767..32767
+	JoystickButtonEvent,	// number: button, value: 1 pressed, 0 released
+	CursorEvent,		// number: 0 x, 1 y, value: screen units from the top left
+};
+
+struct InputEvent {
+	uint64_t time;		// MonotonicTimeNs() when the event was seen
+	uint8_t type;
+	uint8_t number;
+	int16_t value;
+};
+
+// Camera motion accumulated over a time interval, in radians
+struct CameraMotion {
+	float azimuth;
+	float polar;
+};
+
+// Input for the orbit camera, decoupled from the frame rate. A thread polls
+// the joystick device at a fixed high rate and timestamps its events into a
+// lock-free ring; key presses and releases from the GLFW callbacks, and the
+// cursor sampled with glfwGetCursorPos, are timestamped the same way into a
+// second ring. Instead of stepping the camera per event, the render loop
+// integrates the held keys and stick deflection over the real time between
+// events, up to the moment the frame is drawn.
+//
+// GLFW only allows its key and cursor functions on the main thread, so the
+// keyboard and cursor are not sampled from the thread but by pushKey() and
+// sampleCursor(); the main thread is then the producer of their ring.
+// Without a joystick the thread sleeps until the next open attempt.
+class InputSampler {
+public:
+	InputSampler();
+	~InputSampler() { stop(); }
+
+	// Start the joystick thread. Linux only; elsewhere only keys are used.
+	// A missing device is retried, so a joystick can be plugged in later.
+	void start(const char *joystick_path = "/dev/input/js0", int rate_hz = 1000);
+	void stop();
+
+	// Main thread, from the key callback. Returns true if the key moves
+	// the camera.
+	bool pushKey(int key, int action);
+
+	// Main thread: record the cursor position if it moved
+	void sampleCursor(GLFWwindow *window);
+
+	// Camera motion from the last call up to time_ns (MonotonicTimeNs)
+	CameraMotion integrate(uint64_t time_ns);
+
+	// Motion from the last integrate() up to time_ns, without consuming
+	// anything
+	CameraMotion predict(uint64_t time_ns) const;
+
+	// Cursor position as of the last integrate(), if it changed since the
+	// previous call
+	bool takeCursor(float &x, float &y);
+
+	uint64_t joystickEventCount() const { return joystickEvents.load(std::memory_order_relaxed); }
+	uint64_t droppedEventCount() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+	void run(std::string path, int rate_hz);
+	void apply(const InputEvent &event);
+	void rates(float &azimuth_rate, float &polar_rate) const;
+
+	std::thread thread;
+	std::atomic<bool> running;
+	std::mutex wakeMutex;
+	std::condition_variable wake;		// stop() during the wait for a joystick
+	std::atomic<uint64_t> joystickEvents;
+	std::atomic<uint64_t> droppedEvents;
+	SpscRing<InputEvent, 4096> deviceRing;		// Joystick thread to main thread
+	SpscRing<InputEvent, 4096> hostRing;		// Key callback and cursor sampling to integrate()
+
+	// Main thread state
+	std::vector<InputEvent> pending;	// Merged from the rings, not yet reached by integrate()
+	uint64_t lastTime;
+	bool keyHeld[4];		// Left, right, up, down
+	float stick[2];			// Azimuth and polar axes, -1..1
+	int sampledCursor[2];	// Last position sampleCursor() recorded
+	float cursor[2];		// As applied by integrate()
+	bool cursorMoved;
+};
+
+#endif
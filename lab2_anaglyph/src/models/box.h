@@ -7,6 +7,7 @@
 
 #include <render/shader.h>
 #include <render/texture.h>
+#include <render/render_queue.h>
 
 #include <vector>
 #include <iostream>
@@ -189,14 +190,28 @@ struct Box {
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(index_buffer_data), index_buffer_data, GL_STATIC_DRAW);
 
+		// Record the attribute layout in the vertex array object once
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+		glEnableVertexAttribArray(1);
+		glBindBuffer(GL_ARRAY_BUFFER, colorBufferID);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+		glEnableVertexAttribArray(2);
+		glBindBuffer(GL_ARRAY_BUFFER, uvBufferID);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
 		// Create and compile our GLSL program from the shaders
-		programID = LoadShaders("C:\\Users\\Pri\\Documents\\GitHub\\CSP7GV7-XR\\lab2_anaglyph\\src\\box.vert", "C:\\Users\\Pri\\Documents\\GitHub\\CSP7GV7-XR\\lab2_anaglyph\\src\\box.frag");
+		// Shaders and texture are embedded in the executable at build time
+		programID = LoadShadersFromResources("box.vert", "box.frag");
 		if (programID == 0)
 		{
 			std::cerr << "Failed to load shaders." << std::endl;
 		}
 
-		textureID = LoadTexture("C:\\Users\\Pri\\Documents\\GitHub\\CSP7GV7-XR\\lab2_anaglyph\\src\\facade4.jpg");
+		textureID = LoadTextureFromResource("facade4.jpg");
 
 		// Get a handle for our "MVP" uniform
 		mvpMatrixID = glGetUniformLocation(programID, "MVP");
@@ -207,21 +222,8 @@ struct Box {
 
 	void render(glm::mat4 cameraMatrix, glm::mat4 modelMatrix) {
 		glUseProgram(programID);
+		glBindVertexArray(vertexArrayID);
 
-		glEnableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-		glEnableVertexAttribArray(1);
-		glBindBuffer(GL_ARRAY_BUFFER, colorBufferID);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-		glEnableVertexAttribArray(2);
-		glBindBuffer(GL_ARRAY_BUFFER, uvBufferID);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
-		
 		// Set model-view-projection matrix
 		glm::mat4 mvp = cameraMatrix * modelMatrix;
 		glUniformMatrix4fv(mvpMatrixID, 1, GL_FALSE, &mvp[0][0]);
@@ -238,10 +240,11 @@ struct Box {
 			GL_UNSIGNED_INT,   // type
 			(void*)0           // element array buffer offset
 		);
+	}
 
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
+	// Queue the box for drawing instead of drawing it right away
+	void enqueue(RenderQueue &queue, glm::mat4 cameraMatrix, glm::mat4 modelMatrix) {
+		queue.add(Opaque, programID, mvpMatrixID, textureSamplerID, textureID, vertexArrayID, 36, cameraMatrix * modelMatrix);
 	}
 
 	void cleanup() {
@@ -0,0 +1,100 @@
+#ifndef _MESH_H_
+#define _MESH_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <render/shader.h>
+#include <render/render_queue.h>
+#include <models/obj_loader.h>
+
+#include <iostream>
+#include <vector>
+#include <stddef.h>
+
+// A loaded triangle mesh, drawn with the same shaders as Box.
+struct Mesh {
+	GLuint vertexArrayID;
+	GLuint vertexBufferID;
+	GLuint colorBufferID;
+	GLuint indexBufferID;
+	GLsizei indexCount;
+
+	GLuint textureID;
+
+	GLuint mvpMatrixID;
+	GLuint textureSamplerID;
+	GLuint programID;
+
+	// The texture is not owned by the mesh
+	void initialize(const MeshData &data, GLuint texture) {
+		indexCount = (GLsizei)data.indexCount;
+		textureID = texture;
+
+		glGenVertexArrays(1, &vertexArrayID);
+		glBindVertexArray(vertexArrayID);
+
+		// Interleaved position, normal, uv as produced by the loader
+		glGenBuffers(1, &vertexBufferID);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, data.vertexCount * sizeof(MeshVertex), data.vertices, GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, uv));
+
+		// The shader's vertex color is not stored in meshes: white, from a
+		// buffer of its own since a constant attribute value is context
+		// state that any other draw may change
+		std::vector<GLubyte> white((size_t)data.vertexCount * 3, 255);
+		glGenBuffers(1, &colorBufferID);
+		glBindBuffer(GL_ARRAY_BUFFER, colorBufferID);
+		glBufferData(GL_ARRAY_BUFFER, white.size(), white.data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)0);
+
+		glGenBuffers(1, &indexBufferID);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indexCount * sizeof(uint32_t), data.indices, GL_STATIC_DRAW);
+
+		glBindVertexArray(0);
+
+		programID = LoadShadersFromResources("box.vert", "box.frag");
+		if (programID == 0)
+		{
+			std::cerr << "Failed to load shaders." << std::endl;
+		}
+
+		mvpMatrixID = glGetUniformLocation(programID, "MVP");
+		textureSamplerID = glGetUniformLocation(programID, "textureSampler");
+	}
+
+	void render(glm::mat4 cameraMatrix, glm::mat4 modelMatrix) {
+		glUseProgram(programID);
+		glBindVertexArray(vertexArrayID);
+
+		glm::mat4 mvp = cameraMatrix * modelMatrix;
+		glUniformMatrix4fv(mvpMatrixID, 1, GL_FALSE, &mvp[0][0]);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glUniform1i(textureSamplerID, 0);
+
+		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (void*)0);
+	}
+
+	void enqueue(RenderQueue &queue, glm::mat4 cameraMatrix, glm::mat4 modelMatrix) {
+		queue.add(Opaque, programID, mvpMatrixID, textureSamplerID, textureID, vertexArrayID, indexCount, cameraMatrix * modelMatrix);
+	}
+
+	void cleanup() {
+		glDeleteBuffers(1, &vertexBufferID);
+		glDeleteBuffers(1, &colorBufferID);
+		glDeleteBuffers(1, &indexBufferID);
+		glDeleteVertexArrays(1, &vertexArrayID);
+		glDeleteProgram(programID);
+	}
+};
+
+#endif
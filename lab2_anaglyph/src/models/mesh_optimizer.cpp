@@ -0,0 +1,309 @@
+#include "mesh_optimizer.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+// Number of cache misses of a FIFO cache over a triangle range. A vertex is
+// in the cache if fewer than cache_size misses happened since it was loaded.
+struct FifoCache {
+	std::vector<uint32_t> loadTime;
+	uint32_t time;
+	unsigned size;
+
+	FifoCache(size_t vertex_count, unsigned cache_size) : loadTime(vertex_count, 0), time(cache_size + 1), size(cache_size) {}
+
+	void reset() {
+		time += size + 1;
+	}
+
+	// Returns true on a miss
+	bool access(uint32_t vertex) {
+		if (time - loadTime[vertex] > size) {
+			loadTime[vertex] = time++;
+			return true;
+		}
+		return false;
+	}
+};
+
+static size_t countMisses(const uint32_t *indices, size_t index_count, size_t vertex_count, unsigned cache_size) {
+	FifoCache cache(vertex_count, cache_size);
+	size_t misses = 0;
+	for (size_t i = 0; i < index_count; ++i) {
+		misses += cache.access(indices[i]);
+	}
+	return misses;
+}
+
+float ComputeACMR(const uint32_t *indices, size_t index_count, size_t vertex_count, unsigned cache_size) {
+	if (index_count < 3) return 0.0f;
+	return (float)countMisses(indices, index_count, vertex_count, cache_size) / (float)(index_count / 3);
+}
+
+float ComputeATVR(const uint32_t *indices, size_t index_count, size_t vertex_count, unsigned cache_size) {
+	std::vector<bool> used(vertex_count, false);
+	size_t usedCount = 0;
+	for (size_t i = 0; i < index_count; ++i) {
+		if (!used[indices[i]]) {
+			used[indices[i]] = true;
+			++usedCount;
+		}
+	}
+	if (usedCount == 0) return 0.0f;
+	return (float)countMisses(indices, index_count, vertex_count, cache_size) / (float)usedCount;
+}
+
+// Triangles using each vertex, as offsets into one array
+struct TriangleAdjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+
+	void build(const uint32_t *indices, size_t index_count, size_t vertex_count) {
+		offsets.assign(vertex_count + 1, 0);
+		for (size_t i = 0; i < index_count; ++i) ++offsets[indices[i] + 1];
+		for (size_t v = 0; v < vertex_count; ++v) offsets[v + 1] += offsets[v];
+
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		triangles.resize(index_count);
+		for (size_t i = 0; i < index_count; ++i) {
+			triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+		}
+	}
+};
+
+void OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count,
+	unsigned cache_size, std::vector<uint32_t> *clusters) {
+	size_t triangleCount = index_count / 3;
+	if (clusters) clusters->clear();
+	if (triangleCount == 0) return;
+
+	TriangleAdjacency adjacency;
+	adjacency.build(indices, index_count, vertex_count);
+
+	// Triangles still to be emitted around each vertex
+	std::vector<uint32_t> live(vertex_count);
+	for (size_t v = 0; v < vertex_count; ++v) live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+	std::vector<uint32_t> cacheTime(vertex_count, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+	result.reserve(index_count);
+
+	uint32_t time = cache_size + 1;
+	size_t cursor = 0;	// Next vertex to try when the dead-end stack is empty
+
+	// Start with the first vertex that has triangles
+	int fanning = -1;
+	while (cursor < vertex_count && live[cursor] == 0) ++cursor;
+	if (cursor < vertex_count) fanning = (int)cursor;
+	bool fromDeadEnd = true;
+
+	while (fanning >= 0) {
+		if (fromDeadEnd && clusters) clusters->push_back((uint32_t)(result.size() / 3));
+
+		// Emit all remaining triangles around the fanning vertex
+		candidates.clear();
+		for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a) {
+			uint32_t t = adjacency.triangles[a];
+			if (emitted[t]) continue;
+			emitted[t] = true;
+
+			for (int k = 0; k < 3; ++k) {
+				uint32_t v = indices[t * 3 + k];
+				result.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (time - cacheTime[v] > cache_size) cacheTime[v] = time++;
+			}
+		}
+
+		// Next fanning vertex: the candidate that will still be in the cache
+		// after its remaining triangles are emitted, and has been there longest
+		int best = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); ++c) {
+			uint32_t v = candidates[c];
+			if (live[v] == 0) continue;
+			int priority = 0;
+			if (time - cacheTime[v] + 2 * live[v] <= cache_size) priority = (int)(time - cacheTime[v]);
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+
+		fromDeadEnd = best < 0;
+		if (best < 0) {
+			// Dead end: go back to a recently used vertex, or scan for a new start
+			while (!deadEnds.empty()) {
+				uint32_t v = deadEnds.back();
+				deadEnds.pop_back();
+				if (live[v] > 0) {
+					best = (int)v;
+					break;
+				}
+			}
+			while (best < 0 && cursor < vertex_count) {
+				if (live[cursor] > 0) best = (int)cursor;
+				++cursor;
+			}
+		}
+		fanning = best;
+	}
+
+	memcpy(indices, &result[0], result.size() * sizeof(uint32_t));
+}
+
+struct OverdrawCluster {
+	uint32_t begin;
+	uint32_t end;
+	float sortKey;
+};
+
+void OptimizeOverdraw(uint32_t *indices, size_t index_count, const MeshVertex *vertices, size_t vertex_count,
+	const std::vector<uint32_t> &clusters, float threshold, unsigned cache_size) {
+	size_t triangleCount = index_count / 3;
+	if (triangleCount == 0 || clusters.empty()) return;
+
+	// Split the dead-end clusters into smaller ones wherever the ACMR since
+	// the last split is already as good as the whole cluster allows
+	std::vector<OverdrawCluster> split;
+	FifoCache cache(vertex_count, cache_size);
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		uint32_t begin = clusters[c];
+		uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : (uint32_t)triangleCount;
+
+		cache.reset();
+		size_t clusterMisses = 0;
+		for (uint32_t t = begin; t < end; ++t) {
+			for (int k = 0; k < 3; ++k) clusterMisses += cache.access(indices[t * 3 + k]);
+		}
+		float limit = threshold * (float)clusterMisses / (float)(end - begin);
+
+		cache.reset();
+		uint32_t start = begin;
+		size_t misses = 0;
+		for (uint32_t t = begin; t < end; ++t) {
+			for (int k = 0; k < 3; ++k) misses += cache.access(indices[t * 3 + k]);
+			if (t + 1 < end && (float)misses / (float)(t + 1 - start) <= limit) {
+				OverdrawCluster cluster = { start, t + 1, 0.0f };
+				split.push_back(cluster);
+				start = t + 1;
+				misses = 0;
+				cache.reset();
+			}
+		}
+		OverdrawCluster cluster = { start, end, 0.0f };
+		split.push_back(cluster);
+	}
+
+	// Mesh centroid, area weighted
+	double meshCentroid[3] = { 0, 0, 0 };
+	double meshArea = 0;
+	std::vector<float> triangleData(triangleCount * 7);	// area, centroid, area weighted normal
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const float *a = vertices[indices[t * 3]].position;
+		const float *b = vertices[indices[t * 3 + 1]].position;
+		const float *c = vertices[indices[t * 3 + 2]].position;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = {
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0],
+		};
+		float area = 0.5f * sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+		float *data = &triangleData[t * 7];
+		data[0] = area;
+		for (int k = 0; k < 3; ++k) {
+			data[1 + k] = (a[k] + b[k] + c[k]) / 3.0f;
+			data[4 + k] = n[k];
+			meshCentroid[k] += data[1 + k] * area;
+		}
+		meshArea += area;
+	}
+	for (int k = 0; k < 3; ++k) meshCentroid[k] = meshArea > 0 ? meshCentroid[k] / meshArea : 0;
+
+	// Clusters that face away from the mesh center are likely in front of the
+	// others, so they go first (dot(cluster center - mesh center, normal), descending)
+	for (size_t c = 0; c < split.size(); ++c) {
+		double centroid[3] = { 0, 0, 0 };
+		double normal[3] = { 0, 0, 0 };
+		double area = 0;
+		for (uint32_t t = split[c].begin; t < split[c].end; ++t) {
+			const float *data = &triangleData[t * 7];
+			for (int k = 0; k < 3; ++k) {
+				centroid[k] += data[1 + k] * data[0];
+				normal[k] += data[4 + k];
+			}
+			area += data[0];
+		}
+		double key = 0;
+		for (int k = 0; k < 3; ++k) {
+			double center = area > 0 ? centroid[k] / area : 0;
+			key += (center - meshCentroid[k]) * normal[k];
+		}
+		double normalLength = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		split[c].sortKey = normalLength > 0 ? (float)(key / normalLength) : 0.0f;
+	}
+
+	std::stable_sort(split.begin(), split.end(), [](const OverdrawCluster &a, const OverdrawCluster &b) {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(index_count);
+	for (size_t c = 0; c < split.size(); ++c) {
+		result.insert(result.end(), indices + split[c].begin * 3, indices + split[c].end * 3);
+	}
+	memcpy(indices, &result[0], result.size() * sizeof(uint32_t));
+}
+
+size_t OptimizeVertexFetch(MeshVertex *vertices, size_t vertex_count, uint32_t *indices, size_t index_count) {
+	const uint32_t UNUSED = 0xFFFFFFFFu;
+	std::vector<uint32_t> remap(vertex_count, UNUSED);
+	std::vector<MeshVertex> reordered;
+	reordered.reserve(vertex_count);
+
+	for (size_t i = 0; i < index_count; ++i) {
+		uint32_t &target = remap[indices[i]];
+		if (target == UNUSED) {
+			target = (uint32_t)reordered.size();
+			reordered.push_back(vertices[indices[i]]);
+		}
+		indices[i] = target;
+	}
+
+	if (!reordered.empty()) memcpy(vertices, &reordered[0], reordered.size() * sizeof(MeshVertex));
+	return reordered.size();
+}
+
+MeshOptimizationStats OptimizeMesh(MeshData &mesh) {
+	MeshOptimizationStats stats = { 0, 0, 0, 0 };
+	if (mesh.indexStorage.empty()) return stats;
+
+	uint32_t *indices = &mesh.indexStorage[0];
+	size_t indexCount = mesh.indexStorage.size();
+	size_t vertexCount = mesh.vertexStorage.size();
+
+	stats.acmrBefore = ComputeACMR(indices, indexCount, vertexCount);
+	stats.atvrBefore = ComputeATVR(indices, indexCount, vertexCount);
+
+	std::vector<uint32_t> clusters;
+	OptimizeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE, &clusters);
+	OptimizeOverdraw(indices, indexCount, &mesh.vertexStorage[0], vertexCount, clusters);
+	vertexCount = OptimizeVertexFetch(&mesh.vertexStorage[0], vertexCount, indices, indexCount);
+	mesh.vertexStorage.resize(vertexCount);
+
+	stats.acmrAfter = ComputeACMR(indices, indexCount, vertexCount);
+	stats.atvrAfter = ComputeATVR(indices, indexCount, vertexCount);
+
+	mesh.useStorage();
+	return stats;
+}
@@ -0,0 +1,48 @@
+#ifndef _MESH_OPTIMIZER_H_
+#define _MESH_OPTIMIZER_H_
+
+#include <models/obj_loader.h>
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+// Post-transform cache size the optimizer and statistics assume. Small
+// enough that the result is good on any GPU.
+static const unsigned VERTEX_CACHE_SIZE = 16;
+
+// Average cache miss ratio: transformed vertices per triangle with a FIFO
+// cache of cache_size entries. 0.5 is the optimum for large grids, 3 the worst.
+float ComputeACMR(const uint32_t *indices, size_t index_count, size_t vertex_count, unsigned cache_size = VERTEX_CACHE_SIZE);
+
+// Average transform to vertex ratio: transformed vertices per referenced
+// vertex. 1 is the optimum.
+float ComputeATVR(const uint32_t *indices, size_t index_count, size_t vertex_count, unsigned cache_size = VERTEX_CACHE_SIZE);
+
+// Reorder triangles for post-transform cache locality with Tipsify (Sander et
+// al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+// If clusters is given, it receives the first triangle of every run that
+// started at a dead end, for use by OptimizeOverdraw.
+void OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count,
+	unsigned cache_size = VERTEX_CACHE_SIZE, std::vector<uint32_t> *clusters = nullptr);
+
+// Reorder the clusters of an OptimizeVertexCache result so that triangles
+// facing outwards are drawn first, which lets early-z reject more of the
+// rest. Clusters are split further as long as the ACMR stays within
+// threshold (e.g. 1.05 = 5% worse) of the cache-optimized order.
+void OptimizeOverdraw(uint32_t *indices, size_t index_count, const MeshVertex *vertices, size_t vertex_count,
+	const std::vector<uint32_t> &clusters, float threshold = 1.05f, unsigned cache_size = VERTEX_CACHE_SIZE);
+
+// Reorder vertices in the order the index buffer first uses them and drop
+// unused ones. Returns the new vertex count.
+size_t OptimizeVertexFetch(MeshVertex *vertices, size_t vertex_count, uint32_t *indices, size_t index_count);
+
+struct MeshOptimizationStats {
+	float acmrBefore, acmrAfter;
+	float atvrBefore, atvrAfter;
+};
+
+// Run all three passes on the storage of a parsed mesh
+MeshOptimizationStats OptimizeMesh(MeshData &mesh);
+
+#endif
@@ -0,0 +1,527 @@
+#include "obj_loader.h"
+#include "mesh_optimizer.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Corner indices are resolved while parsing. Negative (relative) OBJ indices
+// can only be resolved against the chunk being parsed, and may reach back
+// into earlier chunks, so they are kept as a signed offset from the start of
+// the chunk (biased, and tagged) and rebased once the counts of all previous
+// chunks are known.
+static const uint32_t MISSING_INDEX = 0xFFFFFFFFu;
+static const uint32_t INVALID_INDEX = 0xFFFFFFFEu;	// Above any count, so reported as out of range
+static const uint32_t RELATIVE_INDEX = 0x80000000u;
+static const long RELATIVE_BIAS = 0x40000000;
+
+struct ObjChunk {
+	const char *begin;
+	const char *end;
+
+	std::vector<float> positions;	// 3 per position
+	std::vector<float> texcoords;	// 2 per texcoord
+	std::vector<float> normals;		// 3 per normal
+	std::vector<uint32_t> corners;	// v, vt, vn per corner, 3 corners per triangle
+
+	size_t positionBase = 0;
+	size_t texcoordBase = 0;
+	size_t normalBase = 0;
+};
+
+void MeshData::useStorage() {
+	cacheFile.close();
+	vertices = vertexStorage.empty() ? nullptr : &vertexStorage[0];
+	indices = indexStorage.empty() ? nullptr : &indexStorage[0];
+	vertexCount = (uint32_t)vertexStorage.size();
+	indexCount = (uint32_t)indexStorage.size();
+}
+
+// Parsing helpers. None of them read past end, as mapped files are not zero terminated.
+
+static inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char *skipBlanks(const char *p, const char *end) {
+	while (p < end && isBlank(*p)) ++p;
+	return p;
+}
+
+static inline const char *skipLine(const char *p, const char *end) {
+	const char *newline = (const char *)memchr(p, '\n', end - p);
+	return newline ? newline + 1 : end;
+}
+
+static const double powersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static double powerOf10(int exponent) {
+	if (exponent >= 0) {
+		return exponent <= 22 ? powersOf10[exponent] : pow(10.0, exponent);
+	}
+	return -exponent <= 22 ? 1.0 / powersOf10[-exponent] : pow(10.0, exponent);
+}
+
+// Parse a decimal float such as "-1.25e-3". Much faster than strtof since it
+// does not care about locales, and accurate to well below float precision for
+// the values found in meshes.
+static const char *parseFloat(const char *p, const char *end, float &value) {
+	p = skipBlanks(p, end);
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			++digits;
+		} else {
+			++exponent;	// Digits beyond uint64 precision only scale
+		}
+		++p;
+	}
+	if (p < end && *p == '.') {
+		++p;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				++digits;
+				--exponent;
+			}
+			++p;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		++p;
+		bool negativeExponent = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negativeExponent = *p == '-';
+			++p;
+		}
+		int e = 0;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (e < 10000) e = e * 10 + (*p - '0');
+			++p;
+		}
+		exponent += negativeExponent ? -e : e;
+	}
+
+	double result = (double)mantissa;
+	if (exponent != 0) result *= powerOf10(exponent);
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+static inline const char *parseInt(const char *p, const char *end, long &value) {
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	long result = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		result = result * 10 + (*p - '0');
+		++p;
+	}
+	value = negative ? -result : result;
+	return p;
+}
+
+// Turn an OBJ index (1-based, or negative relative to the current count) into
+// a 0-based index, tagging relative ones for rebasing after the merge.
+static inline uint32_t resolveIndex(long index, size_t localCount) {
+	if (index == 0) return MISSING_INDEX;
+	if (index > 0) return (unsigned long)index <= RELATIVE_INDEX ? (uint32_t)(index - 1) : INVALID_INDEX;
+
+	long long offset = (long long)localCount + index;
+	if (offset < -RELATIVE_BIAS || offset >= RELATIVE_BIAS - 1) return INVALID_INDEX;
+	return (uint32_t)(offset + RELATIVE_BIAS) | RELATIVE_INDEX;
+}
+
+static void parseChunk(ObjChunk &chunk) {
+	const char *p = chunk.begin;
+	const char *end = chunk.end;
+
+	// Corners of the current polygon, triangulated as a fan
+	uint32_t first[3], previous[3], current[3];
+
+	while (p < end) {
+		p = skipBlanks(p, end);
+		if (p + 1 >= end) break;
+
+		if (p[0] == 'v') {
+			if (isBlank(p[1])) {
+				float x, y, z;
+				p = parseFloat(p + 1, end, x);
+				p = parseFloat(p, end, y);
+				p = parseFloat(p, end, z);
+				chunk.positions.push_back(x);
+				chunk.positions.push_back(y);
+				chunk.positions.push_back(z);
+			} else if (p[1] == 't') {
+				float u, v;
+				p = parseFloat(p + 2, end, u);
+				p = parseFloat(p, end, v);
+				chunk.texcoords.push_back(u);
+				chunk.texcoords.push_back(v);
+			} else if (p[1] == 'n') {
+				float x, y, z;
+				p = parseFloat(p + 2, end, x);
+				p = parseFloat(p, end, y);
+				p = parseFloat(p, end, z);
+				chunk.normals.push_back(x);
+				chunk.normals.push_back(y);
+				chunk.normals.push_back(z);
+			}
+		} else if (p[0] == 'f' && isBlank(p[1])) {
+			p += 1;
+			int cornerCount = 0;
+			while (true) {
+				p = skipBlanks(p, end);
+				if (p >= end || *p == '\n' || *p == '#') break;
+
+				long v = 0, vt = 0, vn = 0;
+				const char *start = p;
+				p = parseInt(p, end, v);
+				if (p < end && *p == '/') {
+					++p;
+					if (p < end && *p != '/') p = parseInt(p, end, vt);
+					if (p < end && *p == '/') p = parseInt(p + 1, end, vn);
+				}
+				if (p == start) break; // Not an index, give up on the line
+
+				current[0] = resolveIndex(v, chunk.positions.size() / 3);
+				current[1] = resolveIndex(vt, chunk.texcoords.size() / 2);
+				current[2] = resolveIndex(vn, chunk.normals.size() / 3);
+
+				if (cornerCount == 0) {
+					memcpy(first, current, sizeof(current));
+				} else if (cornerCount >= 2) {
+					chunk.corners.insert(chunk.corners.end(), first, first + 3);
+					chunk.corners.insert(chunk.corners.end(), previous, previous + 3);
+					chunk.corners.insert(chunk.corners.end(), current, current + 3);
+				}
+				memcpy(previous, current, sizeof(current));
+				++cornerCount;
+			}
+		}
+
+		p = skipLine(p, end);
+	}
+}
+
+static inline uint32_t rebase(uint32_t index, size_t base) {
+	if (index == MISSING_INDEX || index == INVALID_INDEX || !(index & RELATIVE_INDEX)) return index;
+	long long resolved = (long long)base + (index & ~RELATIVE_INDEX) - RELATIVE_BIAS;
+	return resolved >= 0 && resolved < INVALID_INDEX ? (uint32_t)resolved : INVALID_INDEX;
+}
+
+// Open addressing hash map from a v/vt/vn triplet to the vertex index
+struct CornerMap {
+	struct Slot {
+		uint32_t key[3];
+		uint32_t value;
+	};
+	std::vector<Slot> slots;
+	size_t mask = 0;
+	size_t count = 0;
+
+	static inline size_t hash(const uint32_t *key) {
+		uint64_t h = key[0] * 0x9E3779B97F4A7C15ull;
+		h ^= (key[1] + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+		h ^= (key[2] + 0x85EBCA77C2B2AE63ull) * 0x165667B19E3779F9ull;
+		return (size_t)(h ^ (h >> 29));
+	}
+
+	void reserve(size_t expected) {
+		size_t capacity = 64;
+		while (capacity < expected * 2) capacity <<= 1;
+		Slot empty = { { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX }, 0 };
+		slots.assign(capacity, empty);
+		mask = capacity - 1;
+		count = 0;
+	}
+
+	void grow() {
+		std::vector<Slot> old;
+		old.swap(slots);
+		reserve(old.size());
+		for (size_t i = 0; i < old.size(); ++i) {
+			if (old[i].key[0] != MISSING_INDEX) insert(old[i].key, old[i].value);
+		}
+	}
+
+	// Returns the existing value, or stores and returns value
+	uint32_t insert(const uint32_t *key, uint32_t value) {
+		if ((count + 1) * 2 > slots.size()) grow();
+		size_t i = hash(key) & mask;
+		while (true) {
+			Slot &slot = slots[i];
+			if (slot.key[0] == MISSING_INDEX) {
+				memcpy(slot.key, key, sizeof(slot.key));
+				slot.value = value;
+				++count;
+				return value;
+			}
+			if (slot.key[0] == key[0] && slot.key[1] == key[1] && slot.key[2] == key[2]) {
+				return slot.value;
+			}
+			i = (i + 1) & mask;
+		}
+	}
+};
+
+static void generateNormals(MeshData &mesh, const std::vector<bool> &needsNormal) {
+	std::vector<MeshVertex> &vertices = mesh.vertexStorage;
+	const std::vector<uint32_t> &indices = mesh.indexStorage;
+
+	// Area weighted face normals, accumulated into the vertices that lack one
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const float *a = vertices[indices[i]].position;
+		const float *b = vertices[indices[i + 1]].position;
+		const float *c = vertices[indices[i + 2]].position;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = {
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0],
+		};
+		for (int k = 0; k < 3; ++k) {
+			uint32_t index = indices[i + k];
+			if (!needsNormal[index]) continue;
+			vertices[index].normal[0] += n[0];
+			vertices[index].normal[1] += n[1];
+			vertices[index].normal[2] += n[2];
+		}
+	}
+
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		if (!needsNormal[i]) continue;
+		float *n = vertices[i].normal;
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length > 0.0f) {
+			n[0] /= length;
+			n[1] /= length;
+			n[2] /= length;
+		}
+	}
+}
+
+bool ParseObj(const char *data, size_t size, MeshData &mesh, int thread_count, size_t min_chunk_size) {
+	const char *end = data + size;
+
+	if (thread_count <= 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>(thread_count, size / std::max<size_t>(min_chunk_size, 1)));
+
+	// Split at line boundaries
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char *begin = data;
+	for (size_t i = 0; i < chunkCount; ++i) {
+		const char *chunkEnd = (i + 1 == chunkCount) ? end : data + size / chunkCount * (i + 1);
+		if (chunkEnd < begin) chunkEnd = begin;
+		if (chunkEnd < end) chunkEnd = skipLine(chunkEnd, end);
+		chunks[i].begin = begin;
+		chunks[i].end = chunkEnd;
+		begin = chunkEnd;
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < chunkCount; ++i) {
+		threads.push_back(std::thread(parseChunk, std::ref(chunks[i])));
+	}
+	parseChunk(chunks[0]);
+	for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+	// Offsets of each chunk in the merged attribute arrays
+	size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (size_t i = 0; i < chunkCount; ++i) {
+		chunks[i].positionBase = positionCount;
+		chunks[i].texcoordBase = texcoordCount;
+		chunks[i].normalBase = normalCount;
+		positionCount += chunks[i].positions.size() / 3;
+		texcoordCount += chunks[i].texcoords.size() / 2;
+		normalCount += chunks[i].normals.size() / 3;
+		cornerCount += chunks[i].corners.size() / 3;
+	}
+	if (cornerCount == 0 || positionCount == 0) {
+		std::cerr << "OBJ data has no faces." << std::endl;
+		return false;
+	}
+	if (cornerCount > 0xFFFFFFFEu) {
+		std::cerr << "OBJ data has too many faces." << std::endl;
+		return false;
+	}
+
+	std::vector<float> positions(positionCount * 3), texcoords(texcoordCount * 2), normals(normalCount * 3);
+	for (size_t i = 0; i < chunkCount; ++i) {
+		std::copy(chunks[i].positions.begin(), chunks[i].positions.end(), positions.begin() + chunks[i].positionBase * 3);
+		std::copy(chunks[i].texcoords.begin(), chunks[i].texcoords.end(), texcoords.begin() + chunks[i].texcoordBase * 2);
+		std::copy(chunks[i].normals.begin(), chunks[i].normals.end(), normals.begin() + chunks[i].normalBase * 3);
+	}
+
+	// Deduplicate corners into indexed vertices
+	mesh.vertexStorage.clear();
+	mesh.indexStorage.clear();
+	mesh.indexStorage.reserve(cornerCount);
+	mesh.vertexStorage.reserve(std::min(cornerCount, positionCount * 2));
+
+	CornerMap corners;
+	corners.reserve(std::min(cornerCount, positionCount * 2));
+	std::vector<bool> needsNormal;
+	bool missingNormals = false;
+
+	for (size_t i = 0; i < chunkCount; ++i) {
+		const ObjChunk &chunk = chunks[i];
+		for (size_t c = 0; c < chunk.corners.size(); c += 3) {
+			uint32_t key[3] = {
+				rebase(chunk.corners[c], chunk.positionBase),
+				rebase(chunk.corners[c + 1], chunk.texcoordBase),
+				rebase(chunk.corners[c + 2], chunk.normalBase),
+			};
+			if (key[0] == MISSING_INDEX || key[0] >= positionCount ||
+				(key[1] != MISSING_INDEX && key[1] >= texcoordCount) ||
+				(key[2] != MISSING_INDEX && key[2] >= normalCount)) {
+				std::cerr << "OBJ face index out of range." << std::endl;
+				return false;
+			}
+
+			uint32_t next = (uint32_t)mesh.vertexStorage.size();
+			uint32_t index = corners.insert(key, next);
+			if (index == next) {
+				MeshVertex vertex;
+				memcpy(vertex.position, &positions[key[0] * 3], sizeof(vertex.position));
+				if (key[1] != MISSING_INDEX) {
+					memcpy(vertex.uv, &texcoords[key[1] * 2], sizeof(vertex.uv));
+				} else {
+					vertex.uv[0] = vertex.uv[1] = 0.0f;
+				}
+				if (key[2] != MISSING_INDEX) {
+					memcpy(vertex.normal, &normals[key[2] * 3], sizeof(vertex.normal));
+				} else {
+					vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+					missingNormals = true;
+				}
+				mesh.vertexStorage.push_back(vertex);
+				needsNormal.push_back(key[2] == MISSING_INDEX);
+			}
+			mesh.indexStorage.push_back(index);
+		}
+	}
+
+	if (missingNormals) generateNormals(mesh, needsNormal);
+
+	mesh.useStorage();
+	return true;
+}
+
+// Binary cache layout: header, vertices, indices
+struct MeshCacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceSize;
+	uint64_t sourceTime;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+};
+
+static const char MESH_CACHE_MAGIC[4] = { 'M', 'S', 'H', 'C' };
+static const uint32_t MESH_CACHE_VERSION = 2;
+
+static bool loadCache(const std::string &cache_path, const MappedFile &source, MeshData &mesh) {
+	if (!mesh.cacheFile.open(cache_path.c_str())) return false;
+
+	const MappedFile &cache = mesh.cacheFile;
+	MeshCacheHeader header;
+	if (cache.size < sizeof(header)) {
+		mesh.cacheFile.close();
+		return false;
+	}
+	memcpy(&header, cache.data, sizeof(header));
+
+	size_t expectedSize = sizeof(header) + header.vertexCount * sizeof(MeshVertex) + header.indexCount * sizeof(uint32_t);
+	if (memcmp(header.magic, MESH_CACHE_MAGIC, 4) != 0 || header.version != MESH_CACHE_VERSION ||
+		header.sourceSize != source.size || header.sourceTime != source.modifiedTime ||
+		cache.size != expectedSize) {
+		mesh.cacheFile.close();
+		return false;
+	}
+
+	mesh.vertexStorage.clear();
+	mesh.indexStorage.clear();
+	mesh.vertices = (const MeshVertex *)(cache.data + sizeof(header));
+	mesh.indices = (const uint32_t *)(cache.data + sizeof(header) + header.vertexCount * sizeof(MeshVertex));
+	mesh.vertexCount = header.vertexCount;
+	mesh.indexCount = header.indexCount;
+	return true;
+}
+
+static void writeCache(const std::string &cache_path, const MappedFile &source, const MeshData &mesh) {
+	MeshCacheHeader header;
+	memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+	header.version = MESH_CACHE_VERSION;
+	header.sourceSize = source.size;
+	header.sourceTime = source.modifiedTime;
+	header.vertexCount = mesh.vertexCount;
+	header.indexCount = mesh.indexCount;
+
+	// Write to a temporary file first so a crash never leaves a broken cache
+	std::string temporary = cache_path + ".tmp";
+	FILE *file = fopen(temporary.c_str(), "wb");
+	if (!file) return;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(mesh.vertices, sizeof(MeshVertex), mesh.vertexCount, file) == mesh.vertexCount &&
+		fwrite(mesh.indices, sizeof(uint32_t), mesh.indexCount, file) == mesh.indexCount;
+	ok = fclose(file) == 0 && ok;
+
+	remove(cache_path.c_str());
+	if (!ok || rename(temporary.c_str(), cache_path.c_str()) != 0) {
+		remove(temporary.c_str());
+		std::cout << "Could not write mesh cache " << cache_path << std::endl;
+	}
+}
+
+bool LoadObj(const char *obj_file_path, MeshData &mesh, bool use_cache) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	MappedFile source;
+	if (!source.open(obj_file_path)) {
+		std::cerr << "OBJ file not found " << obj_file_path << std::endl;
+		return false;
+	}
+
+	std::string cache_path = std::string(obj_file_path) + ".meshcache";
+	bool cached = use_cache && loadCache(cache_path, source, mesh);
+	if (!cached) {
+		if (!ParseObj((const char *)source.data, source.size, mesh)) {
+			std::cerr << "Failed to parse OBJ file " << obj_file_path << std::endl;
+			return false;
+		}
+
+		// Optimize once at import, the cache then stores the optimized buffers
+		MeshOptimizationStats stats = OptimizeMesh(mesh);
+		std::cout << "Optimized " << obj_file_path << ": ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter
+			<< ", ATVR " << stats.atvrBefore << " -> " << stats.atvrAfter << std::endl;
+		if (use_cache) writeCache(cache_path, source, mesh);
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Loaded " << obj_file_path << (cached ? " from cache" : "") << ": "
+		<< mesh.vertexCount << " vertices, " << mesh.indexCount / 3 << " triangles in " << ms << " ms" << std::endl;
+	return true;
+}
@@ -0,0 +1,49 @@
+#ifndef _OBJ_LOADER_H_
+#define _OBJ_LOADER_H_
+
+#include <util/mapped_file.h>
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+// Interleaved vertex produced by the loader
+struct MeshVertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+// An indexed triangle mesh. After parsing, the data lives in the storage
+// vectors; when loaded from a cache file, the pointers refer straight into
+// the mapped file and nothing is copied.
+struct MeshData {
+	const MeshVertex *vertices = nullptr;
+	const uint32_t *indices = nullptr;
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+
+	std::vector<MeshVertex> vertexStorage;
+	std::vector<uint32_t> indexStorage;
+	MappedFile cacheFile;
+
+	// Point vertices/indices at the storage vectors
+	void useStorage();
+};
+
+// Load a Wavefront OBJ file into a single indexed mesh. Only geometry is read
+// (v, vt, vn, f); polygons are triangulated as fans and materials and groups
+// are ignored. Identical v/vt/vn corners share one vertex. Missing normals are
+// generated from the faces. The buffers are then reordered for the vertex
+// cache, overdraw and vertex fetch (see models/mesh_optimizer.h).
+//
+// With use_cache, a binary copy is kept next to the file (<path>.meshcache)
+// and is used, with a single mapping, as long as the OBJ file is unchanged.
+bool LoadObj(const char *obj_file_path, MeshData &mesh, bool use_cache = true);
+
+// Parse OBJ text from memory. thread_count 0 picks the hardware concurrency;
+// the text is split into at most one chunk per thread, none smaller than
+// min_chunk_size bytes.
+bool ParseObj(const char *data, size_t size, MeshData &mesh, int thread_count = 0, size_t min_chunk_size = 1 << 20);
+
+#endif
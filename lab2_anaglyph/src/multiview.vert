@@ -0,0 +1,38 @@
+#version 330 core
+
+// Box vertex shader for instanced multiview rendering. Each instance is one
+// view; its output is squeezed into that view's tile of the quilt.
+
+#define MAX_VIEWS 45
+
+// Input
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexColor;
+layout(location = 2) in vec2 vertexUV;
+
+uniform mat4 Model;
+uniform mat4 ViewProjection[MAX_VIEWS];
+uniform ivec2 QuiltTiles;	// Columns, rows
+
+// Output data, to be interpolated for each fragment
+out vec3 color;
+out vec2 uv;
+
+void main() {
+    int view = gl_InstanceID;
+    vec4 position = ViewProjection[view] * Model * vec4(vertexPosition, 1);
+
+    // Keep the view inside its tile
+    gl_ClipDistance[0] = position.w + position.x;
+    gl_ClipDistance[1] = position.w - position.x;
+    gl_ClipDistance[2] = position.w + position.y;
+    gl_ClipDistance[3] = position.w - position.y;
+
+    // Map [-w, w] to the tile's range of the quilt
+    vec2 tile = vec2(view % QuiltTiles.x, view / QuiltTiles.x);
+    position.xy = (position.xy + position.w * (1.0 + 2.0 * tile)) / vec2(QuiltTiles) - position.w;
+    gl_Position = position;
+
+    color = vertexColor;
+    uv = vertexUV;
+}
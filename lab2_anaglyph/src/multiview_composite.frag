@@ -0,0 +1,35 @@
+#version 330 core
+
+// Interleave the views of a quilt for a lenticular display. Every subpixel
+// shows the view that its lens sends in the direction of the viewer.
+
+in vec2 uv;
+
+uniform sampler2D quiltSampler;
+uniform ivec2 QuiltTiles;	// Columns, rows
+uniform int ViewCount;
+uniform float Pitch;		// Lenses per pixel
+uniform float Tilt;			// Horizontal lens shift per pixel row
+uniform float Center;		// Phase of the first lens
+uniform bool ShowQuilt;		// Show the quilt as is, for debugging
+
+out vec3 finalColor;
+
+vec3 sampleView(int view, vec2 uv) {
+    vec2 tile = vec2(view % QuiltTiles.x, view / QuiltTiles.x);
+    return texture(quiltSampler, (tile + uv) / vec2(QuiltTiles)).rgb;
+}
+
+void main()
+{
+    if (ShowQuilt) {
+        finalColor = texture(quiltSampler, uv).rgb;
+        return;
+    }
+
+    for (int subpixel = 0; subpixel < 3; ++subpixel) {
+        float phase = fract((gl_FragCoord.x + subpixel / 3.0 + gl_FragCoord.y * Tilt) * Pitch + Center);
+        int view = min(int(phase * ViewCount), ViewCount - 1);
+        finalColor[subpixel] = sampleView(view, uv)[subpixel];
+    }
+}
@@ -0,0 +1,52 @@
+#include "camera_rig.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <math.h>
+
+glm::vec3 CameraRig::right() const {
+	glm::vec3 forward = glm::normalize(target - eye);
+	return glm::normalize(glm::cross(forward, up));
+}
+
+float CameraRig::viewOffset(int view) const {
+	if (viewCount < 2) return 0.0f;
+	return baseline * ((float)view / (float)(viewCount - 1) - 0.5f);
+}
+
+glm::vec3 CameraRig::viewPosition(int view) const {
+	return eye + right() * viewOffset(view);
+}
+
+glm::mat4 CameraRig::viewMatrix(int view, RigProjection projection) const {
+	glm::vec3 position = viewPosition(view);
+	if (projection == ToeInProjection) {
+		return glm::lookAt(position, target, up);
+	}
+	glm::vec3 forward = glm::normalize(target - eye);
+	return glm::lookAt(position, position + forward, up);
+}
+
+glm::mat4 CameraRig::projectionMatrix(int view, RigProjection projection) const {
+	if (projection == ToeInProjection) {
+		return glm::perspective(fovY, aspect, zNear, zFar);
+	}
+
+	// Symmetric frustum shifted against the view offset, so all views agree
+	// on the image of the plane at the target distance
+	float top = zNear * tanf(fovY / 2.0f);
+	float bottom = -top;
+	float shift = viewOffset(view) * zNear / glm::length(target - eye);
+	return glm::frustum(-aspect * top - shift, aspect * top - shift, bottom, top, zNear, zFar);
+}
+
+glm::mat4 CameraRig::viewProjection(int view, RigProjection projection) const {
+	return projectionMatrix(view, projection) * viewMatrix(view, projection);
+}
+
+void CameraRig::viewProjections(RigProjection projection, std::vector<glm::mat4> &result) const {
+	result.resize(viewCount);
+	for (int i = 0; i < viewCount; ++i) {
+		result[i] = viewProjection(i, projection);
+	}
+}
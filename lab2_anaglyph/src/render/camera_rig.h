@@ -0,0 +1,44 @@
+#ifndef _CAMERA_RIG_H_
+#define _CAMERA_RIG_H_
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+enum RigProjection {
+	ToeInProjection,	// Every view looks at the target, symmetric frustums
+	OffAxisProjection,	// Parallel views with asymmetric frustums converging at the target
+};
+
+// A row of viewCount cameras spread along the camera's right axis, centered
+// on eye. Two views one ipd apart give the anaglyph eyes; more views feed
+// autostereoscopic displays. The target distance is the convergence
+// (zero parallax) distance.
+struct CameraRig {
+	glm::vec3 eye;
+	glm::vec3 target;
+	glm::vec3 up;
+
+	float fovY;			// Vertical field of view in radians
+	float aspect;
+	float zNear;
+	float zFar;
+
+	float baseline;		// Distance between the outermost views
+	int viewCount;
+
+	glm::vec3 right() const;
+
+	// Offset of a view along the right axis, from -baseline/2 to baseline/2
+	float viewOffset(int view) const;
+	glm::vec3 viewPosition(int view) const;
+
+	glm::mat4 viewMatrix(int view, RigProjection projection) const;
+	glm::mat4 projectionMatrix(int view, RigProjection projection) const;
+	glm::mat4 viewProjection(int view, RigProjection projection) const;
+
+	// All views at once
+	void viewProjections(RigProjection projection, std::vector<glm::mat4> &result) const;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "foveated.h"
+#include "shader.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <math.h>
+
+#include <algorithm>
+#include <iostream>
+
+// Width of the blend between a level and the next coarser one, as a
+// fraction of the level's extent
+static const float FEATHER = 0.1f;
+
+FoveatedRenderer::FoveatedRenderer() : fixation(0.0f, 0.0f) {
+	// Quarter rate periphery, half rate middle ring, full rate center
+	std::vector<FoveationLevel> defaults;
+	FoveationLevel outer = { 1.0f, 0.25f };
+	FoveationLevel middle = { 0.6f, 0.5f };
+	FoveationLevel inner = { 0.3f, 1.0f };
+	defaults.push_back(outer);
+	defaults.push_back(middle);
+	defaults.push_back(inner);
+	setLevels(defaults);
+}
+
+bool FoveatedRenderer::initialize() {
+	programID = LoadShadersFromResources("fullscreen.vert", "foveated_composite.frag");
+	if (programID == 0) {
+		std::cerr << "Failed to load foveated composite shaders." << std::endl;
+		return false;
+	}
+	samplerID = glGetUniformLocation(programID, "levelSampler");
+	regionID = glGetUniformLocation(programID, "Region");
+	featherID = glGetUniformLocation(programID, "Feather");
+	return true;
+}
+
+void FoveatedRenderer::cleanup() {
+	for (int eye = 0; eye < 2; ++eye) {
+		for (int l = 0; l < MAX_FOVEATION_LEVELS; ++l) {
+			targets[eye][l].cleanup();
+			counters[eye][l].cleanup();
+		}
+	}
+	glDeleteProgram(programID);
+	programID = 0;
+}
+
+void FoveatedRenderer::setLevels(const std::vector<FoveationLevel> &new_levels) {
+	levels.assign(new_levels.begin(), new_levels.begin() + std::min((int)new_levels.size(), MAX_FOVEATION_LEVELS));
+}
+
+glm::vec4 FoveatedRenderer::levelRegion(int level) const {
+	float half = glm::clamp(levels[level].size, 0.01f, 1.0f);
+	glm::vec2 center = glm::clamp(fixation, glm::vec2(-1.0f + half), glm::vec2(1.0f - half));
+	return glm::vec4(center - half, center + half);
+}
+
+void FoveatedRenderer::renderEye(int eye, const glm::mat4 &vp, int width, int height,
+	const std::function<void(const glm::mat4 &)> &draw) {
+	for (int l = 0; l < (int)levels.size(); ++l) {
+		glm::vec4 region = levelRegion(l);
+		glm::vec2 extent(region.z - region.x, region.w - region.y);
+
+		int w = std::max(1, (int)lroundf(width * extent.x / 2.0f * levels[l].scale));
+		int h = std::max(1, (int)lroundf(height * extent.y / 2.0f * levels[l].scale));
+		RenderTarget &target = targets[eye][l];
+		if (target.framebufferID == 0) target.initialize(w, h);
+		else target.resize(w, h);
+
+		target.bind();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Depth 0 where the next finer level is opaque, so early-z rejects
+		// everything there. Its feather band stays open: the composite
+		// blends both levels there, so both shade it.
+		if (l + 1 < (int)levels.size()) {
+			glm::vec4 inner = levelRegion(l + 1);
+			glm::vec2 border = FEATHER * glm::vec2(inner.z - inner.x, inner.w - inner.y);
+			inner += glm::vec4(border, -border);
+
+			int x0 = (int)ceilf((inner.x - region.x) / extent.x * w);
+			int y0 = (int)ceilf((inner.y - region.y) / extent.y * h);
+			int x1 = (int)floorf((inner.z - region.x) / extent.x * w);
+			int y1 = (int)floorf((inner.w - region.y) / extent.y * h);
+			if (x1 > x0 && y1 > y0) {
+				glEnable(GL_SCISSOR_TEST);
+				glScissor(x0, y0, x1 - x0, y1 - y0);
+				glClearDepth(0.0);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				glClearDepth(1.0);
+				glDisable(GL_SCISSOR_TEST);
+			}
+		}
+
+		// Map the level's rectangle of clip space to the whole target
+		glm::mat4 crop = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / extent.x, 2.0f / extent.y, 1.0f)) *
+			glm::translate(glm::mat4(1.0f), glm::vec3(-(region.x + region.z) / 2.0f, -(region.y + region.w) / 2.0f, 0.0f));
+
+		counters[eye][l].begin();
+		draw(crop * vp);
+		counters[eye][l].end();
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void FoveatedRenderer::composite(int eye, int width, int height) {
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glUseProgram(programID);
+	glActiveTexture(GL_TEXTURE0);
+	glUniform1i(samplerID, 0);
+	for (int l = 0; l < (int)levels.size(); ++l) {
+		glm::vec4 region = levelRegion(l) * 0.5f + 0.5f;
+		glm::vec2 feather = (l == 0) ? glm::vec2(0.0f) : FEATHER * glm::vec2(region.z - region.x, region.w - region.y);
+
+		glBindTexture(GL_TEXTURE_2D, targets[eye][l].colorTextureID);
+		glUniform4f(regionID, region.x, region.y, region.z, region.w);
+		glUniform2f(featherID, feather.x, feather.y);
+		DrawFullscreenTriangle();
+	}
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+}
+
+GLuint64 FoveatedRenderer::shadedPixels() const {
+	GLuint64 total = 0;
+	for (int eye = 0; eye < 2; ++eye) {
+		for (int l = 0; l < (int)levels.size(); ++l) total += counters[eye][l].lastResult;
+	}
+	return total;
+}
@@ -0,0 +1,75 @@
+#ifndef _FOVEATED_H_
+#define _FOVEATED_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <render/framebuffer.h>
+#include <render/gpu_query.h>
+
+#include <functional>
+#include <vector>
+
+// A rectangle around the fixation point rendered at a given resolution scale
+struct FoveationLevel {
+	float size;		// Fraction of the screen width and height covered
+	float scale;	// Resolution relative to the window
+};
+
+static const int MAX_FOVEATION_LEVELS = 4;
+
+// Multi-resolution eye buffers. Each level renders the part of the view
+// around the fixation point into its own target through a cropped
+// projection; the outer levels cover more of the screen at a lower
+// resolution. The composite step upsamples the levels and blends each one
+// over the next coarser one across a feather band at its border.
+//
+// The area a finer level covers, less its feather band, is masked out of
+// the coarser ones with the depth buffer. The band itself is shaded by
+// both levels, since the blend needs both colors there. With the default
+// levels a full-screen scene costs about 0.21 of the full-rate samples per
+// eye, of which the bands take about 0.016 (8% of the foveated total).
+class FoveatedRenderer {
+public:
+	FoveatedRenderer();
+
+	bool initialize();
+	void cleanup();
+
+	// Levels from the coarsest (size 1, the whole view) to the finest
+	void setLevels(const std::vector<FoveationLevel> &levels);
+
+	// Fixation point in normalized device coordinates
+	void setFixation(glm::vec2 ndc) { fixation = glm::clamp(ndc, glm::vec2(-1.0f), glm::vec2(1.0f)); }
+	glm::vec2 getFixation() const { return fixation; }
+
+	// Render one eye (0 or 1). draw is called once per level with the view
+	// projection cropped to that level.
+	void renderEye(int eye, const glm::mat4 &vp, int width, int height,
+		const std::function<void(const glm::mat4 &)> &draw);
+
+	// Upsample the eye into the bound framebuffer. The caller sets the color
+	// mask of the eye.
+	void composite(int eye, int width, int height);
+
+	// Samples that passed the depth test over both eyes and all levels, as
+	// counted in the previous frame
+	GLuint64 shadedPixels() const;
+
+private:
+	// Level rectangle in NDC, kept on screen
+	glm::vec4 levelRegion(int level) const;
+
+	std::vector<FoveationLevel> levels;
+	glm::vec2 fixation;
+
+	RenderTarget targets[2][MAX_FOVEATION_LEVELS];
+	SampleCounter counters[2][MAX_FOVEATION_LEVELS];
+
+	GLuint programID = 0;
+	GLint samplerID = -1;
+	GLint regionID = -1;
+	GLint featherID = -1;
+};
+
+#endif
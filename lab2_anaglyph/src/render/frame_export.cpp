@@ -0,0 +1,207 @@
+#include "frame_export.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+ExportFormat ExportFormatFromPath(const std::string &path) {
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return ExportPNG;
+	std::string extension = path.substr(dot + 1);
+	for (char &c : extension) c = (char)tolower(c);
+	if (extension == "ppm") return ExportPPM;
+	if (extension == "y4m") return ExportY4M;
+	return ExportPNG;
+}
+
+// The pattern goes to snprintf, so it must hold exactly one %d, with at
+// most a zero flag and a width (%05d); %% is a literal percent sign
+static bool isFramePattern(const std::string &pattern) {
+	int conversions = 0;
+	for (size_t i = 0; i < pattern.size(); ++i) {
+		if (pattern[i] != '%') continue;
+		if (++i < pattern.size() && pattern[i] == '%') continue;
+		while (i < pattern.size() && isdigit((unsigned char)pattern[i])) ++i;
+		if (i >= pattern.size() || pattern[i] != 'd') return false;
+		++conversions;
+	}
+	return conversions == 1;
+}
+
+bool FrameExporter::initialize(int width, int height, const std::string &path, ExportFormat format, int fps) {
+	cleanup();
+	this->width = width;
+	this->height = height;
+	this->format = format;
+
+	if (format == ExportY4M) {
+		if (!y4m.open(path.c_str(), width, height, fps)) return false;
+	} else {
+		pattern = path;
+		if (pattern.find('%') == std::string::npos) {
+			if (!pattern.empty() && pattern.back() != '/' && pattern.back() != '\\') pattern += '/';
+			pattern += format == ExportPPM ? "%05d.ppm" : "%05d.png";
+		}
+		if (!isFramePattern(pattern)) return false;
+	}
+
+	glGenBuffers(READBACK_BUFFERS, packBuffers);
+	for (int i = 0; i < READBACK_BUFFERS; ++i) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	frames.resize(QUEUED_FRAMES);
+	for (Frame &frame : frames) {
+		frame.rgba.resize((size_t)width * height * 4);
+		freeFrames.push_back(&frame);
+	}
+	rgb.resize((size_t)width * height * 3);
+	stopping = false;
+	writeFailed = false;
+	counters = ExportStats();
+	writer = std::thread(&FrameExporter::writerLoop, this);
+	return true;
+}
+
+void FrameExporter::capture() {
+	if (!packBuffers[0]) return;
+
+	// The slot's previous frame goes to the writer first
+	int slot = (int)(captured % READBACK_BUFFERS);
+	if (captured - collected == READBACK_BUFFERS) collect(slot);
+
+	GLint alignment;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[slot]);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, alignment);
+	fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	++captured;
+}
+
+// Map the oldest readback of the ring into a free frame for the writer
+void FrameExporter::collect(int slot) {
+	if (glClientWaitSync(fences[slot], 0, 0) == GL_TIMEOUT_EXPIRED) {
+		++counters.readbackWaits;
+		glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, ~(GLuint64)0);
+	}
+	glDeleteSync(fences[slot]);
+	fences[slot] = 0;
+
+	Frame *frame;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (freeFrames.empty()) {
+			++counters.writerWaits;
+			frameFree.wait(lock, [this]() { return !freeFrames.empty(); });
+		}
+		frame = freeFrames.back();
+		freeFrames.pop_back();
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[slot]);
+	const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)width * height * 4, GL_MAP_READ_BIT);
+	if (pixels) {
+		memcpy(&frame->rgba[0], pixels, frame->rgba.size());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	} else {
+		memset(&frame->rgba[0], 0, frame->rgba.size());
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	frame->index = collected++;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(frame);
+		++counters.frames;
+	}
+	frameReady.notify_one();
+}
+
+void FrameExporter::writerLoop() {
+	for (;;) {
+		Frame *frame;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frameReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+			if (queue.empty()) return;
+			frame = queue.front();
+			queue.pop_front();
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		bool ok = writeFrame(*frame);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			counters.writeSeconds += seconds;
+			if (!ok) writeFailed = true;
+			freeFrames.push_back(frame);
+		}
+		frameFree.notify_one();
+	}
+}
+
+bool FrameExporter::writeFrame(Frame &frame) {
+	// RGBA bottom-up to RGB top-down
+	for (int y = 0; y < height; ++y) {
+		const uint8_t *source = &frame.rgba[(size_t)(height - 1 - y) * width * 4];
+		uint8_t *target = &rgb[(size_t)y * width * 3];
+		for (int x = 0; x < width; ++x) {
+			target[x * 3] = source[x * 4];
+			target[x * 3 + 1] = source[x * 4 + 1];
+			target[x * 3 + 2] = source[x * 4 + 2];
+		}
+	}
+
+	if (format == ExportY4M) return y4m.write(&rgb[0]);
+
+	char path[1024];
+	snprintf(path, sizeof(path), pattern.c_str(), (int)frame.index);
+	if (format == ExportPPM) return WritePPM(path, &rgb[0], width, height);
+	return WritePNG(path, &rgb[0], width, height);
+}
+
+void FrameExporter::finish() {
+	if (!writer.joinable()) return;
+	while (collected < captured) collect((int)(collected % READBACK_BUFFERS));
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	frameReady.notify_one();
+	writer.join();
+	y4m.close();
+}
+
+void FrameExporter::cleanup() {
+	finish();
+	if (packBuffers[0]) glDeleteBuffers(READBACK_BUFFERS, packBuffers);
+	for (int i = 0; i < READBACK_BUFFERS; ++i) {
+		packBuffers[i] = 0;
+		if (fences[i]) glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	captured = collected = 0;
+	queue.clear();
+	freeFrames.clear();
+	frames.clear();
+}
+
+ExportStats FrameExporter::stats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return counters;
+}
+
+bool FrameExporter::failed() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return writeFailed;
+}
@@ -0,0 +1,101 @@
+#ifndef _FRAME_EXPORT_H_
+#define _FRAME_EXPORT_H_
+
+#include <glad/gl.h>
+
+#include <util/image_writer.h>
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum ExportFormat {
+	ExportPPM,		// One file per frame
+	ExportPNG,		// One file per frame
+	ExportY4M,		// One video stream
+};
+
+// Format from the extension of the path, PNG if there is none
+ExportFormat ExportFormatFromPath(const std::string &path);
+
+struct ExportStats {
+	uint64_t frames;			// Handed to the writer
+	uint64_t readbackWaits;		// Readbacks not finished when their buffer came around again
+	uint64_t writerWaits;		// Frames that waited for the writer to free a buffer
+	double writeSeconds;		// Spent encoding and writing, on the writer thread
+};
+
+// Saves rendered frames to files without stalling the GPU. capture() only
+// queues a glReadPixels into the next pixel buffer object of a ring, with a
+// fence behind it; the pixels are mapped a few frames later, when the copy
+// is long done, and handed to a writer thread that converts and encodes
+// them. No frame is dropped: when the writer falls behind, capture() waits
+// for it.
+//
+// For one file per frame, the path is a printf pattern with the frame
+// number (frames/%05d.png); a path without one is a directory, which gets
+// %05d.<ext> appended. A pattern with any other conversion than one %d
+// is refused.
+class FrameExporter {
+public:
+	FrameExporter() {}
+	~FrameExporter() { cleanup(); }
+
+	bool initialize(int width, int height, const std::string &path, ExportFormat format, int fps);
+
+	// Read the bottom left width x height pixels of the current read
+	// framebuffer as the next frame
+	void capture();
+
+	// Write every frame captured so far and stop the writer
+	void finish();
+	void cleanup();
+
+	ExportStats stats() const;
+	bool failed() const;
+
+private:
+	struct Frame {
+		uint64_t index;
+		std::vector<uint8_t> rgba;		// Bottom row first, as read
+	};
+
+	void collect(int slot);
+	void writerLoop();
+	bool writeFrame(Frame &frame);
+
+	static const int READBACK_BUFFERS = 3;
+	static const int QUEUED_FRAMES = 4;
+
+	int width = 0;
+	int height = 0;
+	ExportFormat format = ExportPNG;
+	std::string pattern;
+	Y4MWriter y4m;
+
+	GLuint packBuffers[READBACK_BUFFERS] = { 0 };
+	GLsync fences[READBACK_BUFFERS] = { 0 };
+	uint64_t captured = 0;		// Frames read into the ring
+	uint64_t collected = 0;		// Frames taken out of it
+
+	// Frames between the render thread and the writer
+	std::thread writer;
+	mutable std::mutex mutex;
+	std::condition_variable frameReady;
+	std::condition_variable frameFree;
+	std::deque<Frame *> queue;
+	std::vector<Frame *> freeFrames;
+	std::vector<Frame> frames;
+	bool stopping = false;
+	bool writeFailed = false;
+	std::vector<uint8_t> rgb;		// Writer thread
+
+	ExportStats counters = {};
+};
+
+#endif
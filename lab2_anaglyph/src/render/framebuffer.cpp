@@ -0,0 +1,90 @@
+#include "framebuffer.h"
+#include "shader.h"
+
+#include <iostream>
+
+bool RenderTarget::initialize(int width, int height, DepthAttachment depth, GLenum color_format) {
+	this->width = width;
+	this->height = height;
+	depthAttachment = depth;
+	colorFormat = color_format;
+
+	glGenTextures(1, &colorTextureID);
+	glBindTexture(GL_TEXTURE_2D, colorTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, color_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenFramebuffers(1, &framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTextureID, 0);
+
+	if (depth != NoDepth) {
+		glGenTextures(1, &depthTextureID);
+		glBindTexture(GL_TEXTURE_2D, depthTextureID);
+		if (depth == DepthStencilTexture) {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GLenum attachment = (depth == DepthStencilTexture) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, depthTextureID, 0);
+	}
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Framebuffer incomplete: 0x" << std::hex << status << std::dec << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void RenderTarget::resize(int width, int height) {
+	if (width == this->width && height == this->height && framebufferID != 0) return;
+	cleanup();
+	initialize(width, height, depthAttachment, colorFormat);
+}
+
+void RenderTarget::bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glViewport(0, 0, width, height);
+}
+
+void RenderTarget::cleanup() {
+	if (framebufferID) glDeleteFramebuffers(1, &framebufferID);
+	if (colorTextureID) glDeleteTextures(1, &colorTextureID);
+	if (depthTextureID) glDeleteTextures(1, &depthTextureID);
+	framebufferID = 0;
+	colorTextureID = 0;
+	depthTextureID = 0;
+}
+
+void DrawFullscreenTriangle() {
+	// Core profile needs a vertex array object bound even without attributes
+	static GLuint emptyVertexArrayID = 0;
+	if (emptyVertexArrayID == 0) glGenVertexArrays(1, &emptyVertexArrayID);
+	glBindVertexArray(emptyVertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void DrawTexture(GLuint texture) {
+	static GLuint programID = 0;
+	static GLint samplerID = -1;
+	if (programID == 0) {
+		programID = LoadShadersFromResources("fullscreen.vert", "blit.frag");
+		samplerID = glGetUniformLocation(programID, "textureSampler");
+	}
+
+	glUseProgram(programID);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glUniform1i(samplerID, 0);
+	DrawFullscreenTriangle();
+}
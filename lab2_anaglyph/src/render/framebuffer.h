@@ -0,0 +1,43 @@
+#ifndef _FRAMEBUFFER_H_
+#define _FRAMEBUFFER_H_
+
+#include <glad/gl.h>
+
+enum DepthAttachment {
+	NoDepth,
+	DepthTexture,			// 24-bit depth
+	DepthStencilTexture,	// 24-bit depth, 8-bit stencil
+};
+
+// An offscreen framebuffer with a color texture and, optionally, a depth
+// texture that later passes can sample.
+struct RenderTarget {
+	GLuint framebufferID = 0;
+	GLuint colorTextureID = 0;
+	GLuint depthTextureID = 0;
+	int width = 0;
+	int height = 0;
+
+	bool initialize(int width, int height, DepthAttachment depth = DepthTexture, GLenum color_format = GL_RGBA8);
+
+	// Reallocate if the size changed
+	void resize(int width, int height);
+
+	// Bind for drawing and set the viewport to the whole target
+	void bind();
+
+	void cleanup();
+
+private:
+	DepthAttachment depthAttachment = DepthTexture;
+	GLenum colorFormat = GL_RGBA8;
+};
+
+// Draw a triangle covering the viewport, for post-processing passes. The
+// vertex shader derives the positions from gl_VertexID (see fullscreen.vert).
+void DrawFullscreenTriangle();
+
+// Copy a texture to the whole viewport with a fullscreen triangle
+void DrawTexture(GLuint texture);
+
+#endif
@@ -0,0 +1,89 @@
+#include "gpu_query.h"
+
+void SampleCounter::poll() {
+	// Oldest first; queries finish in order, so stop at the first pending one
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		int index = (next + i) % QUERY_COUNT;
+		if (!issued[index]) continue;
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(queryIDs[index], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+		GLuint samples = 0;
+		glGetQueryObjectuiv(queryIDs[index], GL_QUERY_RESULT, &samples);
+		lastResult = samples;
+		issued[index] = false;
+	}
+}
+
+void SampleCounter::begin() {
+	if (queryIDs[0] == 0) glGenQueries(QUERY_COUNT, queryIDs);
+	poll();
+	counting = !issued[next];
+	if (counting) glBeginQuery(GL_SAMPLES_PASSED, queryIDs[next]);
+}
+
+void SampleCounter::end() {
+	if (!counting) return;
+	glEndQuery(GL_SAMPLES_PASSED);
+	issued[next] = true;
+	next = (next + 1) % QUERY_COUNT;
+	counting = false;
+}
+
+void SampleCounter::cleanup() {
+	if (queryIDs[0]) glDeleteQueries(QUERY_COUNT, queryIDs);
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		queryIDs[i] = 0;
+		issued[i] = false;
+	}
+	next = 0;
+	counting = false;
+	lastResult = 0;
+}
+
+void GpuTimer::collect(bool wait) {
+	// Queries finish in order, so stop at the first pending one
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		int index = (next + i) % QUERY_COUNT;
+		if (!issued[index]) continue;
+		if (!wait) {
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(queryIDs[index], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) break;
+		}
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(queryIDs[index], GL_QUERY_RESULT, &elapsed);
+		results.push_back(elapsed);
+		issued[index] = false;
+	}
+}
+
+void GpuTimer::begin() {
+	if (queryIDs[0] == 0) glGenQueries(QUERY_COUNT, queryIDs);
+	collect(false);
+	timing = !issued[next];
+	if (timing) glBeginQuery(GL_TIME_ELAPSED, queryIDs[next]);
+}
+
+void GpuTimer::end() {
+	if (!timing) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	issued[next] = true;
+	next = (next + 1) % QUERY_COUNT;
+	timing = false;
+}
+
+void GpuTimer::flush() {
+	collect(true);
+}
+
+void GpuTimer::cleanup() {
+	if (queryIDs[0]) glDeleteQueries(QUERY_COUNT, queryIDs);
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		queryIDs[i] = 0;
+		issued[i] = false;
+	}
+	next = 0;
+	timing = false;
+	results.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef _GPU_QUERY_H_
+#define _GPU_QUERY_H_
+
+#include <glad/gl.h>
+
+#include <vector>
+
+// Counts the samples that pass the depth test between begin() and end().
+// With front-to-back sorted draws this is close to the number of shaded
+// pixels. A ring of queries is in flight; results are only read once the
+// GPU reports them available, so the CPU does not wait for the GPU. When
+// the GPU is so far behind that the ring is full, the pass is not counted.
+struct SampleCounter {
+	static const int QUERY_COUNT = 4;
+
+	GLuint queryIDs[QUERY_COUNT] = { 0 };
+	bool issued[QUERY_COUNT] = { false };
+	int next = 0;
+	bool counting = false;		// Between begin() and end() of a query
+	GLuint64 lastResult = 0;	// Samples of the newest finished query
+
+	void begin();
+	void end();
+	void cleanup();
+
+private:
+	void poll();
+};
+
+// GPU time between begin() and end(), from GL_TIME_ELAPSED queries. A
+// ring of queries is in flight; results are only read once the GPU
+// reports them available, so the CPU does not wait for the GPU. When the
+// ring is full, the interval is not timed. Timers cannot nest.
+struct GpuTimer {
+	static const int QUERY_COUNT = 4;
+
+	GLuint queryIDs[QUERY_COUNT] = { 0 };
+	bool issued[QUERY_COUNT] = { false };
+	int next = 0;
+	bool timing = false;			// Between begin() and end() of a query
+	std::vector<GLuint64> results;	// Nanoseconds, in issue order
+
+	void begin();
+	void end();
+
+	// Wait for the queries in flight and move their results to results
+	void flush();
+	void cleanup();
+
+private:
+	// Move the finished queries to results, oldest first; with wait, all
+	void collect(bool wait);
+};
+
+#endif
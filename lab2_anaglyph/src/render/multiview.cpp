@@ -0,0 +1,94 @@
+#include "multiview.h"
+#include "shader.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <iostream>
+
+bool MultiviewRenderer::initialize() {
+	programID = LoadShadersFromResources("multiview.vert", "box.frag");
+	compositeProgramID = LoadShadersFromResources("fullscreen.vert", "multiview_composite.frag");
+	if (programID == 0 || compositeProgramID == 0) {
+		std::cerr << "Failed to load multiview shaders." << std::endl;
+		return false;
+	}
+
+	modelMatrixID = glGetUniformLocation(programID, "Model");
+	viewProjectionID = glGetUniformLocation(programID, "ViewProjection");
+	quiltTilesID = glGetUniformLocation(programID, "QuiltTiles");
+	textureSamplerID = glGetUniformLocation(programID, "textureSampler");
+
+	compositeSamplerID = glGetUniformLocation(compositeProgramID, "quiltSampler");
+	compositeTilesID = glGetUniformLocation(compositeProgramID, "QuiltTiles");
+	compositeViewCountID = glGetUniformLocation(compositeProgramID, "ViewCount");
+	pitchID = glGetUniformLocation(compositeProgramID, "Pitch");
+	tiltID = glGetUniformLocation(compositeProgramID, "Tilt");
+	centerID = glGetUniformLocation(compositeProgramID, "Center");
+	showQuiltID = glGetUniformLocation(compositeProgramID, "ShowQuilt");
+	return true;
+}
+
+void MultiviewRenderer::cleanup() {
+	quilt.cleanup();
+	glDeleteProgram(programID);
+	glDeleteProgram(compositeProgramID);
+	programID = 0;
+	compositeProgramID = 0;
+}
+
+void MultiviewRenderer::resize(int view_count, int view_width, int view_height) {
+	views = std::max(1, std::min(view_count, MAX_MULTIVIEW_VIEWS));
+
+	// Close to square quilt, clamped to the texture size limit
+	columns = (int)ceilf(sqrtf((float)views));
+	rows = (views + columns - 1) / columns;
+
+	GLint maxSize = 4096;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	view_width = std::max(1, std::min(view_width, maxSize / columns));
+	view_height = std::max(1, std::min(view_height, maxSize / rows));
+	quilt.resize(view_width * columns, view_height * rows);
+}
+
+void MultiviewRenderer::begin(const std::vector<glm::mat4> &view_projections) {
+	quilt.bind();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	for (int i = 0; i < 4; ++i) glEnable(GL_CLIP_DISTANCE0 + i);
+
+	int count = std::min((int)view_projections.size(), views);
+	glUseProgram(programID);
+	glUniformMatrix4fv(viewProjectionID, count, GL_FALSE, &view_projections[0][0][0]);
+	glUniform2i(quiltTilesID, columns, rows);
+}
+
+void MultiviewRenderer::enqueue(RenderQueue &queue, GLuint texture, GLuint vertex_array, GLsizei index_count,
+	const glm::mat4 &model, float view_distance) {
+	queue.add(Opaque, programID, modelMatrixID, textureSamplerID, texture, vertex_array, index_count,
+		model, view_distance, views);
+}
+
+void MultiviewRenderer::end() {
+	for (int i = 0; i < 4; ++i) glDisable(GL_CLIP_DISTANCE0 + i);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void MultiviewRenderer::composite(int width, int height, const LenticularParameters &lenticular, bool show_quilt) {
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+
+	glUseProgram(compositeProgramID);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, quilt.colorTextureID);
+	glUniform1i(compositeSamplerID, 0);
+	glUniform2i(compositeTilesID, columns, rows);
+	glUniform1i(compositeViewCountID, views);
+	glUniform1f(pitchID, lenticular.pitch);
+	glUniform1f(tiltID, lenticular.tilt);
+	glUniform1f(centerID, lenticular.center);
+	glUniform1i(showQuiltID, show_quilt ? 1 : 0);
+	DrawFullscreenTriangle();
+
+	glEnable(GL_DEPTH_TEST);
+}
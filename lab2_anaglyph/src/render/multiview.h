@@ -0,0 +1,68 @@
+#ifndef _MULTIVIEW_H_
+#define _MULTIVIEW_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <render/framebuffer.h>
+#include <render/render_queue.h>
+
+#include <vector>
+
+// Must match multiview.vert
+static const int MAX_MULTIVIEW_VIEWS = 45;
+
+// Lens geometry of a lenticular display, for the compositor
+struct LenticularParameters {
+	float pitch = 0.2f;		// Lenses per pixel
+	float tilt = -0.1f;		// Lens slant, horizontal pixels per row
+	float center = 0.0f;	// Phase of the first lens
+};
+
+// Renders N views of the scene into a quilt (an atlas of view tiles) with one
+// instanced draw per object, then interleaves the views for the display.
+// Geometry is submitted once for all views; only the vertex shader runs per
+// view, so the cost grows much slower than N separate passes.
+class MultiviewRenderer {
+public:
+	bool initialize();
+	void cleanup();
+
+	// Lay out the quilt for view_count views of view_width x view_height
+	void resize(int view_count, int view_width, int view_height);
+
+	int viewCount() const { return views; }
+
+	// Bind and clear the quilt and upload the view projections. Draws queued
+	// with enqueue() until end() go to all views.
+	void begin(const std::vector<glm::mat4> &view_projections);
+	void enqueue(RenderQueue &queue, GLuint texture, GLuint vertex_array, GLsizei index_count,
+		const glm::mat4 &model, float view_distance);
+	void end();
+
+	// Interleave the views into the currently bound framebuffer
+	void composite(int width, int height, const LenticularParameters &lenticular, bool show_quilt);
+
+private:
+	RenderTarget quilt;
+	int views = 0;
+	int columns = 1;
+	int rows = 1;
+
+	GLuint programID = 0;
+	GLint modelMatrixID = -1;
+	GLint viewProjectionID = -1;
+	GLint quiltTilesID = -1;
+	GLint textureSamplerID = -1;
+
+	GLuint compositeProgramID = 0;
+	GLint compositeSamplerID = -1;
+	GLint compositeTilesID = -1;
+	GLint compositeViewCountID = -1;
+	GLint pitchID = -1;
+	GLint tiltID = -1;
+	GLint centerID = -1;
+	GLint showQuiltID = -1;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "render_queue.h"
+
+#include <string.h>
+
+static const int PASS_SHIFT = 60;
+static const int PROGRAM_SHIFT = 52;
+static const int TEXTURE_SHIFT = 40;
+static const int MESH_SHIFT = 28;
+static const int DEPTH_SHIFT = 4;
+static const uint64_t DEPTH_MAX = (1u << 24) - 1;
+
+RenderQueue::RenderQueue() : nearDistance(0.1f), farDistance(1000.0f), sortingEnabled(true), sorted(false) {
+	resetStats();
+}
+
+void RenderQueue::setDepthRange(float near_distance, float far_distance) {
+	nearDistance = near_distance;
+	farDistance = far_distance > near_distance ? far_distance : near_distance + 1.0f;
+}
+
+void RenderQueue::clear() {
+	packets.clear();
+	keys.clear();
+	sorted = false;
+}
+
+void RenderQueue::resetStats() {
+	memset(&counters, 0, sizeof(counters));
+}
+
+void RenderQueue::add(RenderPass pass, GLuint program, GLint mvp_location, GLint sampler_location, GLuint texture,
+	GLuint vertex_array, GLsizei index_count, const glm::mat4 &mvp) {
+	add(pass, program, mvp_location, sampler_location, texture, vertex_array, index_count, mvp, mvp[3][3]);
+}
+
+void RenderQueue::add(RenderPass pass, GLuint program, GLint matrix_location, GLint sampler_location, GLuint texture,
+	GLuint vertex_array, GLsizei index_count, const glm::mat4 &matrix, float view_distance,
+	GLsizei instance_count) {
+	float distance = (view_distance - nearDistance) / (farDistance - nearDistance);
+	distance = glm::clamp(distance, 0.0f, 1.0f);
+	uint64_t depth = (uint64_t)(distance * DEPTH_MAX);
+	if (pass == Translucent) depth = DEPTH_MAX - depth;
+
+	// GL names are small integers, so masking them keeps objects apart in
+	// practice. A collision only costs sort quality, not correctness.
+	uint64_t key = ((uint64_t)(pass & 0xF) << PASS_SHIFT) |
+		((uint64_t)(program & 0xFF) << PROGRAM_SHIFT) |
+		((uint64_t)(texture & 0xFFF) << TEXTURE_SHIFT) |
+		((uint64_t)(vertex_array & 0xFFF) << MESH_SHIFT) |
+		(depth << DEPTH_SHIFT);
+
+	DrawPacket packet;
+	packet.key = key;
+	packet.program = program;
+	packet.mvpLocation = matrix_location;
+	packet.samplerLocation = sampler_location;
+	packet.texture = texture;
+	packet.vertexArray = vertex_array;
+	packet.indexCount = index_count;
+	packet.instanceCount = instance_count;
+	packet.mvp = matrix;
+	packets.push_back(packet);
+	keys.push_back(key);
+	sorted = false;
+}
+
+void RenderQueue::sort() {
+	size_t count = packets.size();
+	sorted = true;
+	order.resize(count);
+	for (size_t i = 0; i < count; ++i) order[i] = (uint32_t)i;
+	if (!sortingEnabled || count < 2) return;
+
+	// LSD radix sort of (key, index) pairs, 8 bits per pass. Bytes that are
+	// the same for all keys (unused bits, a single pass or program) are skipped.
+	scratch.resize(count);
+	scratchKeys.resize(count);
+	sortKeys.assign(keys.begin(), keys.end());
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t histogram[256] = {};
+		for (size_t i = 0; i < count; ++i) ++histogram[(sortKeys[i] >> shift) & 0xFF];
+		if (histogram[(sortKeys[0] >> shift) & 0xFF] == count) continue;
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; ++b) {
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			size_t target = histogram[(sortKeys[i] >> shift) & 0xFF]++;
+			scratchKeys[target] = sortKeys[i];
+			scratch[target] = order[i];
+		}
+		sortKeys.swap(scratchKeys);
+		order.swap(scratch);
+	}
+}
+
+void RenderQueue::submit() {
+	if (!sorted) sort();
+
+	// Nothing is assumed about the state left by other code
+	GLuint currentProgram = 0;
+	GLuint currentTexture = 0;
+	GLuint currentVertexArray = 0;
+	bool first = true;
+
+	glActiveTexture(GL_TEXTURE0);
+	for (size_t i = 0; i < order.size(); ++i) {
+		const DrawPacket &packet = packets[order[i]];
+
+		if (first || packet.program != currentProgram) {
+			glUseProgram(packet.program);
+			if (packet.samplerLocation >= 0) glUniform1i(packet.samplerLocation, 0);
+			currentProgram = packet.program;
+			++counters.programChanges;
+		}
+		if (first || packet.texture != currentTexture) {
+			glBindTexture(GL_TEXTURE_2D, packet.texture);
+			currentTexture = packet.texture;
+			++counters.textureChanges;
+		}
+		if (first || packet.vertexArray != currentVertexArray) {
+			glBindVertexArray(packet.vertexArray);
+			currentVertexArray = packet.vertexArray;
+			++counters.meshChanges;
+		}
+		first = false;
+
+		glUniformMatrix4fv(packet.mvpLocation, 1, GL_FALSE, &packet.mvp[0][0]);
+		if (packet.instanceCount > 1) {
+			glDrawElementsInstanced(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, (void*)0, packet.instanceCount);
+		} else {
+			glDrawElements(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, (void*)0);
+		}
+
+		++counters.drawCalls;
+		counters.triangles += packet.indexCount / 3 * packet.instanceCount;
+	}
+}
@@ -0,0 +1,101 @@
+#ifndef _RENDER_QUEUE_H_
+#define _RENDER_QUEUE_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <stdint.h>
+
+enum RenderPass {
+	Opaque = 0,			// Sorted front to back
+	Translucent = 1,	// Sorted back to front
+	Overlay = 2,
+};
+
+// One draw call with all the state it needs. The handles are the real GL
+// objects; the sort key only groups them.
+struct DrawPacket {
+	uint64_t key;
+
+	GLuint program;
+	GLint mvpLocation;
+	GLint samplerLocation;	// Sampler set to texture unit 0, -1 if unused
+	GLuint texture;
+	GLuint vertexArray;
+	GLsizei indexCount;
+	GLsizei instanceCount;
+
+	glm::mat4 mvp;		// Uploaded to mvpLocation, not necessarily an MVP (see add)
+};
+
+struct RenderStats {
+	int drawCalls;
+	int triangles;
+	int programChanges;
+	int textureChanges;
+	int meshChanges;
+
+	int stateChanges() const { return programChanges + textureChanges + meshChanges; }
+};
+
+// Collects the draws of a frame, sorts them by a 64-bit key and submits
+// them with state changes only where the key changes. Key layout, from the
+// most significant bit:
+//
+//   pass (4) | program (8) | texture (12) | mesh (12) | depth (24) | unused (4)
+//
+// Depth is the view distance of the object origin, quantized over the
+// depth range.
+class RenderQueue {
+public:
+	RenderQueue();
+
+	// View distances outside [near_distance, far_distance] are clamped
+	void setDepthRange(float near_distance, float far_distance);
+
+	void clear();
+
+	// Queue one draw. The view distance is taken from the w of the object
+	// origin in clip space, which is exact for perspective projections.
+	void add(RenderPass pass, GLuint program, GLint mvp_location, GLint sampler_location, GLuint texture,
+		GLuint vertex_array, GLsizei index_count, const glm::mat4 &mvp);
+
+	// Same with an explicit view distance, for draws whose matrix is not a
+	// single MVP, such as instanced multiview draws that upload the model
+	// matrix and pick the view projection per instance.
+	void add(RenderPass pass, GLuint program, GLint matrix_location, GLint sampler_location, GLuint texture,
+		GLuint vertex_array, GLsizei index_count, const glm::mat4 &matrix, float view_distance,
+		GLsizei instance_count = 1);
+
+	// Radix sort the queued packets by key. When sorting is disabled,
+	// packets are submitted in the order they were added.
+	void sort();
+	void setSortingEnabled(bool enabled) { sortingEnabled = enabled; }
+	bool isSortingEnabled() const { return sortingEnabled; }
+
+	// Issue the draws. Leaves the last program, texture and vertex array bound.
+	void submit();
+
+	size_t size() const { return packets.size(); }
+
+	// Counters accumulate over submits until reset, typically once per frame
+	const RenderStats &stats() const { return counters; }
+	void resetStats();
+
+private:
+	std::vector<DrawPacket> packets;
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> scratch;
+	std::vector<uint64_t> keys;
+	std::vector<uint64_t> sortKeys;
+	std::vector<uint64_t> scratchKeys;
+
+	float nearDistance;
+	float farDistance;
+	bool sortingEnabled;
+	bool sorted;
+	RenderStats counters;
+};
+
+#endif
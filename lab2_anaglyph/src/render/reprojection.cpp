@@ -0,0 +1,161 @@
+#include "reprojection.h"
+#include "shader.h"
+
+#include <math.h>
+
+#include <iostream>
+#include <vector>
+
+// Holes are re-rendered in tiles of 2^TILE_LEVEL pixels
+static const int TILE_LEVEL = 4;
+
+// Fixed point iterations of the warp search. Converges in a few steps
+// except at depth discontinuities, which are holes anyway.
+static const int WARP_ITERATIONS = 6;
+
+bool StereoReprojector::initialize() {
+	warpProgramID = LoadShadersFromResources("fullscreen.vert", "reproject.frag");
+	tileProgramID = LoadShadersFromResources("fullscreen.vert", "reproject_tiles.frag");
+	if (warpProgramID == 0 || tileProgramID == 0) {
+		std::cerr << "Failed to load reprojection shaders." << std::endl;
+		return false;
+	}
+	leftColorSamplerID = glGetUniformLocation(warpProgramID, "leftColorSampler");
+	leftDepthSamplerID = glGetUniformLocation(warpProgramID, "leftDepthSampler");
+	leftToRightID = glGetUniformLocation(warpProgramID, "LeftToRight");
+	texelSizeID = glGetUniformLocation(warpProgramID, "TexelSize");
+	iterationsID = glGetUniformLocation(warpProgramID, "Iterations");
+
+	warpedSamplerID = glGetUniformLocation(tileProgramID, "warpedSampler");
+	tileLevelID = glGetUniformLocation(tileProgramID, "TileLevel");
+	clearColorID = glGetUniformLocation(tileProgramID, "ClearColor");
+	return true;
+}
+
+void StereoReprojector::cleanup() {
+	left.cleanup();
+	warped.cleanup();
+	right.cleanup();
+	reference.cleanup();
+	tileCounter.cleanup();
+	glDeleteProgram(warpProgramID);
+	glDeleteProgram(tileProgramID);
+	warpProgramID = 0;
+	tileProgramID = 0;
+}
+
+void StereoReprojector::resize(int width, int height) {
+	if (left.framebufferID == 0) {
+		left.initialize(width, height, DepthTexture);
+		warped.initialize(width, height, NoDepth);
+		right.initialize(width, height, DepthStencilTexture);
+	} else {
+		left.resize(width, height);
+		warped.resize(width, height);
+		right.resize(width, height);
+	}
+	if (reference.framebufferID != 0) reference.resize(width, height);
+}
+
+void StereoReprojector::renderLeft(const glm::mat4 &vp_left, const std::function<void(const glm::mat4 &)> &draw) {
+	left.bind();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	draw(vp_left);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void StereoReprojector::synthesizeRight(const glm::mat4 &vp_left, const glm::mat4 &vp_right, bool rerender_holes,
+	const std::function<void(const glm::mat4 &)> &draw) {
+	glDisable(GL_DEPTH_TEST);
+
+	// Warp the left eye
+	warped.bind();
+	glm::mat4 leftToRight = vp_right * glm::inverse(vp_left);
+	glUseProgram(warpProgramID);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, left.colorTextureID);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, left.depthTextureID);
+	glActiveTexture(GL_TEXTURE0);
+	glUniform1i(leftColorSamplerID, 0);
+	glUniform1i(leftDepthSamplerID, 1);
+	glUniformMatrix4fv(leftToRightID, 1, GL_FALSE, &leftToRight[0][0]);
+	glUniform2f(texelSizeID, 1.0f / warped.width, 1.0f / warped.height);
+	glUniform1i(iterationsID, WARP_ITERATIONS);
+	DrawFullscreenTriangle();
+
+	rerendered = rerender_holes;
+	if (!rerender_holes) {
+		glEnable(GL_DEPTH_TEST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return;
+	}
+
+	// The tile mip level averages the hole flags, any tile below 1 has holes
+	glBindTexture(GL_TEXTURE_2D, warped.colorTextureID);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+
+	right.bind();
+	glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	DrawTexture(warped.colorTextureID);
+
+	// Clear the hole tiles to the background and mark them in the stencil
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 1, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	glUseProgram(tileProgramID);
+	glBindTexture(GL_TEXTURE_2D, warped.colorTextureID);
+	glUniform1i(warpedSamplerID, 0);
+	glUniform1f(tileLevelID, (float)TILE_LEVEL);
+	glUniform3f(clearColorID, clearColor[0], clearColor[1], clearColor[2]);
+	DrawFullscreenTriangle();
+
+	// Render the scene again, only into the marked tiles
+	glEnable(GL_DEPTH_TEST);
+	glStencilFunc(GL_EQUAL, 1, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	tileCounter.begin();
+	draw(vp_right);
+	tileCounter.end();
+	glDisable(GL_STENCIL_TEST);
+
+	glBindTexture(GL_TEXTURE_2D, warped.colorTextureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ImageError StereoReprojector::measureError(const glm::mat4 &vp_right, const std::function<void(const glm::mat4 &)> &draw) {
+	if (reference.framebufferID == 0) reference.initialize(left.width, left.height, DepthTexture);
+
+	reference.bind();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	draw(vp_right);
+
+	size_t pixelCount = (size_t)reference.width * reference.height;
+	std::vector<unsigned char> truth(pixelCount * 4);
+	std::vector<unsigned char> synthesized(pixelCount * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, reference.width, reference.height, GL_RGBA, GL_UNSIGNED_BYTE, &truth[0]);
+	glBindFramebuffer(GL_FRAMEBUFFER, rerendered ? right.framebufferID : warped.framebufferID);
+	glReadPixels(0, 0, reference.width, reference.height, GL_RGBA, GL_UNSIGNED_BYTE, &synthesized[0]);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	double absoluteSum = 0;
+	double squaredSum = 0;
+	for (size_t i = 0; i < pixelCount; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			double d = (double)truth[i * 4 + c] - (double)synthesized[i * 4 + c];
+			absoluteSum += fabs(d);
+			squaredSum += d * d;
+		}
+	}
+
+	ImageError error;
+	double mse = squaredSum / (pixelCount * 3);
+	error.meanAbsoluteError = absoluteSum / (pixelCount * 3);
+	error.psnr = mse > 0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+	return error;
+}
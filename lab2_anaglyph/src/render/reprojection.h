@@ -0,0 +1,70 @@
+#ifndef _REPROJECTION_H_
+#define _REPROJECTION_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <render/framebuffer.h>
+#include <render/gpu_query.h>
+
+#include <functional>
+
+// Difference between the synthesized and the true right eye
+struct ImageError {
+	double meanAbsoluteError;	// Per channel, 0-255
+	double psnr;				// In dB
+};
+
+// Stereo by reprojection: the scene is rendered once for the left eye with
+// color and depth, and the right eye is warped from it in screen space.
+// Needs the parallel (off-axis) rig, where the eyes differ by a horizontal
+// disparity only. Holes left by disocclusions are filled from the
+// background; optionally, the tiles containing holes are rendered again,
+// in a single stencil-masked submission. That submission is the whole
+// scene, so its vertex work is that of a second eye; only the fragment
+// work is limited to the holes.
+class StereoReprojector {
+public:
+	bool initialize();
+	void cleanup();
+
+	void resize(int width, int height);
+
+	// draw is called with a view projection to submit the scene
+	void renderLeft(const glm::mat4 &vp_left, const std::function<void(const glm::mat4 &)> &draw);
+	void synthesizeRight(const glm::mat4 &vp_left, const glm::mat4 &vp_right, bool rerender_holes,
+		const std::function<void(const glm::mat4 &)> &draw);
+
+	GLuint leftTexture() const { return left.colorTextureID; }
+	GLuint rightTexture() const { return rerendered ? right.colorTextureID : warped.colorTextureID; }
+
+	// Render the right eye for real and compare it with the synthesized one.
+	// Reads back both images, so only meant for occasional measurements.
+	ImageError measureError(const glm::mat4 &vp_right, const std::function<void(const glm::mat4 &)> &draw);
+
+	// Pixels in re-rendered tiles, counted in the previous frame
+	GLuint64 rerenderedPixels() const { return tileCounter.lastResult; }
+
+private:
+	RenderTarget left;
+	RenderTarget warped;		// Warp result, alpha 0 marks holes
+	RenderTarget right;			// Warp result with the hole tiles rendered again
+	RenderTarget reference;		// True right eye, for measurements
+	bool rerendered = false;
+
+	SampleCounter tileCounter;
+
+	GLuint warpProgramID = 0;
+	GLint leftColorSamplerID = -1;
+	GLint leftDepthSamplerID = -1;
+	GLint leftToRightID = -1;
+	GLint texelSizeID = -1;
+	GLint iterationsID = -1;
+
+	GLuint tileProgramID = 0;
+	GLint warpedSamplerID = -1;
+	GLint tileLevelID = -1;
+	GLint clearColorID = -1;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "resource.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <string>
+#include <fstream>
+#include <map>
+#include <vector>
+
+// Defined in the generated embedded_resources.cpp
+extern const ResourceEntry embeddedResources[];
+extern const size_t embeddedResourceCount;
+
+static bool overrideInitialized = false;
+static std::string overrideDirectory;
+static std::map<std::string, std::vector<unsigned char> > overrideCache;
+
+static void initializeOverrideDirectory() {
+	if (overrideInitialized) return;
+	overrideInitialized = true;
+	const char *env = getenv("ANAGLYPH_RESOURCE_DIR");
+	if (env) overrideDirectory = env;
+}
+
+void SetResourceOverrideDirectory(const char *directory) {
+	overrideInitialized = true;
+	overrideDirectory = directory ? directory : "";
+	overrideCache.clear();
+}
+
+static bool loadOverride(const char *name, Resource &resource) {
+	initializeOverrideDirectory();
+	if (overrideDirectory.empty()) return false;
+
+	std::map<std::string, std::vector<unsigned char> >::iterator it = overrideCache.find(name);
+	if (it == overrideCache.end()) {
+		std::ifstream stream(overrideDirectory + "/" + name, std::ios::in | std::ios::binary);
+		if (!stream.is_open()) return false;
+
+		std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		bytes.push_back(0); // Keep the zero terminator of embedded resources
+		it = overrideCache.insert(std::make_pair(std::string(name), bytes)).first;
+	}
+
+	resource.data = &it->second[0];
+	resource.size = it->second.size() - 1;
+	return true;
+}
+
+Resource LookupResource(const char *name) {
+	Resource resource = { NULL, 0 };
+	if (loadOverride(name, resource)) return resource;
+
+	// Binary search the name-sorted table
+	size_t lo = 0, hi = embeddedResourceCount;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		int cmp = strcmp(embeddedResources[mid].name, name);
+		if (cmp == 0) {
+			resource.data = embeddedResources[mid].data;
+			resource.size = embeddedResources[mid].size;
+			break;
+		}
+		if (cmp < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return resource;
+}
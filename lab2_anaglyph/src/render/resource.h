@@ -0,0 +1,32 @@
+#ifndef _RESOURCE_H_
+#define _RESOURCE_H_
+
+#include <stddef.h>
+
+// A read-only view of an asset. Embedded resources point straight into the
+// executable image, so nothing is copied or freed. The byte after the last
+// one is always zero, so text resources can be passed on as C strings.
+struct Resource {
+	const unsigned char *data;
+	size_t size;
+};
+
+// Entry of the table generated at build time by cmake/EmbedResources.cmake.
+// The table is sorted by name.
+struct ResourceEntry {
+	const char *name;
+	const unsigned char *data;
+	size_t size;
+};
+
+// Look up a resource by name, e.g. "box.vert". Returns { NULL, 0 } if missing.
+// When an override directory is set and contains the file, the file is read
+// once and served from memory instead, which allows editing shaders without
+// rebuilding.
+Resource LookupResource(const char *name);
+
+// Set the development override directory, NULL to disable. Defaults to the
+// ANAGLYPH_RESOURCE_DIR environment variable.
+void SetResourceOverrideDirectory(const char *directory);
+
+#endif
@@ -1,4 +1,5 @@
 #include "shader.h"
+#include "resource.h"
 
 #include <string> 
 #include <iostream> 
@@ -6,12 +7,11 @@
 #include <sstream> 
 #include <vector>
 
+static GLuint CompileProgram(const char *VertexSourcePointer, const char *vertex_label,
+	const char *FragmentSourcePointer, const char *fragment_label);
+
 GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 {
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
 	// Read the Vertex Shader code from the file
 	std::string VertexShaderCode;
 	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
@@ -44,12 +44,42 @@ GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 		return 0;
 	}
 
+	return CompileProgram(VertexShaderCode.c_str(), vertex_file_path, FragmentShaderCode.c_str(), fragment_file_path);
+}
+
+GLuint LoadShadersFromResources(const char *vertex_name, const char *fragment_name)
+{
+	// Embedded resources are zero terminated, so they are used in place
+	Resource VertexShaderResource = LookupResource(vertex_name);
+	if (!VertexShaderResource.data)
+	{
+		printf("Vertex shader resource not found %s.\n", vertex_name);
+		return 0;
+	}
+
+	Resource FragmentShaderResource = LookupResource(fragment_name);
+	if (!FragmentShaderResource.data)
+	{
+		printf("Fragment shader resource not found %s.\n", fragment_name);
+		return 0;
+	}
+
+	return CompileProgram((const char *)VertexShaderResource.data, vertex_name,
+		(const char *)FragmentShaderResource.data, fragment_name);
+}
+
+static GLuint CompileProgram(const char *VertexSourcePointer, const char *vertex_label,
+	const char *FragmentSourcePointer, const char *fragment_label)
+{
+	// Create the shaders
+	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 
 	// Compile Vertex Shader
-	printf("Compiling vertex shader : %s\n", vertex_file_path);
-	char const *VertexSourcePointer = VertexShaderCode.c_str();
+	printf("Compiling vertex shader : %s\n", vertex_label);
 	glShaderSource(VertexShaderID, 1, &VertexSourcePointer, NULL);
 	glCompileShader(VertexShaderID);
 
@@ -65,8 +95,7 @@ GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 	}
 
 	// Compile Fragment Shader
-	printf("Compiling fragment shader : %s\n", fragment_file_path);
-	char const *FragmentSourcePointer = FragmentShaderCode.c_str();
+	printf("Compiling fragment shader : %s\n", fragment_label);
 	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer, NULL);
 	glCompileShader(FragmentShaderID);
 
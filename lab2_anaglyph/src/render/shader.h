@@ -5,4 +5,7 @@
 
 GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path);
 
+// Same as LoadShaders, but takes resource names (see render/resource.h)
+GLuint LoadShadersFromResources(const char *vertex_name, const char *fragment_name);
+
 #endif
@@ -1,13 +1,12 @@
 #include "texture.h"
+#include "resource.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
 #include <iostream>
 
-GLuint LoadTexture(const char *texture_file_path) {
-    int w, h, channels;
-    uint8_t* img = stbi_load(texture_file_path, &w, &h, &channels, 3);
+static GLuint UploadTexture(uint8_t *img, int w, int h, const char *label) {
     GLuint texture;
     glGenTextures(1, &texture);  
     glBindTexture(GL_TEXTURE_2D, texture);  
@@ -20,9 +19,27 @@ GLuint LoadTexture(const char *texture_file_path) {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, img);
         glGenerateMipmap(GL_TEXTURE_2D);
     } else {
-        std::cout << "Failed to load texture " << texture_file_path << std::endl;
+        std::cout << "Failed to load texture " << label << std::endl;
     }
     stbi_image_free(img);
 
     return texture;
 }
+
+GLuint LoadTexture(const char *texture_file_path) {
+    int w, h, channels;
+    uint8_t* img = stbi_load(texture_file_path, &w, &h, &channels, 3);
+    return UploadTexture(img, w, h, texture_file_path);
+}
+
+GLuint LoadTextureFromMemory(const unsigned char *data, size_t size, const char *label) {
+    int w, h, channels;
+    uint8_t* img = data ? stbi_load_from_memory(data, (int)size, &w, &h, &channels, 3) : NULL;
+    return UploadTexture(img, w, h, label);
+}
+
+GLuint LoadTextureFromResource(const char *texture_name) {
+    // Decode straight from the embedded bytes, no file access
+    Resource resource = LookupResource(texture_name);
+    return LoadTextureFromMemory(resource.data, resource.size, texture_name);
+}
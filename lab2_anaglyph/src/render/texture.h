@@ -2,7 +2,14 @@
 #define _TEXTURE_H_
 
 #include <glad/gl.h>
+#include <stddef.h>
 
 GLuint LoadTexture(const char *texture_file_path);
 
+// Decode an encoded image (jpg, png, ...) that is already in memory
+GLuint LoadTextureFromMemory(const unsigned char *data, size_t size, const char *label);
+
+// Same as LoadTexture, but takes a resource name (see render/resource.h)
+GLuint LoadTextureFromResource(const char *texture_name);
+
 #endif
@@ -0,0 +1,52 @@
+#version 330 core
+
+// Synthesize the right eye from the left eye's color and depth. For every
+// right eye pixel, search the left eye row for the pixel that lands on it:
+// x_left is refined by the difference between where its reprojection lands
+// and where it should. Pixels where the search does not converge were
+// hidden in the left eye (disocclusions); they are filled with the nearby
+// background and flagged with alpha 0.
+
+in vec2 uv;
+
+uniform sampler2D leftColorSampler;
+uniform sampler2D leftDepthSampler;
+uniform mat4 LeftToRight;	// Left eye NDC to right eye clip space
+uniform vec2 TexelSize;
+uniform int Iterations;
+
+out vec4 finalColor;
+
+// Where the left eye point at (x, uv.y) with the given depth lands in the right eye
+float reprojectX(float x, float depth) {
+    vec4 clip = LeftToRight * vec4(vec3(x, uv.y, depth) * 2.0 - 1.0, 1.0);
+    return clip.x / clip.w * 0.5 + 0.5;
+}
+
+void main()
+{
+    float x = uv.x;
+    float residual = 1.0;
+    for (int i = 0; i < Iterations; ++i) {
+        float depth = texture(leftDepthSampler, vec2(x, uv.y)).r;
+        residual = uv.x - reprojectX(x, depth);
+        x += residual;
+    }
+
+    if (abs(residual) < TexelSize.x && x >= 0.0 && x <= 1.0) {
+        finalColor = vec4(texture(leftColorSampler, vec2(x, uv.y)).rgb, 1.0);
+        return;
+    }
+
+    // Hole: take the farthest depth around the search position as the
+    // background and place it with its own disparity
+    float backgroundDepth = 0.0;
+    for (int k = -4; k <= 4; ++k) {
+        backgroundDepth = max(backgroundDepth, texture(leftDepthSampler, vec2(x + k * 4.0 * TexelSize.x, uv.y)).r);
+    }
+    float backgroundX = uv.x;
+    for (int i = 0; i < 2; ++i) {
+        backgroundX += uv.x - reprojectX(backgroundX, backgroundDepth);
+    }
+    finalColor = vec4(texture(leftColorSampler, vec2(backgroundX, uv.y)).rgb, 0.0);
+}
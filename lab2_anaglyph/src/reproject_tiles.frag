@@ -0,0 +1,18 @@
+#version 330 core
+
+// Mark the tiles of the synthesized eye that contain holes. The mip level of
+// the tile size holds the fraction of valid pixels of each tile in alpha.
+
+in vec2 uv;
+
+uniform sampler2D warpedSampler;
+uniform float TileLevel;
+uniform vec3 ClearColor;
+
+out vec3 finalColor;
+
+void main()
+{
+    if (textureLod(warpedSampler, uv, TileLevel).a > 0.999) discard;
+    finalColor = ClearColor;
+}
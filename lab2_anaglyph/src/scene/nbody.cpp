@@ -0,0 +1,582 @@
+#include "nbody.h"
+
+#include <util/thread_pool.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/simd_math.hpp>
+
+#include <stdlib.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+static const int LEAF_SIZE = 16;		// Most bodies in a leaf, but at the deepest level
+static const int GROUP_SIZE = 128;		// Most bodies sharing one walk of the tree, but in a deep leaf
+static const int MORTON_LEVELS = 16;	// Bits of each axis in a code, and depth of the tree
+static const int RADIX_BITS = 12;		// Bits sorted per pass
+static const int RADIX_SIZE = 1 << RADIX_BITS;
+
+// Least softening length. The interaction lists hold each body itself, at
+// distance 0, which only adds nothing while the softened distance is not 0.
+static const float MIN_SOFTENING = 1e-3f;
+
+// Initial disk, in the units of the other scenes: orbits of a few seconds
+static float nbGravity = 1.0f;
+static float nbCentralMass = 8.0e4f;
+static float nbDiskMass = 1.6e4f;
+static float nbInnerRadius = 12.0f;
+static float nbOuterRadius = 80.0f;
+static float nbDiskThickness = 3.0f;
+static float nbDiskTilt = 1.0f;			// Radians around x, toward the camera
+
+static float randomFloat() {
+	return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+}
+
+// The 16 bits of v, two zero bits after each
+static uint64_t spreadBits(uint32_t v) {
+	uint64_t x = v & 0xffff;
+	x = (x | x << 16) & 0x0000ff0000ffull;
+	x = (x | x << 8) & 0x00f00f00f00full;
+	x = (x | x << 4) & 0x0c30c30c30c3ull;
+	x = (x | x << 2) & 0x249249249249ull;
+	return x;
+}
+
+// Interaction list of one group, as arrays for the SIMD lanes. Padded with
+// massless entries to a whole number of the widest lanes.
+struct InteractionList {
+	std::vector<float> x, y, z, m;
+	int count = 0;
+
+	void clear() { count = 0; }
+
+	void add(glm::vec3 position, float mass) {
+		if (count == (int)x.size()) {
+			size_t capacity = std::max<size_t>(256, 2 * x.size());
+			x.resize(capacity);
+			y.resize(capacity);
+			z.resize(capacity);
+			m.resize(capacity);
+		}
+		x[count] = position.x;
+		y[count] = position.y;
+		z[count] = position.z;
+		m[count] = mass;
+		++count;
+	}
+
+	void pad(int lanes) {
+		while (count % lanes != 0) add(glm::vec3(0.0f), 0.0f);
+	}
+};
+
+// Operations on a register of lanes for accumulateForce
+struct ScalarLanes {
+	typedef float f;
+	static const int WIDTH = 1;
+	static f load(const float *p) { return *p; }
+	static f set(float a) { return a; }
+	static f sub(f a, f b) { return a - b; }
+	static f mul(f a, f b) { return a * b; }
+	static f madd(f a, f b, f c) { return a * b + c; }
+	static f inversesqrt(f a) { return glm::simdInversesqrt<glm::mediump>(a); }
+	static float sum(f a) { return a; }
+};
+
+#ifdef GLM_SIMD_MATH_SSE2
+struct Sse2Lanes {
+	typedef __m128 f;
+	static const int WIDTH = 4;
+	static f load(const float *p) { return _mm_loadu_ps(p); }
+	static f set(float a) { return _mm_set1_ps(a); }
+	static f sub(f a, f b) { return _mm_sub_ps(a, b); }
+	static f mul(f a, f b) { return _mm_mul_ps(a, b); }
+#	ifdef __FMA__
+	static f madd(f a, f b, f c) { return _mm_fmadd_ps(a, b, c); }
+#	else
+	static f madd(f a, f b, f c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#	endif
+	static f inversesqrt(f a) { return glm::simdInversesqrt<glm::mediump>(a); }
+	static float sum(f a) {
+		a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+		a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+		return _mm_cvtss_f32(a);
+	}
+};
+#endif
+
+#ifdef GLM_SIMD_MATH_AVX2
+struct Avx2Lanes {
+	typedef __m256 f;
+	static const int WIDTH = 8;
+	static f load(const float *p) { return _mm256_loadu_ps(p); }
+	static f set(float a) { return _mm256_set1_ps(a); }
+	static f sub(f a, f b) { return _mm256_sub_ps(a, b); }
+	static f mul(f a, f b) { return _mm256_mul_ps(a, b); }
+#	ifdef __FMA__
+	static f madd(f a, f b, f c) { return _mm256_fmadd_ps(a, b, c); }
+#	else
+	static f madd(f a, f b, f c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#	endif
+	static f inversesqrt(f a) { return glm::simdInversesqrt<glm::mediump>(a); }
+	static float sum(f a) {
+		return Sse2Lanes::sum(_mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+	}
+};
+#endif
+
+#ifdef GLM_SIMD_MATH_AVX512
+struct Avx512Lanes {
+	typedef __m512 f;
+	static const int WIDTH = 16;
+	static f load(const float *p) { return _mm512_loadu_ps(p); }
+	static f set(float a) { return _mm512_set1_ps(a); }
+	static f sub(f a, f b) { return _mm512_sub_ps(a, b); }
+	static f mul(f a, f b) { return _mm512_mul_ps(a, b); }
+	static f madd(f a, f b, f c) { return _mm512_fmadd_ps(a, b, c); }
+	static f inversesqrt(f a) { return glm::simdInversesqrt<glm::mediump>(a); }
+	static float sum(f a) { return _mm512_reduce_add_ps(a); }
+};
+typedef Avx512Lanes ForceLanes;
+#elif defined(GLM_SIMD_MATH_AVX2)
+typedef Avx2Lanes ForceLanes;
+#elif defined(GLM_SIMD_MATH_SSE2)
+typedef Sse2Lanes ForceLanes;
+#else
+typedef ScalarLanes ForceLanes;
+#endif
+
+// Sum of m r / (|r|^2 + eps^2)^(3/2) over the list, r from point to each
+// entry. The count is a whole number of lanes.
+template <typename L>
+static glm::vec3 accumulateForce(const InteractionList &list, glm::vec3 point, float softening_squared) {
+	typename L::f px = L::set(point.x), py = L::set(point.y), pz = L::set(point.z);
+	typename L::f eps2 = L::set(softening_squared);
+	typename L::f ax = L::set(0.0f), ay = L::set(0.0f), az = L::set(0.0f);
+	for (int j = 0; j < list.count; j += L::WIDTH) {
+		typename L::f dx = L::sub(L::load(&list.x[j]), px);
+		typename L::f dy = L::sub(L::load(&list.y[j]), py);
+		typename L::f dz = L::sub(L::load(&list.z[j]), pz);
+		typename L::f r2 = L::madd(dx, dx, L::madd(dy, dy, L::madd(dz, dz, eps2)));
+		typename L::f inv = L::inversesqrt(r2);
+		typename L::f s = L::mul(L::load(&list.m[j]), L::mul(inv, L::mul(inv, inv)));
+		ax = L::madd(dx, s, ax);
+		ay = L::madd(dy, s, ay);
+		az = L::madd(dz, s, az);
+	}
+	return glm::vec3(L::sum(ax), L::sum(ay), L::sum(az));
+}
+
+// values[i] = values[order[i]], in parallel
+template <typename T>
+static void reorder(ThreadPool &pool, std::vector<T> &values, const std::vector<int> &order, std::vector<T> &scratch) {
+	scratch.resize(values.size());
+	pool.parallelFor((int)values.size(), 4096, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) scratch[i] = values[order[i]];
+	});
+	values.swap(scratch);
+}
+
+void NBodySystem::generate(int body_count) {
+	int bodyCount = std::max(body_count, 1);
+	position.resize(bodyCount);
+	velocity.resize(bodyCount);
+	acceleration.assign(bodyCount, glm::vec3(0.0f));
+	mass.resize(bodyCount);
+	size.resize(bodyCount);
+	forcesValid = false;
+	pendingTime = 0.0;
+
+	// The central body, drawn as the cube of the black hole scene
+	position[0] = glm::vec3(0.0f);
+	velocity[0] = glm::vec3(0.0f);
+	mass[0] = nbCentralMass;
+	size[0] = 15.0f;
+
+	int diskCount = bodyCount - 1;
+	float bodyMass = diskCount > 0 ? nbDiskMass / diskCount : 0.0f;
+	glm::mat3 tilt(glm::rotate(glm::mat4(1.0f), nbDiskTilt, glm::vec3(1, 0, 0)));
+	float inner2 = nbInnerRadius * nbInnerRadius;
+	float outer2 = nbOuterRadius * nbOuterRadius;
+	for (int i = 1; i < bodyCount; ++i) {
+		// Uniform over the area of the disk
+		float radius = sqrtf(inner2 + randomFloat() * (outer2 - inner2));
+		float angle = randomFloat() * (float)(2.0 * M_PI);
+		float height = (randomFloat() + randomFloat() + randomFloat() - 1.5f) * nbDiskThickness;
+		float massFactor = 0.5f + randomFloat();
+
+		// Circular orbit around the mass inside the radius, with some dispersion
+		float enclosed = nbCentralMass + nbDiskMass * (radius * radius - inner2) / (outer2 - inner2);
+		float speed = sqrtf(nbGravity * enclosed / radius) * (1.0f + 0.05f * (2.0f * randomFloat() - 1.0f));
+
+		glm::vec3 local(cosf(angle) * radius, height, sinf(angle) * radius);
+		glm::vec3 tangent(-sinf(angle), 0.0f, cosf(angle));
+		position[i] = tilt * local;
+		velocity[i] = tilt * (speed * tangent);
+		mass[i] = bodyMass * massFactor;
+		size[i] = 0.8f + 0.8f * massFactor;
+	}
+}
+
+void NBodySystem::advance(float delta_time) {
+	pendingTime += delta_time;
+	int steps = (int)floor(pendingTime / timeStep + 1e-6);
+	pendingTime -= steps * (double)timeStep;
+	if (steps > maxStepsPerUpdate) {
+		steps = maxStepsPerUpdate;
+		pendingTime = 0.0;
+	}
+	for (int i = 0; i < steps; ++i) step();
+}
+
+void NBodySystem::step() {
+	if (position.empty()) return;
+	if (!forcesValid) {
+		sortBodies();
+		buildTree();
+		computeForces(0.0f);
+		forcesValid = true;
+	}
+
+	// Kick half a step with the forces of the last one, then drift
+	float halfStep = 0.5f * timeStep;
+	float dt = timeStep;
+	threads().parallelFor((int)position.size(), 4096, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			velocity[i] += halfStep * acceleration[i];
+			position[i] += dt * velocity[i];
+		}
+	});
+
+	// Forces at the new positions, and the second half kick with them
+	sortBodies();
+	buildTree();
+	computeForces(halfStep);
+}
+
+// Morton codes of the positions in a cube around all bodies, sorted by a
+// parallel LSD radix sort; the bodies are then reordered to match.
+void NBodySystem::sortBodies() {
+	ThreadPool &pool = threads();
+	int n = (int)position.size();
+
+	// Bounds
+	glm::vec3 lower(std::numeric_limits<float>::max());
+	glm::vec3 upper(-std::numeric_limits<float>::max());
+	std::mutex boundsMutex;
+	pool.parallelFor(n, 4096, [&](int begin, int end) {
+		glm::vec3 chunkLower = position[begin], chunkUpper = position[begin];
+		for (int i = begin + 1; i < end; ++i) {
+			chunkLower = glm::min(chunkLower, position[i]);
+			chunkUpper = glm::max(chunkUpper, position[i]);
+		}
+		std::lock_guard<std::mutex> lock(boundsMutex);
+		lower = glm::min(lower, chunkLower);
+		upper = glm::max(upper, chunkUpper);
+	});
+	glm::vec3 extent = upper - lower;
+	rootSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f)) * 1.0001f;
+	rootCorner = lower;
+
+	// Codes
+	codes.resize(n);
+	order.resize(n);
+	sortedCodes.resize(n);
+	sortedOrder.resize(n);
+	float scale = (float)(1 << MORTON_LEVELS) / rootSize;
+	pool.parallelFor(n, 4096, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			glm::ivec3 cell = glm::clamp(glm::ivec3((position[i] - rootCorner) * scale), 0, (1 << MORTON_LEVELS) - 1);
+			codes[i] = spreadBits(cell.x) | spreadBits(cell.y) << 1 | spreadBits(cell.z) << 2;
+			order[i] = i;
+		}
+	});
+
+	// Radix sort: each chunk counts its digits, the counts give every chunk
+	// its place for each digit, then each chunk scatters, keeping its order
+	int chunks = std::min(pool.threadCount(), std::max(n / 4096, 1));
+	int chunkSize = (n + chunks - 1) / chunks;
+	std::vector<int> counts((size_t)chunks * RADIX_SIZE);
+	for (int shift = 0; shift < 3 * MORTON_LEVELS; shift += RADIX_BITS) {
+		std::fill(counts.begin(), counts.end(), 0);
+		pool.parallelFor(chunks, 1, [&](int first, int last) {
+			for (int c = first; c < last; ++c) {
+				int *count = &counts[(size_t)c * RADIX_SIZE];
+				int end = std::min(n, (c + 1) * chunkSize);
+				for (int i = c * chunkSize; i < end; ++i) ++count[(codes[i] >> shift) & (RADIX_SIZE - 1)];
+			}
+		});
+		int offset = 0;
+		for (int digit = 0; digit < RADIX_SIZE; ++digit) {
+			for (int c = 0; c < chunks; ++c) {
+				int count = counts[(size_t)c * RADIX_SIZE + digit];
+				counts[(size_t)c * RADIX_SIZE + digit] = offset;
+				offset += count;
+			}
+		}
+		pool.parallelFor(chunks, 1, [&](int first, int last) {
+			for (int c = first; c < last; ++c) {
+				int *next = &counts[(size_t)c * RADIX_SIZE];
+				int end = std::min(n, (c + 1) * chunkSize);
+				for (int i = c * chunkSize; i < end; ++i) {
+					int to = next[(codes[i] >> shift) & (RADIX_SIZE - 1)]++;
+					sortedCodes[to] = codes[i];
+					sortedOrder[to] = order[i];
+				}
+			}
+		});
+		codes.swap(sortedCodes);
+		order.swap(sortedOrder);
+	}
+
+	reorder(pool, position, order, scratchVec3);
+	reorder(pool, velocity, order, scratchVec3);
+	reorder(pool, mass, order, scratchFloat);
+	reorder(pool, size, order, scratchFloat);
+}
+
+// The non-empty children of the cell of range, from the next 3 bits of the
+// sorted codes; returns their number
+int NBodySystem::splitRange(const BuildRange &range, BuildRange *children) const {
+	int shift = 3 * (MORTON_LEVELS - 1 - range.level);
+	float half = ldexpf(rootSize, -(range.level + 1));
+	int count = 0;
+	for (int begin = range.begin; begin < range.end; ++count) {
+		int digit = (int)(codes[begin] >> shift) & 7;
+		int end = (int)(std::partition_point(codes.begin() + begin, codes.begin() + range.end, [shift, digit](uint64_t code) {
+			return (int)(code >> shift & 7) <= digit;
+		}) - codes.begin());
+		BuildRange &child = children[count];
+		child.node = -1;
+		child.begin = begin;
+		child.end = end;
+		child.level = range.level + 1;
+		child.corner = range.corner + half * glm::vec3(digit & 1, digit >> 1 & 1, digit >> 2 & 1);
+		begin = end;
+	}
+	return count;
+}
+
+// Center of mass from the mass weighted positions, and the opening radius:
+// side / theta from the center of mass, plus its offset from the center of
+// the cell, so a cell whose mass sits to one side is not accepted too close
+void NBodySystem::finishNode(Node &node, const BuildRange &range, glm::vec3 weighted_position) const {
+	float side = ldexpf(rootSize, -range.level);
+	node.centerOfMass = node.mass > 0.0f ? weighted_position / node.mass : range.corner + 0.5f * side;
+	if (theta <= 0.0f) {
+		node.openRadiusSq = std::numeric_limits<float>::infinity();
+		return;
+	}
+	float offset = glm::length(node.centerOfMass - (range.corner + 0.5f * side));
+	float radius = side / theta + offset;
+	node.openRadiusSq = radius * radius;
+}
+
+static bool isLeafRange(int begin, int end, int level) {
+	return end - begin <= LEAF_SIZE || level == MORTON_LEVELS;
+}
+
+void NBodySystem::buildSubtree(std::vector<Node> &subtree, int node, const BuildRange &range) {
+	Node result;
+	result.mass = 0.0f;
+	result.bodyBegin = range.begin;
+	result.bodyCount = range.end - range.begin;
+	glm::vec3 weighted(0.0f);
+
+	if (isLeafRange(range.begin, range.end, range.level)) {
+		result.firstChild = -1;
+		result.childCount = 0;
+		for (int i = range.begin; i < range.end; ++i) {
+			result.mass += mass[i];
+			weighted += mass[i] * position[i];
+		}
+	} else {
+		BuildRange children[8];
+		int childCount = splitRange(range, children);
+		int first = (int)subtree.size();
+		subtree.resize(first + childCount);
+		for (int c = 0; c < childCount; ++c) buildSubtree(subtree, first + c, children[c]);
+		result.firstChild = first;
+		result.childCount = childCount;
+		for (int c = 0; c < childCount; ++c) {
+			const Node &child = subtree[first + c];
+			result.mass += child.mass;
+			weighted += child.mass * child.centerOfMass;
+		}
+	}
+	finishNode(result, range, weighted);
+	subtree[node] = result;
+}
+
+// The levels holding more than a share of the bodies are split here, in
+// breadth first order; each range below that is a subtree built on the pool
+// into its own array, then moved behind the top levels.
+void NBodySystem::buildTree() {
+	ThreadPool &pool = threads();
+	int n = (int)position.size();
+	nodes.assign(1, Node());
+
+	BuildRange root;
+	root.node = 0;
+	root.begin = 0;
+	root.end = n;
+	root.level = 0;
+	root.corner = rootCorner;
+
+	std::vector<BuildRange> queue(1, root);
+	std::vector<BuildRange> tasks;
+	std::vector<BuildRange> split;
+	int taskSize = std::max(4 * LEAF_SIZE, n / (8 * pool.threadCount()));
+	for (size_t q = 0; q < queue.size(); ++q) {
+		BuildRange range = queue[q];
+		if (range.end - range.begin <= taskSize || isLeafRange(range.begin, range.end, range.level)) {
+			tasks.push_back(range);
+			continue;
+		}
+		BuildRange children[8];
+		int childCount = splitRange(range, children);
+		Node &node = nodes[range.node];
+		node.firstChild = (int)nodes.size();
+		node.childCount = childCount;
+		node.bodyBegin = range.begin;
+		node.bodyCount = range.end - range.begin;
+		for (int c = 0; c < childCount; ++c) {
+			children[c].node = (int)nodes.size();
+			nodes.push_back(Node());
+			queue.push_back(children[c]);
+		}
+		split.push_back(range);
+	}
+
+	if (subtrees.size() < tasks.size()) subtrees.resize(tasks.size());
+	pool.parallelFor((int)tasks.size(), 1, [&](int first, int last) {
+		for (int t = first; t < last; ++t) {
+			std::vector<Node> &subtree = subtrees[t];
+			subtree.assign(1, Node());
+			buildSubtree(subtree, 0, tasks[t]);
+		}
+	});
+
+	// The root of a subtree takes the node of its range; the rest follow
+	// the top levels
+	std::vector<int> offsets(tasks.size());
+	int total = (int)nodes.size();
+	for (size_t t = 0; t < tasks.size(); ++t) {
+		offsets[t] = total;
+		total += (int)subtrees[t].size() - 1;
+	}
+	nodes.resize(total);
+	pool.parallelFor((int)tasks.size(), 1, [&](int first, int last) {
+		for (int t = first; t < last; ++t) {
+			const std::vector<Node> &subtree = subtrees[t];
+			int shift = offsets[t] - 1;
+			for (size_t k = 0; k < subtree.size(); ++k) {
+				Node node = subtree[k];
+				if (node.firstChild >= 0) node.firstChild += shift;
+				nodes[k == 0 ? tasks[t].node : offsets[t] + (int)k - 1] = node;
+			}
+		}
+	});
+
+	// Top levels bottom up: children come after their parent
+	for (size_t s = split.size(); s-- > 0;) {
+		Node &node = nodes[split[s].node];
+		node.mass = 0.0f;
+		glm::vec3 weighted(0.0f);
+		for (int c = 0; c < node.childCount; ++c) {
+			const Node &child = nodes[node.firstChild + c];
+			node.mass += child.mass;
+			weighted += child.mass * child.centerOfMass;
+		}
+		finishNode(node, split[s], weighted);
+	}
+
+	// The largest subtrees of at most GROUP_SIZE bodies
+	groups.clear();
+	std::vector<int> stack(1, 0);
+	while (!stack.empty()) {
+		const Node &node = nodes[stack.back()];
+		int index = stack.back();
+		stack.pop_back();
+		if (node.bodyCount <= GROUP_SIZE || node.firstChild < 0) {
+			groups.push_back(index);
+		} else {
+			for (int c = node.childCount; c-- > 0;) stack.push_back(node.firstChild + c);
+		}
+	}
+}
+
+// For each group, one walk of the tree gives the interaction list of all
+// its bodies: a cell is taken whole when the box of the group is outside its
+// opening radius, and opened otherwise. Then velocities get kick times the
+// new accelerations.
+void NBodySystem::computeForces(float kick) {
+	float length = std::max(softening, MIN_SOFTENING);
+	float softeningSquared = length * length;
+	threads().parallelFor((int)groups.size(), 2, [&](int first, int last) {
+		static thread_local InteractionList list;
+		int stack[8 * (MORTON_LEVELS + 1)];
+
+		for (int g = first; g < last; ++g) {
+			const Node &group = nodes[groups[g]];
+			int groupEnd = group.bodyBegin + group.bodyCount;
+			glm::vec3 lower = position[group.bodyBegin], upper = lower;
+			for (int i = group.bodyBegin + 1; i < groupEnd; ++i) {
+				lower = glm::min(lower, position[i]);
+				upper = glm::max(upper, position[i]);
+			}
+
+			list.clear();
+			int depth = 0;
+			stack[depth++] = 0;
+			while (depth > 0) {
+				const Node &node = nodes[stack[--depth]];
+				glm::vec3 outside = glm::max(glm::max(lower - node.centerOfMass, node.centerOfMass - upper), glm::vec3(0.0f));
+				if (glm::dot(outside, outside) > node.openRadiusSq) {
+					list.add(node.centerOfMass, node.mass);
+				} else if (node.firstChild < 0) {
+					// The leaves of the group land here too; a body adds nothing to its own force
+					for (int i = node.bodyBegin; i < node.bodyBegin + node.bodyCount; ++i) list.add(position[i], mass[i]);
+				} else {
+					for (int c = node.childCount; c-- > 0;) stack[depth++] = node.firstChild + c;
+				}
+			}
+			list.pad(ForceLanes::WIDTH);
+
+			for (int i = group.bodyBegin; i < groupEnd; ++i) {
+				glm::vec3 a = nbGravity * accumulateForce<ForceLanes>(list, position[i], softeningSquared);
+				acceleration[i] = a;
+				velocity[i] += kick * a;
+			}
+		}
+	});
+}
+
+void NBodySystem::writeTransforms(std::vector<glm::mat4> &transforms) const {
+	transforms.resize(position.size());
+	threads().parallelFor((int)position.size(), 4096, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			glm::mat4 &model = transforms[i];
+			model = glm::mat4(size[i]);
+			model[3] = glm::vec4(position[i], 1.0f);
+		}
+	});
+}
+
+double NBodySystem::totalEnergy() const {
+	double length = std::max(softening, MIN_SOFTENING);
+	double softeningSquared = length * length;
+	double kinetic = 0.0, potential = 0.0;
+	for (size_t i = 0; i < position.size(); ++i) {
+		kinetic += 0.5 * mass[i] * glm::dot(velocity[i], velocity[i]);
+		for (size_t j = i + 1; j < position.size(); ++j) {
+			glm::vec3 d = position[j] - position[i];
+			potential -= nbGravity * (double)mass[i] * mass[j] / sqrt(glm::dot(d, d) + softeningSquared);
+		}
+	}
+	return kinetic + potential;
+}
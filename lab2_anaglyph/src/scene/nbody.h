@@ -0,0 +1,107 @@
+#ifndef _NBODY_H_
+#define _NBODY_H_
+
+#include <glm/glm.hpp>
+
+#include <util/thread_pool.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+// Self-gravitating bodies, a disk around a heavy central body, with the
+// forces from a Barnes-Hut octree rebuilt every step.
+//
+// A step sorts the bodies along a Morton curve (parallel radix sort of the
+// codes of their positions, the body arrays reordered to match), builds the
+// octree from the sorted codes (the top levels serially, the subtrees below
+// them in parallel), then walks the tree once per group of nearby bodies
+// for all of them. The cells far enough from the group, by the opening
+// angle, and the bodies of the cells that are not, make an interaction list
+// evaluated with SIMD lanes. The integrator is kick-drift-kick leapfrog
+// with a fixed step, which is symplectic: the energy error stays bounded
+// instead of drifting.
+//
+// The loops run on threadPool, ThreadPool::shared() by default; the
+// results do not depend on the thread count. Random numbers come from
+// rand().
+class NBodySystem {
+public:
+	float theta = 0.5f;				// Opening angle: a cell of side s is one body from a distance above s / theta
+	float softening = 1.0f;			// Plummer softening length, at least 1e-3
+	float timeStep = 1.0f / 120.0f;	// Fixed step of the integrator, seconds
+	int maxStepsPerUpdate = 4;		// Simulated time is dropped beyond this, after a stall
+	ThreadPool *threadPool = nullptr;	// Runs the loops; ThreadPool::shared() if null
+
+	// A disk of body_count - 1 bodies in circular orbits around a central body
+	void generate(int body_count);
+
+	// Advance by delta_time in whole steps; the remainder carries over
+	void advance(float delta_time);
+	void step();
+
+	// A box at each body, scaled with its mass
+	void writeTransforms(std::vector<glm::mat4> &transforms) const;
+
+	// Kinetic plus potential energy, by direct summation: O(n^2), for
+	// checking the integrator on small systems
+	double totalEnergy() const;
+
+	// In the Morton order of the last step
+	const std::vector<glm::vec3> &positions() const { return position; }
+	const std::vector<glm::vec3> &accelerations() const { return acceleration; }
+	const std::vector<float> &masses() const { return mass; }
+	int nodeCount() const { return (int)nodes.size(); }
+
+private:
+	ThreadPool &threads() const { return threadPool ? *threadPool : ThreadPool::shared(); }
+
+	struct Node {
+		glm::vec3 centerOfMass;
+		float mass;
+		float openRadiusSq;		// Opened for points closer than this to the center of mass
+		int firstChild;			// Children are contiguous; -1 for a leaf
+		int childCount;
+		int bodyBegin;			// Bodies of the subtree, in Morton order
+		int bodyCount;
+	};
+
+	// A node to build over the sorted bodies [begin, end)
+	struct BuildRange {
+		int node;
+		int begin, end;
+		int level;
+		glm::vec3 corner;		// Minimum corner of the cell
+	};
+
+	void sortBodies();
+	void buildTree();
+	void buildSubtree(std::vector<Node> &subtree, int node, const BuildRange &range);
+	int splitRange(const BuildRange &range, BuildRange *children) const;
+	void finishNode(Node &node, const BuildRange &range, glm::vec3 weighted_position) const;
+	void computeForces(float kick);
+
+	// Bodies
+	std::vector<glm::vec3> position;
+	std::vector<glm::vec3> velocity;
+	std::vector<glm::vec3> acceleration;
+	std::vector<float> mass;
+	std::vector<float> size;
+	bool forcesValid = false;
+	double pendingTime = 0.0;
+
+	// Tree, rebuilt every step
+	glm::vec3 rootCorner;
+	float rootSize = 1.0f;
+	std::vector<uint64_t> codes, sortedCodes;
+	std::vector<int> order, sortedOrder;
+	std::vector<Node> nodes;
+	std::vector<int> groups;				// Subtrees whose bodies share an interaction list
+	std::vector<std::vector<Node>> subtrees;
+
+	// Scratch of the reordering
+	std::vector<glm::vec3> scratchVec3;
+	std::vector<float> scratchFloat;
+};
+
+#endif
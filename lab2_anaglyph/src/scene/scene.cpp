@@ -0,0 +1,257 @@
+#include "scene.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <stdlib.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <algorithm>
+
+// for Part 4: Black Hole
+
+static float bhInnerRadius = 8.0f;   // event horizon-ish
+static float bhOuterRadius = 200.0f; // spawn ring-ish
+static float bhMinRadius = 40.0f;  // initial min spawn radius
+static float bhMaxHeight = 50.0f;  // vertical spread
+
+static float bhBaseAngSpeed = 1.6f;  // base orbital speed
+static float bhBaseFallSpeed = 6.0f; // base inward drift
+
+static int bhRenormalizeInterval = 32; // updates between renormalizing the rotations
+
+static int randomInt() {
+	return rand();
+}
+
+static float randomFloat() {
+	float r = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+	return r;
+}
+
+static glm::vec3 randomVec3() {
+	return glm::vec3(randomFloat(), randomFloat(), randomFloat());
+}
+
+// (cos x, sin(x) / x) from x * x. The series is exact in float for the
+// angles of one update (below 0.25); longer steps, after a stall, fall
+// back to libm.
+static inline glm::vec2 cosSinc(float x_squared) {
+	if (x_squared > 0.0625f) {
+		float x = sqrtf(x_squared);
+		return glm::vec2(cosf(x), sinf(x) / x);
+	}
+	return glm::vec2(1.0f - x_squared * (0.5f - x_squared * (1.0f / 24.0f - x_squared * (1.0f / 720.0f))),
+		1.0f - x_squared * (1.0f / 6.0f - x_squared * (1.0f / 120.0f - x_squared * (1.0f / 5040.0f))));
+}
+
+// The rotation by |rotation| radians around rotation
+static inline glm::quat smallRotation(glm::vec3 rotation) {
+	glm::vec3 half = 0.5f * rotation;
+	glm::vec2 cs = cosSinc(glm::dot(half, half));
+	return glm::quat(cs.x, half * cs.y);
+}
+
+// direction turned by angle radians
+static inline glm::vec2 rotateDirection(glm::vec2 direction, float angle) {
+	glm::vec2 cs = cosSinc(angle * angle);
+	float c = cs.x;
+	float s = angle * cs.y;
+	return glm::vec2(direction.x * c - direction.y * s, direction.x * s + direction.y * c);
+}
+
+// Translate * rotate * scale, without the matrix products
+static inline void composeTransform(glm::mat4 &model, glm::vec3 position, const glm::quat &orientation, glm::vec3 scale) {
+	glm::mat3 rotation = glm::mat3_cast(orientation);
+	model[0] = glm::vec4(rotation[0] * scale.x, 0.0f);
+	model[1] = glm::vec4(rotation[1] * scale.y, 0.0f);
+	model[2] = glm::vec4(rotation[2] * scale.z, 0.0f);
+	model[3] = glm::vec4(position, 1.0f);
+}
+
+void Scene::generate(SceneMode mode, int object_count) {
+	this->mode = mode;
+	boxTransforms.clear();
+	if (mode == SceneMode::Debug) {
+		// Use this for debugging
+		glm::mat4 modelMatrix = glm::mat4();
+		modelMatrix = glm::translate(modelMatrix, glm::vec3(0, 0, 0));
+		modelMatrix = glm::scale(modelMatrix, glm::vec3(16, 16, 16));
+		boxTransforms.push_back(modelMatrix);
+	} else if (mode == SceneMode::RandomBoxes) {
+		// Generate boxes based on random position, rotation, and scale. 
+		// Store their transforms.
+		for (int i = 0; i < object_count; ++i) {
+			glm::vec3 position = 100.0f * (randomVec3() - 0.5f);
+			float s = (1 + (randomInt() % 4)) * 1.0f;
+			glm::vec3 scale(s, s, s);
+			float angle = randomFloat() * M_PI * 2;
+			glm::vec3 axis = glm::normalize(randomVec3() - 0.5f);
+
+			glm::mat4 modelMatrix = glm::mat4();
+			modelMatrix = glm::translate(modelMatrix, position);
+			modelMatrix = glm::rotate(modelMatrix, angle, axis);
+			modelMatrix = glm::scale(modelMatrix, scale);
+			boxTransforms.push_back(modelMatrix);
+		}
+	}
+	else if (mode == SceneMode::BlackHole) {
+		generateBlackHole(object_count);
+	}
+	else if (mode == SceneMode::NBody) {
+		nbody.generate(object_count);
+		nbody.writeTransforms(boxTransforms);
+	}
+
+}
+
+void Scene::generateBlackHole(int particle_count) {
+	int particleCount = particle_count;
+	boxTransforms.resize(particleCount + 1);
+
+	// Resize particle state arrays
+	bhDirection.resize(particleCount);
+	bhRadius.resize(particleCount);
+	bhAngSpeed.resize(particleCount);
+	bhFallSpeed.resize(particleCount);
+	bhHeight.resize(particleCount);
+	bhYSpeed.resize(particleCount);
+	bhScale.resize(particleCount);
+	bhOrientation.resize(particleCount);
+	bhSpin.resize(particleCount);
+	bhWobblePhase.resize(particleCount);
+	bhStep = 0;
+
+	// Black hole cube at origin (index 0)
+	{
+		glm::mat4 modelMatrix(1.0f);
+		modelMatrix = glm::translate(modelMatrix, glm::vec3(0, 0, 0));
+		modelMatrix = glm::scale(modelMatrix, glm::vec3(15, 15, 15));
+		boxTransforms[0] = modelMatrix;
+	}
+
+	for (int i = 0; i < particleCount; ++i) {
+		float angle = randomFloat() * (float)(2.0 * M_PI);
+
+		// spawn radius (biased outward)
+		float radius = bhMinRadius + (bhOuterRadius - bhMinRadius) * (0.35f + 0.65f * randomFloat());
+		float height = (randomFloat() * 2.0f - 1.0f) * bhMaxHeight;
+
+		// faster nearer center
+		float chaos = 0.4f + 1.6f * randomFloat();
+		float angSpd = bhBaseAngSpeed * sqrt(bhOuterRadius / radius);
+		float fallSpd = bhBaseFallSpeed * (0.35f + 0.65f * randomFloat());
+		float ySpd = (randomFloat() * 2.0f - 1.0f) * 2.0f;
+		float scale = 0.8f + 2.5f * (radius / bhOuterRadius);
+		float direction = (randomFloat() < 0.5f) ? -1.0f : 1.0f;
+
+		bhDirection[i] = glm::vec2(cosf(angle), sinf(angle));
+		bhRadius[i] = radius;
+		bhHeight[i] = height;
+		bhAngSpeed[i] = angSpd * chaos * direction;
+		bhFallSpeed[i] = fallSpd * chaos;
+		bhYSpeed[i] = ySpd;
+		bhScale[i] = scale;
+
+		glm::vec3 spinAxis = glm::normalize(randomVec3() - 0.5f);
+		bhSpin[i] = spinAxis * (0.8f + 2.5f * randomFloat());
+		bhOrientation[i] = glm::angleAxis(angle, glm::vec3(0, 1, 0)) *
+			glm::angleAxis(randomFloat() * (float)(2.0 * M_PI), spinAxis);
+		bhWobblePhase[i] = glm::vec2(cosf((float)i), sinf((float)i));
+
+		glm::vec3 position(bhDirection[i].x * radius, height, bhDirection[i].y * radius);
+		composeTransform(boxTransforms[i + 1], position, bhOrientation[i], glm::vec3(scale));
+	}
+}
+
+void Scene::update(double time, float delta_time) {
+	// Black hole animation update
+	if (mode == SceneMode::BlackHole && boxTransforms.size() > 1) updateBlackHole(time, delta_time);
+	if (mode == SceneMode::NBody) {
+		nbody.advance(delta_time);
+		nbody.writeTransforms(boxTransforms);
+	}
+}
+
+void Scene::updateBlackHole(double time, float delta_time) {
+	int particleCount = (int)boxTransforms.size() - 1;
+
+	// Rotate black hole cube slowly
+	glm::mat4 modelMatrix(1.0f);
+	modelMatrix = glm::rotate(modelMatrix, (float)time * 0.3f, glm::vec3(1, 1, 1));
+	modelMatrix = glm::scale(modelMatrix, glm::vec3(15, 15, 15));
+	boxTransforms[0] = modelMatrix;
+
+	// The wobble of particle i is sin(0.7 time + i) * 0.2; with the angle
+	// sum formula only the constant bhWobblePhase is per particle
+	float wobbleSin = sinf((float)time * 0.7f) * 0.2f;
+	float wobbleCos = cosf((float)time * 0.7f) * 0.2f;
+
+	// Each particle turns around (1, 1, 1) as it orbits, and spins around
+	// its own axis
+	const glm::vec3 orbitAxis = glm::normalize(glm::vec3(1, 1, 1));
+	bool renormalize = ++bhStep % bhRenormalizeInterval == 0;
+
+	for (int i = 0; i < particleCount; ++i) {
+		// Orbital motion
+		float orbitStep = bhAngSpeed[i] * delta_time * (1.0f + 2.0f / std::max(bhRadius[i], 20.0f));
+		// Vertical bobbing
+		float wobble = wobbleSin * bhWobblePhase[i].x + wobbleCos * bhWobblePhase[i].y;
+		orbitStep += wobble * delta_time;
+		bhDirection[i] = rotateDirection(bhDirection[i], orbitStep);
+		bhOrientation[i] = smallRotation(orbitAxis * orbitStep) * bhOrientation[i] * smallRotation(bhSpin[i] * delta_time);
+		if (renormalize) {
+			bhDirection[i] = glm::normalize(bhDirection[i]);
+			bhOrientation[i] = glm::normalize(bhOrientation[i]);
+		}
+
+		// Radial pull inward
+		float pull = 1.0f + 40.0f / std::max(bhRadius[i], 20.0f);
+		bhRadius[i] -= bhFallSpeed[i] * pull * delta_time;
+
+		// Vertical drift
+		bhHeight[i] += bhYSpeed[i] * delta_time;
+		if (bhHeight[i] > bhMaxHeight) { bhHeight[i] = bhMaxHeight; bhYSpeed[i] *= -1.0f; }
+		if (bhHeight[i] < -bhMaxHeight) { bhHeight[i] = -bhMaxHeight; bhYSpeed[i] *= -1.0f; }
+
+		// Event horizon: respawn
+		if (bhRadius[i] < bhInnerRadius) {
+			// Reposition
+			float angle = randomFloat() * (float)(2.0 * M_PI);
+			bhDirection[i] = glm::vec2(cosf(angle), sinf(angle));
+			bhRadius[i] = bhMinRadius + (bhOuterRadius - bhMinRadius) * (0.4f + 0.3f * randomFloat());
+			bhHeight[i] = (randomFloat() * 2.0f - 1.0f) * bhMaxHeight;
+			float chaos = 0.4f + 1.6f * randomFloat();
+
+			// Re-roll orbital speeds
+			float direction = (randomFloat() < 0.5f) ? -1.0f : 1.0f;
+			bhAngSpeed[i] = bhBaseAngSpeed * sqrt(bhOuterRadius / bhRadius[i]) * chaos * direction;
+
+			// Radial + vertical speeds
+			bhFallSpeed[i] = bhBaseFallSpeed * (0.35f + 0.65f * randomFloat()) * chaos;
+			bhYSpeed[i] = (randomFloat() * 2.0f - 1.0f) * 2.0f;
+
+			// Visuals: the orientation it would have spinning since time 0
+			glm::vec3 spinAxis = glm::normalize(randomVec3() - 0.5f);
+			float spinSpeed = 0.8f + 2.5f * randomFloat();
+			bhSpin[i] = spinAxis * spinSpeed;
+			bhOrientation[i] = glm::angleAxis(angle, orbitAxis) * glm::angleAxis((float)time * spinSpeed, spinAxis);
+		}
+
+		// Occasional energy injection
+		if (randomFloat() < 0.2f * delta_time) {
+			bhRadius[i] *= 0.5f;
+		}
+
+		// Tidal stretching (increases toward center)
+		float baseScale = 0.5f + 2.5f * (bhRadius[i] / bhOuterRadius);
+		float t = glm::clamp(1.0f - (bhRadius[i] / bhOuterRadius), 0.0f, 1.0f);
+		float sx = baseScale * (1.0f + t * 1.5f);
+		float sy = baseScale * (1.0f - t * 0.5f);
+		float sz = baseScale * (1.0f + t * 1.5f);
+
+		// Update transform
+		glm::vec3 position(bhDirection[i].x * bhRadius[i], bhHeight[i], bhDirection[i].y * bhRadius[i]);
+		composeTransform(boxTransforms[i + 1], position, bhOrientation[i], glm::vec3(sx, sy, sz));
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef _SCENE_H_
+#define _SCENE_H_
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <scene/nbody.h>
+
+#include <vector>
+
+enum SceneMode {
+	Debug,
+	RandomBoxes,
+	BlackHole,
+	NBody,			// Gravity between all the bodies, see scene/nbody.h
+};
+
+// The boxes of the scene, as one transform per box, and their animation.
+// Random numbers come from rand(), so a scene is reproducible from the
+// seed given to srand().
+class Scene {
+public:
+	SceneMode mode = SceneMode::Debug;
+	std::vector<glm::mat4> boxTransforms;	// We represent the scene by a single box and a number of transforms for drawing the box at different locations.
+	NBodySystem nbody;						// State and settings (opening angle, time step) of the NBody mode
+
+	// object_count is the number of random boxes, black hole particles or bodies
+	void generate(SceneMode mode, int object_count = 100);
+
+	// Advance the animation to time, delta_time after the last update
+	void update(double time, float delta_time);
+
+private:
+	// for Part 4: Black Hole
+	void generateBlackHole(int particle_count);
+	void updateBlackHole(double time, float delta_time);
+
+	// Per-particle state. Orbit direction and orientation are advanced by
+	// small rotations each update, so the steady state needs no trig.
+	std::vector<glm::vec2> bhDirection;		// (cos, sin) of the orbit angle
+	std::vector<float> bhRadius;
+	std::vector<float> bhAngSpeed;
+	std::vector<float> bhFallSpeed;
+	std::vector<float> bhHeight;
+	std::vector<float> bhYSpeed;
+	std::vector<float> bhScale;
+	std::vector<glm::quat> bhOrientation;
+	std::vector<glm::vec3> bhSpin;			// Angular velocity in the particle's frame, rad/s
+	std::vector<glm::vec2> bhWobblePhase;	// (cos, sin) of the particle index
+	int bhStep = 0;							// Updates since generation, for renormalization
+};
+
+#endif
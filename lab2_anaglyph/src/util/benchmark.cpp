@@ -0,0 +1,174 @@
+#include "benchmark.h"
+
+#include <glm/glm.hpp>
+
+#include <math.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool PinCurrentThread(int cpu) {
+#if defined(_WIN32)
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+static double percentile(const std::vector<double> &sorted, double fraction) {
+	// Linear interpolation between the closest ranks
+	double position = fraction * (sorted.size() - 1);
+	size_t below = (size_t)position;
+	size_t above = std::min(below + 1, sorted.size() - 1);
+	return sorted[below] + (sorted[above] - sorted[below]) * (position - below);
+}
+
+SampleStats ComputeStats(std::vector<double> &samples) {
+	SampleStats stats = {};
+	stats.count = samples.size();
+	if (samples.empty()) return stats;
+
+	std::sort(samples.begin(), samples.end());
+	double sum = 0.0;
+	for (double sample : samples) sum += sample;
+	stats.mean = sum / samples.size();
+	double squares = 0.0;
+	for (double sample : samples) squares += (sample - stats.mean) * (sample - stats.mean);
+	stats.stddev = samples.size() > 1 ? sqrt(squares / (samples.size() - 1)) : 0.0;
+
+	stats.min = samples.front();
+	stats.max = samples.back();
+	stats.median = percentile(samples, 0.5);
+	stats.p90 = percentile(samples, 0.9);
+	stats.p99 = percentile(samples, 0.99);
+	return stats;
+}
+
+void JsonWriter::separator(const char *key) {
+	if (!first.empty()) {
+		if (!first.back()) fputc(',', file);
+		first.back() = false;
+		fputc('\n', file);
+		for (size_t i = 0; i < first.size(); ++i) fputc('\t', file);
+	}
+	if (key) fprintf(file, "\"%s\": ", key);
+}
+
+void JsonWriter::beginObject(const char *key) {
+	separator(key);
+	fputc('{', file);
+	first.push_back(true);
+}
+
+void JsonWriter::endObject() {
+	bool empty = first.back();
+	first.pop_back();
+	if (!empty) {
+		fputc('\n', file);
+		for (size_t i = 0; i < first.size(); ++i) fputc('\t', file);
+	}
+	fputc('}', file);
+	if (first.empty()) fputc('\n', file);
+}
+
+void JsonWriter::beginArray(const char *key) {
+	separator(key);
+	fputc('[', file);
+	first.push_back(true);
+}
+
+void JsonWriter::endArray() {
+	bool empty = first.back();
+	first.pop_back();
+	if (!empty) {
+		fputc('\n', file);
+		for (size_t i = 0; i < first.size(); ++i) fputc('\t', file);
+	}
+	fputc(']', file);
+}
+
+void JsonWriter::value(const char *key, const char *text) {
+	separator(key);
+	fputc('"', file);
+	for (const char *c = text; *c; ++c) {
+		if (*c == '"' || *c == '\\') fputc('\\', file);
+		if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", *c);
+			continue;
+		}
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+void JsonWriter::value(const char *key, double number) {
+	separator(key);
+	if (isfinite(number)) fprintf(file, "%.6g", number);
+	else fputs("null", file);
+}
+
+void JsonWriter::value(const char *key, int64_t number) {
+	separator(key);
+	fprintf(file, "%lld", (long long)number);
+}
+
+void JsonWriter::value(const char *key, bool flag) {
+	separator(key);
+	fputs(flag ? "true" : "false", file);
+}
+
+void JsonWriter::stats(const char *key, const SampleStats &stats) {
+	beginObject(key);
+	value("min", stats.min);
+	value("median", stats.median);
+	value("mean", stats.mean);
+	value("p90", stats.p90);
+	value("p99", stats.p99);
+	value("max", stats.max);
+	value("stddev", stats.stddev);
+	value("count", (int64_t)stats.count);
+	endObject();
+}
+
+std::string BuildDescription() {
+	std::string description;
+#if defined(__clang__)
+	description += "clang " __clang_version__;
+#elif defined(__GNUC__)
+	description += "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	description += "msvc " + std::to_string(_MSC_VER);
+#endif
+#ifdef NDEBUG
+	description += ", release";
+#else
+	description += ", debug";
+#endif
+#if defined(__AVX2__)
+	description += ", avx2";
+#elif defined(__AVX__)
+	description += ", avx";
+#elif defined(__SSE4_1__)
+	description += ", sse4.1";
+#elif defined(__SSE2__) || defined(_M_X64)
+	description += ", sse2";
+#endif
+#if GLM_ARCH == GLM_ARCH_PURE
+	description += ", glm pure";
+#else
+	description += ", glm simd";
+#endif
+	return description;
+}
@@ -0,0 +1,67 @@
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+// Shared pieces of the benchmarks (bench/micro_bench.cpp, anaglyph
+// --benchmark): thread pinning, timing statistics and a small JSON writer
+// for results that are compared from run to run.
+
+// Pin the calling thread to one CPU, so it is not migrated between
+// samples. Returns false where this is not supported or not allowed.
+bool PinCurrentThread(int cpu);
+
+// Keep a value alive without the compiler seeing through it
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void *sink;
+	sink = &value;
+#endif
+}
+
+// Order statistics of a set of samples
+struct SampleStats {
+	double min, median, mean, p90, p99, max, stddev;
+	size_t count;
+};
+
+// Sorts the samples
+SampleStats ComputeStats(std::vector<double> &samples);
+
+// Streaming JSON with comma and indentation bookkeeping. Keys are only
+// passed inside objects.
+class JsonWriter {
+public:
+	explicit JsonWriter(FILE *file) : file(file) {}
+
+	void beginObject(const char *key = nullptr);
+	void endObject();
+	void beginArray(const char *key = nullptr);
+	void endArray();
+
+	void value(const char *key, const char *text);
+	void value(const char *key, const std::string &text) { value(key, text.c_str()); }
+	void value(const char *key, double number);
+	void value(const char *key, int64_t number);
+	void value(const char *key, int number) { value(key, (int64_t)number); }
+	void value(const char *key, bool flag);
+	void stats(const char *key, const SampleStats &stats);
+
+private:
+	void separator(const char *key);
+
+	FILE *file;
+	std::vector<bool> first;	// Per open scope: nothing written in it yet
+};
+
+// Compiler, flags and glm configuration, for the header of result files
+std::string BuildDescription();
+
+#endif
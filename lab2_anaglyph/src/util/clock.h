@@ -0,0 +1,14 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+
+// Monotonic time in nanoseconds from an arbitrary origin. Unaffected by
+// changes of the wall clock, so differences are safe to use as latencies.
+uint64_t MonotonicTimeNs();
+
+inline double NanosecondsToMilliseconds(uint64_t ns) {
+	return (double)ns / 1e6;
+}
+
+#endif
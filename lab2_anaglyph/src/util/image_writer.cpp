@@ -0,0 +1,192 @@
+#include "image_writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+bool WritePPM(const char *path, const uint8_t *rgb, int width, int height) {
+	FILE *file = fopen(path, "wb");
+	if (!file) return false;
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	size_t size = (size_t)width * height * 3;
+	bool ok = fwrite(rgb, 1, size, file) == size;
+	return fclose(file) == 0 && ok;
+}
+
+static uint32_t crcTable[256];
+
+static void initializeCrcTable() {
+	if (crcTable[1]) return;
+	for (uint32_t n = 0; n < 256; ++n) {
+		uint32_t c = n;
+		for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		crcTable[n] = c;
+	}
+}
+
+static uint32_t updateCrc(uint32_t crc, const uint8_t *data, size_t size) {
+	for (size_t i = 0; i < size; ++i) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+static void putBigEndian(std::vector<uint8_t> &out, uint32_t value) {
+	out.push_back((uint8_t)(value >> 24));
+	out.push_back((uint8_t)(value >> 16));
+	out.push_back((uint8_t)(value >> 8));
+	out.push_back((uint8_t)value);
+}
+
+static void putChunk(std::vector<uint8_t> &out, const char *type, const uint8_t *data, size_t size) {
+	putBigEndian(out, (uint32_t)size);
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	if (size) out.insert(out.end(), data, data + size);
+	putBigEndian(out, updateCrc(0xFFFFFFFFu, &out[start], out.size() - start) ^ 0xFFFFFFFFu);
+}
+
+// Largest stored deflate block
+static const size_t MAX_BLOCK = 65535;
+
+// zlib stream of stored deflate blocks, fed in pieces of any size
+struct StoredDeflate {
+	std::vector<uint8_t> &out;
+	size_t remaining;		// Bytes still to come
+	size_t blockLeft = 0;	// Bytes still to come in the current block
+	uint32_t adlerA = 1, adlerB = 0;
+
+	StoredDeflate(std::vector<uint8_t> &out, size_t size) : out(out), remaining(size) {
+		out.reserve(out.size() + size + size / MAX_BLOCK * 5 + 16);
+		out.push_back(0x78);
+		out.push_back(0x01);
+	}
+
+	void put(const uint8_t *data, size_t size) {
+		while (size > 0) {
+			if (blockLeft == 0) {
+				blockLeft = std::min(remaining, MAX_BLOCK);
+				remaining -= blockLeft;
+				out.push_back(remaining == 0 ? 1 : 0);
+				out.push_back((uint8_t)blockLeft);
+				out.push_back((uint8_t)(blockLeft >> 8));
+				out.push_back((uint8_t)~blockLeft);
+				out.push_back((uint8_t)(~blockLeft >> 8));
+			}
+			size_t count = std::min(size, blockLeft);
+			out.insert(out.end(), data, data + count);
+
+			// Adler-32, reduced often enough that the sums cannot overflow
+			for (size_t i = 0; i < count; ++i) {
+				adlerA += data[i];
+				adlerB += adlerA;
+				if ((i & 4095) == 4095) {
+					adlerA %= 65521;
+					adlerB %= 65521;
+				}
+			}
+			adlerA %= 65521;
+			adlerB %= 65521;
+
+			data += count;
+			size -= count;
+			blockLeft -= count;
+		}
+	}
+
+	void finish() {
+		putBigEndian(out, (adlerB << 16) | adlerA);
+	}
+};
+
+bool WritePNG(const char *path, const uint8_t *rgb, int width, int height) {
+	initializeCrcTable();
+
+	// Every row starts with its filter type, 0 (none)
+	size_t rowSize = (size_t)width * 3;
+	std::vector<uint8_t> zlib;
+	StoredDeflate deflate(zlib, (rowSize + 1) * height);
+	const uint8_t filter = 0;
+	for (int y = 0; y < height; ++y) {
+		deflate.put(&filter, 1);
+		deflate.put(rgb + y * rowSize, rowSize);
+	}
+	deflate.finish();
+
+	std::vector<uint8_t> png;
+	png.reserve(zlib.size() + 64);
+	const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	png.insert(png.end(), signature, signature + 8);
+	uint8_t header[13] = { 0 };
+	for (int k = 0; k < 4; ++k) {
+		header[k] = (uint8_t)(width >> (24 - 8 * k));
+		header[4 + k] = (uint8_t)(height >> (24 - 8 * k));
+	}
+	header[8] = 8;		// Bit depth
+	header[9] = 2;		// Truecolor
+	putChunk(png, "IHDR", header, sizeof(header));
+	putChunk(png, "IDAT", &zlib[0], zlib.size());
+	putChunk(png, "IEND", nullptr, 0);
+
+	FILE *file = fopen(path, "wb");
+	if (!file) return false;
+	bool ok = fwrite(&png[0], 1, png.size(), file) == png.size();
+	return fclose(file) == 0 && ok;
+}
+
+bool Y4MWriter::open(const char *path, int width, int height, int fps) {
+	close();
+	file = fopen(path, "wb");
+	if (!file) return false;
+	this->width = width;
+	this->height = height;
+	int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+	planes = (uint8_t *)malloc((size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight);
+	fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fps);
+	return planes != nullptr;
+}
+
+static inline uint8_t clampByte(int value) {
+	return (uint8_t)std::min(std::max(value, 0), 255);
+}
+
+bool Y4MWriter::write(const uint8_t *rgb) {
+	if (!file) return false;
+	int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+	uint8_t *luma = planes;
+	uint8_t *cb = luma + (size_t)width * height;
+	uint8_t *cr = cb + (size_t)chromaWidth * chromaHeight;
+
+	// JFIF coefficients in 16.16 fixed point
+	for (size_t i = 0, n = (size_t)width * height; i < n; ++i) {
+		const uint8_t *p = rgb + i * 3;
+		luma[i] = (uint8_t)((19595 * p[0] + 38470 * p[1] + 7471 * p[2] + 32768) >> 16);
+	}
+	for (int y = 0; y < chromaHeight; ++y) {
+		for (int x = 0; x < chromaWidth; ++x) {
+			// Average of the 2x2 block, edge pixels repeated
+			int r = 0, g = 0, b = 0;
+			for (int dy = 0; dy < 2; ++dy) {
+				for (int dx = 0; dx < 2; ++dx) {
+					int sx = std::min(2 * x + dx, width - 1), sy = std::min(2 * y + dy, height - 1);
+					const uint8_t *p = rgb + ((size_t)sy * width + sx) * 3;
+					r += p[0];
+					g += p[1];
+					b += p[2];
+				}
+			}
+			cb[y * chromaWidth + x] = clampByte((-11059 * r - 21709 * g + 32768 * b + (128 << 18) + 131072) >> 18);
+			cr[y * chromaWidth + x] = clampByte((32768 * r - 27439 * g - 5329 * b + (128 << 18) + 131072) >> 18);
+		}
+	}
+
+	size_t size = (size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight;
+	return fputs("FRAME\n", file) >= 0 && fwrite(planes, 1, size, file) == size;
+}
+
+void Y4MWriter::close() {
+	if (file) fclose(file);
+	free(planes);
+	file = nullptr;
+	planes = nullptr;
+}
@@ -0,0 +1,36 @@
+#ifndef _IMAGE_WRITER_H_
+#define _IMAGE_WRITER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Uncompressed image encoders for frame dumps. Images are 8-bit RGB, top
+// row first, without row padding. Nothing is compressed: the files are
+// meant to be written as fast as frames are rendered and to compare equal
+// byte for byte when the frames do.
+
+// Binary PPM (P6)
+bool WritePPM(const char *path, const uint8_t *rgb, int width, int height);
+
+// PNG with stored (uncompressed) deflate blocks, readable by any decoder
+bool WritePNG(const char *path, const uint8_t *rgb, int width, int height);
+
+// YUV4MPEG2 stream, 4:2:0 full range BT.601 (C420jpeg, XCOLORRANGE=FULL), for video tools
+// such as ffmpeg or mpv. Odd sizes get their last chroma column/row from
+// the edge pixels.
+class Y4MWriter {
+public:
+	~Y4MWriter() { close(); }
+
+	bool open(const char *path, int width, int height, int fps);
+	bool write(const uint8_t *rgb);
+	void close();
+
+private:
+	FILE *file = nullptr;
+	int width = 0;
+	int height = 0;
+	uint8_t *planes = nullptr;
+};
+
+#endif
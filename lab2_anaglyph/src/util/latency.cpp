@@ -0,0 +1,93 @@
+#include "latency.h"
+#include "clock.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <iomanip>
+
+static const char *INPUT_NAMES[LatencyInputCount] = { "key", "cursor", "camera" };
+
+uint32_t LatencyTracker::recordInput(LatencyInput kind) {
+	LatencyEvent event = {};
+	event.sequence = (uint32_t)events.size() + 1;
+	event.kind = kind;
+	event.arrival = MonotonicTimeNs();
+	events.push_back(event);
+	return event.sequence;
+}
+
+uint32_t LatencyTracker::consumeInputs() {
+	uint64_t now = MonotonicTimeNs();
+	for (; consumedCount < events.size(); ++consumedCount) events[consumedCount].consumed = now;
+	return (uint32_t)events.size();
+}
+
+void LatencyTracker::frameSwapped(uint32_t sequence) {
+	uint64_t now = MonotonicTimeNs();
+	for (; swappedCount < sequence && swappedCount < events.size(); ++swappedCount) events[swappedCount].swapped = now;
+}
+
+void LatencyTracker::frameVisible(uint32_t sequence) {
+	uint64_t now = MonotonicTimeNs();
+	for (; visibleCount < sequence && visibleCount < events.size(); ++visibleCount) events[visibleCount].visible = now;
+}
+
+void LatencyTracker::clear() {
+	events.clear();
+	consumedCount = swappedCount = visibleCount = 0;
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+	size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void LatencyTracker::printReport(std::ostream &out) const {
+	static const char *STAGE_NAMES[] = { "to frame", "to swap", "to visible" };
+
+	out << "Latency in ms        count     mean      p50      p90      p99      max" << std::endl;
+	out << std::fixed << std::setprecision(2);
+	for (int kind = 0; kind < LatencyInputCount; ++kind) {
+		for (int stage = 0; stage < 3; ++stage) {
+			std::vector<double> samples;
+			for (size_t i = 0; i < events.size(); ++i) {
+				const LatencyEvent &event = events[i];
+				if (event.kind != kind) continue;
+				uint64_t time = (stage == 0) ? event.consumed : (stage == 1) ? event.swapped : event.visible;
+				if (time != 0) samples.push_back(NanosecondsToMilliseconds(time - event.arrival));
+			}
+			if (samples.empty()) continue;
+
+			std::sort(samples.begin(), samples.end());
+			double sum = 0;
+			for (size_t i = 0; i < samples.size(); ++i) sum += samples[i];
+			out << std::left << std::setw(7) << INPUT_NAMES[kind] << std::setw(11) << STAGE_NAMES[stage] << std::right
+				<< std::setw(8) << samples.size() << std::setw(9) << sum / samples.size()
+				<< std::setw(9) << percentile(samples, 50) << std::setw(9) << percentile(samples, 90)
+				<< std::setw(9) << percentile(samples, 99) << std::setw(9) << samples.back() << std::endl;
+		}
+	}
+	out.unsetf(std::ios::floatfield);
+	out << std::setprecision(6);
+}
+
+bool LatencyTracker::writeCsv(const char *path) const {
+	FILE *file = fopen(path, "w");
+	if (!file) return false;
+
+	// Stages not reached are left empty
+	fprintf(file, "sequence,kind,frame_ms,swap_ms,visible_ms\n");
+	for (size_t i = 0; i < events.size(); ++i) {
+		const LatencyEvent &event = events[i];
+		fprintf(file, "%u,%s", event.sequence, INPUT_NAMES[event.kind]);
+		uint64_t times[3] = { event.consumed, event.swapped, event.visible };
+		for (int s = 0; s < 3; ++s) {
+			if (times[s]) fprintf(file, ",%.3f", NanosecondsToMilliseconds(times[s] - event.arrival));
+			else fprintf(file, ",");
+		}
+		fprintf(file, "\n");
+	}
+	fclose(file);
+	return true;
+}
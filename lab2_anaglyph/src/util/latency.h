@@ -0,0 +1,60 @@
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ostream>
+#include <vector>
+
+enum LatencyInput {
+	KeyInput,
+	CursorInput,
+	CameraUpdate,	// Animation step of the camera
+	LatencyInputCount,
+};
+
+// One input event and the times it reached each stage, 0 if not (yet) reached
+struct LatencyEvent {
+	uint32_t sequence;
+	LatencyInput kind;
+	uint64_t arrival;	// Input callback ran
+	uint64_t consumed;	// A frame started with it
+	uint64_t swapped;	// The buffer swap of that frame returned
+	uint64_t visible;	// Its frame's marker pixel was read back from the front buffer
+};
+
+// Motion-to-photon instrumentation. Inputs are numbered in arrival order,
+// frames are tagged with the newest input they consumed, and every event
+// gets the time its frame was swapped and, with marker readback, seen.
+// Everything runs on the main thread.
+class LatencyTracker {
+public:
+	// Returns the sequence number of the input, starting at 1
+	uint32_t recordInput(LatencyInput kind);
+
+	// All inputs so far are used by the frame being built. Returns the
+	// newest sequence number, 0 if there was no input yet.
+	uint32_t consumeInputs();
+
+	// The frame tagged with sequence was swapped / seen on screen
+	void frameSwapped(uint32_t sequence);
+	void frameVisible(uint32_t sequence);
+
+	size_t eventCount() const { return events.size(); }
+	void clear();
+
+	// Latency percentiles per input kind and stage, in milliseconds
+	void printReport(std::ostream &out) const;
+
+	// One line per event, times relative to its arrival
+	bool writeCsv(const char *path) const;
+
+private:
+	std::vector<LatencyEvent> events;	// Event n is at index n - 1
+	size_t consumedCount = 0;
+	size_t swappedCount = 0;
+	size_t visibleCount = 0;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "mapped_file.h"
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+uint64_t FileModifiedTime(const char *path) {
+	struct stat info;
+	if (stat(path, &info) != 0) return 0;
+	return (uint64_t)info.st_mtime;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char *path) {
+	close();
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		fileHandle = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL) {
+		mappingHandle = nullptr;
+		close();
+		return false;
+	}
+
+	data = (const unsigned char *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL) {
+		close();
+		return false;
+	}
+	modifiedTime = FileModifiedTime(path);
+	return true;
+}
+
+void MappedFile::close() {
+	if (data) UnmapViewOfFile(data);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+	data = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	size = 0;
+	modifiedTime = 0;
+}
+
+#else
+
+bool MappedFile::open(const char *path) {
+	close();
+	fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close();
+		return false;
+	}
+	size = (size_t)info.st_size;
+	modifiedTime = (uint64_t)info.st_mtime;
+
+	void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapping == MAP_FAILED) {
+		close();
+		return false;
+	}
+	// Readers touch the whole file right away, start paging it in
+	madvise(mapping, size, MADV_WILLNEED);
+	data = (const unsigned char *)mapping;
+	return true;
+}
+
+void MappedFile::close() {
+	if (data) munmap((void *)data, size);
+	if (fd >= 0) ::close(fd);
+	data = nullptr;
+	fd = -1;
+	size = 0;
+	modifiedTime = 0;
+}
+
+#endif
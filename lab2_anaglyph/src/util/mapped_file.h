@@ -0,0 +1,35 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A read-only memory mapping of a whole file. The pages are brought in by
+// the OS on first touch, so opening a large file costs almost nothing.
+struct MappedFile {
+	const unsigned char *data = nullptr;
+	size_t size = 0;
+	uint64_t modifiedTime = 0;	// Last write time of the file, for cache validation
+
+	MappedFile() {}
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const char *path);
+	void close();
+
+private:
+#ifdef _WIN32
+	void *fileHandle = nullptr;
+	void *mappingHandle = nullptr;
+#else
+	int fd = -1;
+#endif
+};
+
+// Last write time of a file, 0 if it does not exist
+uint64_t FileModifiedTime(const char *path);
+
+#endif
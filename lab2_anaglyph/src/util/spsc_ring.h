@@ -0,0 +1,46 @@
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <stddef.h>
+
+#include <atomic>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Head and tail only ever grow; the capacity is a power of two so
+// the slot is a mask of them. Each index is written by one side only and
+// lives on its own cache line.
+template <typename T, size_t Capacity>
+class SpscRing {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// Producer side. Returns false if the ring is full.
+	bool push(const T &item) {
+		size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - headIndex.load(std::memory_order_acquire) == Capacity) return false;
+		items[tail & (Capacity - 1)] = item;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns false if the ring is empty.
+	bool pop(T &item) {
+		size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == tailIndex.load(std::memory_order_acquire)) return false;
+		item = items[head & (Capacity - 1)];
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Exact only when called from one of the two sides while the other is idle
+	size_t size() const {
+		return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+	}
+
+private:
+	alignas(64) std::atomic<size_t> headIndex{ 0 };
+	alignas(64) std::atomic<size_t> tailIndex{ 0 };
+	alignas(64) T items[Capacity];
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int thread_count) : nextChunk(0) {
+	if (thread_count <= 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 1; i < thread_count; ++i) {
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for (std::thread &worker : workers) worker.join();
+}
+
+ThreadPool &ThreadPool::shared() {
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int)> &fn) {
+	if (count <= 0) return;
+	grain = std::max(grain, 1);
+
+	// About four chunks per thread, so a slow chunk is evened out by the rest
+	int chunk = std::max(grain, (count + 4 * threadCount() - 1) / (4 * threadCount()));
+	if (workers.empty() || chunk >= count) {
+		fn(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		jobCount = count;
+		jobChunk = chunk;
+		nextChunk.store(0, std::memory_order_relaxed);
+		busy = (int)workers.size();
+		++generation;
+	}
+	jobReady.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [this]() { return busy == 0; });
+	job = nullptr;
+}
+
+void ThreadPool::runChunks() {
+	for (;;) {
+		int begin = nextChunk.fetch_add(jobChunk, std::memory_order_relaxed);
+		if (begin >= jobCount) return;
+		(*job)(begin, std::min(begin + jobChunk, jobCount));
+	}
+}
+
+void ThreadPool::workerLoop() {
+	uint64_t seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		runChunks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busy == 0) jobDone.notify_one();
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads that stay up between jobs, for loops run every frame
+// where starting threads would cost more than the work. parallelFor()
+// splits a range into chunks that the workers and the calling thread take
+// in turn, and returns once all are done. One job runs at a time; the
+// function must not call parallelFor() of the same pool.
+class ThreadPool {
+public:
+	// thread_count includes the calling thread; 0 is one per hardware thread
+	explicit ThreadPool(int thread_count = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	int threadCount() const { return (int)workers.size() + 1; }
+
+	// Calls fn(begin, end) on chunks of [0, count), each of at least grain
+	// items unless it is the last one
+	void parallelFor(int count, int grain, const std::function<void(int, int)> &fn);
+
+	// A pool of one thread per hardware thread, created on first use
+	static ThreadPool &shared();
+
+private:
+	void workerLoop();
+	void runChunks();
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+	uint64_t generation = 0;		// Jobs started
+	int busy = 0;					// Workers still in the current job
+	bool stopping = false;
+
+	// The current job
+	const std::function<void(int, int)> *job = nullptr;
+	int jobCount = 0;
+	int jobChunk = 1;
+	std::atomic<int> nextChunk;
+};
+
+#endif
@@ -0,0 +1,138 @@
+// Checks of NBodySystem: tree forces against direct summation, energy
+// conservation of the integrator, results independent of the thread
+// count, and no NaN without softening.
+
+#include <scene/nbody.h>
+#include <util/thread_pool.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+// Relative error of the tree accelerations against direct summation
+struct ForceError {
+	double mean;
+	double max;
+};
+
+static ForceError measureForceError(const NBodySystem &system) {
+	const std::vector<glm::vec3> &position = system.positions();
+	const std::vector<float> &mass = system.masses();
+	double softeningSquared = (double)system.softening * system.softening;
+
+	ForceError error = { 0.0, 0.0 };
+	for (size_t i = 0; i < position.size(); ++i) {
+		double a[3] = { 0.0, 0.0, 0.0 };
+		for (size_t j = 0; j < position.size(); ++j) {
+			double d[3] = { position[j].x - position[i].x, position[j].y - position[i].y, position[j].z - position[i].z };
+			double r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + softeningSquared;
+			double f = mass[j] / (r2 * sqrt(r2));
+			for (int k = 0; k < 3; ++k) a[k] += f * d[k];
+		}
+		glm::vec3 tree = system.accelerations()[i];
+		double diff[3] = { tree.x - a[0], tree.y - a[1], tree.z - a[2] };
+		double relative = sqrt(diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2]) /
+			sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+		error.mean += relative;
+		if (relative > error.max) error.max = relative;
+	}
+	error.mean /= position.size();
+	return error;
+}
+
+static int testForceError() {
+	int errors = 0;
+
+	srand(1);
+	NBodySystem system;
+	system.generate(2000);
+
+	// theta 0 opens every cell: the tree only reorders the sum
+	const float thetas[] = { 0.0f, 0.5f };
+	const double meanBounds[] = { 1e-5, 1e-3 };
+	const double maxBounds[] = { 1e-4, 5e-2 };
+	for (int t = 0; t < 2; ++t) {
+		system.theta = thetas[t];
+		system.step();
+		ForceError error = measureForceError(system);
+		printf("theta %.1f: force error mean %.2e, max %.2e, %d nodes\n", thetas[t], error.mean, error.max, system.nodeCount());
+		if (!(error.mean < meanBounds[t] && error.max < maxBounds[t])) {
+			fprintf(stderr, "force error above %.0e mean, %.0e max at theta %.1f\n", meanBounds[t], maxBounds[t], thetas[t]);
+			++errors;
+		}
+	}
+	return errors;
+}
+
+static int testEnergy() {
+	int errors = 0;
+
+	// The integrator alone (theta 0), then with the monopole error of the tree
+	const float thetas[] = { 0.0f, 0.5f };
+	const double bounds[] = { 1e-5, 1e-4 };
+	for (int t = 0; t < 2; ++t) {
+		srand(2);
+		NBodySystem system;
+		system.theta = thetas[t];
+		system.generate(500);
+		system.step();
+
+		double initial = system.totalEnergy();
+		for (int i = 0; i < 240; ++i) system.step();
+		double drift = fabs(system.totalEnergy() - initial) / fabs(initial);
+		printf("theta %.1f: energy drift %.2e over %d steps\n", thetas[t], drift, 240);
+		if (!(drift < bounds[t])) {
+			fprintf(stderr, "energy drift above %.0e at theta %.1f\n", bounds[t], thetas[t]);
+			++errors;
+		}
+	}
+	return errors;
+}
+
+static int testThreadCount() {
+	ThreadPool one(1), many(8);
+	NBodySystem systems[2];
+	systems[0].threadPool = &one;
+	systems[1].threadPool = &many;
+	for (NBodySystem &system : systems) {
+		srand(3);
+		system.generate(20000);
+		for (int i = 0; i < 10; ++i) system.step();
+	}
+
+	const std::vector<glm::vec3> &a = systems[0].positions();
+	const std::vector<glm::vec3> &b = systems[1].positions();
+	if (a.size() != b.size() || memcmp(&a[0], &b[0], a.size() * sizeof(glm::vec3)) != 0) {
+		fprintf(stderr, "positions differ between 1 and 8 threads\n");
+		return 1;
+	}
+	return 0;
+}
+
+static int testZeroSoftening() {
+	srand(4);
+	NBodySystem system;
+	system.softening = 0.0f;
+	system.generate(1000);
+	for (int i = 0; i < 5; ++i) system.step();
+
+	for (const glm::vec3 &p : system.positions()) {
+		if (!(isfinite(p.x) && isfinite(p.y) && isfinite(p.z))) {
+			fprintf(stderr, "non-finite position without softening\n");
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main() {
+	int errors = 0;
+	errors += testForceError();
+	errors += testEnergy();
+	errors += testThreadCount();
+	errors += testZeroSoftening();
+	return errors;
+}
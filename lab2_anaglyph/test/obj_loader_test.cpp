@@ -0,0 +1,81 @@
+// Regression tests of ParseObj: the same mesh written with absolute and with
+// relative (negative) indices, parsed as one chunk and split into many small
+// chunks so that relative indices reach back into earlier chunks.
+
+#include <models/obj_loader.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+// A strip of quads; each face refers to the last four vertices written
+static std::string makeStrip(int quad_count, bool relative) {
+	std::string text;
+	char line[256];
+	for (int i = 0; i < quad_count; ++i) {
+		snprintf(line, sizeof(line), "v %d 0 0\nv %d 1 0\nv %d 0 1\nv %d 1 1\nvt 0 %d\nvn 0 0 1\n", i, i, i, i, i);
+		text += line;
+		if (relative) {
+			snprintf(line, sizeof(line), "f -4/-1/-1 -3/-1/-1 -1/-1/-1 -2/-1/-1\n");
+		} else {
+			int v = i * 4 + 1;
+			snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+				v, i + 1, i + 1, v + 1, i + 1, i + 1, v + 3, i + 1, i + 1, v + 2, i + 1, i + 1);
+		}
+		text += line;
+	}
+	return text;
+}
+
+static bool sameMesh(const MeshData &a, const MeshData &b) {
+	return a.vertexCount == b.vertexCount && a.indexCount == b.indexCount &&
+		memcmp(a.vertices, b.vertices, a.vertexCount * sizeof(MeshVertex)) == 0 &&
+		memcmp(a.indices, b.indices, a.indexCount * sizeof(uint32_t)) == 0;
+}
+
+static int testRelativeAcrossChunks() {
+	int errors = 0;
+
+	std::string absolute = makeStrip(500, false);
+	std::string relative = makeStrip(500, true);
+
+	MeshData expected;
+	if (!ParseObj(absolute.data(), absolute.size(), expected, 1)) return 1;
+	errors += expected.indexCount != 500 * 6;
+
+	// Chunks of about 64 bytes hold less than one quad, so nearly every
+	// relative index resolves into an earlier chunk
+	const int threadCounts[] = { 1, 2, 4, 64 };
+	for (int threads : threadCounts) {
+		MeshData mesh;
+		if (!ParseObj(relative.data(), relative.size(), mesh, threads, 64) || !sameMesh(mesh, expected)) {
+			fprintf(stderr, "relative indices differ with %d threads\n", threads);
+			++errors;
+		}
+	}
+	return errors;
+}
+
+static int testRelativeOutOfRange() {
+	int errors = 0;
+
+	// -4 reaches before the first vertex, in the first chunk or a later one
+	std::string text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\n";
+	const int threadCounts[] = { 1, 4 };
+	for (int threads : threadCounts) {
+		MeshData mesh;
+		if (ParseObj(text.data(), text.size(), mesh, threads, 8)) {
+			fprintf(stderr, "out of range relative index accepted with %d threads\n", threads);
+			++errors;
+		}
+	}
+	return errors;
+}
+
+int main() {
+	int errors = 0;
+	errors += testRelativeAcrossChunks();
+	errors += testRelativeOutOfRange();
+	return errors;
+}
@@ -11,6 +11,12 @@ parser.add_argument("--video", type=str, help="Input video file")
 parser.add_argument("--save", type=str, help="Output annotated video file")
 parser.add_argument("--no-annotate", action="store_true", help="Disable face mesh")
 parser.add_argument("--faces", type=int, default=5, help="Maximum number of faces to detect")
+parser.add_argument("--gpu-overlay", action="store_true", help="Draw the face mesh with OpenGL in a couple of draw calls (needs moderngl and the native library of ../assignment2)")
+parser.add_argument("--smooth", choices=["one-euro", "kalman"], help="Filter the landmarks and predict them ahead by the processing latency (needs the native library of ../assignment2)")
+parser.add_argument("--native-resize", action="store_true", help="Flip and resize frames in one multithreaded pass (needs the native library of ../assignment2)")
+parser.add_argument("--track", action="store_true", help="Follow the landmarks with optical flow and run FaceMesh only when tracking fails or every few frames (needs the native library of ../assignment2)")
+parser.add_argument("--track-eval", action="store_true", help="With --track, also run FaceMesh on every frame and report how far the tracked landmarks are from it")
+parser.add_argument("--shm", type=str, metavar="NAME", help="Publish frames and landmarks to a shared memory ring for another process, e.g. /ar_frames (needs the native library of ../assignment2)")
 
 args = parser.parse_args()
 
@@ -19,6 +25,12 @@ INPUT_VIDEO = args.video
 SAVE_OUTPUT = args.save
 ANNOTATE = not args.no_annotate
 MAX_FACES = args.faces
+SMOOTH = args.smooth
+GPU_OVERLAY = args.gpu_overlay
+NATIVE_RESIZE = args.native_resize
+TRACK = args.track or args.track_eval
+TRACK_EVAL = args.track_eval
+SHM_NAME = args.shm
 
 
 # mediapipe setup
@@ -40,6 +52,61 @@ face_mesh = mp_face_mesh.FaceMesh(
 print("FaceMesh ready.")
 
 
+# the native library of ../assignment2
+arnative = None
+if SMOOTH or GPU_OVERLAY or NATIVE_RESIZE or TRACK or SHM_NAME:
+    import os
+    import sys
+    import numpy as np
+    sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "assignment2"))
+    import arnative
+    if not arnative.available():
+        print("Native library not built, see ../assignment2/native.")
+        arnative = None
+
+# landmark filter, one channel per coordinate of every landmark of every face
+landmark_filter = None
+if SMOOTH and arnative:
+    kind = arnative.FILTER_KALMAN if SMOOTH == "kalman" else arnative.FILTER_ONE_EURO
+    landmark_filter = arnative.LandmarkFilter((MAX_FACES, 478, 3), kind)
+    print(f"Smoothing landmarks ({SMOOTH}).")
+
+# offscreen GL overlay: all faces' tessellation in one line draw and all
+# landmarks in one instanced draw, read back and laid over the frame
+gl_context = None
+if GPU_OVERLAY and arnative:
+    import moderngl
+    gl_context = moderngl.create_standalone_context(require=330)
+    overlay = arnative.Overlay(478, MAX_FACES, mp_face_mesh.FACEMESH_TESSELATION)
+    overlay_target = None
+    print("Drawing the face mesh with OpenGL.")
+
+# flip + resize of each frame
+preprocessor = None
+if NATIVE_RESIZE and arnative:
+    preprocessor = arnative.Preprocessor()
+    print(f"Preprocessing frames on {preprocessor.threads} threads.")
+
+# detect-then-track: FaceMesh runs when the tracker asks for it, the
+# landmarks are followed by optical flow in between
+tracker = None
+if TRACK and arnative:
+    tracker = arnative.LandmarkTracker(478)
+    print("Tracking landmarks between FaceMesh runs.")
+tracked_landmarks = None    # normalized landmarks of the last FaceMesh run, faces x 478 x 3
+frame_count = 0
+detector_runs = 0
+track_errors = []
+
+# shared memory ring to a reader process: the frame, and the landmarks of
+# each face as the record; created at the first frame, once its size is known
+shm_ring = None
+shm_dropped = 0
+
+filtered_faces = 0
+latency = 0.0
+
+
 # prepare video capture
 if USE_WEBCAM:
     print("Opening webcam...")
@@ -82,18 +149,22 @@ print("Processing started (ESC to quit)")
 # As long as device is ready
 while cap.isOpened():
     # Read the video frame
+    capture_time = time.perf_counter()
+    capture_ns = time.monotonic_ns()
     success, image = cap.read()
     if not success:
         print("End of video or frame read failed")
         break
  
-    # flip the image for a front-facing webcam view
-    if USE_WEBCAM:
-        image = cv2.flip(image, 1)
-
-    # resizing the frame
+    # resizing the frame, flipped for a front-facing webcam view
     aspect_ratio = image.shape[1] / image.shape[0]
-    image = cv2.resize(image, (int(512 * aspect_ratio), 512))
+    size = (int(512 * aspect_ratio), 512)
+    if preprocessor is not None:
+        image = preprocessor(image, size, mirror=USE_WEBCAM)
+    else:
+        if USE_WEBCAM:
+            image = cv2.flip(image, 1)
+        image = cv2.resize(image, size)
 
     # calculating the FPS
     currentTime = time.time()
@@ -104,9 +175,95 @@ while cap.isOpened():
     cv2.putText(image, str(int(fps))+" FPS", (10, 70), 
                 cv2.FONT_HERSHEY_COMPLEX, 1, (0, 255, 0), 2)
     
-    # mediapipe processing
-    results = face_mesh.process(image)
-    if ANNOTATE and results.multi_face_landmarks:
+    # mediapipe processing, or the last run's landmarks followed into this
+    # frame while tracking works
+    frame_count += 1
+    if tracker:
+        scale = np.float32([image.shape[1], image.shape[0]])
+        tracking = tracked_landmarks is not None
+        tracked = tracker.track(image) if tracking else None
+        if tracked is None or TRACK_EVAL:
+            detected = face_mesh.process(image)
+            detector_runs += int(tracked is None)
+        if tracked is None:
+            results = detected
+            tracked_landmarks = None
+            if results.multi_face_landmarks:
+                faces = results.multi_face_landmarks[:MAX_FACES]
+                tracked_landmarks = np.float32([[(l.x, l.y, l.z) for l in f.landmark] for f in faces])
+                # without a track() call on this frame the tracker needs the frame itself
+                tracker.set_points(tracked_landmarks[:, :, :2] * scale, None if tracking else image)
+        else:
+            # x and y from the tracker, z from the last run; every coordinate
+            # is written, as the filter below changes them in place
+            tracked_landmarks[:, :, :2] = tracked[0] / scale
+            for face, landmarks in zip(results.multi_face_landmarks, tracked_landmarks):
+                for l, p in zip(face.landmark, landmarks):
+                    l.x, l.y, l.z = float(p[0]), float(p[1]), float(p[2])
+            if TRACK_EVAL and detected.multi_face_landmarks and len(detected.multi_face_landmarks) >= len(tracked_landmarks):
+                reference = np.float32([[(l.x, l.y) for l in f.landmark] for f in detected.multi_face_landmarks[:len(tracked_landmarks)]])
+                track_errors.append(np.linalg.norm((tracked_landmarks[:, :, :2] - reference) * scale, axis=-1).ravel())
+    else:
+        results = face_mesh.process(image)
+        detector_runs += 1
+
+    # replace the landmarks by the filtered ones, extrapolated to the time
+    # the frame will be on screen
+    if landmark_filter and results.multi_face_landmarks:
+        faces = min(len(results.multi_face_landmarks), MAX_FACES)
+        if faces != filtered_faces:
+            landmark_filter.reset()
+            filtered_faces = faces
+        # pixels, the scale the filter parameters are meant for
+        scale = np.float32([image.shape[1], image.shape[0], image.shape[1]])
+        measured = np.zeros((MAX_FACES, 478, 3), dtype=np.float32)
+        for f in range(faces):
+            landmarks = results.multi_face_landmarks[f].landmark
+            measured[f, :len(landmarks)] = [(l.x, l.y, l.z) for l in landmarks]
+        _, predicted = landmark_filter.update(measured * scale, capture_time, latency)
+        predicted = predicted / scale
+        for f in range(faces):
+            for l, p in zip(results.multi_face_landmarks[f].landmark, predicted[f]):
+                l.x, l.y, l.z = float(p[0]), float(p[1]), float(p[2])
+    elif landmark_filter:
+        filtered_faces = 0
+
+    # publish before annotating; a reader that falls behind loses frames
+    # instead of holding up the capture
+    if SHM_NAME and arnative:
+        if shm_ring is None:
+            shm_ring = arnative.SharedRing(SHM_NAME, create=True, frame_capacity=image.nbytes,
+                                           record_capacity=MAX_FACES * 478 * 3 * 4)
+            print(f"Publishing to shared memory {SHM_NAME}.")
+        slot = shm_ring.begin_write(timeout_ms=0)
+        if slot is None:
+            shm_dropped += 1
+        else:
+            faces = results.multi_face_landmarks[:MAX_FACES] if results.multi_face_landmarks else []
+            landmarks = np.zeros((len(faces), 478, 3), dtype=np.float32)
+            for f, face in enumerate(faces):
+                landmarks[f, :len(face.landmark)] = [(l.x, l.y, l.z) for l in face.landmark]
+            slot.set_frame(image)
+            slot.set_record(landmarks)
+            slot.header.timestamp_ns = capture_ns
+            shm_ring.end_write()
+    if ANNOTATE and results.multi_face_landmarks and gl_context:
+        size = (image.shape[1], image.shape[0])
+        if overlay_target is None or overlay_target.size != size:
+            overlay_target = gl_context.simple_framebuffer(size)
+        overlay_target.use()
+        overlay_target.clear(0.0, 0.0, 0.0, 0.0)
+        faces = min(len(results.multi_face_landmarks), MAX_FACES)
+        points = np.zeros((faces, 478, 3), dtype=np.float32)
+        for f in range(faces):
+            landmarks = results.multi_face_landmarks[f].landmark
+            points[f, :len(landmarks)] = [(l.x, l.y, 0.0) for l in landmarks]
+        overlay.draw(points, arnative.image_transform(), marker_size=2.0 * drawingSpec.circle_radius)
+        # rows come bottom up, RGBA to BGR
+        drawn = np.frombuffer(overlay_target.read(components=4), dtype=np.uint8).reshape(size[1], size[0], 4)[::-1]
+        mask = drawn[:, :, 3] > 0
+        image[mask] = drawn[mask][:, 2::-1]
+    elif ANNOTATE and results.multi_face_landmarks:
         for face_landmarks in results.multi_face_landmarks:
             mp_drawing.draw_landmarks(
             image=image,
@@ -120,11 +277,24 @@ while cap.isOpened():
 
     # Display
     cv2.imshow('OpenCV camera', image)
+    latency = 0.9 * latency + 0.1 * (time.perf_counter() - capture_time)
 
     if cv2.waitKey(5) & 0xFF == 27:
         print("ESC pressed, exiting.")
         break
 
+if tracker:
+    print(f"FaceMesh ran on {detector_runs} of {frame_count} frames.")
+if track_errors:
+    # distance of the tracked landmarks to FaceMesh run on the same frames
+    errors = np.concatenate(track_errors)
+    print(f"Tracked landmarks vs FaceMesh on {len(track_errors)} tracked frames: mean {errors.mean():.2f} px, "
+          f"p95 {np.percentile(errors, 95):.2f} px, max {errors.max():.2f} px")
+
+if shm_ring:
+    print(f"Published {shm_ring.stats()[0]} frames to {SHM_NAME}, dropped {shm_dropped} for a slow reader.")
+    shm_ring.close_writer()
+
 # Clean up after the loop
 cap.release()
 if out: